@@ -90,7 +90,14 @@ LIBS += -L../libKitsunemimiCrypto/src/debug -lKitsunemimiCrypto
 LIBS += -L../libKitsunemimiCrypto/src/release -lKitsunemimiCrypto
 INCLUDEPATH += ../libKitsunemimiCrypto/include
 
-LIBS += -lcryptopp -lssl -lsqlite3 -luuid -lcrypto -pthread -lprotobuf -lpthread
+# the session-close-callback of HanamiMessaging::initialize is only available since
+# libKitsunemimiHanamiNetwork v0.4.0, so it has to be enabled with
+# "CONFIG += session_close_callback"
+session_close_callback {
+    DEFINES += SHIORI_SESSION_CLOSE_CALLBACK
+}
+
+LIBS += -lcryptopp -lssl -lsqlite3 -luuid -lcrypto -pthread -lprotobuf -lpthread -llz4 -lzstd
 
 INCLUDEPATH += $$PWD \
                src
@@ -102,12 +109,16 @@ SOURCES += src/main.cpp \
     src/api/v1/cluster_snapshot/get_cluster_snapshot.cpp \
     src/api/v1/cluster_snapshot/list_cluster_snapshot.cpp \
     src/api/v1/data_files/check_data_set.cpp \
+    src/api/v1/data_files/csv/append_csv_data_set.cpp \
     src/api/v1/data_files/csv/create_csv_data_set.cpp \
+    src/api/v1/data_files/csv/finalize_append_csv_data_set.cpp \
     src/api/v1/data_files/csv/finalize_csv_data_set.cpp \
+    src/api/v1/data_files/create_data_set_view.cpp \
     src/api/v1/data_files/delete_data_set.cpp \
     src/api/v1/data_files/get_data_set.cpp \
     src/api/v1/data_files/get_progress_data_set.cpp \
     src/api/v1/data_files/list_data_set.cpp \
+    src/api/v1/data_files/pin_data_set.cpp \
     src/api/v1/data_files/mnist/create_mnist_data_set.cpp \
     src/api/v1/data_files/mnist/finalize_mnist_data_set.cpp \
     src/api/v1/logs/get_audit_log.cpp \
@@ -115,10 +126,29 @@ SOURCES += src/main.cpp \
     src/api/v1/request_results/delete_request_result.cpp \
     src/api/v1/request_results/get_request_result.cpp \
     src/api/v1/request_results/list_request_result.cpp \
+    src/api/v1/storage/get_deduplication_report.cpp \
+    src/api/v1/storage/get_payload_cache.cpp \
+    src/api/v1/storage/get_warmup_status.cpp \
+    src/api/v1/storage/start_warmup.cpp \
+    src/core/batch_server.cpp \
+    src/core/block_store.cpp \
+    src/core/data_set_batcher.cpp \
+    src/core/data_set_cache.cpp \
     src/core/data_set_files/data_set_file.cpp \
     src/core/data_set_files/image_data_set_file.cpp \
     src/core/data_set_files/table_data_set_file.cpp \
+    src/core/data_set_files/value_conversion.cpp \
+    src/core/data_set_files/view_data_set_file.cpp \
+    src/core/load_coalescer.cpp \
+    src/core/local_handoff.cpp \
+    src/core/mapped_file.cpp \
+    src/core/normalization_cache.cpp \
+    src/core/payload_cache.cpp \
+    src/core/payload_transform.cpp \
+    src/core/stream_sender.cpp \
     src/core/temp_file_handler.cpp \
+    src/core/warmup_manager.cpp \
+    src/core/worker_pool.cpp \
     src/database/audit_log_table.cpp \
     src/database/cluster_snapshot_table.cpp \
     src/database/data_set_table.cpp \
@@ -134,12 +164,16 @@ HEADERS += \
     src/api/v1/cluster_snapshot/get_cluster_snapshot.h \
     src/api/v1/cluster_snapshot/list_cluster_snapshot.h \
     src/api/v1/data_files/check_data_set.h \
+    src/api/v1/data_files/csv/append_csv_data_set.h \
     src/api/v1/data_files/csv/create_csv_data_set.h \
+    src/api/v1/data_files/csv/finalize_append_csv_data_set.h \
     src/api/v1/data_files/csv/finalize_csv_data_set.h \
+    src/api/v1/data_files/create_data_set_view.h \
     src/api/v1/data_files/delete_data_set.h \
     src/api/v1/data_files/get_data_set.h \
     src/api/v1/data_files/get_progress_data_set.h \
     src/api/v1/data_files/list_data_set.h \
+    src/api/v1/data_files/pin_data_set.h \
     src/api/v1/data_files/mnist/create_mnist_data_set.h \
     src/api/v1/data_files/mnist/finalize_mnist_data_set.h \
     src/api/v1/logs/get_audit_log.h \
@@ -147,13 +181,32 @@ HEADERS += \
     src/api/v1/request_results/delete_request_result.h \
     src/api/v1/request_results/get_request_result.h \
     src/api/v1/request_results/list_request_result.h \
+    src/api/v1/storage/get_deduplication_report.h \
+    src/api/v1/storage/get_payload_cache.h \
+    src/api/v1/storage/get_warmup_status.h \
+    src/api/v1/storage/start_warmup.h \
     src/args.h \
     src/callbacks.h \
     src/config.h \
+    src/core/batch_server.h \
+    src/core/block_store.h \
+    src/core/data_set_batcher.h \
+    src/core/data_set_cache.h \
     src/core/data_set_files/data_set_file.h \
     src/core/data_set_files/image_data_set_file.h \
     src/core/data_set_files/table_data_set_file.h \
+    src/core/data_set_files/value_conversion.h \
+    src/core/data_set_files/view_data_set_file.h \
+    src/core/load_coalescer.h \
+    src/core/local_handoff.h \
+    src/core/mapped_file.h \
+    src/core/normalization_cache.h \
+    src/core/payload_cache.h \
+    src/core/payload_transform.h \
+    src/core/stream_sender.h \
     src/core/temp_file_handler.h \
+    src/core/warmup_manager.h \
+    src/core/worker_pool.h \
     src/database/audit_log_table.h \
     src/database/cluster_snapshot_table.h \
     src/database/data_set_table.h \
@@ -32,10 +32,14 @@
 #include <api/v1/data_files/delete_data_set.h>
 #include <api/v1/data_files/check_data_set.h>
 #include <api/v1/data_files/get_progress_data_set.h>
+#include <api/v1/data_files/create_data_set_view.h>
+#include <api/v1/data_files/pin_data_set.h>
 #include <api/v1/data_files/mnist/create_mnist_data_set.h>
 #include <api/v1/data_files/mnist/finalize_mnist_data_set.h>
 #include <api/v1/data_files/csv/create_csv_data_set.h>
 #include <api/v1/data_files/csv/finalize_csv_data_set.h>
+#include <api/v1/data_files/csv/append_csv_data_set.h>
+#include <api/v1/data_files/csv/finalize_append_csv_data_set.h>
 
 #include <api/v1/cluster_snapshot/create_cluster_snapshot.h>
 #include <api/v1/cluster_snapshot/delete_cluster_snapshot.h>
@@ -50,6 +54,11 @@
 #include <api/v1/logs/get_audit_log.h>
 #include <api/v1/logs/get_error_log.h>
 
+#include <api/v1/storage/get_deduplication_report.h>
+#include <api/v1/storage/get_payload_cache.h>
+#include <api/v1/storage/start_warmup.h>
+#include <api/v1/storage/get_warmup_status.h>
+
 using Kitsunemimi::Hanami::HanamiMessaging;
 
 /**
@@ -89,6 +98,34 @@ dataSetBlossoms()
                            group,
                            "finalize_csv");
 
+    assert(interface->addBlossom(group, "append_csv", new AppendCsvDataSet()));
+    interface->addEndpoint("v1/csv/data_set/append",
+                           Kitsunemimi::Hanami::POST_TYPE,
+                           Kitsunemimi::Hanami::BLOSSOM_TYPE,
+                           group,
+                           "append_csv");
+
+    assert(interface->addBlossom(group, "finalize_append_csv", new FinalizeAppendCsvDataSet()));
+    interface->addEndpoint("v1/csv/data_set/append",
+                           Kitsunemimi::Hanami::PUT_TYPE,
+                           Kitsunemimi::Hanami::BLOSSOM_TYPE,
+                           group,
+                           "finalize_append_csv");
+
+    assert(interface->addBlossom(group, "create_view", new CreateDataSetView()));
+    interface->addEndpoint("v1/data_set/view",
+                           Kitsunemimi::Hanami::POST_TYPE,
+                           Kitsunemimi::Hanami::BLOSSOM_TYPE,
+                           group,
+                           "create_view");
+
+    assert(interface->addBlossom(group, "pin", new PinDataSet()));
+    interface->addEndpoint("v1/data_set/pin",
+                           Kitsunemimi::Hanami::PUT_TYPE,
+                           Kitsunemimi::Hanami::BLOSSOM_TYPE,
+                           group,
+                           "pin");
+
     assert(interface->addBlossom(group, "check", new CheckDataSet()));
     interface->addEndpoint("v1/data_set/check",
                            Kitsunemimi::Hanami::POST_TYPE,
@@ -225,6 +262,44 @@ logsBlossoms()
                            "get_error_log");
 }
 
+/**
+ * @brief init storage blossoms
+ */
+void
+storageBlossoms()
+{
+    HanamiMessaging* interface = HanamiMessaging::getInstance();
+    const std::string group = "storage";
+
+    assert(interface->addBlossom(group, "dedup_report", new GetDeduplicationReport()));
+    interface->addEndpoint("v1/storage/deduplication",
+                           Kitsunemimi::Hanami::GET_TYPE,
+                           Kitsunemimi::Hanami::BLOSSOM_TYPE,
+                           group,
+                           "dedup_report");
+
+    assert(interface->addBlossom(group, "payload_cache", new GetPayloadCache()));
+    interface->addEndpoint("v1/storage/payload_cache",
+                           Kitsunemimi::Hanami::GET_TYPE,
+                           Kitsunemimi::Hanami::BLOSSOM_TYPE,
+                           group,
+                           "payload_cache");
+
+    assert(interface->addBlossom(group, "start_warmup", new StartWarmup()));
+    interface->addEndpoint("v1/storage/warmup",
+                           Kitsunemimi::Hanami::POST_TYPE,
+                           Kitsunemimi::Hanami::BLOSSOM_TYPE,
+                           group,
+                           "start_warmup");
+
+    assert(interface->addBlossom(group, "warmup_status", new GetWarmupStatus()));
+    interface->addEndpoint("v1/storage/warmup",
+                           Kitsunemimi::Hanami::GET_TYPE,
+                           Kitsunemimi::Hanami::BLOSSOM_TYPE,
+                           group,
+                           "warmup_status");
+}
+
 void
 initBlossoms()
 {
@@ -232,6 +307,7 @@ initBlossoms()
     clusterSnapshotBlossoms();
     resultBlossoms();
     logsBlossoms();
+    storageBlossoms();
 }
 
 #endif // SHIORIARCHIVE_BLOSSOM_INITIALIZING_H
@@ -24,6 +24,7 @@
 
 #include <shiori_root.h>
 #include <database/cluster_snapshot_table.h>
+#include <core/block_store.h>
 
 #include <libKitsunemimiJson/json_item.h>
 #include <libKitsunemimiCommon/methods/file_methods.h>
@@ -87,8 +88,8 @@ DeleteClusterSnapshot::runTask(BlossomIO &blossomIO,
         return false;
     }
 
-    // delete local files
-    if(Kitsunemimi::deleteFileOrDir(location, error) == false)
+    // delete local files and the blocks, which are not used by other files anymore
+    if(ShioriRoot::clusterSnapshotBlockStore->deleteFile(location, error) == false)
     {
         status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
         return false;
@@ -25,6 +25,7 @@
 #include <shiori_root.h>
 #include <database/cluster_snapshot_table.h>
 #include <core/temp_file_handler.h>
+#include <core/block_store.h>
 
 #include <libKitsunemimiHanamiCommon/enums.h>
 
@@ -131,6 +132,12 @@ FinalizeClusterSnapshot::runTask(BlossomIO &blossomIO,
         return false;
     }
 
+    // split snapshot into deduplicated blocks, because successive snapshots of the same cluster
+    // are mostly identical. If this fails, the file is kept complete.
+    if(ShioriRoot::clusterSnapshotBlockStore->storeFile(targetLocation, error) == false) {
+        LOG_ERROR(error);
+    }
+
     // create output
     blossomIO.output.insert("uuid", uuid);
 
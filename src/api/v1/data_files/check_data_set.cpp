@@ -26,12 +26,12 @@
 #include <database/request_result_table.h>
 #include <database/data_set_table.h>
 #include <core/data_set_files/data_set_file.h>
+#include <core/data_set_files/image_data_set_file.h>
+#include <core/data_set_cache.h>
 
 #include <libKitsunemimiJson/json_item.h>
 #include <libKitsunemimiCommon/methods/file_methods.h>
-#include <libKitsunemimiCommon/buffer/data_buffer.h>
 #include <libKitsunemimiCommon/files/text_file.h>
-#include <libKitsunemimiCommon/files/binary_file.h>
 #include <libKitsunemimiConfig/config_handler.h>
 
 #include <libKitsunemimiHanamiCommon/enums.h>
@@ -113,42 +113,72 @@ CheckDataSet::runTask(Hanami::BlossomIO &blossomIO,
     // get file information
     const std::string location = blossomIO.output.get("location").getString();
 
-    Kitsunemimi::DataBuffer buffer;
-    DataSetFile::DataSetHeader dataSetHeader;
-    DataSetFile::ImageTypeHeader imageTypeHeader;
-    Kitsunemimi::BinaryFile file(location);
-
-    // read data-set-header
-    if(file.readCompleteFile(buffer, error) == false)
+    // get data-set from the cache of opened data-sets
+    std::shared_ptr<DataSetFile> file = ShioriRoot::dataSetCache->getDataSetFile(location, error);
+    if(file == nullptr)
     {
         error.addMeesage("Failed to read data-set-header from file '" + location + "'");
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+
+    // check type
+    ImageDataSetFile* imageFile = dynamic_cast<ImageDataSetFile*>(file.get());
+    if(imageFile == nullptr)
+    {
+        status.errorMessage = "Only image-data-sets can be checked.";
+        status.statusCode = Kitsunemimi::Hanami::BAD_REQUEST_RTYPE;
+        error.addMeesage(status.errorMessage);
         return false;
     }
 
+    // get payload directly from the mapped file and only copy it, if this is not possible,
+    // which is the case for compressed files or files, which are not stored as float32
+    DataSetFile::PayloadView view;
+    float* payloadCopy = nullptr;
+    if(imageFile->getPayloadView(view) == false
+            || view.dataType != DataSetFile::FLOAT32_DTYPE)
+    {
+        uint64_t payloadSize = 0;
+        payloadCopy = imageFile->getPayload(payloadSize);
+        if(payloadCopy == nullptr)
+        {
+            error.addMeesage("Failed to access payload of file '" + location + "'");
+            status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+            return false;
+        }
+        view.data = payloadCopy;
+        view.size = payloadSize;
+    }
+
     // prepare values
     uint64_t correctValues = 0;
-    uint64_t dataPos = sizeof(DataSetFile::DataSetHeader) + sizeof(DataSetFile::ImageTypeHeader);
-    const uint8_t* u8Data = static_cast<const uint8_t*>(buffer.data);
-    memcpy(&dataSetHeader, buffer.data, sizeof(DataSetFile::DataSetHeader));
-    memcpy(&imageTypeHeader,
-           &u8Data[sizeof(DataSetFile::DataSetHeader)],
-           sizeof(DataSetFile::ImageTypeHeader));
+    const DataSetFile::ImageTypeHeader &imageTypeHeader = imageFile->imageHeader;
     const uint64_t lineOffset = imageTypeHeader.numberOfInputsX * imageTypeHeader.numberOfInputsY;
     const uint64_t lineSize = (imageTypeHeader.numberOfInputsX * imageTypeHeader.numberOfInputsY)
                               + imageTypeHeader.numberOfOutputs;
-    const float* content = reinterpret_cast<const float*>(&u8Data[dataPos]);
+    const float* content = static_cast<const float*>(view.data);
 
     // iterate over all values and check
     DataArray* compareData = result.get("data").getItemContent()->toArray();
     for(uint64_t i = 0; i < compareData->size(); i++)
     {
-        const uint64_t actualPos = (i * lineSize) + lineOffset;
+        // values outside of the data-set are counted as wrong
         const uint64_t checkVal = compareData->get(i)->toValue()->getInt();
+        if(i >= imageTypeHeader.numberOfImages
+                || checkVal >= imageTypeHeader.numberOfOutputs)
+        {
+            continue;
+        }
+
+        const uint64_t actualPos = (i * lineSize) + lineOffset;
         if(content[actualPos + checkVal] > 0.0f) {
             correctValues++;
         }
     }
 
+    delete[] payloadCopy;
+
     // add result to output
     const float correctness = (100.0f / static_cast<float>(compareData->size()))
                               * static_cast<float>(correctValues);
@@ -0,0 +1,276 @@
+/**
+ * @file        create_data_set_view.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "create_data_set_view.h"
+
+#include <shiori_root.h>
+#include <database/data_set_table.h>
+#include <core/data_set_cache.h>
+#include <core/data_set_files/view_data_set_file.h>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/defines.h>
+
+#include <libKitsunemimiConfig/config_handler.h>
+#include <libKitsunemimiJson/json_item.h>
+
+using namespace Kitsunemimi::Hanami;
+
+CreateDataSetView::CreateDataSetView()
+    : Blossom("Create a view on a subset of the rows of an existing data-set, without copying "
+              "the rows.")
+{
+    //----------------------------------------------------------------------------------------------
+    // input
+    //----------------------------------------------------------------------------------------------
+
+    registerInputField("name",
+                       SAKURA_STRING_TYPE,
+                       true,
+                       "Name of the new view.");
+    assert(addFieldBorder("name", 4, 256));
+    assert(addFieldRegex("name", NAME_REGEX));
+
+    registerInputField("parent_uuid",
+                       SAKURA_STRING_TYPE,
+                       true,
+                       "UUID of the data-set, on which the view is based.");
+    assert(addFieldRegex("parent_uuid", UUID_REGEX));
+
+    registerInputField("row_ranges",
+                       SAKURA_ARRAY_TYPE,
+                       false,
+                       "List of ranges of rows of the parent as pairs of first row and "
+                       "number of rows, like [[0, 5000], [8000, 100]].");
+
+    registerInputField("rows",
+                       SAKURA_ARRAY_TYPE,
+                       false,
+                       "List of single rows of the parent as alternative to the row-ranges.");
+
+    //----------------------------------------------------------------------------------------------
+    // output
+    //----------------------------------------------------------------------------------------------
+
+    registerOutputField("uuid",
+                        SAKURA_STRING_TYPE,
+                        "UUID of the new view.");
+    registerOutputField("name",
+                        SAKURA_STRING_TYPE,
+                        "Name of the new view.");
+    registerOutputField("owner_id",
+                        SAKURA_STRING_TYPE,
+                        "ID of the user, who created the view.");
+    registerOutputField("project_id",
+                        SAKURA_STRING_TYPE,
+                        "ID of the project, where the view belongs to.");
+    registerOutputField("visibility",
+                        SAKURA_STRING_TYPE,
+                        "Visibility of the view (private, shared, public).");
+    registerOutputField("type",
+                        SAKURA_STRING_TYPE,
+                        "Type of the new set (view)");
+    registerOutputField("lines",
+                        SAKURA_INT_TYPE,
+                        "Number of lines of the view.");
+
+    //----------------------------------------------------------------------------------------------
+    //
+    //----------------------------------------------------------------------------------------------
+}
+
+/**
+ * @brief runTask
+ */
+bool
+CreateDataSetView::runTask(BlossomIO &blossomIO,
+                           const Kitsunemimi::DataMap &context,
+                           BlossomStatus &status,
+                           Kitsunemimi::ErrorContainer &error)
+{
+    const std::string name = blossomIO.input.get("name").getString();
+    const std::string parentUuid = blossomIO.input.get("parent_uuid").getString();
+    const Kitsunemimi::Hanami::UserContext userContext(context);
+
+    // get requested rows
+    std::vector<DataSetFile::RowRange> ranges;
+    if(getRowRanges(ranges, blossomIO.input, status.errorMessage) == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::BAD_REQUEST_RTYPE;
+        error.addMeesage(status.errorMessage);
+        return false;
+    }
+
+    // get parent from database
+    Kitsunemimi::JsonItem parentData;
+    if(ShioriRoot::dataSetTable->getDataSet(parentData,
+                                            parentUuid,
+                                            userContext,
+                                            error,
+                                            true) == false)
+    {
+        status.errorMessage = "Data with uuid '" + parentUuid + "' not found.";
+        status.statusCode = Kitsunemimi::Hanami::NOT_FOUND_RTYPE;
+        return false;
+    }
+
+    // open parent
+    const std::string parentLocation = parentData.get("location").getString();
+    std::shared_ptr<DataSetFile> parent = ShioriRoot::dataSetCache->getDataSetFile(parentLocation,
+                                                                                   error);
+    if(parent == nullptr)
+    {
+        error.addMeesage("Failed to open parent of the view '" + parentLocation + "'");
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+
+    // get directory to store data from config
+    bool success = false;
+    std::string targetFilePath = GET_STRING_CONFIG("shiori", "data_set_location", success);
+    if(success == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        error.addMeesage("file-location to store dataset is missing in the config");
+        return false;
+    }
+
+    // build absolut file-path to store the file
+    if(targetFilePath.at(targetFilePath.size() - 1) != '/') {
+        targetFilePath.append("/");
+    }
+    targetFilePath.append(name + "_view_" + userContext.userId);
+
+    // write view-file, which only contains the location of the parent and the ranges of rows
+    ViewDataSetFile file(targetFilePath);
+    file.name = name;
+    if(file.initView(parent, parentLocation, ranges, error) == false)
+    {
+        status.errorMessage = "Requested rows are outside of the data-set with uuid '"
+                              + parentUuid + "'.";
+        status.statusCode = Kitsunemimi::Hanami::BAD_REQUEST_RTYPE;
+        return false;
+    }
+    if(file.initNewFile() == false)
+    {
+        error.addMeesage("Failed to write view-file '" + targetFilePath + "'");
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+
+    // register in database
+    blossomIO.output.insert("name", name);
+    blossomIO.output.insert("type", "view");
+    blossomIO.output.insert("location", targetFilePath);
+    blossomIO.output.insert("project_id", userContext.projectId);
+    blossomIO.output.insert("owner_id", userContext.userId);
+    blossomIO.output.insert("visibility", "private");
+
+    // views have no uploads, so the list of temp-files is empty
+    Kitsunemimi::JsonItem tempFiles;
+    tempFiles.parse("{}", error);
+    blossomIO.output.insert("temp_files", tempFiles);
+
+    // add to database
+    if(ShioriRoot::dataSetTable->addDataSet(blossomIO.output, userContext, error) == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+
+    // add values to output
+    blossomIO.output.insert("lines", static_cast<long>(file.getNumberOfRows()));
+
+    // remove blocked values from output
+    blossomIO.output.remove("location");
+    blossomIO.output.remove("temp_files");
+
+    return true;
+}
+
+/**
+ * @brief convert the requested rows of the input into ranges of rows
+ *
+ * @param ranges reference for the resulting ranges
+ * @param input input of the request
+ * @param errorMessage reference for the message, which is returned to the user
+ *
+ * @return false, if the input is invalid, else true
+ */
+bool
+CreateDataSetView::getRowRanges(std::vector<DataSetFile::RowRange> &ranges,
+                                const Kitsunemimi::JsonItem &input,
+                                std::string &errorMessage)
+{
+    const Kitsunemimi::JsonItem rowRanges = input.get("row_ranges");
+    const Kitsunemimi::JsonItem rows = input.get("rows");
+    if(rowRanges.isArray() == rows.isArray())
+    {
+        errorMessage = "Exactly one of 'row_ranges' or 'rows' has to be set.";
+        return false;
+    }
+
+    // single rows are converted into ranges with only one row, which are merged by the view
+    if(rows.isArray())
+    {
+        for(uint64_t i = 0; i < rows.size(); i++)
+        {
+            const Kitsunemimi::JsonItem row = rows.get(i);
+            if(row.isInteger() == false
+                    || row.getLong() < 0)
+            {
+                errorMessage = "Entries of 'rows' have to be positive integers.";
+                return false;
+            }
+
+            DataSetFile::RowRange range;
+            range.startRow = row.getLong();
+            range.numberOfRows = 1;
+            ranges.push_back(range);
+        }
+
+        return true;
+    }
+
+    for(uint64_t i = 0; i < rowRanges.size(); i++)
+    {
+        const Kitsunemimi::JsonItem pair = rowRanges.get(i);
+        if(pair.isArray() == false
+                || pair.size() != 2
+                || pair.get(0).isInteger() == false
+                || pair.get(1).isInteger() == false
+                || pair.get(0).getLong() < 0
+                || pair.get(1).getLong() < 0)
+        {
+            errorMessage = "Entries of 'row_ranges' have to be pairs of positive integers.";
+            return false;
+        }
+
+        DataSetFile::RowRange range;
+        range.startRow = pair.get(0).getLong();
+        range.numberOfRows = pair.get(1).getLong();
+        ranges.push_back(range);
+    }
+
+    return true;
+}
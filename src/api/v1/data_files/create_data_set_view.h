@@ -0,0 +1,47 @@
+/**
+ * @file        create_data_set_view.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_CREATE_DATA_SET_VIEW_H
+#define SHIORIARCHIVE_CREATE_DATA_SET_VIEW_H
+
+#include <libKitsunemimiHanamiNetwork/blossom.h>
+#include <core/data_set_files/data_set_file.h>
+
+class CreateDataSetView
+        : public Kitsunemimi::Hanami::Blossom
+{
+public:
+    CreateDataSetView();
+
+protected:
+    bool runTask(Kitsunemimi::Hanami::BlossomIO &blossomIO,
+                 const Kitsunemimi::DataMap &context,
+                 Kitsunemimi::Hanami::BlossomStatus &status,
+                 Kitsunemimi::ErrorContainer &error);
+
+private:
+    bool getRowRanges(std::vector<DataSetFile::RowRange> &ranges,
+                      const Kitsunemimi::JsonItem &input,
+                      std::string &errorMessage);
+};
+
+#endif // SHIORIARCHIVE_CREATE_DATA_SET_VIEW_H
@@ -0,0 +1,127 @@
+/**
+ * @file        append_csv_data_set.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "append_csv_data_set.h"
+
+#include <shiori_root.h>
+#include <database/data_set_table.h>
+#include <core/temp_file_handler.h>
+
+#include <libKitsunemimiHanamiCommon/uuid.h>
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/defines.h>
+#include <libKitsunemimiHanamiNetwork/hanami_messaging.h>
+
+#include <libKitsunemimiJson/json_item.h>
+
+using namespace Kitsunemimi::Hanami;
+
+AppendCsvDataSet::AppendCsvDataSet()
+    : Blossom("Init upload of new lines for an existing csv-file data-set.")
+{
+    //----------------------------------------------------------------------------------------------
+    // input
+    //----------------------------------------------------------------------------------------------
+
+    registerInputField("uuid",
+                       SAKURA_STRING_TYPE,
+                       true,
+                       "UUID of the data-set, which should be extended.");
+    assert(addFieldRegex("uuid", UUID_REGEX));
+
+    registerInputField("input_data_size",
+                       SAKURA_INT_TYPE,
+                       true,
+                       "Total size of the new input-data.");
+    assert(addFieldBorder("input_data_size", 1, 10000000000));
+
+    //----------------------------------------------------------------------------------------------
+    // output
+    //----------------------------------------------------------------------------------------------
+
+    registerOutputField("uuid",
+                        SAKURA_STRING_TYPE,
+                        "UUID of the data-set.");
+    registerOutputField("uuid_input_file",
+                        SAKURA_STRING_TYPE,
+                        "UUID to identify the file for date upload of the new input-data.");
+
+    //----------------------------------------------------------------------------------------------
+    //
+    //----------------------------------------------------------------------------------------------
+}
+
+/**
+ * @brief runTask
+ */
+bool
+AppendCsvDataSet::runTask(BlossomIO &blossomIO,
+                          const Kitsunemimi::DataMap &context,
+                          BlossomStatus &status,
+                          Kitsunemimi::ErrorContainer &error)
+{
+    const std::string uuid = blossomIO.input.get("uuid").getString();
+    const long inputDataSize = blossomIO.input.get("input_data_size").getLong();
+    const Kitsunemimi::Hanami::UserContext userContext(context);
+
+    // check if data-set exist
+    Kitsunemimi::JsonItem result;
+    if(ShioriRoot::dataSetTable->getDataSet(result, uuid, userContext, error, true) == false)
+    {
+        status.errorMessage = "Data with uuid '" + uuid + "' not found.";
+        status.statusCode = Kitsunemimi::Hanami::NOT_FOUND_RTYPE;
+        return false;
+    }
+
+    // only tables can be extended by new lines
+    if(result.get("type").getString() != "csv")
+    {
+        status.errorMessage = "Data-set with uuid '" + uuid + "' is not a csv-data-set.";
+        status.statusCode = Kitsunemimi::Hanami::BAD_REQUEST_RTYPE;
+        error.addMeesage(status.errorMessage);
+        return false;
+    }
+
+    // init temp-file for input-data
+    const std::string inputUuid = Kitsunemimi::Hanami::generateUuid().toString();
+    if(ShioriRoot::tempFileHandler->initNewFile(inputUuid, inputDataSize) == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        error.addMeesage("Failed to initialize temporary file for new input-data.");
+        return false;
+    }
+
+    // register temp-file for the upload-progress
+    if(ShioriRoot::dataSetTable->addUploadFile(uuid, inputUuid, error) == false)
+    {
+        ShioriRoot::tempFileHandler->removeData(inputUuid);
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+
+    // create output
+    blossomIO.output.insert("uuid", uuid);
+    blossomIO.output.insert("uuid_input_file", inputUuid);
+
+    return true;
+}
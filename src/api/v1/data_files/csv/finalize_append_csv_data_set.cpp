@@ -0,0 +1,286 @@
+/**
+ * @file        finalize_append_csv_data_set.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "finalize_append_csv_data_set.h"
+
+#include <shiori_root.h>
+#include <database/data_set_table.h>
+#include <core/temp_file_handler.h>
+#include <core/data_set_cache.h>
+#include <core/block_store.h>
+#include <core/data_set_files/data_set_file.h>
+#include <core/data_set_files/table_data_set_file.h>
+#include <api/v1/data_files/csv/finalize_csv_data_set.h>
+
+#include <libKitsunemimiHanamiCommon/uuid.h>
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+#include <libKitsunemimiHanamiCommon/defines.h>
+#include <libKitsunemimiHanamiNetwork/hanami_messaging.h>
+
+#include <libKitsunemimiJson/json_item.h>
+#include <libKitsunemimiCommon/methods/string_methods.h>
+
+using namespace Kitsunemimi::Hanami;
+
+FinalizeAppendCsvDataSet::FinalizeAppendCsvDataSet()
+    : Blossom("Finalize upload of new lines for an existing csv-file data-set by converting "
+              "only the new lines and appending them to the existing data-set.")
+{
+    //----------------------------------------------------------------------------------------------
+    // input
+    //----------------------------------------------------------------------------------------------
+
+    registerInputField("uuid",
+                       SAKURA_STRING_TYPE,
+                       true,
+                       "UUID of the data-set, which should be extended.");
+    assert(addFieldRegex("uuid", UUID_REGEX));
+
+    registerInputField("uuid_input_file",
+                       SAKURA_STRING_TYPE,
+                       true,
+                       "UUID to identify the file for date upload of the new input-data.");
+    assert(addFieldRegex("uuid_input_file", UUID_REGEX));
+
+    //----------------------------------------------------------------------------------------------
+    // output
+    //----------------------------------------------------------------------------------------------
+
+    registerOutputField("uuid",
+                        SAKURA_STRING_TYPE,
+                        "UUID of the data-set.");
+    registerOutputField("number_of_lines",
+                        SAKURA_INT_TYPE,
+                        "Total number of lines of the data-set after appending the new lines.");
+
+    //----------------------------------------------------------------------------------------------
+    //
+    //----------------------------------------------------------------------------------------------
+}
+
+/**
+ * @brief runTask
+ */
+bool
+FinalizeAppendCsvDataSet::runTask(BlossomIO &blossomIO,
+                                  const Kitsunemimi::DataMap &context,
+                                  BlossomStatus &status,
+                                  Kitsunemimi::ErrorContainer &error)
+{
+    const std::string uuid = blossomIO.input.get("uuid").getString();
+    const std::string inputUuid = blossomIO.input.get("uuid_input_file").getString();
+    const Kitsunemimi::Hanami::UserContext userContext(context);
+
+    // get location from database
+    Kitsunemimi::JsonItem result;
+    if(ShioriRoot::dataSetTable->getDataSet(result, uuid, userContext, error, true) == false)
+    {
+        status.errorMessage = "Data with uuid '" + uuid + "' not found.";
+        status.statusCode = Kitsunemimi::Hanami::NOT_FOUND_RTYPE;
+        return false;
+    }
+
+    // read input-data from temp-file
+    Kitsunemimi::DataBuffer inputBuffer;
+    if(ShioriRoot::tempFileHandler->getData(inputBuffer, inputUuid) == false)
+    {
+        status.errorMessage = "Input-data with uuid '" + inputUuid + "' not found.";
+        status.statusCode = Kitsunemimi::Hanami::NOT_FOUND_RTYPE;
+        return false;
+    }
+
+    // the file is extended in place, so multiple appends must not run at the same time
+    std::lock_guard<std::mutex> guard(m_appendLock);
+
+    // the file is modified in place, so it has to be reassembled, if it was deduplicated
+    const std::string location = result.get("location").getString();
+    if(ShioriRoot::dataSetBlockStore->restoreFile(location, error) == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+
+    // open existing data-set
+    DataSetFile* file = readDataSetFile(location, error);
+    TableDataSetFile* tableFile = dynamic_cast<TableDataSetFile*>(file);
+    if(tableFile == nullptr)
+    {
+        delete file;
+        status.errorMessage = "Data-set with uuid '" + uuid + "' is not a table.";
+        status.statusCode = Kitsunemimi::Hanami::BAD_REQUEST_RTYPE;
+        error.addMeesage(status.errorMessage);
+        return false;
+    }
+
+    // the new number of lines is written after the new lines, so they become visible at once
+    if(appendCsvData(*tableFile, inputBuffer, error) == false
+            || tableFile->finishAppend(error) == false)
+    {
+        delete file;
+        status.errorMessage = "Failed to append new lines to data-set with uuid '" + uuid + "'.";
+        status.statusCode = Kitsunemimi::Hanami::BAD_REQUEST_RTYPE;
+        error.addMeesage(status.errorMessage);
+        return false;
+    }
+    const long numberOfLines = tableFile->tableHeader.numberOfLines;
+    delete file;
+
+    // split file again into deduplicated blocks, where the blocks of the old lines are reused
+    if(ShioriRoot::dataSetBlockStore->storeFile(location, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    // opened instances of the old version of the file are not used anymore for new requests
+    ShioriRoot::dataSetCache->removeDataSetFile(location);
+
+    // delete temp-files
+    ShioriRoot::tempFileHandler->removeData(inputUuid);
+
+    // create output
+    blossomIO.output.insert("uuid", uuid);
+    blossomIO.output.insert("number_of_lines", numberOfLines);
+
+    return true;
+}
+
+/**
+ * @brief convert new csv-lines and append them to an existing table. The first line of the
+ *        csv-data must be a header with the same columns like the table.
+ *
+ * @param file opened table to extend
+ * @param inputBuffer buffer with the new csv-data
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+FinalizeAppendCsvDataSet::appendCsvData(TableDataSetFile &file,
+                                        const Kitsunemimi::DataBuffer &inputBuffer,
+                                        Kitsunemimi::ErrorContainer &error)
+{
+    const uint64_t numberOfColumns = file.tableColumns.size();
+
+    // prepare content-processing
+    const std::string stringContent(static_cast<char*>(inputBuffer.data),
+                                    inputBuffer.usedBufferSize);
+    std::vector<std::string> lines;
+    Kitsunemimi::splitStringByDelimiter(lines, stringContent, '\n');
+
+    // null-values of the first new line are replaced by the values of the last existing line
+    std::vector<float> lastLine(numberOfColumns, 0.0f);
+    if(file.tableHeader.numberOfLines > 0)
+    {
+        for(uint64_t colNum = 0; colNum < numberOfColumns; colNum++)
+        {
+            uint64_t payloadSize = 0;
+            float* lastValue = file.getPayload(payloadSize,
+                                               file.tableHeader.numberOfLines - 1,
+                                               1,
+                                               file.tableColumns[colNum].name);
+            if(lastValue == nullptr)
+            {
+                error.addMeesage("Failed to read last line of data-set '" + file.name + "'");
+                return false;
+            }
+            lastLine[colNum] = lastValue[0];
+            delete[] lastValue;
+        }
+    }
+
+    // buffer for values to reduce write-access to file
+    const uint32_t segmentSize = 10000000;
+    const uint64_t linesPerSegment = std::max<uint64_t>(segmentSize / numberOfColumns, 1);
+    std::vector<float> segment(linesPerSegment * numberOfColumns, 0.0f);
+    uint64_t segmentPos = 0;
+    uint64_t segmentLines = 0;
+    bool isHeader = true;
+
+    for(uint64_t lineNum = 0; lineNum < lines.size(); lineNum++)
+    {
+        const std::string* line = &lines[lineNum];
+
+        // check if the line is relevant to ignore broken lines
+        const uint64_t numberOfCells = std::count(line->begin(), line->end(), ',') + 1;
+        if(numberOfCells == 1) {
+            continue;
+        }
+
+        // split line
+        std::vector<std::string> lineContent;
+        Kitsunemimi::splitStringByDelimiter(lineContent, *line, ',');
+
+        // the header must match the columns of the existing table
+        if(isHeader)
+        {
+            bool match = lineContent.size() == numberOfColumns;
+            for(uint64_t colNum = 0; match && colNum < numberOfColumns; colNum++) {
+                match = lineContent[colNum] == file.tableColumns[colNum].name;
+            }
+            if(match == false)
+            {
+                error.addMeesage("Columns of the new csv-data don't match the columns of the "
+                                 "existing data-set");
+                return false;
+            }
+            isHeader = false;
+            continue;
+        }
+
+        for(uint64_t colNum = 0; colNum < numberOfColumns; colNum++)
+        {
+            // missing cells are handled like null-values
+            const float lastVal = lastLine[colNum];
+            if(colNum < lineContent.size())
+            {
+                FinalizeCsvDataSet::convertField(&segment[segmentPos],
+                                                 lineContent[colNum],
+                                                 lastVal);
+            }
+            else
+            {
+                segment[segmentPos] = lastVal;
+            }
+
+            lastLine[colNum] = segment[segmentPos];
+            segmentPos++;
+        }
+        segmentLines++;
+
+        // append next segment to file
+        if(segmentLines == linesPerSegment)
+        {
+            if(file.appendLines(&segment[0], segmentLines, error) == false) {
+                return false;
+            }
+            segmentPos = 0;
+            segmentLines = 0;
+        }
+    }
+
+    // append last incomplete segment to file
+    if(segmentLines != 0) {
+        return file.appendLines(&segment[0], segmentLines, error);
+    }
+
+    return true;
+}
@@ -25,6 +25,7 @@
 #include <shiori_root.h>
 #include <database/data_set_table.h>
 #include <core/temp_file_handler.h>
+#include <core/block_store.h>
 #include <core/data_set_files/data_set_file.h>
 #include <core/data_set_files/table_data_set_file.h>
 
@@ -63,6 +64,30 @@ FinalizeCsvDataSet::FinalizeCsvDataSet()
                        "UUID to identify the file for date upload of input-data.");
     assert(addFieldRegex("uuid_input_file", UUID_REGEX));
 
+    registerInputField("layout",
+                       SAKURA_STRING_TYPE,
+                       false,
+                       "Storage-layout of the converted table: 'row' (default) or 'column'. "
+                       "With 'column' each column is stored as one contiguous block, so that a "
+                       "single column can be read without reading the complete table.");
+    assert(addFieldRegex("layout", "(row|column)"));
+
+    registerInputField("compression",
+                       SAKURA_STRING_TYPE,
+                       false,
+                       "Compression of the converted payload: 'none' (default), 'lz4' or 'zstd'. "
+                       "The payload is compressed in blocks, so that parts of the data-set can "
+                       "still be read without decompressing everything.");
+    assert(addFieldRegex("compression", "(none|lz4|zstd)"));
+
+    registerInputField("data_type",
+                       SAKURA_STRING_TYPE,
+                       false,
+                       "Data-type of the stored values: 'float32' (default), 'float16', "
+                       "'bfloat16' or 'int8'. Values of int8 are affine quantized with a "
+                       "scale and zero-point, which are stored in the header of the file.");
+    assert(addFieldRegex("data_type", "(float32|float16|bfloat16|int8)"));
+
     //----------------------------------------------------------------------------------------------
     // output
     //----------------------------------------------------------------------------------------------
@@ -87,6 +112,9 @@ FinalizeCsvDataSet::runTask(BlossomIO &blossomIO,
 {
     const std::string uuid = blossomIO.input.get("uuid").getString();
     const std::string inputUuid = blossomIO.input.get("uuid_input_file").getString();
+    const bool columnar = blossomIO.input.get("layout").getString() == "column";
+    const std::string compression = blossomIO.input.get("compression").getString();
+    const std::string dataType = blossomIO.input.get("data_type").getString();
     const Kitsunemimi::Hanami::UserContext userContext(context);
 
     // get location from database
@@ -98,6 +126,17 @@ FinalizeCsvDataSet::runTask(BlossomIO &blossomIO,
         return false;
     }
 
+    // the column-blocks can not be compressed, because they are not written sequentially
+    if(columnar
+            && compression != ""
+            && compression != "none")
+    {
+        status.errorMessage = "Compression is not supported for tables in column-layout.";
+        status.statusCode = Kitsunemimi::Hanami::BAD_REQUEST_RTYPE;
+        error.addMeesage(status.errorMessage);
+        return false;
+    }
+
     // read input-data from temp-file
     Kitsunemimi::DataBuffer inputBuffer;
     if(ShioriRoot::tempFileHandler->getData(inputBuffer, inputUuid) == false)
@@ -110,13 +149,23 @@ FinalizeCsvDataSet::runTask(BlossomIO &blossomIO,
     // write data to file
     if(convertCsvData(result.get("location").getString(),
                       result.get("name").getString().c_str(),
-                      inputBuffer) == false)
+                      inputBuffer,
+                      columnar,
+                      getEncodingFromName(compression),
+                      getDataTypeFromName(dataType)) == false)
     {
         status.statusCode = Kitsunemimi:: Hanami::INTERNAL_SERVER_ERROR_RTYPE;
         error.addMeesage("Failed to convert csv-data");
         return false;
     }
 
+    // split file into deduplicated blocks. If this fails, the file is kept complete.
+    if(ShioriRoot::dataSetBlockStore->storeFile(result.get("location").getString(),
+                                                error) == false)
+    {
+        LOG_ERROR(error);
+    }
+
     // delete temp-files
     ShioriRoot::tempFileHandler->removeData(inputUuid);
 
@@ -126,6 +175,13 @@ FinalizeCsvDataSet::runTask(BlossomIO &blossomIO,
     return true;
 }
 
+/**
+ * @brief convert a cell of a csv-file into a float
+ *
+ * @param segmentPos pointer to the target-position of the value
+ * @param cell content of the cell
+ * @param lastVal value of the same column of the previous line, which is used for null-values
+ */
 void
 FinalizeCsvDataSet::convertField(float* segmentPos,
                                  const std::string &cell,
@@ -175,16 +231,25 @@ FinalizeCsvDataSet::convertField(float* segmentPos,
  * @param filePath path to the resulting file
  * @param name data-set name
  * @param inputBuffer buffer with input-data
+ * @param columnar true to store the table in columnar layout
+ * @param encoding encoding of the payload
+ * @param dataType data-type of the stored values
  *
  * @return true, if successfull, else false
  */
 bool
 FinalizeCsvDataSet::convertCsvData(const std::string &filePath,
                                    const std::string &name,
-                                   const Kitsunemimi::DataBuffer &inputBuffer)
+                                   const Kitsunemimi::DataBuffer &inputBuffer,
+                                   const bool columnar,
+                                   const DataSetFile::Encoding encoding,
+                                   const DataSetFile::DataType dataType)
 {
     TableDataSetFile file(filePath);
     file.type = DataSetFile::TABLE_TYPE;
+    file.layout = columnar ? DataSetFile::COLUMN_MAJOR_LAYOUT : DataSetFile::ROW_MAJOR_LAYOUT;
+    file.encoding = encoding;
+    file.dataType = dataType;
     file.name = name;
 
     // prepare content-processing
@@ -193,10 +258,12 @@ FinalizeCsvDataSet::convertCsvData(const std::string &filePath,
 
     // buffer for values to reduce write-access to file
     const uint32_t segmentSize = 10000000;
-    std::vector<float> segment(segmentSize, 0.0f);
+    std::vector<float> segment;
     std::vector<float> lastLine;
     uint64_t segmentPos = 0;
-    uint64_t segmentCounter = 0;
+    uint64_t segmentLines = 0;
+    uint64_t linesPerSegment = 0;
+    uint64_t numberOfColumns = 0;
 
     // split content
     std::vector<std::string> lines;
@@ -209,8 +276,8 @@ FinalizeCsvDataSet::convertCsvData(const std::string &filePath,
         const std::string* line = &lines[lineNum];
 
         // check if the line is relevant to ignore broken lines
-        const uint64_t numberOfColumns = std::count(line->begin(), line->end(), ',') + 1;
-        if(numberOfColumns == 1) {
+        const uint64_t numberOfCells = std::count(line->begin(), line->end(), ',') + 1;
+        if(numberOfCells == 1) {
             continue;
         }
 
@@ -220,6 +287,7 @@ FinalizeCsvDataSet::convertCsvData(const std::string &filePath,
 
         if(isHeader)
         {
+            numberOfColumns = numberOfCells;
             file.tableHeader.numberOfColumns = numberOfColumns;
             file.tableHeader.numberOfLines = lines.size();
 
@@ -240,41 +308,73 @@ FinalizeCsvDataSet::convertCsvData(const std::string &filePath,
             // calculated with the correct value
             file.tableHeader.numberOfLines = 0;
             lastLine = std::vector<float>(numberOfColumns, 0.0f);
+
+            // segments always contain complete lines, because in columnar layout the
+            // lines have to be split into the column-blocks
+            linesPerSegment = std::max<uint64_t>(segmentSize / numberOfColumns, 1);
+
+            // the int8-quantization needs the value-range of each column before the first
+            // values can be written, so in this case the complete table is buffered
+            if(dataType == DataSetFile::INT8_DTYPE) {
+                linesPerSegment = lines.size();
+            }
+            segment = std::vector<float>(linesPerSegment * numberOfColumns, 0.0f);
         }
         else
         {
-            for(uint64_t colNum = 0; colNum < lineContent.size(); colNum++)
+            for(uint64_t colNum = 0; colNum < numberOfColumns; colNum++)
             {
-                const std::string* cell = &lineContent[colNum];
-                if(lastLine.size() > 0)
+                // missing cells are handled like null-values
+                const float lastVal = lastLine[colNum];
+                if(colNum < lineContent.size())
                 {
-                    const float lastVal = lastLine[colNum];
-                    convertField(&segment[segmentPos], *cell, lastVal);
+                    convertField(&segment[segmentPos], lineContent[colNum], lastVal);
                 }
                 else
                 {
-                    convertField(&segment[segmentPos], *cell, 0.0f);
+                    segment[segmentPos] = lastVal;
                 }
 
                 lastLine[colNum] = segment[segmentPos];
-
-                // write next segment to file
                 segmentPos++;
-                if(segmentPos == segmentSize)
-                {
-                    file.addBlock(segmentCounter, &segment[0], segmentSize);
-                    segmentPos = 0;
-                    segmentCounter++;
-                }                
             }
-
+            segmentLines++;
             file.tableHeader.numberOfLines++;
+
+            // write next segment to file
+            if(segmentLines == linesPerSegment)
+            {
+                file.updateStatistics(&segment[0],
+                                      file.tableHeader.numberOfLines - segmentLines,
+                                      segmentLines);
+                if(file.addLines(file.tableHeader.numberOfLines - segmentLines,
+                                 &segment[0],
+                                 segmentLines) == false)
+                {
+                    return false;
+                }
+                segmentPos = 0;
+                segmentLines = 0;
+            }
         }
     }
 
     // write last incomplete segment to file
-    if(segmentPos != 0) {
-        file.addBlock(segmentCounter, &segment[0], segmentPos);
+    if(segmentLines != 0)
+    {
+        if(dataType == DataSetFile::INT8_DTYPE) {
+            file.updateQuantization(&segment[0], segmentLines);
+        }
+        file.updateStatistics(&segment[0],
+                              file.tableHeader.numberOfLines - segmentLines,
+                              segmentLines);
+
+        if(file.addLines(file.tableHeader.numberOfLines - segmentLines,
+                         &segment[0],
+                         segmentLines) == false)
+        {
+            return false;
+        }
     }
 
     // update header in file for the final number of lines for the case,
@@ -26,12 +26,18 @@
 #include <libKitsunemimiHanamiNetwork/blossom.h>
 #include <libKitsunemimiCommon/buffer/data_buffer.h>
 
+#include <core/data_set_files/data_set_file.h>
+
 class FinalizeCsvDataSet
         : public Kitsunemimi::Hanami::Blossom
 {
 public:
     FinalizeCsvDataSet();
 
+    static void convertField(float* segmentPos,
+                             const std::string &cell,
+                             const float lastVal);
+
 protected:
     bool runTask(Kitsunemimi::Hanami::BlossomIO &blossomIO,
                  const Kitsunemimi::DataMap &context,
@@ -41,10 +47,10 @@ protected:
 private:
     bool convertCsvData(const std::string &filePath,
                         const std::string &name,
-                        const Kitsunemimi::DataBuffer &inputBuffer);
-    void convertField(float* segmentPos,
-                      const std::string &cell,
-                      const float lastVal);
+                        const Kitsunemimi::DataBuffer &inputBuffer,
+                        const bool columnar,
+                        const DataSetFile::Encoding encoding,
+                        const DataSetFile::DataType dataType);
 };
 
 #endif // SHIORIARCHIVE_CSV_FINALIZE_DATA_SET_H
@@ -24,6 +24,12 @@
 
 #include <shiori_root.h>
 #include <database/data_set_table.h>
+#include <core/data_set_cache.h>
+#include <core/data_set_files/view_data_set_file.h>
+#include <core/block_store.h>
+#include <core/normalization_cache.h>
+#include <core/payload_cache.h>
+#include <core/warmup_manager.h>
 
 #include <libKitsunemimiJson/json_item.h>
 #include <libKitsunemimiCommon/methods/file_methods.h>
@@ -78,6 +84,35 @@ DeleteDataSet::runTask(Hanami::BlossomIO &blossomIO,
     // get location from response
     const std::string location = result.get("location").getString();
 
+    // views only reference the rows of their parent, so the parent must outlive them
+    std::vector<std::string> viewLocations;
+    if(ShioriRoot::dataSetTable->getAllViewLocations(viewLocations, error) == false)
+    {
+        status.statusCode = Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+    for(const std::string &viewLocation : viewLocations)
+    {
+        if(viewLocation == location) {
+            continue;
+        }
+
+        // views, which can not be opened anymore, don't reference any data-set
+        ErrorContainer viewError;
+        std::shared_ptr<DataSetFile> file = ShioriRoot::dataSetCache->getDataSetFile(viewLocation,
+                                                                                     viewError);
+        ViewDataSetFile* view = dynamic_cast<ViewDataSetFile*>(file.get());
+        if(view != nullptr
+                && view->parentLocation == location)
+        {
+            status.errorMessage = "Data-set with uuid '" + dataUuid + "' is still used by views "
+                                  "and can only be deleted after all of its views.";
+            status.statusCode = Hanami::CONFLICT_RTYPE;
+            error.addMeesage(status.errorMessage);
+            return false;
+        }
+    }
+
     // delete entry from db
     if(ShioriRoot::dataSetTable->deleteDataSet(dataUuid, userContext, error) == false)
     {
@@ -85,8 +120,12 @@ DeleteDataSet::runTask(Hanami::BlossomIO &blossomIO,
         return false;
     }
 
-    // delete local files
-    if(Kitsunemimi::deleteFileOrDir(location, error) == false)
+    // delete local files and the blocks, which are not used by other files anymore
+    ShioriRoot::dataSetCache->removeDataSetFile(location);
+    ShioriRoot::normalizationCache->removeVariants(location);
+    ShioriRoot::payloadCache->removeDataSet(location);
+    ShioriRoot::warmupManager->removeDataSet(location);
+    if(ShioriRoot::dataSetBlockStore->deleteFile(location, error) == false)
     {
         status.statusCode = Hanami::INTERNAL_SERVER_ERROR_RTYPE;
         return false;
@@ -27,6 +27,8 @@
 #include <core/data_set_files/data_set_file.h>
 #include <core/data_set_files/image_data_set_file.h>
 #include <core/data_set_files/table_data_set_file.h>
+#include <core/data_set_files/view_data_set_file.h>
+#include <core/data_set_cache.h>
 
 #include <libKitsunemimiHanamiCommon/enums.h>
 #include <libKitsunemimiHanamiCommon/defines.h>
@@ -73,7 +75,7 @@ GetDataSet::GetDataSet()
                         "Local file-path of the data-set.");
     registerOutputField("type",
                         SAKURA_STRING_TYPE,
-                        "Type of the new set (csv or mnist)");
+                        "Type of the new set (csv, mnist or view)");
     registerOutputField("inputs",
                         SAKURA_INT_TYPE,
                         "Number of inputs.");
@@ -83,6 +85,17 @@ GetDataSet::GetDataSet()
     registerOutputField("lines",
                         SAKURA_INT_TYPE,
                         "Number of lines.");
+    registerOutputField("data_type",
+                        SAKURA_STRING_TYPE,
+                        "Data-type of the stored values (float32, float16, bfloat16, int8).");
+    registerOutputField("scales",
+                        SAKURA_ARRAY_TYPE,
+                        "Scales of the int8-quantization, one for each column of a table or "
+                        "a single one for images.");
+    registerOutputField("zero_points",
+                        SAKURA_ARRAY_TYPE,
+                        "Zero-points of the int8-quantization, one for each column of a table or "
+                        "a single one for images.");
 
     //----------------------------------------------------------------------------------------------
     //
@@ -142,23 +155,30 @@ GetDataSet::getHeaderInformation(Kitsunemimi::JsonItem &result,
 {
     bool ret = false;
 
-    DataSetFile* file = readDataSetFile(location);
-    if(file == nullptr) {
+    // get data-set from the cache of opened data-sets
+    std::shared_ptr<DataSetFile> file = ShioriRoot::dataSetCache->getDataSetFile(location, error);
+    if(file == nullptr)
+    {
+        error.addMeesage("Failed to read header from file '" + location + "'");
         return ret;
     }
 
+    // views have the structure of their parent and only another number of lines
+    DataSetFile* structureFile = file.get();
+    ViewDataSetFile* viewFile = dynamic_cast<ViewDataSetFile*>(file.get());
+    if(viewFile != nullptr) {
+        structureFile = viewFile->getParent();
+    }
+
+    result.insert("data_type", getDataTypeName(file->dataType));
+    std::vector<Kitsunemimi::JsonItem> scales;
+    std::vector<Kitsunemimi::JsonItem> zeroPoints;
+
     do
     {
-        // read data-set-header
-        if(file->readFromFile() == false)
-        {
-            error.addMeesage("Failed to read header from file '" + location + "'");
-            break;
-        }
-
-        if(file->type == DataSetFile::IMAGE_TYPE)
+        if(structureFile->type == DataSetFile::IMAGE_TYPE)
         {
-            ImageDataSetFile* imgF = dynamic_cast<ImageDataSetFile*>(file);
+            ImageDataSetFile* imgF = dynamic_cast<ImageDataSetFile*>(structureFile);
             if(imgF == nullptr) {
                 break;
             }
@@ -167,16 +187,18 @@ GetDataSet::getHeaderInformation(Kitsunemimi::JsonItem &result,
             const uint64_t size = imgF->imageHeader.numberOfInputsX * imgF->imageHeader.numberOfInputsY;
             result.insert("inputs", static_cast<long>(size));
             result.insert("outputs", static_cast<long>(imgF->imageHeader.numberOfOutputs));
-            result.insert("lines", static_cast<long>(imgF->imageHeader.numberOfImages));
+            result.insert("lines", static_cast<long>(file->getNumberOfRows()));
             // result.insert("average_value", static_cast<float>(imgF->imageHeader.avgValue));
             // result.insert("max_value", static_cast<float>(imgF->imageHeader.maxValue));
+            scales.push_back(Kitsunemimi::JsonItem(imgF->imageHeader.scale));
+            zeroPoints.push_back(Kitsunemimi::JsonItem(imgF->imageHeader.zeroPoint));
 
             ret = true;
             break;
         }
-        else if(file->type == DataSetFile::TABLE_TYPE)
+        else if(structureFile->type == DataSetFile::TABLE_TYPE)
         {
-            TableDataSetFile* imgT = dynamic_cast<TableDataSetFile*>(file);
+            TableDataSetFile* imgT = dynamic_cast<TableDataSetFile*>(structureFile);
             if(imgT == nullptr) {
                 break;
             }
@@ -193,11 +215,13 @@ GetDataSet::getHeaderInformation(Kitsunemimi::JsonItem &result,
                 if(entry.isOutput) {
                     outputs++;
                 }
+                scales.push_back(Kitsunemimi::JsonItem(entry.scale));
+                zeroPoints.push_back(Kitsunemimi::JsonItem(entry.zeroPoint));
             }
 
             result.insert("inputs", inputs);
             result.insert("outputs", outputs);
-            result.insert("lines", static_cast<long>(imgT->tableHeader.numberOfLines));
+            result.insert("lines", static_cast<long>(file->getNumberOfRows()));
             // result.insert("average_value", 0.0f);
             // result.insert("max_value", 0.0f);
 
@@ -210,7 +234,8 @@ GetDataSet::getHeaderInformation(Kitsunemimi::JsonItem &result,
     }
     while(true);
 
-    delete file;
+    result.insert("scales", Kitsunemimi::JsonItem(scales));
+    result.insert("zero_points", Kitsunemimi::JsonItem(zeroPoints));
 
     return ret;
 }
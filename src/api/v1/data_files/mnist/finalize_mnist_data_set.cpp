@@ -25,8 +25,10 @@
 #include <shiori_root.h>
 #include <database/data_set_table.h>
 #include <core/temp_file_handler.h>
+#include <core/block_store.h>
 #include <core/data_set_files/data_set_file.h>
 #include <core/data_set_files/image_data_set_file.h>
+#include <core/data_set_files/value_conversion.h>
 
 #include <libKitsunemimiHanamiCommon/uuid.h>
 #include <libKitsunemimiHanamiCommon/enums.h>
@@ -64,6 +66,20 @@ FinalizeMnistDataSet::FinalizeMnistDataSet()
                        true,
                        "UUID to identify the file for date upload of label-data.");
     assert(addFieldRegex("uuid_label_file", UUID_REGEX));
+    registerInputField("compression",
+                       SAKURA_STRING_TYPE,
+                       false,
+                       "Compression of the converted payload: 'none' (default), 'lz4' or 'zstd'. "
+                       "The payload is compressed in blocks, so that parts of the data-set can "
+                       "still be read without decompressing everything.");
+    assert(addFieldRegex("compression", "(none|lz4|zstd)"));
+    registerInputField("data_type",
+                       SAKURA_STRING_TYPE,
+                       false,
+                       "Data-type of the stored values: 'float32' (default), 'float16', "
+                       "'bfloat16' or 'int8'. Values of int8 are affine quantized with a "
+                       "scale and zero-point, which are stored in the header of the file.");
+    assert(addFieldRegex("data_type", "(float32|float16|bfloat16|int8)"));
 
     //----------------------------------------------------------------------------------------------
     // output
@@ -90,6 +106,8 @@ FinalizeMnistDataSet::runTask(BlossomIO &blossomIO,
     const std::string uuid = blossomIO.input.get("uuid").getString();
     const std::string inputUuid = blossomIO.input.get("uuid_input_file").getString();
     const std::string labelUuid = blossomIO.input.get("uuid_label_file").getString();
+    const std::string compression = blossomIO.input.get("compression").getString();
+    const std::string dataType = blossomIO.input.get("data_type").getString();
     const Kitsunemimi::Hanami::UserContext userContext(context);
 
     // get location from database
@@ -123,13 +141,22 @@ FinalizeMnistDataSet::runTask(BlossomIO &blossomIO,
     if(convertMnistData(result.get("location").getString(),
                         result.get("name").getString().c_str(),
                         inputBuffer,
-                        labelBuffer) == false)
+                        labelBuffer,
+                        getEncodingFromName(compression),
+                        getDataTypeFromName(dataType)) == false)
     {
         status.statusCode =Kitsunemimi:: Hanami::INTERNAL_SERVER_ERROR_RTYPE;
         error.addMeesage("Failed to convert mnist-data");
         return false;
     }
 
+    // split file into deduplicated blocks. If this fails, the file is kept complete.
+    if(ShioriRoot::dataSetBlockStore->storeFile(result.get("location").getString(),
+                                                error) == false)
+    {
+        LOG_ERROR(error);
+    }
+
     // delete temp-files
     ShioriRoot::tempFileHandler->removeData(inputUuid);
     ShioriRoot::tempFileHandler->removeData(labelUuid);
@@ -147,6 +174,8 @@ FinalizeMnistDataSet::runTask(BlossomIO &blossomIO,
  * @param name data-set name
  * @param inputBuffer buffer with input-data
  * @param labelBuffer buffer with label-data
+ * @param encoding encoding of the payload
+ * @param dataType data-type of the stored values
  *
  * @return true, if successfull, else false
  */
@@ -154,10 +183,14 @@ bool
 FinalizeMnistDataSet::convertMnistData(const std::string &filePath,
                                        const std::string &name,
                                        const Kitsunemimi::DataBuffer &inputBuffer,
-                                       const Kitsunemimi::DataBuffer &labelBuffer)
+                                       const Kitsunemimi::DataBuffer &labelBuffer,
+                                       const DataSetFile::Encoding encoding,
+                                       const DataSetFile::DataType dataType)
 {
     ImageDataSetFile file(filePath);
     file.type = DataSetFile::IMAGE_TYPE;
+    file.encoding = encoding;
+    file.dataType = dataType;
     file.name = name;
 
     // source-data
@@ -194,6 +227,12 @@ FinalizeMnistDataSet::convertMnistData(const std::string &filePath,
     file.imageHeader.numberOfOutputs = 10;
     file.imageHeader.numberOfImages = numberOfImages;
 
+    // pixels and labels are all within the range of 0 to 255, so they can be quantized
+    // without loss
+    if(dataType == DataSetFile::INT8_DTYPE) {
+        calcInt8Quantization(file.imageHeader.scale, file.imageHeader.zeroPoint, 0.0f, 255.0f);
+    }
+
     // buffer for values to reduce write-access to file
     const uint64_t lineSize = (numberOfColumns * numberOfRows) * 10;
     const uint32_t segmentSize = lineSize * 10000;
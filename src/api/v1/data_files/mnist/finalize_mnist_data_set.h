@@ -26,6 +26,8 @@
 #include <libKitsunemimiHanamiNetwork/blossom.h>
 #include <libKitsunemimiCommon/buffer/data_buffer.h>
 
+#include <core/data_set_files/data_set_file.h>
+
 class FinalizeMnistDataSet
         : public Kitsunemimi::Hanami::Blossom
 {
@@ -42,7 +44,9 @@ private:
     bool convertMnistData(const std::string &filePath,
                           const std::string &name,
                           const Kitsunemimi::DataBuffer &inputBuffer,
-                          const Kitsunemimi::DataBuffer &labelBuffer);
+                          const Kitsunemimi::DataBuffer &labelBuffer,
+                          const DataSetFile::Encoding encoding,
+                          const DataSetFile::DataType dataType);
 };
 
 #endif // SHIORIARCHIVE_MNIST_FINALIZE_DATA_SET_H
@@ -0,0 +1,107 @@
+/**
+ * @file        pin_data_set.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "pin_data_set.h"
+
+#include <shiori_root.h>
+#include <database/data_set_table.h>
+#include <core/payload_cache.h>
+
+#include <libKitsunemimiJson/json_item.h>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/defines.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+
+using namespace Kitsunemimi;
+
+PinDataSet::PinDataSet()
+    : Blossom("Pin or unpin a data-set within the cache for decoded payloads. The payloads of a "
+              "pinned data-set are cached at their first request and never evicted. Only an "
+              "admin is allowed to pin data-sets.")
+{
+    //----------------------------------------------------------------------------------------------
+    // input
+    //----------------------------------------------------------------------------------------------
+
+    registerInputField("uuid",
+                       Hanami::SAKURA_STRING_TYPE,
+                       true,
+                       "UUID of the data-set to pin or unpin.");
+    assert(addFieldRegex("uuid", UUID_REGEX));
+
+    registerInputField("pin",
+                       Hanami::SAKURA_BOOL_TYPE,
+                       true,
+                       "True to pin the data-set, false to unpin it.");
+
+    //----------------------------------------------------------------------------------------------
+    //
+    //----------------------------------------------------------------------------------------------
+}
+
+/**
+ * @brief runTask
+ */
+bool
+PinDataSet::runTask(Hanami::BlossomIO &blossomIO,
+                    const Kitsunemimi::DataMap &context,
+                    Hanami::BlossomStatus &status,
+                    ErrorContainer &error)
+{
+    const std::string dataUuid = blossomIO.input.get("uuid").getString();
+    const bool pin = blossomIO.input.get("pin").getBool();
+    const Kitsunemimi::Hanami::UserContext userContext(context);
+
+    // check that the user is an admin
+    if(userContext.isAdmin == false)
+    {
+        status.statusCode = Hanami::UNAUTHORIZED_RTYPE;
+        status.errorMessage = "only an admin is allowed to pin data-sets";
+        return false;
+    }
+
+    // get location from database
+    JsonItem result;
+    if(ShioriRoot::dataSetTable->getDataSet(result,
+                                            dataUuid,
+                                            userContext,
+                                            error,
+                                            true) == false)
+    {
+        status.statusCode = Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+
+    // get location from response
+    const std::string location = result.get("location").getString();
+
+    if(pin)
+    {
+        ShioriRoot::payloadCache->pinDataSet(location);
+        return true;
+    }
+
+    ShioriRoot::payloadCache->unpinDataSet(location);
+
+    return true;
+}
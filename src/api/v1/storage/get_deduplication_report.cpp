@@ -0,0 +1,195 @@
+/**
+ * @file        get_deduplication_report.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "get_deduplication_report.h"
+
+#include <shiori_root.h>
+#include <database/data_set_table.h>
+#include <database/cluster_snapshot_table.h>
+#include <core/block_store.h>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiJson/json_item.h>
+
+#include <filesystem>
+
+using namespace Kitsunemimi::Hanami;
+
+GetDeduplicationReport::GetDeduplicationReport()
+    : Blossom("Get the storage-savings by the deduplication of blocks for each visible project.")
+{
+    //----------------------------------------------------------------------------------------------
+    // output
+    //----------------------------------------------------------------------------------------------
+
+    registerOutputField("projects",
+                        SAKURA_ARRAY_TYPE,
+                        "Array with one entry for each project with the number of files, the "
+                        "size of the files without deduplication (logical_size), the size of "
+                        "their stored blocks (stored_size) and the ratio of both.");
+
+    //----------------------------------------------------------------------------------------------
+    //
+    //----------------------------------------------------------------------------------------------
+}
+
+/**
+ * @brief runTask
+ */
+bool
+GetDeduplicationReport::runTask(BlossomIO &blossomIO,
+                                const Kitsunemimi::DataMap &context,
+                                BlossomStatus &status,
+                                Kitsunemimi::ErrorContainer &error)
+{
+    const Kitsunemimi::Hanami::UserContext userContext(context);
+    std::map<std::string, ProjectUsage> projects;
+
+    // get locations of all visible data-sets and snapshots
+    Kitsunemimi::TableItem dataSets;
+    if(ShioriRoot::dataSetTable->getAllDataSet(dataSets, userContext, error, true) == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+    addFiles(projects, dataSets);
+
+    Kitsunemimi::TableItem snapshots;
+    if(ShioriRoot::clusterSnapshotTable->getAllClusterSnapshot(snapshots,
+                                                               userContext,
+                                                               error,
+                                                               true) == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::INTERNAL_SERVER_ERROR_RTYPE;
+        return false;
+    }
+    addFiles(projects, snapshots);
+
+    // create output
+    Kitsunemimi::JsonItem result;
+    result.parse("[]", error);
+    for(auto &[projectId, usage] : projects)
+    {
+        // blocks, which are used multiple times within the project, are counted only once
+        for(const auto &[block, blockSize] : usage.blocks) {
+            usage.storedSize += blockSize;
+        }
+
+        float ratio = 1.0f;
+        if(usage.storedSize > 0) {
+            ratio = static_cast<float>(usage.logicalSize) / static_cast<float>(usage.storedSize);
+        }
+
+        Kitsunemimi::JsonItem entry;
+        entry.insert("project_id", projectId);
+        entry.insert("number_of_files", usage.numberOfFiles);
+        entry.insert("logical_size", usage.logicalSize);
+        entry.insert("stored_size", usage.storedSize);
+        entry.insert("dedup_ratio", ratio);
+        result.append(entry);
+    }
+    blossomIO.output.insert("projects", result);
+
+    return true;
+}
+
+/**
+ * @brief add the usage of all files of a table to the usage of their projects
+ *
+ * @param projects reference for the usages of the projects
+ * @param table table with all entries, including the hidden location
+ */
+void
+GetDeduplicationReport::addFiles(std::map<std::string, ProjectUsage> &projects,
+                                 Kitsunemimi::TableItem &table)
+{
+    const Kitsunemimi::JsonItem header(table.getInnerHeader());
+    const Kitsunemimi::JsonItem body(table.getBody());
+
+    // get positions of the relevant columns
+    uint64_t projectPos = header.size();
+    uint64_t locationPos = header.size();
+    for(uint64_t i = 0; i < header.size(); i++)
+    {
+        if(header.get(i).getString() == "project_id") {
+            projectPos = i;
+        }
+        if(header.get(i).getString() == "location") {
+            locationPos = i;
+        }
+    }
+    if(projectPos == header.size()
+            || locationPos == header.size())
+    {
+        return;
+    }
+
+    for(uint64_t i = 0; i < body.size(); i++)
+    {
+        const Kitsunemimi::JsonItem row = body.get(i);
+        addFile(projects[row.get(projectPos).getString()], row.get(locationPos).getString());
+    }
+}
+
+/**
+ * @brief add the size and the blocks of a file to the usage of its project
+ *
+ * @param usage reference for the usage of the project
+ * @param location location of the file
+ */
+void
+GetDeduplicationReport::addFile(ProjectUsage &usage,
+                                const std::string &location)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // files, which are not split into blocks, are counted completely
+    if(BlockStore::isBlockMap(location) == false)
+    {
+        std::error_code errorCode;
+        const uint64_t fileSize = std::filesystem::file_size(location, errorCode);
+        if(errorCode) {
+            return;
+        }
+
+        usage.numberOfFiles++;
+        usage.logicalSize += fileSize;
+        usage.storedSize += fileSize;
+        return;
+    }
+
+    std::vector<BlockStore::BlockEntry> blocks;
+    uint64_t totalSize = 0;
+    if(BlockStore::readBlockMap(blocks, totalSize, location, error) == false)
+    {
+        LOG_ERROR(error);
+        return;
+    }
+
+    // blocks are identified by their store and their hash
+    const std::string directory = BlockStore::getBlockDirectory(location);
+    usage.numberOfFiles++;
+    usage.logicalSize += totalSize;
+    for(const BlockStore::BlockEntry &block : blocks) {
+        usage.blocks[BlockStore::getBlockPath(directory, block.hash)] = block.size;
+    }
+}
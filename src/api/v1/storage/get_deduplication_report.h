@@ -0,0 +1,58 @@
+/**
+ * @file        get_deduplication_report.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_GET_DEDUPLICATION_REPORT_H
+#define SHIORIARCHIVE_GET_DEDUPLICATION_REPORT_H
+
+#include <libKitsunemimiHanamiNetwork/blossom.h>
+#include <libKitsunemimiCommon/items/table_item.h>
+
+#include <map>
+
+class GetDeduplicationReport
+        : public Kitsunemimi::Hanami::Blossom
+{
+public:
+    GetDeduplicationReport();
+
+protected:
+    bool runTask(Kitsunemimi::Hanami::BlossomIO &blossomIO,
+                 const Kitsunemimi::DataMap &context,
+                 Kitsunemimi::Hanami::BlossomStatus &status,
+                 Kitsunemimi::ErrorContainer &error);
+
+private:
+    struct ProjectUsage
+    {
+        long numberOfFiles = 0;
+        long logicalSize = 0;
+        long storedSize = 0;
+        std::map<std::string, long> blocks;
+    };
+
+    void addFiles(std::map<std::string, ProjectUsage> &projects,
+                  Kitsunemimi::TableItem &table);
+    void addFile(ProjectUsage &usage,
+                 const std::string &location);
+};
+
+#endif // SHIORIARCHIVE_GET_DEDUPLICATION_REPORT_H
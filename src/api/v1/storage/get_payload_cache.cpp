@@ -0,0 +1,102 @@
+/**
+ * @file        get_payload_cache.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "get_payload_cache.h"
+
+#include <shiori_root.h>
+#include <core/payload_cache.h>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+
+using namespace Kitsunemimi::Hanami;
+
+GetPayloadCache::GetPayloadCache()
+    : Blossom("Get the counters and the memory-usage of the cache for the decoded payloads. "
+              "Only an admin is allowed to request them.")
+{
+    //----------------------------------------------------------------------------------------------
+    // output
+    //----------------------------------------------------------------------------------------------
+
+    registerOutputField("hits",
+                        SAKURA_INT_TYPE,
+                        "Number of requests, which were served from the cache.");
+    registerOutputField("misses",
+                        SAKURA_INT_TYPE,
+                        "Number of requests of payloads, which were not cached.");
+    registerOutputField("evictions",
+                        SAKURA_INT_TYPE,
+                        "Number of payloads, which were removed to free memory for others.");
+    registerOutputField("rejections",
+                        SAKURA_INT_TYPE,
+                        "Number of payloads, which were not cached, because they were "
+                        "requested less frequently than the cached ones.");
+    registerOutputField("used_bytes",
+                        SAKURA_INT_TYPE,
+                        "Number of bytes of all cached payloads.");
+    registerOutputField("max_bytes",
+                        SAKURA_INT_TYPE,
+                        "Memory-budget of the cache in bytes.");
+    registerOutputField("number_of_entries",
+                        SAKURA_INT_TYPE,
+                        "Number of cached payloads.");
+    registerOutputField("number_of_pinned",
+                        SAKURA_INT_TYPE,
+                        "Number of pinned data-sets.");
+
+    //----------------------------------------------------------------------------------------------
+    //
+    //----------------------------------------------------------------------------------------------
+}
+
+/**
+ * @brief runTask
+ */
+bool
+GetPayloadCache::runTask(BlossomIO &blossomIO,
+                         const Kitsunemimi::DataMap &context,
+                         BlossomStatus &status,
+                         Kitsunemimi::ErrorContainer &)
+{
+    const Kitsunemimi::Hanami::UserContext userContext(context);
+
+    // check that the user is an admin
+    if(userContext.isAdmin == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::UNAUTHORIZED_RTYPE;
+        status.errorMessage = "only an admin is allowed to request the payload-cache";
+        return false;
+    }
+
+    const PayloadCache::CacheStats stats = ShioriRoot::payloadCache->getStats();
+    blossomIO.output.insert("hits", static_cast<long>(stats.hits));
+    blossomIO.output.insert("misses", static_cast<long>(stats.misses));
+    blossomIO.output.insert("evictions", static_cast<long>(stats.evictions));
+    blossomIO.output.insert("rejections", static_cast<long>(stats.rejections));
+    blossomIO.output.insert("used_bytes", static_cast<long>(stats.usedBytes));
+    blossomIO.output.insert("max_bytes", static_cast<long>(stats.maxBytes));
+    blossomIO.output.insert("number_of_entries", static_cast<long>(stats.numberOfEntries));
+    blossomIO.output.insert("number_of_pinned", static_cast<long>(stats.numberOfPinned));
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file        get_warmup_status.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "get_warmup_status.h"
+
+#include <shiori_root.h>
+#include <core/warmup_manager.h>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+
+using namespace Kitsunemimi::Hanami;
+
+GetWarmupStatus::GetWarmupStatus()
+    : Blossom("Get the progress of the current or last warmup of the data-sets. "
+              "Only an admin is allowed to request it.")
+{
+    //----------------------------------------------------------------------------------------------
+    // output
+    //----------------------------------------------------------------------------------------------
+
+    registerOutputField("running",
+                        SAKURA_BOOL_TYPE,
+                        "True, if the warmup is still running.");
+    registerOutputField("queued_data_sets",
+                        SAKURA_INT_TYPE,
+                        "Number of data-sets, which were selected for the warmup.");
+    registerOutputField("warmed_data_sets",
+                        SAKURA_INT_TYPE,
+                        "Number of data-sets, which were already warmed up.");
+    registerOutputField("warmed_bytes",
+                        SAKURA_INT_TYPE,
+                        "Number of bytes, which were already read into the page-cache.");
+    registerOutputField("tracked_data_sets",
+                        SAKURA_INT_TYPE,
+                        "Number of data-sets, whose requests are counted.");
+
+    //----------------------------------------------------------------------------------------------
+    //
+    //----------------------------------------------------------------------------------------------
+}
+
+/**
+ * @brief runTask
+ */
+bool
+GetWarmupStatus::runTask(BlossomIO &blossomIO,
+                         const Kitsunemimi::DataMap &context,
+                         BlossomStatus &status,
+                         Kitsunemimi::ErrorContainer &)
+{
+    const Kitsunemimi::Hanami::UserContext userContext(context);
+
+    // check that the user is an admin
+    if(userContext.isAdmin == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::UNAUTHORIZED_RTYPE;
+        status.errorMessage = "only an admin is allowed to request the warmup";
+        return false;
+    }
+
+    const WarmupManager::WarmupStatus warmupStatus = ShioriRoot::warmupManager->getStatus();
+    blossomIO.output.insert("running", warmupStatus.running);
+    blossomIO.output.insert("queued_data_sets", static_cast<long>(warmupStatus.queuedDataSets));
+    blossomIO.output.insert("warmed_data_sets", static_cast<long>(warmupStatus.warmedDataSets));
+    blossomIO.output.insert("warmed_bytes", static_cast<long>(warmupStatus.warmedBytes));
+    blossomIO.output.insert("tracked_data_sets",
+                            static_cast<long>(warmupStatus.trackedDataSets));
+
+    return true;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file        start_warmup.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "start_warmup.h"
+
+#include <shiori_root.h>
+#include <core/warmup_manager.h>
+
+#include <libKitsunemimiHanamiCommon/enums.h>
+#include <libKitsunemimiHanamiCommon/structs.h>
+
+using namespace Kitsunemimi::Hanami;
+
+StartWarmup::StartWarmup()
+    : Blossom("Start to read the most frequently and recently requested data-sets in the "
+              "background into the page-cache. Only an admin is allowed to start it.")
+{
+    //----------------------------------------------------------------------------------------------
+    // output
+    //----------------------------------------------------------------------------------------------
+
+    registerOutputField("number_of_data_sets",
+                        SAKURA_INT_TYPE,
+                        "Number of data-sets, which are warmed up. It is 0, if a warmup is "
+                        "already running.");
+
+    //----------------------------------------------------------------------------------------------
+    //
+    //----------------------------------------------------------------------------------------------
+}
+
+/**
+ * @brief runTask
+ */
+bool
+StartWarmup::runTask(BlossomIO &blossomIO,
+                     const Kitsunemimi::DataMap &context,
+                     BlossomStatus &status,
+                     Kitsunemimi::ErrorContainer &)
+{
+    const Kitsunemimi::Hanami::UserContext userContext(context);
+
+    // check that the user is an admin
+    if(userContext.isAdmin == false)
+    {
+        status.statusCode = Kitsunemimi::Hanami::UNAUTHORIZED_RTYPE;
+        status.errorMessage = "only an admin is allowed to start the warmup";
+        return false;
+    }
+
+    const uint64_t numberOfDataSets = ShioriRoot::warmupManager->startWarmup();
+    blossomIO.output.insert("number_of_data_sets", static_cast<long>(numberOfDataSets));
+
+    return true;
+}
@@ -25,6 +25,17 @@
 
 #include <core/temp_file_handler.h>
 #include <core/data_set_files/data_set_file.h>
+#include <core/data_set_cache.h>
+#include <core/batch_server.h>
+#include <core/block_store.h>
+#include <core/normalization_cache.h>
+#include <core/payload_cache.h>
+#include <core/load_coalescer.h>
+#include <core/worker_pool.h>
+#include <core/stream_sender.h>
+#include <core/warmup_manager.h>
+#include <core/payload_transform.h>
+#include <core/local_handoff.h>
 #include <database/data_set_table.h>
 #include <database/cluster_snapshot_table.h>
 #include <database/request_result_table.h>
@@ -44,6 +55,8 @@
 #include <../libKitsunemimiHanamiMessages/protobuffers/shiori_messages.proto3.pb.h>
 #include <../libKitsunemimiHanamiMessages/message_sub_types.h>
 
+#include <algorithm>
+
 /**
  * @brief handleProtobufFileUpload
  * @param data
@@ -149,6 +162,25 @@ getDatetime()
     return datatime;
 }
 
+/**
+ * @brief handle errors of message which to requires a response
+ *
+ * @param msg error-message
+ */
+inline void
+handleFail(const std::string &msg,
+           Kitsunemimi::Sakura::Session* session,
+           const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+    error.addMeesage(msg);
+    LOG_ERROR(error);
+
+    const std::string ret = "-";
+    session->sendResponse(ret.c_str(), ret.size(), blockerId, error);
+    return;
+}
+
 /**
  * @brief handle cluster-snapshot-message
  *
@@ -163,19 +195,595 @@ handleClusterSnapshotRequest(const ClusterSnapshotPull_Message &msg,
 {
     Kitsunemimi::ErrorContainer error;
 
-    // init file
-    Kitsunemimi::BinaryFile targetFile(msg.location());
-    DataSetFile::DataSetHeader header;
-    Kitsunemimi::DataBuffer content;
-    if(targetFile.readCompleteFile(content, error) == false)
+    // with a chunk-size the client requests the snapshot as stream of chunks, so it doesn't
+    // have to be loaded completely into the memory on both sides. The chunks are read ahead
+    // from the disc, while the previous ones are sent.
+    if(msg.streamchunksize() > 0)
+    {
+        bool success = false;
+        const long chunksInFlight = GET_INT_CONFIG("shiori", "stream_chunks_in_flight", success);
+        FileStreamSender sender(msg.location(), msg.streamchunksize(), chunksInFlight);
+        if(sender.initFile(msg.rangeoffset(), msg.rangesize(), error) == false)
+        {
+            LOG_ERROR(error);
+            handleFail("Failed to read cluster-snapshot '" + msg.location() + "'",
+                       session,
+                       blockerId);
+            return;
+        }
+        if(sender.sendStream(session, blockerId, error) == false) {
+            LOG_ERROR(error);
+        }
+
+        return;
+    }
+
+    // the client can request only a byte-range of the snapshot. Snapshots, which were split
+    // into deduplicated blocks, are reassembled only from the blocks of the range.
+    uint64_t fileSize = 0;
+    if(FileStreamSender::getFileSize(fileSize, msg.location(), error) == false
+            || msg.rangeoffset() > fileSize)
+    {
+        error.addMeesage("Invalid range of cluster-snapshot '" + msg.location() + "' requested");
+        LOG_ERROR(error);
+        handleFail("Failed to read cluster-snapshot '" + msg.location() + "'",
+                   session,
+                   blockerId);
+        return;
+    }
+
+    uint64_t rangeSize = fileSize - msg.rangeoffset();
+    if(msg.rangesize() > 0) {
+        rangeSize = std::min<uint64_t>(rangeSize, msg.rangesize());
+    }
+
+    // a single response has to be completely in the memory, so bigger ranges have to be
+    // requested as stream or split into multiple requests by the client
+    bool success = false;
+    const long maxResponseMb = GET_INT_CONFIG("shiori", "max_snapshot_response_mb", success);
+    if(rangeSize > static_cast<uint64_t>(maxResponseMb) * 1024 * 1024)
+    {
+        handleFail("Requested range of cluster-snapshot '" + msg.location() + "' is bigger than "
+                   + std::to_string(maxResponseMb) + " MiB and has to be requested as stream",
+                   session,
+                   blockerId);
+        return;
+    }
+
+    std::vector<uint8_t> content(rangeSize);
+    if(FileStreamSender::readFileRange(content.data(),
+                                       msg.location(),
+                                       msg.rangeoffset(),
+                                       rangeSize,
+                                       error) == false)
+    {
+        LOG_ERROR(error);
+        handleFail("Failed to read cluster-snapshot '" + msg.location() + "'",
+                   session,
+                   blockerId);
+        return;
+    }
+
+    // send data
+    if(session->sendResponse(content.data(), content.size(), blockerId, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return;
+}
+
+/**
+ * @brief send ranges of rows directly from the mapped data-set-file without reading them into
+ *        intermediate buffers first. A single contiguous range is sent directly out of the
+ *        page-cache, while multiple ranges are copied once into the response.
+ *
+ * @param file data-set-file to read
+ * @param ranges ranges of rows to send
+ * @param columnName name of the column for table-data-sets
+ * @param compact true to send the values in the data-type, in which they are stored
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ *
+ * @return false, if the rows are not available in the mapped file in the requested data-type,
+ *         else true
+ */
+inline bool
+sendMappedRowRanges(std::shared_ptr<DataSetFile> file,
+                    const std::vector<DataSetFile::RowRange> &ranges,
+                    const std::string &columnName,
+                    const bool compact,
+                    Kitsunemimi::Sakura::Session* session,
+                    const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // collect views on the mapped payload
+    std::vector<DataSetFile::PayloadView> views;
+    for(const DataSetFile::RowRange &range : ranges)
+    {
+        if(file->getPayloadViews(views, range.startRow, range.numberOfRows, columnName) == false) {
+            return false;
+        }
+    }
+
+    uint64_t totalSize = 0;
+    for(const DataSetFile::PayloadView &view : views)
+    {
+        if(compact == false
+                && view.dataType != DataSetFile::FLOAT32_DTYPE)
+        {
+            return false;
+        }
+        totalSize += view.size;
+    }
+
+    // let the kernel read the pages ahead, before they are touched while sending
+    for(const DataSetFile::PayloadView &view : views) {
+        MappedFile::prefetchRange(view.data, view.size);
+    }
+
+    if(views.size() == 1)
+    {
+        if(session->sendResponse(views[0].data, views[0].size, blockerId, error) == false) {
+            LOG_ERROR(error);
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> content(totalSize);
+    uint64_t contentPos = 0;
+    for(const DataSetFile::PayloadView &view : views)
+    {
+        memcpy(&content[contentPos], view.data, view.size);
+        contentPos += view.size;
+    }
+
+    if(session->sendResponse(content.data(), content.size(), blockerId, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return true;
+}
+
+/**
+ * @brief send ranges of rows out of the decoded payload within the payload-cache, which is
+ *        loaded by the cache, if the payload is requested frequently enough
+ *
+ * @param file data-set-file to read
+ * @param location location of the data-set-file
+ * @param ranges ranges of rows to send
+ * @param columnName name of the column for table-data-sets
+ * @param compact true to send the values in the data-type, in which they are stored
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ *
+ * @return false, if the payload is not cached, else true
+ */
+inline bool
+sendCachedRowRanges(std::shared_ptr<DataSetFile> file,
+                    const std::string &location,
+                    const std::vector<DataSetFile::RowRange> &ranges,
+                    const std::string &columnName,
+                    const bool compact,
+                    Kitsunemimi::Sakura::Session* session,
+                    const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    std::shared_ptr<const std::vector<uint8_t>> payload;
+    payload = ShioriRoot::payloadCache->getPayload(file, location, columnName, compact);
+    if(payload == nullptr) {
+        return false;
+    }
+
+    uint64_t rowSize = file->getValuesPerRow() * sizeof(float);
+    if(compact) {
+        rowSize = file->getValuesPerRow() * file->getValueSize();
+    }
+    const uint64_t numberOfRows = payload->size() / rowSize;
+
+    // limit ranges to the cached rows
+    std::vector<DataSetFile::RowRange> validRanges;
+    for(DataSetFile::RowRange range : ranges)
+    {
+        if(range.startRow >= numberOfRows) {
+            continue;
+        }
+        range.numberOfRows = std::min(range.numberOfRows, numberOfRows - range.startRow);
+        validRanges.push_back(range);
+    }
+
+    if(validRanges.size() == 1)
+    {
+        const uint8_t* data = &(*payload)[validRanges[0].startRow * rowSize];
+        const uint64_t size = validRanges[0].numberOfRows * rowSize;
+        if(session->sendResponse(data, size, blockerId, error) == false) {
+            LOG_ERROR(error);
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> content;
+    for(const DataSetFile::RowRange &range : validRanges)
     {
-        //TODO: handle error
+        const uint8_t* data = &(*payload)[range.startRow * rowSize];
+        content.insert(content.end(), data, data + range.numberOfRows * rowSize);
+    }
+
+    if(session->sendResponse(content.data(), content.size(), blockerId, error) == false) {
         LOG_ERROR(error);
     }
 
+    return true;
+}
+
+/**
+ * @brief read a range of rows of a data-set. Identical requests, which come in at the same time,
+ *        for example from all trainers of a cluster at its start, share a single read. The state
+ *        of the file is part of the key, so a request for a replaced file never gets the rows of
+ *        the old file.
+ *
+ * @param file data-set-file to read
+ * @param location location of the data-set-file
+ * @param range range of rows to read
+ * @param columnName name of the column for table-data-sets
+ * @param compact true to read the values in the data-type, in which they are stored
+ *
+ * @return pointer to the payload, or nullptr if the read failed
+ */
+inline std::shared_ptr<const std::vector<uint8_t>>
+loadRowRange(std::shared_ptr<DataSetFile> file,
+             const std::string &location,
+             const DataSetFile::RowRange &range,
+             const std::string &columnName,
+             const bool compact)
+{
+    const std::function<LoadCoalescer::Payload()> loadFunction = [&]() -> LoadCoalescer::Payload
+    {
+        uint64_t payloadSize = 0;
+        std::shared_ptr<std::vector<uint8_t>> payload = std::make_shared<std::vector<uint8_t>>();
+        if(compact)
+        {
+            uint8_t* data = file->getCompactPayload(payloadSize,
+                                                    range.startRow,
+                                                    range.numberOfRows,
+                                                    columnName);
+            if(data == nullptr) {
+                return nullptr;
+            }
+            payload->assign(data, data + payloadSize);
+            delete[] data;
+        }
+        else
+        {
+            float* data = file->getPayload(payloadSize,
+                                           range.startRow,
+                                           range.numberOfRows,
+                                           columnName);
+            if(data == nullptr) {
+                return nullptr;
+            }
+            const uint8_t* dataBytes = reinterpret_cast<const uint8_t*>(data);
+            payload->assign(dataBytes, dataBytes + payloadSize);
+            delete[] data;
+        }
+
+        return payload;
+    };
+
+    // files, which were deleted in the meantime, are read without sharing the read
+    ino_t inode = 0;
+    int64_t modifyTime = 0;
+    if(DataSetCache::getFileState(location, inode, modifyTime) == false) {
+        return loadFunction();
+    }
+
+    const std::string key = location + "\n" + std::to_string(inode)
+                            + "\n" + std::to_string(modifyTime)
+                            + "\n" + columnName + "\n" + std::to_string(compact)
+                            + "\n" + std::to_string(range.startRow)
+                            + "\n" + std::to_string(range.numberOfRows);
+
+    return ShioriRoot::payloadLoads->load(key, loadFunction);
+}
+
+/**
+ * @brief send a range of rows of a data-set
+ *
+ * @param file data-set-file to read
+ * @param location location of the data-set-file
+ * @param range range of rows to send
+ * @param columnName name of the column for table-data-sets
+ * @param compact true to send the values in the data-type, in which they are stored
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ */
+inline void
+handleRowRange(std::shared_ptr<DataSetFile> file,
+               const std::string &location,
+               const DataSetFile::RowRange &range,
+               const std::string &columnName,
+               const bool compact,
+               Kitsunemimi::Sakura::Session* session,
+               const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // send payload directly from the mapped file, if possible
+    if(sendMappedRowRanges(file, {range}, columnName, compact, session, blockerId)) {
+        return;
+    }
+
+    // send decoded payload from the memory, if cached
+    if(sendCachedRowRanges(file, location, {range}, columnName, compact, session, blockerId)) {
+        return;
+    }
+
+    // get payload
+    std::shared_ptr<const std::vector<uint8_t>> payload;
+    payload = loadRowRange(file, location, range, columnName, compact);
+    if(payload == nullptr)
+    {
+        handleFail("Failed to read data-set '" + location + "'", session, blockerId);
+        return;
+    }
+
     // send data
-    if(session->sendResponse(content.data,
-                             content.usedBufferSize,
+    if(session->sendResponse(payload->data(), payload->size(), blockerId, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return;
+}
+
+/**
+ * @brief send multiple ranges of rows of a data-set concatenated in one response
+ *
+ * @param file data-set-file to read
+ * @param location location of the data-set-file
+ * @param ranges ranges of rows to send
+ * @param columnName name of the column for table-data-sets
+ * @param compact true to send the values in the data-type, in which they are stored
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ */
+inline void
+handleRowRanges(std::shared_ptr<DataSetFile> file,
+                const std::string &location,
+                const std::vector<DataSetFile::RowRange> &ranges,
+                const std::string &columnName,
+                const bool compact,
+                Kitsunemimi::Sakura::Session* session,
+                const uint64_t blockerId)
+{
+    // send payload directly from the mapped file, if possible
+    if(sendMappedRowRanges(file, ranges, columnName, compact, session, blockerId)) {
+        return;
+    }
+
+    // send decoded payload from the memory, if cached
+    if(sendCachedRowRanges(file, location, ranges, columnName, compact, session, blockerId)) {
+        return;
+    }
+
+    Kitsunemimi::ErrorContainer error;
+    std::vector<uint8_t> content;
+
+    for(const DataSetFile::RowRange &range : ranges)
+    {
+        uint64_t payloadSize = 0;
+        uint8_t* data = nullptr;
+        if(compact)
+        {
+            data = file->getCompactPayload(payloadSize,
+                                           range.startRow,
+                                           range.numberOfRows,
+                                           columnName);
+        }
+        else
+        {
+            float* payload = file->getPayload(payloadSize,
+                                              range.startRow,
+                                              range.numberOfRows,
+                                              columnName);
+            data = reinterpret_cast<uint8_t*>(payload);
+        }
+
+        // a partial response could not be distinguished from a complete one by the client
+        if(data == nullptr)
+        {
+            handleFail("Failed to read rows " + std::to_string(range.startRow) + " to "
+                       + std::to_string(range.startRow + range.numberOfRows)
+                       + " of data-set '" + location + "'",
+                       session,
+                       blockerId);
+            return;
+        }
+
+        content.insert(content.end(), data, data + payloadSize);
+        delete[] data;
+    }
+
+    if(session->sendResponse(content.data(), content.size(), blockerId, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return;
+}
+
+/**
+ * @brief hand off ranges of rows of a data-set to a client on the same host. Instead of the
+ *        payload, the response contains the ranges of files, which the client maps read-only.
+ *        Rows, which are stored in the requested data-type within the data-set-file, are mapped
+ *        directly from the file. All others are decoded and exported into shared memory. A
+ *        response with segments can not be distinguished from a payload by the client, so the
+ *        request fails, if the payload can not be handed off, instead of sending the payload.
+ *
+ * @param file data-set-file to read
+ * @param location location of the data-set-file
+ * @param ranges ranges of rows to send
+ * @param columnName name of the column for table-data-sets
+ * @param compact true to send the values in the data-type, in which they are stored
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ */
+inline void
+handleLocalRowRanges(std::shared_ptr<DataSetFile> file,
+                     const std::string &location,
+                     const std::vector<DataSetFile::RowRange> &ranges,
+                     const std::string &columnName,
+                     const bool compact,
+                     Kitsunemimi::Sakura::Session* session,
+                     const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+    std::vector<LocalHandoff::Segment> segments;
+
+    // try to map the rows directly from the data-set-file
+    std::vector<DataSetFile::PayloadView> views;
+    bool mapped = true;
+    for(const DataSetFile::RowRange &range : ranges)
+    {
+        if(file->getPayloadViews(views, range.startRow, range.numberOfRows, columnName) == false) {
+            mapped = false;
+        }
+    }
+    for(const DataSetFile::PayloadView &view : views)
+    {
+        LocalHandoff::Segment segment;
+        segment.size = view.size;
+        if(mapped == false
+                || (compact == false && view.dataType != DataSetFile::FLOAT32_DTYPE)
+                || file->getViewFileRange(segment.filePath, segment.offset, view) == false)
+        {
+            mapped = false;
+            break;
+        }
+        LocalHandoff::addSegment(segments, segment);
+    }
+
+    // export the decoded rows into shared memory. The state of the file is part of the key, so
+    // a changed data-set is exported again.
+    if(mapped == false)
+    {
+        segments.clear();
+
+        ino_t inode = 0;
+        int64_t modifyTime = 0;
+        if(DataSetCache::getFileState(location, inode, modifyTime) == false)
+        {
+            handleFail("Failed to get state of data-set-file '" + location + "'",
+                       session,
+                       blockerId);
+            return;
+        }
+
+        for(const DataSetFile::RowRange &range : ranges)
+        {
+            std::shared_ptr<const std::vector<uint8_t>> payload;
+            payload = loadRowRange(file, location, range, columnName, compact);
+            if(payload == nullptr)
+            {
+                handleFail("Failed to read data-set '" + location + "'", session, blockerId);
+                return;
+            }
+
+            const std::string key = location + "\n" + std::to_string(inode)
+                                    + "\n" + std::to_string(modifyTime)
+                                    + "\n" + columnName + "\n" + std::to_string(compact)
+                                    + "\n" + std::to_string(range.startRow)
+                                    + "\n" + std::to_string(range.numberOfRows);
+            LocalHandoff::Segment segment;
+            if(ShioriRoot::localHandoff->exportPayload(segment,
+                                                       key,
+                                                       payload->data(),
+                                                       payload->size(),
+                                                       error) == false)
+            {
+                // the export failed or there is no space without evicting payloads, which are
+                // not mapped yet by their clients, so the client has to request the payload
+                // again without local handoff
+                handleFail("Failed to hand off data-set '" + location + "'",
+                           session,
+                           blockerId);
+                return;
+            }
+            LocalHandoff::addSegment(segments, segment);
+        }
+    }
+
+    std::vector<uint8_t> response;
+    LocalHandoff::serializeSegments(response, segments);
+    if(session->sendResponse(response.data(), response.size(), blockerId, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return;
+}
+
+/**
+ * @brief send ranges of rows of a data-set with transformed float-values in one response
+ *
+ * @param file data-set-file to read
+ * @param location location of the data-set-file
+ * @param ranges ranges of rows to send
+ * @param columnName name of the column for table-data-sets
+ * @param transform transforms, which are applied to the values
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ */
+inline void
+handleTransformedRowRanges(std::shared_ptr<DataSetFile> file,
+                           const std::string &location,
+                           const std::vector<DataSetFile::RowRange> &ranges,
+                           const std::string &columnName,
+                           const PayloadTransform &transform,
+                           Kitsunemimi::Sakura::Session* session,
+                           const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // the untransformed rows are shared with the parallel requests of the other trainers
+    std::vector<std::shared_ptr<const std::vector<uint8_t>>> payloads;
+    uint64_t numberOfValues = 0;
+    for(const DataSetFile::RowRange &range : ranges)
+    {
+        payloads.push_back(loadRowRange(file, location, range, columnName, false));
+        if(payloads.back() == nullptr)
+        {
+            handleFail("Failed to read data-set '" + location + "'", session, blockerId);
+            return;
+        }
+        numberOfValues += payloads.back()->size() / sizeof(float);
+    }
+
+    bool success = false;
+    const long maxResponseMb = GET_INT_CONFIG("shiori", "max_transformed_response_mb", success);
+    if(transform.checkTransformedSize(numberOfValues, maxResponseMb * 1024 * 1024, error) == false)
+    {
+        LOG_ERROR(error);
+        handleFail("Transformed rows of data-set '" + location + "' are too big",
+                   session,
+                   blockerId);
+        return;
+    }
+
+    const float multiplicator = file->getColumnMultiplicator(columnName);
+    std::vector<float> content(numberOfValues * transform.getValuesPerValue());
+    uint64_t contentPos = 0;
+    for(const std::shared_ptr<const std::vector<uint8_t>> &payload : payloads)
+    {
+        const uint64_t partValues = payload->size() / sizeof(float);
+        transformPayload(&content[contentPos],
+                         reinterpret_cast<const float*>(payload->data()),
+                         partValues,
+                         multiplicator,
+                         transform);
+        contentPos += partValues * transform.getValuesPerValue();
+    }
+
+    if(session->sendResponse(content.data(),
+                             content.size() * sizeof(float),
                              blockerId,
                              error) == false)
     {
@@ -185,6 +793,264 @@ handleClusterSnapshotRequest(const ClusterSnapshotPull_Message &msg,
     return;
 }
 
+/**
+ * @brief send multiple columns of ranges of rows of a data-set in one response. The columns of
+ *        each range are gathered together in a single pass over the payload.
+ *
+ * @param file data-set-file to read
+ * @param ranges ranges of rows to send
+ * @param columnNames names of the columns to send
+ * @param columnBlocked true to send the values of each column contiguous one after another,
+ *                      false to interleave the columns row by row
+ * @param compact true to send the values in the data-type, in which they are stored
+ * @param transform transforms, which are applied to the float-values of the columns
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ */
+inline void
+handleColumnsRowRanges(std::shared_ptr<DataSetFile> file,
+                       const std::vector<DataSetFile::RowRange> &ranges,
+                       const std::vector<std::string> &columnNames,
+                       const bool columnBlocked,
+                       const bool compact,
+                       const PayloadTransform &transform,
+                       Kitsunemimi::Sakura::Session* session,
+                       const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // transforms are applied to complete columns, so the columns are read blocked in this case
+    // and interleaved while transforming
+    const bool readBlocked = columnBlocked || transform.isActive();
+
+    uint64_t valueSize = file->getValuesPerRow() * sizeof(float);
+    if(compact) {
+        valueSize = file->getValuesPerRow() * file->getValueSize();
+    }
+
+    // read columns of all ranges
+    std::vector<uint8_t*> parts;
+    std::vector<uint64_t> partRows;
+    uint64_t totalRows = 0;
+    for(const DataSetFile::RowRange &range : ranges)
+    {
+        uint64_t partSize = 0;
+        uint8_t* part = nullptr;
+        if(compact)
+        {
+            part = file->getCompactColumnsPayload(partSize,
+                                                  range.startRow,
+                                                  range.numberOfRows,
+                                                  columnNames,
+                                                  readBlocked);
+        }
+        else
+        {
+            float* payload = file->getColumnsPayload(partSize,
+                                                     range.startRow,
+                                                     range.numberOfRows,
+                                                     columnNames,
+                                                     readBlocked);
+            part = reinterpret_cast<uint8_t*>(payload);
+        }
+
+        if(part == nullptr)
+        {
+            for(uint8_t* readPart : parts) {
+                delete[] readPart;
+            }
+            handleFail("Failed to read rows " + std::to_string(range.startRow) + " to "
+                       + std::to_string(range.startRow + range.numberOfRows)
+                       + " of data-set '" + file->name + "'",
+                       session,
+                       blockerId);
+            return;
+        }
+
+        parts.push_back(part);
+        partRows.push_back(partSize / (columnNames.size() * valueSize));
+        totalRows += partRows.back();
+    }
+
+    // blocked columns of multiple ranges have to be merged column by column
+    std::vector<uint8_t> content(totalRows * columnNames.size() * valueSize);
+    uint64_t firstRow = 0;
+    for(uint64_t i = 0; i < parts.size(); i++)
+    {
+        copyRowsPart(content.data(),
+                     parts[i],
+                     firstRow,
+                     partRows[i],
+                     totalRows,
+                     columnNames.size(),
+                     valueSize,
+                     readBlocked);
+        firstRow += partRows[i];
+        delete[] parts[i];
+    }
+
+    if(transform.isActive())
+    {
+        std::vector<float> multiplicators;
+        for(const std::string &columnName : columnNames) {
+            multiplicators.push_back(file->getColumnMultiplicator(columnName));
+        }
+
+        std::vector<uint8_t> transformed(content.size());
+        transformColumnsPayload(reinterpret_cast<float*>(transformed.data()),
+                                reinterpret_cast<const float*>(content.data()),
+                                totalRows,
+                                file->getValuesPerRow(),
+                                multiplicators,
+                                columnBlocked,
+                                transform);
+        content.swap(transformed);
+    }
+
+    if(session->sendResponse(content.data(), content.size(), blockerId, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return;
+}
+
+/**
+ * @brief send ranges of rows of a data-set as stream of chunks, so large payloads don't have to
+ *        be buffered completely and the client can start to process the first rows, while the
+ *        following are still transfered
+ *
+ * @param file data-set-file to read
+ * @param ranges ranges of rows to send
+ * @param columnName name of the column for table-data-sets
+ * @param compact true to send the values in the data-type, in which they are stored
+ * @param transform transforms, which are applied to the float-values of each chunk
+ * @param chunkSize requested number of bytes of each chunk
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ */
+inline void
+handleStreamedRowRanges(std::shared_ptr<DataSetFile> file,
+                        const std::vector<DataSetFile::RowRange> &ranges,
+                        const std::string &columnName,
+                        const bool compact,
+                        const PayloadTransform &transform,
+                        const uint64_t chunkSize,
+                        Kitsunemimi::Sakura::Session* session,
+                        const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    bool success = false;
+    const long chunksInFlight = GET_INT_CONFIG("shiori", "stream_chunks_in_flight", success);
+    DataSetStreamSender sender(file,
+                               ranges,
+                               columnName,
+                               compact,
+                               transform,
+                               chunkSize,
+                               chunksInFlight);
+    if(sender.sendStream(session, blockerId, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return;
+}
+
+/**
+ * @brief handle request of a batch of a shuffled data-set
+ *
+ * @param msg message to process
+ * @param location location of the data-set, which can differ from the requested location
+ * @param transform transforms, which are applied to the values of the batch
+ * @param session pointer to the session, which received the message
+ * @param blockerId blocker-id for the response
+ */
+inline void
+handleBatchRequest(const DatasetRequest_Message &msg,
+                   const std::string &location,
+                   const PayloadTransform &transform,
+                   Kitsunemimi::Sakura::Session* session,
+                   const uint64_t blockerId)
+{
+    Kitsunemimi::ErrorContainer error;
+    std::vector<uint8_t> batch;
+    if(ShioriRoot::batchServer->getBatch(batch,
+                                         location,
+                                         msg.columnname(),
+                                         msg.seed(),
+                                         msg.batchsize(),
+                                         msg.batchindex(),
+                                         msg.compactencoding(),
+                                         error) == false)
+    {
+        LOG_ERROR(error);
+        handleFail("Failed to get batch of data-set '" + msg.location() + "'", session, blockerId);
+        return;
+    }
+
+    if(transform.isActive())
+    {
+        std::shared_ptr<DataSetFile> file = ShioriRoot::dataSetCache->getDataSetFile(location,
+                                                                                     error);
+        if(file == nullptr)
+        {
+            LOG_ERROR(error);
+            handleFail("Failed to read data-set '" + msg.location() + "'", session, blockerId);
+            return;
+        }
+        const float multiplicator = file->getColumnMultiplicator(msg.columnname());
+
+        bool success = false;
+        const long maxResponseMb = GET_INT_CONFIG("shiori", "max_transformed_response_mb", success);
+        const uint64_t numberOfValues = batch.size() / sizeof(float);
+        if(transform.checkTransformedSize(numberOfValues,
+                                          maxResponseMb * 1024 * 1024,
+                                          error) == false)
+        {
+            LOG_ERROR(error);
+            handleFail("Transformed batch of data-set '" + msg.location() + "' is too big",
+                       session,
+                       blockerId);
+            return;
+        }
+
+        std::vector<uint8_t> transformed(batch.size() * transform.getValuesPerValue());
+        transformPayload(reinterpret_cast<float*>(transformed.data()),
+                         reinterpret_cast<const float*>(batch.data()),
+                         numberOfValues,
+                         multiplicator,
+                         transform);
+        batch.swap(transformed);
+    }
+
+    if(session->sendResponse(batch.data(), batch.size(), blockerId, error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return;
+}
+
+/**
+ * @brief get the transforms, which are requested for the served values
+ *
+ * @param msg message to process
+ *
+ * @return requested transforms
+ */
+inline PayloadTransform
+getPayloadTransform(const DatasetRequest_Message &msg)
+{
+    PayloadTransform transform;
+    transform.scaleByMultiplicator = msg.scalebymultiplicator();
+    transform.clip = msg.clipvalues();
+    transform.clipMin = msg.clipmin();
+    transform.clipMax = msg.clipmax();
+    transform.logarithm = msg.logtransform();
+    transform.oneHotClasses = msg.onehotclasses();
+
+    return transform;
+}
+
 /**
  * @brief handle dataset-request-message
  *
@@ -197,40 +1063,244 @@ handleDataSetRequest(const DatasetRequest_Message &msg,
                      Kitsunemimi::Sakura::Session* session,
                      const uint64_t blockerId)
 {
-    // init file
-    DataSetFile* file = readDataSetFile(msg.location());
-    if(file == nullptr) {
+    Kitsunemimi::ErrorContainer error;
+
+    // with a normalization-mode the client requests a normalized variant of the data-set, which
+    // is created by the first request and directly served to all following requests
+    std::string location = "";
+    if(ShioriRoot::normalizationCache->getNormalizedLocation(location,
+                                                             msg.location(),
+                                                             msg.normalization(),
+                                                             error) == false)
+    {
+        LOG_ERROR(error);
+        handleFail("Failed to normalize data-set '" + msg.location() + "'", session, blockerId);
         return;
     }
 
-    float* payload = nullptr;
+    // count the request, so the data-set is warmed up after the next restart
+    ShioriRoot::warmupManager->recordAccess(location);
 
-    do
+    // the client can request transforms of the values, which are applied while serving, so
+    // the trainers don't have to repeat them in each epoch. They work on float-values only.
+    const PayloadTransform transform = getPayloadTransform(msg);
+    if(transform.checkTransform(error) == false)
     {
-        // get payload
-        uint64_t payloadSize = 0;
-        payload = file->getPayload(payloadSize, msg.columnname());
-        if(payload == nullptr)
+        LOG_ERROR(error);
+        handleFail("Invalid transform for data-set '" + msg.location() + "' requested",
+                   session,
+                   blockerId);
+        return;
+    }
+    if(transform.isActive()
+            && msg.compactencoding())
+    {
+        handleFail("Transforms of data-set '" + msg.location() + "' can not be combined with "
+                   "compact encoding",
+                   session,
+                   blockerId);
+        return;
+    }
+
+    // the response of a local handoff can not be distinguished from a payload, so the client
+    // must get either a handoff or an error, but never another kind of response
+    if(msg.localhandoff()
+            && (msg.batchsize() > 0
+                || msg.streamchunksize() > 0
+                || transform.isActive()
+                || msg.columnnames_size() > 0
+                || msg.columngroup() != DataSetFile::NO_COLUMN_GROUP))
+    {
+        handleFail("Local handoff of data-set '" + msg.location() + "' can not be combined "
+                   "with batches, streaming, transforms or multiple columns",
+                   session,
+                   blockerId);
+        return;
+    }
+
+    // with a batch-size the client requests batches of the shuffled rows instead of a range
+    if(msg.batchsize() > 0)
+    {
+        // batches are limited by the batch-size and sent in one response
+        if(msg.streamchunksize() > 0)
         {
-            // TODO: error
-            break;
+            handleFail("Batches of data-set '" + msg.location() + "' can not be streamed",
+                       session,
+                       blockerId);
+            return;
         }
 
-        // send data
-        Kitsunemimi::ErrorContainer error;
-        if(session->sendResponse(payload, payloadSize, blockerId, error) == false) {
+        handleBatchRequest(msg, location, transform, session, blockerId);
+        return;
+    }
+
+    // get file from the cache of opened data-sets
+    std::shared_ptr<DataSetFile> file = ShioriRoot::dataSetCache->getDataSetFile(location, error);
+    if(file == nullptr)
+    {
+        LOG_ERROR(error);
+        handleFail("Failed to read data-set '" + msg.location() + "'", session, blockerId);
+        return;
+    }
+
+    // the client can request the payload in the data-type, in which it is stored, instead of
+    // widened float32-values to reduce the transfered data
+    const bool compact = msg.compactencoding();
+
+    // with a shard-count the client requests only the rows of one shard of the data-set
+    std::vector<DataSetFile::RowRange> ranges;
+    if(msg.shardcount() > 0)
+    {
+        if(file->getShardRanges(ranges,
+                                msg.shardindex(),
+                                msg.shardcount(),
+                                msg.shardseed(),
+                                error) == false)
+        {
             LOG_ERROR(error);
+            handleFail("Invalid shard of data-set '" + msg.location() + "' requested",
+                       session,
+                       blockerId);
+            return;
         }
+    }
+    else
+    {
+        // the client can request only a range of rows to fetch the data-set in batches. If no
+        // number of rows is given, all rows behind the start-row are requested.
+        DataSetFile::RowRange range;
+        range.startRow = msg.startrow();
+        range.numberOfRows = msg.numberofrows();
+        if(range.startRow > file->getNumberOfRows())
+        {
+            handleFail("Requested start-row of data-set '" + msg.location() + "' is out of range",
+                       session,
+                       blockerId);
+            return;
+        }
+        if(range.numberOfRows == 0) {
+            range.numberOfRows = file->getNumberOfRows() - range.startRow;
+        }
+        ranges.push_back(range);
+    }
 
-        break;
+    // the client can request multiple columns or a group of columns of a table at once, which
+    // are gathered together instead of reading the payload again for each column
+    std::vector<std::string> columnNames;
+    for(int i = 0; i < msg.columnnames_size(); i++) {
+        columnNames.push_back(msg.columnnames(i));
     }
-    while(true);
+    if(msg.columngroup() != DataSetFile::NO_COLUMN_GROUP)
+    {
+        const DataSetFile::ColumnGroup group = static_cast<DataSetFile::ColumnGroup>(
+                                                   msg.columngroup());
+        file->getColumnNames(columnNames, group);
+    }
+    if(columnNames.size() > 0)
+    {
+        // only tables have named columns, so requests for columns of other data-sets and for
+        // unknown columns are rejected
+        std::vector<std::string> existingColumns;
+        file->getColumnNames(existingColumns, DataSetFile::ALL_COLUMNS);
+        for(const std::string &columnName : columnNames)
+        {
+            if(std::find(existingColumns.begin(), existingColumns.end(), columnName)
+                    == existingColumns.end())
+            {
+                handleFail("Column '" + columnName + "' doesn't exist in data-set '"
+                           + msg.location() + "'",
+                           session,
+                           blockerId);
+                return;
+            }
+        }
+
+        // one-hot-vectors of multiple columns would have different sizes
+        if(transform.oneHotClasses > 0)
+        {
+            handleFail("One-hot-expansion of data-set '" + msg.location() + "' is only "
+                       "possible for a single column",
+                       session,
+                       blockerId);
+            return;
+        }
 
-    delete file;
-    if(payload != nullptr) {
-        delete[] payload;
+        // the columns are gathered over all requested rows at once, so they can not be streamed
+        // in chunks of rows
+        if(msg.streamchunksize() > 0)
+        {
+            handleFail("Streaming of data-set '" + msg.location() + "' is only possible for a "
+                       "single column",
+                       session,
+                       blockerId);
+            return;
+        }
+
+        handleColumnsRowRanges(file,
+                               ranges,
+                               columnNames,
+                               msg.columnblocked(),
+                               compact,
+                               transform,
+                               session,
+                               blockerId);
+        return;
     }
 
+    if(msg.streamchunksize() > 0)
+    {
+        handleStreamedRowRanges(file,
+                                ranges,
+                                msg.columnname(),
+                                compact,
+                                transform,
+                                msg.streamchunksize(),
+                                session,
+                                blockerId);
+        return;
+    }
+
+    if(transform.isActive())
+    {
+        handleTransformedRowRanges(file,
+                                   location,
+                                   ranges,
+                                   msg.columnname(),
+                                   transform,
+                                   session,
+                                   blockerId);
+        return;
+    }
+
+    // clients on the same host can map the payload instead of receiving it over the socket
+    if(msg.localhandoff())
+    {
+        if(ShioriRoot::localHandoff->isLocalClient(msg.clientbootid()) == false)
+        {
+            handleFail("Local handoff of data-set '" + msg.location() + "' is only possible "
+                       "for clients on the same host",
+                       session,
+                       blockerId);
+            return;
+        }
+
+        handleLocalRowRanges(file,
+                             location,
+                             ranges,
+                             msg.columnname(),
+                             compact,
+                             session,
+                             blockerId);
+        return;
+    }
+
+    if(ranges.size() != 1)
+    {
+        handleRowRanges(file, location, ranges, msg.columnname(), compact, session, blockerId);
+        return;
+    }
+
+    handleRowRange(file, location, ranges[0], msg.columnname(), compact, session, blockerId);
     return;
 }
 
@@ -330,26 +1400,34 @@ handleAuditLog(const AuditLog_Message &msg)
 }
 
 /**
- * @brief handle errors of message which to requires a response
+ * @brief add a task to the worker-pool without blocking the thread of the messaging
  *
- * @param msg error-message
+ * @param lane lane, which should process the task
+ * @param owner session, which is used by the task, or nullptr, if the task uses no session
+ * @param task function to run
+ *
+ * @return false, if the worker-pool is not initialized yet, stopped or the lane is full, else true
  */
-inline void
-handleFail(const std::string &msg,
-           Kitsunemimi::Sakura::Session* session,
-           const uint64_t blockerId)
+inline bool
+addWorkerTask(const WorkerPool::Lane lane,
+              const void* owner,
+              const std::function<void()> &task)
 {
-    Kitsunemimi::ErrorContainer error;
-    error.addMeesage(msg);
-    LOG_ERROR(error);
+    if(ShioriRoot::workerPool == nullptr) {
+        return false;
+    }
 
-    const std::string ret = "-";
-    session->sendResponse(ret.c_str(), ret.size(), blockerId, error);
-    return;
+    return ShioriRoot::workerPool->addTask(lane, owner, task);
 }
 
 /**
- * @brief handle generic message-content
+ * @brief handle generic message-content. The messages are only parsed within the thread of the
+ *        messaging and processed by the worker-pool, so a large transfer doesn't block the
+ *        processing of other messages. Each kind of message is processed in its own lane, so
+ *        small requests and logs never wait behind reads of data-sets or snapshots. The tasks
+ *        are bound to the session, so they are cancelled, when the session is closed. If a
+ *        lane is full, requests are answered as busy and logs are dropped, because the thread of
+ *        the messaging must never wait for the workers.
  *
  * @param session pointer to the session, which received the message
  * @param data received bytes
@@ -374,7 +1452,15 @@ genericMessageCallback(Kitsunemimi::Sakura::Session* session,
                     return;
                 }
 
-                handleClusterSnapshotRequest(msg, session, blockerId);
+                const bool added = addWorkerTask(WorkerPool::BULK_LANE,
+                                                 session,
+                                                 [msg, session, blockerId]
+                {
+                    handleClusterSnapshotRequest(msg, session, blockerId);
+                });
+                if(added == false) {
+                    handleFail("Server is busy", session, blockerId);
+                }
             }
             break;
         case SHIORI_DATASET_REQUEST_MESSAGE_TYPE:
@@ -386,7 +1472,15 @@ genericMessageCallback(Kitsunemimi::Sakura::Session* session,
                     return;
                 }
 
-                handleDataSetRequest(msg, session, blockerId);
+                const bool added = addWorkerTask(WorkerPool::BULK_LANE,
+                                                 session,
+                                                 [msg, session, blockerId]
+                {
+                    handleDataSetRequest(msg, session, blockerId);
+                });
+                if(added == false) {
+                    handleFail("Server is busy", session, blockerId);
+                }
             }
             break;
         case SHIORI_RESULT_PUSH_MESSAGE_TYPE:
@@ -398,7 +1492,15 @@ genericMessageCallback(Kitsunemimi::Sakura::Session* session,
                     return;
                 }
 
-                handleResultPush(msg, session, blockerId);
+                const bool added = addWorkerTask(WorkerPool::METADATA_LANE,
+                                                 session,
+                                                 [msg, session, blockerId]
+                {
+                    handleResultPush(msg, session, blockerId);
+                });
+                if(added == false) {
+                    handleFail("Server is busy", session, blockerId);
+                }
             }
             break;
         case SHIORI_AUDIT_LOG_MESSAGE_TYPE:
@@ -412,7 +1514,17 @@ genericMessageCallback(Kitsunemimi::Sakura::Session* session,
                     return;
                 }
 
-                handleAuditLog(msg);
+                const bool added = addWorkerTask(WorkerPool::LOG_LANE, nullptr, [msg]
+                {
+                    handleAuditLog(msg);
+                });
+                if(added == false)
+                {
+                    // logs need no response, so they are dropped, when the server is overloaded
+                    Kitsunemimi::ErrorContainer error;
+                    error.addMeesage("Dropped audit-log-message, because the server is busy");
+                    LOG_ERROR(error);
+                }
             }
             break;
         case SHIORI_ERROR_LOG_MESSAGE_TYPE:
@@ -426,7 +1538,17 @@ genericMessageCallback(Kitsunemimi::Sakura::Session* session,
                     return;
                 }
 
-                handleErrorLog(msg);
+                const bool added = addWorkerTask(WorkerPool::LOG_LANE, nullptr, [msg]
+                {
+                    handleErrorLog(msg);
+                });
+                if(added == false)
+                {
+                    // logs need no response, so they are dropped, when the server is overloaded
+                    Kitsunemimi::ErrorContainer error;
+                    error.addMeesage("Dropped error-log-message, because the server is busy");
+                    LOG_ERROR(error);
+                }
             }
             break;
         default:
@@ -435,4 +1557,22 @@ genericMessageCallback(Kitsunemimi::Sakura::Session* session,
     }
 }
 
+/**
+ * @brief handle closed session. The session is deleted after this callback, so all tasks, which
+ *        still use the session, are removed or finished before. The callback is only registered,
+ *        when built with SHIORI_SESSION_CLOSE_CALLBACK, because it needs
+ *        libKitsunemimiHanamiNetwork v0.4.0.
+ *
+ * @param session pointer to the closed session
+ */
+void
+sessionCloseCallback(Kitsunemimi::Sakura::Session* session)
+{
+    if(ShioriRoot::workerPool == nullptr) {
+        return;
+    }
+
+    ShioriRoot::workerPool->cancelTasks(session);
+}
+
 #endif // SHIORIARCHIVE_CALLBACKS_H
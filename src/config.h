@@ -35,8 +35,31 @@ registerConfigs(Kitsunemimi::ErrorContainer &error)
 {
     Kitsunemimi::Hanami::registerBasicConfigs(error);
 
-    REGISTER_STRING_CONFIG( "shiori", "data_set_location",         error, "", true );
-    REGISTER_STRING_CONFIG( "shiori", "cluster_snapshot_location", error, "", true );
+    REGISTER_STRING_CONFIG( "shiori", "data_set_location",            error, "",    true  );
+    REGISTER_STRING_CONFIG( "shiori", "cluster_snapshot_location",    error, "",    true  );
+    REGISTER_INT_CONFIG(    "shiori", "data_set_cache_max_files",     error, 64,    false );
+    REGISTER_INT_CONFIG(    "shiori", "data_set_cache_max_mapped_mb", error, 65536, false );
+    REGISTER_INT_CONFIG(    "shiori", "batch_server_max_iterators",   error, 16,    false );
+    REGISTER_INT_CONFIG(    "shiori", "batch_prefetch_depth",         error, 4,     false );
+    REGISTER_BOOL_CONFIG(   "shiori", "dedup_data_sets",              error, false, false );
+    REGISTER_BOOL_CONFIG(   "shiori", "dedup_cluster_snapshots",      error, false, false );
+    // only selects fixed-size blocks instead of content-defined blocks for the deduplication of
+    // snapshots. There is no delta against a selected base-snapshot and no rebasing.
+    REGISTER_INT_CONFIG(    "shiori", "cluster_snapshot_block_kb",    error, 0,     false );
+    REGISTER_INT_CONFIG(    "shiori", "stream_chunks_in_flight",      error, 4,     false );
+    REGISTER_INT_CONFIG(    "shiori", "payload_cache_max_mb",         error, 1024,  false );
+    REGISTER_INT_CONFIG(    "shiori", "max_transformed_response_mb",  error, 1024,  false );
+    REGISTER_INT_CONFIG(    "shiori", "max_snapshot_response_mb",     error, 1024,  false );
+    REGISTER_INT_CONFIG(    "shiori", "bulk_worker_threads",          error, 8,     false );
+    REGISTER_INT_CONFIG(    "shiori", "metadata_worker_threads",      error, 2,     false );
+    REGISTER_INT_CONFIG(    "shiori", "log_worker_threads",           error, 1,     false );
+    REGISTER_INT_CONFIG(    "shiori", "worker_queue_max_tasks",       error, 64,    false );
+    REGISTER_BOOL_CONFIG(   "shiori", "warmup_on_startup",            error, true,  false );
+    REGISTER_INT_CONFIG(    "shiori", "warmup_max_data_sets",         error, 16,    false );
+    REGISTER_INT_CONFIG(    "shiori", "warmup_max_mb_per_sec",        error, 200,   false );
+    REGISTER_STRING_CONFIG( "shiori", "local_handoff_directory",      error, "/dev/shm/shiori", false );
+    REGISTER_INT_CONFIG(    "shiori", "local_handoff_max_mb",         error, 0,     false );
+    REGISTER_INT_CONFIG(    "shiori", "local_handoff_pin_seconds",    error, 60,    false );
 }
 
 #endif // SHIORIARCHIVE_CONFIG_H
@@ -0,0 +1,170 @@
+/**
+ * @file        batch_server.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "batch_server.h"
+
+#include <shiori_root.h>
+#include <core/data_set_batcher.h>
+#include <core/data_set_cache.h>
+#include <core/data_set_files/data_set_file.h>
+
+/**
+ * @brief constructor
+ *
+ * @param maxNumberOfBatchers maximum number of batchers, which are kept with their prefetched
+ *                            batches at the same time
+ * @param prefetchDepth number of batches, which are prefetched by each batcher
+ */
+BatchServer::BatchServer(const uint64_t maxNumberOfBatchers,
+                         const uint64_t prefetchDepth)
+{
+    m_maxNumberOfBatchers = maxNumberOfBatchers;
+    m_prefetchDepth = prefetchDepth;
+}
+
+/**
+ * @brief destructor
+ */
+BatchServer::~BatchServer() {}
+
+/**
+ * @brief get a batch of a shuffled data-set. All requests with the same data-set, column, seed,
+ *        batch-size and encoding share one batcher, which prefetches the following batches.
+ *
+ * @param batch reference for the gathered rows of the batch
+ * @param location path to the data-set-file
+ * @param columnName name of the column for table-data-sets
+ * @param seed seed for the permutation of the rows
+ * @param batchSize number of rows of each batch
+ * @param batchIndex number of the requested batch
+ * @param compact true to get the values in the data-type, in which they are stored
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BatchServer::getBatch(std::vector<uint8_t> &batch,
+                      const std::string &location,
+                      const std::string &columnName,
+                      const uint64_t seed,
+                      const uint64_t batchSize,
+                      const uint64_t batchIndex,
+                      const bool compact,
+                      Kitsunemimi::ErrorContainer &error)
+{
+    if(batchSize == 0)
+    {
+        error.addMeesage("Batch-size must be greater than 0");
+        return false;
+    }
+
+    std::shared_ptr<DataSetBatcher> batcher = getBatcher(location,
+                                                         columnName,
+                                                         seed,
+                                                         batchSize,
+                                                         compact,
+                                                         error);
+    if(batcher == nullptr) {
+        return false;
+    }
+
+    return batcher->getBatch(batch, batchIndex, error);
+}
+
+/**
+ * @brief get batcher for the requested permutation or create a new one. A batcher is replaced,
+ *        when the data-set-file was changed since the batcher was created.
+ *
+ * @param location path to the data-set-file
+ * @param columnName name of the column for table-data-sets
+ * @param seed seed for the permutation of the rows
+ * @param batchSize number of rows of each batch
+ * @param compact true to get the values in the data-type, in which they are stored
+ * @param error reference for error-output
+ *
+ * @return pointer to the batcher, if successful, else nullptr
+ */
+std::shared_ptr<DataSetBatcher>
+BatchServer::getBatcher(const std::string &location,
+                        const std::string &columnName,
+                        const uint64_t seed,
+                        const uint64_t batchSize,
+                        const bool compact,
+                        Kitsunemimi::ErrorContainer &error)
+{
+    std::shared_ptr<DataSetFile> file = ShioriRoot::dataSetCache->getDataSetFile(location, error);
+    if(file == nullptr) {
+        return nullptr;
+    }
+
+    const std::string key = location + "|" + columnName
+                            + "|" + std::to_string(seed)
+                            + "|" + std::to_string(batchSize)
+                            + "|" + std::to_string(compact);
+
+    // removed batchers are destroyed after the lock is released, because their destructor has
+    // to wait for their prefetch-thread
+    std::vector<std::shared_ptr<DataSetBatcher>> removedBatchers;
+    std::shared_ptr<DataSetBatcher> batcher;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        std::map<std::string, BatcherEntry>::iterator it = m_batchers.find(key);
+        if(it != m_batchers.end())
+        {
+            if(it->second.batcher->getFile() == file)
+            {
+                m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+                return it->second.batcher;
+            }
+
+            // data-set-file was changed since the batcher was created
+            removedBatchers.push_back(it->second.batcher);
+            m_lru.erase(it->second.lruPos);
+            m_batchers.erase(it);
+        }
+
+        BatcherEntry entry;
+        entry.batcher = std::make_shared<DataSetBatcher>(file,
+                                                         columnName,
+                                                         seed,
+                                                         batchSize,
+                                                         compact,
+                                                         m_prefetchDepth);
+        m_lru.push_front(key);
+        entry.lruPos = m_lru.begin();
+        m_batchers.insert(std::make_pair(key, entry));
+        batcher = entry.batcher;
+
+        // remove least recently used batchers
+        while(m_batchers.size() > 1
+              && m_batchers.size() > m_maxNumberOfBatchers)
+        {
+            it = m_batchers.find(m_lru.back());
+            removedBatchers.push_back(it->second.batcher);
+            m_lru.pop_back();
+            m_batchers.erase(it);
+        }
+    }
+
+    return batcher;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file        batch_server.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_BATCHSERVER_H
+#define SHIORIARCHIVE_BATCHSERVER_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <mutex>
+#include <memory>
+
+class DataSetBatcher;
+
+class BatchServer
+{
+public:
+    BatchServer(const uint64_t maxNumberOfBatchers,
+                const uint64_t prefetchDepth);
+    ~BatchServer();
+
+    bool getBatch(std::vector<uint8_t> &batch,
+                  const std::string &location,
+                  const std::string &columnName,
+                  const uint64_t seed,
+                  const uint64_t batchSize,
+                  const uint64_t batchIndex,
+                  const bool compact,
+                  Kitsunemimi::ErrorContainer &error);
+
+private:
+    struct BatcherEntry
+    {
+        std::shared_ptr<DataSetBatcher> batcher;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    std::shared_ptr<DataSetBatcher> getBatcher(const std::string &location,
+                                               const std::string &columnName,
+                                               const uint64_t seed,
+                                               const uint64_t batchSize,
+                                               const bool compact,
+                                               Kitsunemimi::ErrorContainer &error);
+
+    std::mutex m_lock;
+    std::map<std::string, BatcherEntry> m_batchers;
+    std::list<std::string> m_lru;
+    uint64_t m_maxNumberOfBatchers = 0;
+    uint64_t m_prefetchDepth = 0;
+};
+
+#endif // SHIORIARCHIVE_BATCHSERVER_H
@@ -0,0 +1,966 @@
+/**
+ * @file        block_store.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "block_store.h"
+
+#include <libKitsunemimiCommon/files/binary_file.h>
+#include <libKitsunemimiCommon/methods/file_methods.h>
+
+#include <core/mapped_file.h>
+
+#include <openssl/evp.h>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+// blocks, which are read by open files or streams, and blocks, which are not referenced anymore,
+// but can only be deleted after the last reader is gone
+static std::mutex pinLock;
+static std::map<std::string, uint64_t> pinnedBlocks;
+static std::set<std::string> unreferencedBlocks;
+
+/**
+ * @brief create the table of random values for the rolling hash of the content-defined blocks.
+ *        The values must never change, because else the same content would be split differently
+ *        and could not be deduplicated with already stored blocks anymore.
+ *
+ * @return table with one random value for each possible byte
+ */
+static std::vector<uint64_t>
+createGearTable()
+{
+    std::mt19937_64 generator(0x5348494f5249ULL);
+    std::vector<uint64_t> table(256, 0);
+    for(uint64_t i = 0; i < 256; i++) {
+        table[i] = generator();
+    }
+
+    return table;
+}
+
+/**
+ * @brief constructor
+ *
+ * @param location directory of the stored files, where the blocks are stored in a sub-directory
+ * @param enabled false to keep all files as they are
+ * @param fixedBlockSize size of the blocks in bytes, if the files should be split at fixed
+ *                       offsets, or 0 to split them into content-defined blocks
+ */
+BlockStore::BlockStore(const std::string &location,
+                       const bool enabled,
+                       const uint64_t fixedBlockSize)
+{
+    m_directory = location + "/blocks";
+    m_enabled = enabled;
+    m_index = getBlockIndex(m_directory);
+
+    if(fixedBlockSize != 0) {
+        m_fixedBlockSize = std::clamp(fixedBlockSize, MIN_BLOCK_SIZE, MAX_BLOCK_SIZE);
+    }
+}
+
+/**
+ * @brief destructor
+ */
+BlockStore::~BlockStore() {}
+
+/**
+ * @brief create the directory for the blocks and count the references to the stored blocks. The
+ *        references are only counted by the first store of a location, because the other stores
+ *        of the same location share its index.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BlockStore::initStore(Kitsunemimi::ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_index->lock);
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(m_directory, errorCode);
+    if(errorCode)
+    {
+        error.addMeesage("Failed to create block-directory '" + m_directory + "': "
+                         + errorCode.message());
+        return false;
+    }
+
+    if(m_index->loaded) {
+        return true;
+    }
+    m_index->loaded = loadIndex(error);
+
+    return m_index->loaded;
+}
+
+/**
+ * @brief split a file into content-defined or fixed-size blocks, store each block only once and
+ *        replace the file by a block-map, which lists the blocks of the file. Small files and
+ *        files, which are already block-maps, are kept as they are.
+ *
+ * @param filePath path of the file
+ * @param error reference for error-output
+ *
+ * @return false, if storing failed, in which case the file is unchanged, else true
+ */
+bool
+BlockStore::storeFile(const std::string &filePath,
+                      Kitsunemimi::ErrorContainer &error)
+{
+    if(m_enabled == false
+            || isBlockMap(filePath))
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> guard(m_index->lock);
+
+    // files smaller than a single block can not share blocks with other files
+    std::error_code errorCode;
+    const uint64_t fileSize = std::filesystem::file_size(filePath, errorCode);
+    if(errorCode)
+    {
+        error.addMeesage("Failed to get size of file '" + filePath + "'");
+        return false;
+    }
+    if(fileSize < MIN_BLOCK_SIZE) {
+        return true;
+    }
+
+    MappedFile input(filePath);
+    if(input.mapFile(error) == false) {
+        return false;
+    }
+
+    // store blocks
+    const std::string directory = getBlockDirectory(filePath);
+    std::vector<uint64_t> blockEnds;
+    if(m_fixedBlockSize == 0)
+    {
+        splitIntoBlocks(blockEnds, input.data, input.size);
+    }
+    else
+    {
+        splitIntoFixedBlocks(blockEnds, input.size, m_fixedBlockSize);
+    }
+    std::vector<BlockEntry> blocks;
+    uint64_t blockStart = 0;
+    for(const uint64_t blockEnd : blockEnds)
+    {
+        BlockEntry entry;
+        if(addBlock(entry, directory, &input.data[blockStart], blockEnd - blockStart, error) == false)
+        {
+            releaseBlocks(blocks, directory);
+            return false;
+        }
+        blocks.push_back(entry);
+        blockStart = blockEnd;
+    }
+
+    // replace file by its block-map
+    BlockMapHeader header;
+    header.numberOfBlocks = blocks.size();
+    header.totalSize = input.size;
+    std::vector<std::pair<const void*, uint64_t>> parts;
+    parts.emplace_back(&header, sizeof(BlockMapHeader));
+    parts.emplace_back(&blocks[0], blocks.size() * sizeof(BlockEntry));
+    if(writeFile(filePath, parts, error) == false)
+    {
+        error.addMeesage("Failed to write block-map of file '" + filePath + "'");
+        releaseBlocks(blocks, directory);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief reassemble a file from its blocks, so it can be modified again, and release the
+ *        references to the blocks
+ *
+ * @param filePath path of the block-map, which is replaced by the complete file
+ * @param error reference for error-output
+ *
+ * @return true, if successful or the file is no block-map, else false
+ */
+bool
+BlockStore::restoreFile(const std::string &filePath,
+                        Kitsunemimi::ErrorContainer &error)
+{
+    if(isBlockMap(filePath) == false) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> guard(m_index->lock);
+
+    std::vector<BlockEntry> blocks;
+    uint64_t totalSize = 0;
+    if(readBlockMap(blocks, totalSize, filePath, error) == false) {
+        return false;
+    }
+
+    // write the blocks one after another into a new file
+    const std::string directory = getBlockDirectory(filePath);
+    const std::string tempPath = filePath + ".restore";
+    Kitsunemimi::BinaryFile targetFile(tempPath);
+    if(targetFile.allocateStorage(totalSize, error) == false)
+    {
+        error.addMeesage("Failed to allocate storage to restore file '" + filePath + "'");
+        return false;
+    }
+
+    std::vector<uint8_t> buffer;
+    uint64_t offset = 0;
+    for(const BlockEntry &block : blocks)
+    {
+        buffer.resize(block.size);
+        Kitsunemimi::BinaryFile blockFile(getBlockPath(directory, block.hash));
+        if(blockFile.readDataFromFile(&buffer[0], 0, block.size, error) == false
+                || targetFile.writeDataIntoFile(&buffer[0], offset, block.size, error) == false)
+        {
+            error.addMeesage("Failed to restore file '" + filePath + "' from its blocks");
+            targetFile.closeFile(error);
+            Kitsunemimi::deleteFileOrDir(tempPath, error);
+            return false;
+        }
+        offset += block.size;
+    }
+
+    if(targetFile.closeFile(error) == false
+            || Kitsunemimi::renameFileOrDir(tempPath, filePath, error) == false)
+    {
+        error.addMeesage("Failed to replace block-map '" + filePath + "' by restored file");
+        return false;
+    }
+
+    releaseBlocks(blocks, directory);
+
+    return true;
+}
+
+/**
+ * @brief delete a file and, if it is a block-map, release the references to its blocks. The
+ *        blocks are only released after the file is gone, so a block-map never references
+ *        deleted blocks, even if the process stops in between.
+ *
+ * @param filePath path of the file
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BlockStore::deleteFile(const std::string &filePath,
+                       Kitsunemimi::ErrorContainer &error)
+{
+    if(isBlockMap(filePath) == false) {
+        return Kitsunemimi::deleteFileOrDir(filePath, error);
+    }
+
+    std::lock_guard<std::mutex> guard(m_index->lock);
+
+    std::vector<BlockEntry> blocks;
+    uint64_t totalSize = 0;
+    if(readBlockMap(blocks, totalSize, filePath, error) == false
+            || Kitsunemimi::deleteFileOrDir(filePath, error) == false)
+    {
+        return false;
+    }
+
+    releaseBlocks(blocks, getBlockDirectory(filePath));
+
+    return true;
+}
+
+/**
+ * @brief get size of the store
+ *
+ * @param storedSize reference for the number of bytes of all stored blocks
+ * @param referencedSize reference for the number of bytes of all references to the blocks,
+ *                       which is the size the files would have without deduplication
+ */
+void
+BlockStore::getStoreSize(uint64_t &storedSize,
+                         uint64_t &referencedSize)
+{
+    std::lock_guard<std::mutex> guard(m_index->lock);
+
+    storedSize = 0;
+    referencedSize = 0;
+    for(const auto &[blockPath, entry] : m_index->entries)
+    {
+        storedSize += entry.size;
+        referencedSize += entry.size * entry.refCount;
+    }
+}
+
+/**
+ * @brief check if a file is a block-map
+ *
+ * @param filePath path of the file
+ *
+ * @return true, if the file starts with the magic-number of a block-map, else false
+ */
+bool
+BlockStore::isBlockMap(const std::string &filePath)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // check size before opening the file, to not create missing files
+    std::error_code errorCode;
+    const uint64_t fileSize = std::filesystem::file_size(filePath, errorCode);
+    if(errorCode
+            || fileSize < sizeof(BlockMapHeader))
+    {
+        return false;
+    }
+
+    char magic[8];
+    Kitsunemimi::BinaryFile file(filePath);
+    if(file.readDataFromFile(magic, 0, 8, error) == false) {
+        return false;
+    }
+
+    return memcmp(magic, BlockMapHeader().magic, 8) == 0;
+}
+
+/**
+ * @brief read the list of blocks of a block-map
+ *
+ * @param blocks reference for the blocks of the file in their order
+ * @param totalSize reference for the size of the complete file
+ * @param filePath path of the block-map
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BlockStore::readBlockMap(std::vector<BlockEntry> &blocks,
+                         uint64_t &totalSize,
+                         const std::string &filePath,
+                         Kitsunemimi::ErrorContainer &error)
+{
+    Kitsunemimi::BinaryFile file(filePath);
+    BlockMapHeader header;
+    if(file.readDataFromFile(&header, 0, sizeof(BlockMapHeader), error) == false
+            || memcmp(header.magic, BlockMapHeader().magic, 8) != 0)
+    {
+        error.addMeesage("File '" + filePath + "' is no valid block-map");
+        return false;
+    }
+
+    blocks.resize(header.numberOfBlocks);
+    if(header.numberOfBlocks > 0
+            && file.readDataFromFile(&blocks[0],
+                                     sizeof(BlockMapHeader),
+                                     header.numberOfBlocks * sizeof(BlockEntry),
+                                     error) == false)
+    {
+        error.addMeesage("Failed to read blocks of block-map '" + filePath + "'");
+        return false;
+    }
+    totalSize = header.totalSize;
+
+    return true;
+}
+
+/**
+ * @brief read a part of a file, which is stored as block-map, by reading the blocks, which
+ *        overlap with the requested range
+ *
+ * @param filePath path of the block-map
+ * @param target pointer to the buffer for the read data
+ * @param offset byte-offset within the complete file
+ * @param size number of bytes to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BlockStore::readFileData(const std::string &filePath,
+                         void* target,
+                         const uint64_t offset,
+                         const uint64_t size,
+                         Kitsunemimi::ErrorContainer &error)
+{
+    std::vector<BlockEntry> blocks;
+    uint64_t totalSize = 0;
+    if(readBlockMap(blocks, totalSize, filePath, error) == false) {
+        return false;
+    }
+
+    std::vector<uint64_t> blockOffsets;
+    getBlockOffsets(blockOffsets, blocks);
+
+    return readBlocksData(blocks, blockOffsets, totalSize, filePath, target, offset, size, error);
+}
+
+/**
+ * @brief get the byte-offsets of the blocks within the complete file
+ *
+ * @param blockOffsets reference for the offset of each block
+ * @param blocks blocks of the file in their order
+ */
+void
+BlockStore::getBlockOffsets(std::vector<uint64_t> &blockOffsets,
+                            const std::vector<BlockEntry> &blocks)
+{
+    blockOffsets.clear();
+    blockOffsets.reserve(blocks.size());
+
+    uint64_t blockStart = 0;
+    for(const BlockEntry &block : blocks)
+    {
+        blockOffsets.push_back(blockStart);
+        blockStart += block.size;
+    }
+}
+
+/**
+ * @brief read a range of a file, which is stored as block-map, with the already read list of
+ *        its blocks, so multiple ranges can be read without reading the block-map again. Only
+ *        the blocks, which overlap with the range, are read.
+ *
+ * @param blocks blocks of the file
+ * @param blockOffsets byte-offsets of the blocks within the file
+ * @param totalSize total size of the file
+ * @param filePath path to the block-map
+ * @param target buffer for the read data
+ * @param offset byte-offset within the file
+ * @param size number of bytes to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BlockStore::readBlocksData(const std::vector<BlockEntry> &blocks,
+                           const std::vector<uint64_t> &blockOffsets,
+                           const uint64_t totalSize,
+                           const std::string &filePath,
+                           void* target,
+                           const uint64_t offset,
+                           const uint64_t size,
+                           Kitsunemimi::ErrorContainer &error)
+{
+    if(offset + size > totalSize
+            || blockOffsets.size() != blocks.size())
+    {
+        error.addMeesage("Requested data is outside of the file '" + filePath + "'");
+        return false;
+    }
+    if(size == 0) {
+        return true;
+    }
+
+    // search the block, which contains the first requested byte
+    const std::vector<uint64_t>::const_iterator it = std::upper_bound(blockOffsets.begin(),
+                                                                      blockOffsets.end(),
+                                                                      offset);
+    uint64_t blockId = static_cast<uint64_t>(it - blockOffsets.begin()) - 1;
+
+    const std::string directory = getBlockDirectory(filePath);
+    uint8_t* targetBytes = static_cast<uint8_t*>(target);
+    for(; blockId < blocks.size(); blockId++)
+    {
+        const uint64_t blockStart = blockOffsets[blockId];
+        const uint64_t blockEnd = blockStart + blocks[blockId].size;
+        if(blockStart >= offset + size) {
+            break;
+        }
+
+        const uint64_t readStart = std::max(blockStart, offset);
+        const uint64_t readEnd = std::min(blockEnd, offset + size);
+        if(readEnd <= readStart) {
+            continue;
+        }
+
+        Kitsunemimi::BinaryFile blockFile(getBlockPath(directory, blocks[blockId].hash));
+        if(blockFile.readDataFromFile(&targetBytes[readStart - offset],
+                                      readStart - blockStart,
+                                      readEnd - readStart,
+                                      error) == false)
+        {
+            error.addMeesage("Failed to read block of file '" + filePath + "'");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief split data into content-defined blocks. The borders of the blocks only depend on the
+ *        bytes directly before them, so the same content results in the same blocks, even if
+ *        it was moved within the file by inserted or removed bytes. Blocks smaller than the
+ *        average size use a stricter condition for a border than larger blocks, which keeps the
+ *        sizes of the blocks close to the average.
+ *
+ * @param blockEnds reference for the end-offsets of the blocks
+ * @param data data to split
+ * @param size number of bytes of the data
+ */
+void
+BlockStore::splitIntoBlocks(std::vector<uint64_t> &blockEnds,
+                            const uint8_t* data,
+                            const uint64_t size)
+{
+    static const std::vector<uint64_t> gearTable = createGearTable();
+
+    // the rolling hash is shifted to the left, so the upper bits depend on the most bytes
+    const uint64_t strictMask = ((1ULL << 18) - 1) << 46;
+    const uint64_t looseMask = ((1ULL << 14) - 1) << 50;
+
+    uint64_t blockStart = 0;
+    while(blockStart < size)
+    {
+        const uint64_t remaining = size - blockStart;
+        if(remaining <= MIN_BLOCK_SIZE)
+        {
+            blockEnds.push_back(size);
+            break;
+        }
+
+        const uint64_t maxEnd = blockStart + std::min(remaining, MAX_BLOCK_SIZE);
+        const uint64_t avgEnd = std::min(blockStart + AVG_BLOCK_SIZE, maxEnd);
+        uint64_t blockEnd = maxEnd;
+        uint64_t hash = 0;
+        uint64_t pos = blockStart + MIN_BLOCK_SIZE;
+
+        for(; pos < avgEnd; pos++)
+        {
+            hash = (hash << 1) + gearTable[data[pos]];
+            if((hash & strictMask) == 0)
+            {
+                blockEnd = pos + 1;
+                break;
+            }
+        }
+
+        if(pos == avgEnd)
+        {
+            for(; pos < maxEnd; pos++)
+            {
+                hash = (hash << 1) + gearTable[data[pos]];
+                if((hash & looseMask) == 0)
+                {
+                    blockEnd = pos + 1;
+                    break;
+                }
+            }
+        }
+
+        blockEnds.push_back(blockEnd);
+        blockStart = blockEnd;
+    }
+}
+
+/**
+ * @brief split data into blocks of a fixed size. In contrast to content-defined blocks, inserted
+ *        or removed bytes shift all following borders, but files, which keep their layout and are
+ *        only modified in-place, like successive snapshots of the same cluster, only differ in
+ *        the blocks, which contain the modified bytes. Additionally the data don't have to be
+ *        scanned to find the borders.
+ *
+ * @param blockEnds reference for the end-offsets of the blocks
+ * @param size number of bytes of the data
+ * @param blockSize size of the blocks in bytes, where only the last block can be smaller
+ */
+void
+BlockStore::splitIntoFixedBlocks(std::vector<uint64_t> &blockEnds,
+                                 const uint64_t size,
+                                 const uint64_t blockSize)
+{
+    blockEnds.clear();
+    if(blockSize == 0) {
+        return;
+    }
+
+    for(uint64_t blockEnd = blockSize; blockEnd < size; blockEnd += blockSize) {
+        blockEnds.push_back(blockEnd);
+    }
+    if(size > 0) {
+        blockEnds.push_back(size);
+    }
+}
+
+/**
+ * @brief get directory of the blocks of a file
+ *
+ * @param filePath path of the file
+ *
+ * @return directory of the blocks, which is a sub-directory of the directory of the file
+ */
+const std::string
+BlockStore::getBlockDirectory(const std::string &filePath)
+{
+    return std::filesystem::path(filePath).parent_path().string() + "/blocks";
+}
+
+/**
+ * @brief get path of a block, which is named by the hex-string of its hash. The blocks are
+ *        distributed over sub-directories by the first byte of the hash.
+ *
+ * @param directory directory of the blocks
+ * @param hash sha256-hash of the block
+ *
+ * @return path of the block
+ */
+const std::string
+BlockStore::getBlockPath(const std::string &directory,
+                         const uint8_t* hash)
+{
+    const char hexChars[] = "0123456789abcdef";
+    std::string hexHash(64, '0');
+    for(uint32_t i = 0; i < 32; i++)
+    {
+        hexHash[i * 2] = hexChars[hash[i] >> 4];
+        hexHash[i * 2 + 1] = hexChars[hash[i] & 0xf];
+    }
+
+    return directory + "/" + hexHash.substr(0, 2) + "/" + hexHash;
+}
+
+/**
+ * @brief mark blocks as read by an open file or a stream. Pinned blocks are not deleted, when
+ *        their last reference is released, until they are unpinned again.
+ *
+ * @param blocks blocks to pin
+ * @param directory directory of the blocks
+ */
+void
+BlockStore::pinBlocks(const std::vector<BlockEntry> &blocks,
+                      const std::string &directory)
+{
+    std::lock_guard<std::mutex> guard(pinLock);
+
+    for(const BlockEntry &block : blocks) {
+        pinnedBlocks[getBlockPath(directory, block.hash)]++;
+    }
+}
+
+/**
+ * @brief unpin blocks and delete the blocks, which were released while they were pinned
+ *
+ * @param blocks blocks to unpin, which must be pinned before
+ * @param directory directory of the blocks
+ */
+void
+BlockStore::unpinBlocks(const std::vector<BlockEntry> &blocks,
+                        const std::string &directory)
+{
+    Kitsunemimi::ErrorContainer error;
+    std::lock_guard<std::mutex> guard(pinLock);
+
+    for(const BlockEntry &block : blocks)
+    {
+        const std::string blockPath = getBlockPath(directory, block.hash);
+        std::map<std::string, uint64_t>::iterator it = pinnedBlocks.find(blockPath);
+        if(it == pinnedBlocks.end()) {
+            continue;
+        }
+
+        it->second--;
+        if(it->second > 0) {
+            continue;
+        }
+        pinnedBlocks.erase(it);
+
+        if(unreferencedBlocks.erase(blockPath) > 0
+                && Kitsunemimi::deleteFileOrDir(blockPath, error) == false)
+        {
+            LOG_ERROR(error);
+        }
+    }
+}
+
+/**
+ * @brief delete a block without any remaining reference, or delay the deletion until the
+ *        block is not pinned anymore
+ *
+ * @param blockPath path of the block
+ */
+void
+BlockStore::removeBlockFile(const std::string &blockPath)
+{
+    Kitsunemimi::ErrorContainer error;
+    std::lock_guard<std::mutex> guard(pinLock);
+
+    if(pinnedBlocks.find(blockPath) != pinnedBlocks.end())
+    {
+        unreferencedBlocks.insert(blockPath);
+        return;
+    }
+
+    if(Kitsunemimi::deleteFileOrDir(blockPath, error) == false) {
+        LOG_ERROR(error);
+    }
+}
+
+/**
+ * @brief get the index of a block-directory, which is created by the first store of the
+ *        directory and shared with all further stores of the same directory
+ *
+ * @param directory directory of the blocks
+ *
+ * @return index of the block-directory
+ */
+std::shared_ptr<BlockStore::BlockIndex>
+BlockStore::getBlockIndex(const std::string &directory)
+{
+    static std::mutex indexesLock;
+    static std::map<std::string, std::weak_ptr<BlockIndex>> indexes;
+
+    std::lock_guard<std::mutex> guard(indexesLock);
+
+    // different spellings of the same directory must share one index
+    const std::string key = std::filesystem::absolute(directory).lexically_normal().string();
+    std::shared_ptr<BlockIndex> index = indexes[key].lock();
+    if(index == nullptr)
+    {
+        index = std::make_shared<BlockIndex>();
+        indexes[key] = index;
+    }
+
+    return index;
+}
+
+/**
+ * @brief add a reference to a block and write the block, if it doesn't exist yet. The lock must
+ *        already be held by the caller.
+ *
+ * @param entry reference for the entry of the block within the block-map
+ * @param directory directory of the blocks
+ * @param data content of the block
+ * @param size size of the block
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BlockStore::addBlock(BlockEntry &entry,
+                     const std::string &directory,
+                     const uint8_t* data,
+                     const uint64_t size,
+                     Kitsunemimi::ErrorContainer &error)
+{
+    unsigned int hashSize = 0;
+    if(EVP_Digest(data, size, entry.hash, &hashSize, EVP_sha256(), nullptr) != 1)
+    {
+        error.addMeesage("Failed to create hash of block");
+        return false;
+    }
+    entry.size = size;
+
+    const std::string blockPath = getBlockPath(directory, entry.hash);
+    std::map<std::string, IndexEntry>::iterator it = m_index->entries.find(blockPath);
+    if(it != m_index->entries.end())
+    {
+        it->second.refCount++;
+        return true;
+    }
+
+    // write new block. A pinned block, whose last reference was released before, is referenced
+    // again and must not be deleted anymore, when it is unpinned.
+    {
+        std::lock_guard<std::mutex> guard(pinLock);
+        unreferencedBlocks.erase(blockPath);
+    }
+    std::error_code errorCode;
+    std::filesystem::create_directories(std::filesystem::path(blockPath).parent_path(), errorCode);
+    std::vector<std::pair<const void*, uint64_t>> parts;
+    parts.emplace_back(data, size);
+    if(errorCode
+            || writeFile(blockPath, parts, error) == false)
+    {
+        error.addMeesage("Failed to write block '" + blockPath + "'");
+        return false;
+    }
+
+    IndexEntry indexEntry;
+    memcpy(indexEntry.hash, entry.hash, 32);
+    indexEntry.refCount = 1;
+    indexEntry.size = size;
+    m_index->entries.emplace(blockPath, indexEntry);
+
+    return true;
+}
+
+/**
+ * @brief remove references to blocks and delete blocks without any remaining reference. The
+ *        lock must already be held by the caller.
+ *
+ * @param blocks blocks to release
+ * @param directory directory of the blocks
+ */
+void
+BlockStore::releaseBlocks(const std::vector<BlockEntry> &blocks,
+                          const std::string &directory)
+{
+    for(const BlockEntry &block : blocks)
+    {
+        const std::string blockPath = getBlockPath(directory, block.hash);
+        std::map<std::string, IndexEntry>::iterator it = m_index->entries.find(blockPath);
+        if(it == m_index->entries.end()) {
+            continue;
+        }
+
+        it->second.refCount--;
+        if(it->second.refCount == 0)
+        {
+            removeBlockFile(blockPath);
+            m_index->entries.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief write a file at first to a temporary file and move it to its final location afterwards,
+ *        so the file is never visible in an incomplete state
+ *
+ * @param filePath path of the file
+ * @param parts parts of the content of the file, which are written one after another
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BlockStore::writeFile(const std::string &filePath,
+                      const std::vector<std::pair<const void*, uint64_t>> &parts,
+                      Kitsunemimi::ErrorContainer &error)
+{
+    uint64_t totalSize = 0;
+    for(const auto &[data, size] : parts) {
+        totalSize += size;
+    }
+
+    const std::string tempPath = filePath + ".tmp";
+    Kitsunemimi::BinaryFile file(tempPath);
+    if(file.allocateStorage(totalSize, error) == false)
+    {
+        error.addMeesage("Failed to allocate storage for file '" + filePath + "'");
+        return false;
+    }
+
+    uint64_t offset = 0;
+    for(const auto &[data, size] : parts)
+    {
+        if(size > 0
+                && file.writeDataIntoFile(data, offset, size, error) == false)
+        {
+            error.addMeesage("Failed to write file '" + filePath + "'");
+            file.closeFile(error);
+            Kitsunemimi::deleteFileOrDir(tempPath, error);
+            return false;
+        }
+        offset += size;
+    }
+
+    if(file.closeFile(error) == false
+            || Kitsunemimi::renameFileOrDir(tempPath, filePath, error) == false)
+    {
+        error.addMeesage("Failed to move file '" + tempPath + "' to '" + filePath + "'");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief count the references to the stored blocks by reading all block-maps of the location
+ *        and delete blocks, which are not referenced by any block-map, because the process
+ *        stopped after the blocks were written, but before the block-map was, or after a
+ *        block-map was deleted, but before its blocks were. The block-maps are the only source
+ *        of the reference-counts, so the counts can not become inconsistent with the files.
+ *        The lock must already be held by the caller.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+BlockStore::loadIndex(Kitsunemimi::ErrorContainer &error)
+{
+    m_index->entries.clear();
+
+    // count references of all block-maps
+    const std::string location = std::filesystem::path(m_directory).parent_path().string();
+    std::set<std::string> referencedNames;
+    std::error_code errorCode;
+    for(const std::filesystem::directory_entry &file
+        : std::filesystem::directory_iterator(location, errorCode))
+    {
+        if(file.is_regular_file() == false
+                || isBlockMap(file.path().string()) == false)
+        {
+            continue;
+        }
+
+        std::vector<BlockEntry> blocks;
+        uint64_t totalSize = 0;
+        if(readBlockMap(blocks, totalSize, file.path().string(), error) == false) {
+            return false;
+        }
+
+        const std::string directory = getBlockDirectory(file.path().string());
+        for(const BlockEntry &block : blocks)
+        {
+            const std::string blockPath = getBlockPath(directory, block.hash);
+            std::map<std::string, IndexEntry>::iterator it = m_index->entries.find(blockPath);
+            if(it == m_index->entries.end())
+            {
+                IndexEntry indexEntry;
+                memcpy(indexEntry.hash, block.hash, 32);
+                indexEntry.size = block.size;
+                it = m_index->entries.emplace(blockPath, indexEntry).first;
+                referencedNames.insert(std::filesystem::path(blockPath).filename().string());
+            }
+            it->second.refCount++;
+        }
+    }
+    if(errorCode)
+    {
+        error.addMeesage("Failed to read directory '" + location + "': " + errorCode.message());
+        return false;
+    }
+
+    // delete unreferenced blocks and incomplete files
+    std::vector<std::string> unreferencedFiles;
+    for(const std::filesystem::directory_entry &file
+        : std::filesystem::recursive_directory_iterator(m_directory, errorCode))
+    {
+        if(file.is_regular_file()
+                && referencedNames.count(file.path().filename().string()) == 0)
+        {
+            unreferencedFiles.push_back(file.path().string());
+        }
+    }
+    for(const std::string &filePath : unreferencedFiles)
+    {
+        if(Kitsunemimi::deleteFileOrDir(filePath, error) == false) {
+            LOG_ERROR(error);
+        }
+    }
+
+    return true;
+}
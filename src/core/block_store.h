@@ -0,0 +1,149 @@
+/**
+ * @file        block_store.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_BLOCKSTORE_H
+#define SHIORIARCHIVE_BLOCKSTORE_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+class BlockStore
+{
+public:
+    // header of a block-map, which replaces a file, after it was split into blocks
+    struct BlockMapHeader
+    {
+        char magic[8] = {'S', 'H', 'I', 'O', 'R', 'I', 'B', 'M'};
+        uint32_t version = 1;
+        uint32_t padding = 0;
+        uint64_t numberOfBlocks = 0;
+        uint64_t totalSize = 0;
+    };
+    static_assert(sizeof(BlockMapHeader) == 32);
+
+    struct BlockEntry
+    {
+        uint8_t hash[32];
+        uint64_t size = 0;
+    };
+    static_assert(sizeof(BlockEntry) == 40);
+
+    // limits of the content-defined blocks
+    static constexpr uint64_t MIN_BLOCK_SIZE = 16 * 1024;
+    static constexpr uint64_t AVG_BLOCK_SIZE = 64 * 1024;
+    static constexpr uint64_t MAX_BLOCK_SIZE = 256 * 1024;
+
+    BlockStore(const std::string &location,
+               const bool enabled,
+               const uint64_t fixedBlockSize);
+    ~BlockStore();
+
+    bool initStore(Kitsunemimi::ErrorContainer &error);
+    bool storeFile(const std::string &filePath,
+                   Kitsunemimi::ErrorContainer &error);
+    bool restoreFile(const std::string &filePath,
+                     Kitsunemimi::ErrorContainer &error);
+    bool deleteFile(const std::string &filePath,
+                    Kitsunemimi::ErrorContainer &error);
+    void getStoreSize(uint64_t &storedSize,
+                      uint64_t &referencedSize);
+
+    static bool isBlockMap(const std::string &filePath);
+    static bool readBlockMap(std::vector<BlockEntry> &blocks,
+                             uint64_t &totalSize,
+                             const std::string &filePath,
+                             Kitsunemimi::ErrorContainer &error);
+    static bool readFileData(const std::string &filePath,
+                             void* target,
+                             const uint64_t offset,
+                             const uint64_t size,
+                             Kitsunemimi::ErrorContainer &error);
+    static void getBlockOffsets(std::vector<uint64_t> &blockOffsets,
+                                const std::vector<BlockEntry> &blocks);
+    static bool readBlocksData(const std::vector<BlockEntry> &blocks,
+                               const std::vector<uint64_t> &blockOffsets,
+                               const uint64_t totalSize,
+                               const std::string &filePath,
+                               void* target,
+                               const uint64_t offset,
+                               const uint64_t size,
+                               Kitsunemimi::ErrorContainer &error);
+    static void splitIntoBlocks(std::vector<uint64_t> &blockEnds,
+                                const uint8_t* data,
+                                const uint64_t size);
+    static void splitIntoFixedBlocks(std::vector<uint64_t> &blockEnds,
+                                     const uint64_t size,
+                                     const uint64_t blockSize);
+    static const std::string getBlockDirectory(const std::string &filePath);
+    static const std::string getBlockPath(const std::string &directory,
+                                          const uint8_t* hash);
+    static void pinBlocks(const std::vector<BlockEntry> &blocks,
+                          const std::string &directory);
+    static void unpinBlocks(const std::vector<BlockEntry> &blocks,
+                            const std::string &directory);
+
+private:
+    struct IndexEntry
+    {
+        uint8_t hash[32];
+        uint64_t refCount = 0;
+        uint64_t size = 0;
+    };
+    static_assert(sizeof(IndexEntry) == 48);
+
+    // reference-counts of the blocks of a block-directory, which are shared by all stores of the
+    // same location, so a store never deletes blocks, which are still used by another one
+    struct BlockIndex
+    {
+        std::mutex lock;
+        std::map<std::string, IndexEntry> entries;
+        bool loaded = false;
+    };
+
+    bool addBlock(BlockEntry &entry,
+                  const std::string &directory,
+                  const uint8_t* data,
+                  const uint64_t size,
+                  Kitsunemimi::ErrorContainer &error);
+    void releaseBlocks(const std::vector<BlockEntry> &blocks,
+                       const std::string &directory);
+    bool writeFile(const std::string &filePath,
+                   const std::vector<std::pair<const void*, uint64_t>> &parts,
+                   Kitsunemimi::ErrorContainer &error);
+    bool loadIndex(Kitsunemimi::ErrorContainer &error);
+
+    static void removeBlockFile(const std::string &blockPath);
+    static std::shared_ptr<BlockIndex> getBlockIndex(const std::string &directory);
+
+    std::string m_directory = "";
+    bool m_enabled = false;
+    uint64_t m_fixedBlockSize = 0;
+    std::shared_ptr<BlockIndex> m_index;
+};
+
+#endif // SHIORIARCHIVE_BLOCKSTORE_H
@@ -0,0 +1,267 @@
+/**
+ * @file        data_set_batcher.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "data_set_batcher.h"
+
+#include <core/data_set_files/data_set_file.h>
+
+/**
+ * @brief constructor, which creates the permutation of the rows and starts the prefetching of
+ *        the first batches
+ *
+ * @param file data-set-file to serve
+ * @param columnName name of the column for table-data-sets
+ * @param seed seed for the random permutation of the rows
+ * @param batchSize number of rows of each batch
+ * @param compact true to serve the values in the data-type, in which they are stored, instead of
+ *                floats
+ * @param prefetchDepth number of batches, which are gathered in the background ahead of the
+ *                      next expected batch
+ */
+DataSetBatcher::DataSetBatcher(std::shared_ptr<DataSetFile> file,
+                               const std::string &columnName,
+                               const uint64_t seed,
+                               const uint64_t batchSize,
+                               const bool compact,
+                               const uint64_t prefetchDepth)
+{
+    m_file = file;
+    m_columnName = columnName;
+    m_batchSize = batchSize;
+    m_compact = compact;
+    m_prefetchDepth = prefetchDepth;
+
+    createPermutation(m_permutation, m_file->getNumberOfRows(), seed);
+
+    m_prefetchThread = std::thread(&DataSetBatcher::prefetchLoop, this);
+}
+
+/**
+ * @brief destructor, which stops the prefetch-thread
+ */
+DataSetBatcher::~DataSetBatcher()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_abort = true;
+    }
+    m_cond.notify_all();
+
+    if(m_prefetchThread.joinable()) {
+        m_prefetchThread.join();
+    }
+}
+
+/**
+ * @brief get a batch of the permutation. If the batch was already prefetched, it is returned
+ *        without accessing the file, else it is gathered synchronously. The following batches
+ *        are prefetched in the background.
+ *
+ * @param batch reference for the gathered rows of the batch
+ * @param batchIndex number of the batch within the permutation
+ * @param error reference for error-output
+ *
+ * @return false, if the batch is out of range or gathering failed, else true
+ */
+bool
+DataSetBatcher::getBatch(std::vector<uint8_t> &batch,
+                         const uint64_t batchIndex,
+                         Kitsunemimi::ErrorContainer &error)
+{
+    if(batchIndex >= getNumberOfBatches())
+    {
+        error.addMeesage("Requested batch " + std::to_string(batchIndex) + " is out of range");
+        return false;
+    }
+
+    bool found = false;
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+
+        // wait, if the batch is gathered by the prefetch-thread at the moment
+        m_cond.wait(lock, [this, batchIndex] { return m_gatheredBatch != batchIndex; });
+
+        std::map<uint64_t, std::vector<uint8_t>>::iterator it;
+        it = m_prefetchedBatches.find(batchIndex);
+        if(it != m_prefetchedBatches.end())
+        {
+            batch.swap(it->second);
+            found = true;
+        }
+
+        // move prefetch-window behind the requested batch and drop batches outside of the window
+        m_nextBatch = batchIndex + 1;
+        m_prefetchFailed = false;
+        it = m_prefetchedBatches.begin();
+        while(it != m_prefetchedBatches.end())
+        {
+            if(it->first < m_nextBatch
+                    || it->first >= m_nextBatch + m_prefetchDepth)
+            {
+                it = m_prefetchedBatches.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+    m_cond.notify_all();
+
+    if(found) {
+        return true;
+    }
+
+    if(gatherBatch(batch, batchIndex) == false)
+    {
+        error.addMeesage("Failed to gather batch " + std::to_string(batchIndex));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get number of batches of the permutation. The last batch can be smaller than the others.
+ *
+ * @return number of batches
+ */
+uint64_t
+DataSetBatcher::getNumberOfBatches() const
+{
+    return (m_permutation.size() + m_batchSize - 1) / m_batchSize;
+}
+
+/**
+ * @brief get the file, which is served by the batcher
+ *
+ * @return pointer to the file
+ */
+std::shared_ptr<DataSetFile>
+DataSetBatcher::getFile() const
+{
+    return m_file;
+}
+
+/**
+ * @brief gather the rows of a batch from the file into one contiguous buffer
+ *
+ * @param batch reference for the gathered rows
+ * @param batchIndex number of the batch within the permutation
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetBatcher::gatherBatch(std::vector<uint8_t> &batch,
+                            const uint64_t batchIndex)
+{
+    const uint64_t start = batchIndex * m_batchSize;
+    const uint64_t end = std::min(start + m_batchSize, static_cast<uint64_t>(m_permutation.size()));
+    const std::vector<uint64_t> rows(m_permutation.begin() + start, m_permutation.begin() + end);
+
+    uint64_t payloadSize = 0;
+    uint8_t* payload = nullptr;
+    if(m_compact)
+    {
+        payload = m_file->gatherCompactPayload(payloadSize, rows, m_columnName);
+    }
+    else
+    {
+        float* floatPayload = m_file->gatherPayload(payloadSize, rows, m_columnName);
+        payload = reinterpret_cast<uint8_t*>(floatPayload);
+    }
+    if(payload == nullptr) {
+        return false;
+    }
+
+    batch.assign(payload, payload + payloadSize);
+    delete[] payload;
+
+    return true;
+}
+
+/**
+ * @brief search the next batch within the prefetch-window, which is not prefetched yet. The lock
+ *        must already be held by the caller.
+ *
+ * @param batchIndex reference for the number of the found batch
+ *
+ * @return true, if a batch was found, else false
+ */
+bool
+DataSetBatcher::getNextPrefetchBatch(uint64_t &batchIndex) const
+{
+    if(m_prefetchFailed) {
+        return false;
+    }
+
+    const uint64_t end = std::min(m_nextBatch + m_prefetchDepth, getNumberOfBatches());
+    for(uint64_t i = m_nextBatch; i < end; i++)
+    {
+        if(m_prefetchedBatches.find(i) == m_prefetchedBatches.end())
+        {
+            batchIndex = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief loop of the prefetch-thread, which gathers the batches within the prefetch-window
+ */
+void
+DataSetBatcher::prefetchLoop()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while(true)
+    {
+        uint64_t batchIndex = 0;
+        m_cond.wait(lock, [this, &batchIndex] {
+            return m_abort || getNextPrefetchBatch(batchIndex);
+        });
+        if(m_abort) {
+            return;
+        }
+
+        // gather outside of the lock to not block requests of already prefetched batches
+        m_gatheredBatch = batchIndex;
+        lock.unlock();
+        std::vector<uint8_t> batch;
+        const bool success = gatherBatch(batch, batchIndex);
+        lock.lock();
+        m_gatheredBatch = UINT64_MAX;
+
+        if(success == false)
+        {
+            // stop prefetching until the next request, to not retry a broken file in a loop
+            m_prefetchFailed = true;
+        }
+        else if(batchIndex >= m_nextBatch)
+        {
+            m_prefetchedBatches[batchIndex].swap(batch);
+        }
+
+        m_cond.notify_all();
+    }
+}
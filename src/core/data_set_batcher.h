@@ -0,0 +1,78 @@
+/**
+ * @file        data_set_batcher.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_DATASETBATCHER_H
+#define SHIORIARCHIVE_DATASETBATCHER_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <condition_variable>
+
+class DataSetFile;
+
+class DataSetBatcher
+{
+public:
+    DataSetBatcher(std::shared_ptr<DataSetFile> file,
+                   const std::string &columnName,
+                   const uint64_t seed,
+                   const uint64_t batchSize,
+                   const bool compact,
+                   const uint64_t prefetchDepth);
+    ~DataSetBatcher();
+
+    bool getBatch(std::vector<uint8_t> &batch,
+                  const uint64_t batchIndex,
+                  Kitsunemimi::ErrorContainer &error);
+    uint64_t getNumberOfBatches() const;
+    std::shared_ptr<DataSetFile> getFile() const;
+
+private:
+    bool gatherBatch(std::vector<uint8_t> &batch,
+                     const uint64_t batchIndex);
+    bool getNextPrefetchBatch(uint64_t &batchIndex) const;
+    void prefetchLoop();
+
+    std::shared_ptr<DataSetFile> m_file;
+    std::string m_columnName = "";
+    uint64_t m_batchSize = 0;
+    bool m_compact = false;
+    uint64_t m_prefetchDepth = 0;
+    std::vector<uint64_t> m_permutation;
+
+    std::mutex m_lock;
+    std::condition_variable m_cond;
+    std::map<uint64_t, std::vector<uint8_t>> m_prefetchedBatches;
+    uint64_t m_nextBatch = 0;
+    uint64_t m_gatheredBatch = UINT64_MAX;
+    bool m_prefetchFailed = false;
+    bool m_abort = false;
+    std::thread m_prefetchThread;
+};
+
+#endif // SHIORIARCHIVE_DATASETBATCHER_H
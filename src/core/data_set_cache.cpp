@@ -0,0 +1,188 @@
+/**
+ * @file        data_set_cache.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "data_set_cache.h"
+
+#include <core/data_set_files/data_set_file.h>
+
+#include <sys/stat.h>
+
+/**
+ * @brief constructor
+ *
+ * @param maxNumberOfFiles maximum number of opened files within the cache
+ * @param maxMappedBytes maximum number of mapped bytes of all files within the cache
+ */
+DataSetCache::DataSetCache(const uint64_t maxNumberOfFiles,
+                           const uint64_t maxMappedBytes)
+{
+    m_maxNumberOfFiles = maxNumberOfFiles;
+    m_maxMappedBytes = maxMappedBytes;
+}
+
+/**
+ * @brief destructor
+ */
+DataSetCache::~DataSetCache() {}
+
+/**
+ * @brief get opened data-set-file from the cache or open the file, if not cached yet. A cached
+ *        file is only used, as long as the file on the disc was not replaced or modified since
+ *        it was opened.
+ *
+ * @param location path to the data-set-file
+ * @param error reference for error-output
+ *
+ * @return pointer to the opened file, if successful, else nullptr. The file stays valid, as long
+ *         as the pointer is held, even if it is evicted from the cache in the meantime.
+ */
+std::shared_ptr<DataSetFile>
+DataSetCache::getDataSetFile(const std::string &location,
+                             Kitsunemimi::ErrorContainer &error)
+{
+    ino_t inode = 0;
+    int64_t modifyTime = 0;
+    if(getFileState(location, inode, modifyTime) == false)
+    {
+        error.addMeesage("Data-set-file '" + location + "' doesn't exist");
+        removeDataSetFile(location);
+        return nullptr;
+    }
+
+    // check cache. If the file is opened by another request at the moment, wait for it instead
+    // of opening it again.
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_fileOpened.wait(lock, [&] { return m_opening.count(location) == 0; });
+
+    std::map<std::string, CacheEntry>::iterator it = m_entries.find(location);
+    if(it != m_entries.end())
+    {
+        if(it->second.inode == inode
+                && it->second.modifyTime == modifyTime)
+        {
+            // move to the front of the lru-list
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+            return it->second.file;
+        }
+
+        // file was changed since it was cached
+        removeEntry(it);
+    }
+    m_opening.insert(location);
+    lock.unlock();
+
+    // open file outside of the lock to not block requests of other files
+    DataSetFile* file = readDataSetFile(location, error);
+
+    lock.lock();
+    m_opening.erase(location);
+    m_fileOpened.notify_all();
+    if(file == nullptr) {
+        return nullptr;
+    }
+
+    // add new entry
+    CacheEntry entry;
+    entry.file = std::shared_ptr<DataSetFile>(file);
+    entry.inode = inode;
+    entry.modifyTime = modifyTime;
+    entry.mappedBytes = file->getMappedSize();
+    m_lru.push_front(location);
+    entry.lruPos = m_lru.begin();
+    m_mappedBytes += entry.mappedBytes;
+    m_entries.insert(std::make_pair(location, entry));
+
+    evictEntries();
+
+    return entry.file;
+}
+
+/**
+ * @brief remove a file from the cache, for example because it was deleted. Requests, which
+ *        still use the file, can finish with their pointer.
+ *
+ * @param location path to the data-set-file
+ */
+void
+DataSetCache::removeDataSetFile(const std::string &location)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::map<std::string, CacheEntry>::iterator it = m_entries.find(location);
+    if(it != m_entries.end()) {
+        removeEntry(it);
+    }
+}
+
+/**
+ * @brief get inode and last modification-time of a file
+ *
+ * @param location path to the file
+ * @param inode reference for the resulting inode
+ * @param modifyTime reference for the resulting modification-time in nanoseconds
+ *
+ * @return false, if file doesn't exist, else true
+ */
+bool
+DataSetCache::getFileState(const std::string &location,
+                           ino_t &inode,
+                           int64_t &modifyTime)
+{
+    struct stat fileStat;
+    if(stat(location.c_str(), &fileStat) != 0) {
+        return false;
+    }
+
+    inode = fileStat.st_ino;
+    modifyTime = (static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000)
+                 + fileStat.st_mtim.tv_nsec;
+
+    return true;
+}
+
+/**
+ * @brief remove entry from the cache. The lock must already be held by the caller.
+ *
+ * @param it iterator to the entry
+ */
+void
+DataSetCache::removeEntry(const std::map<std::string, CacheEntry>::iterator &it)
+{
+    m_mappedBytes -= it->second.mappedBytes;
+    m_lru.erase(it->second.lruPos);
+    m_entries.erase(it);
+}
+
+/**
+ * @brief remove least recently used entries, until the limits of the cache are fulfilled. The
+ *        most recently used entry is never removed. The lock must already be held by the caller.
+ */
+void
+DataSetCache::evictEntries()
+{
+    while(m_entries.size() > 1
+          && (m_entries.size() > m_maxNumberOfFiles
+              || m_mappedBytes > m_maxMappedBytes))
+    {
+        removeEntry(m_entries.find(m_lru.back()));
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * @file        data_set_cache.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_DATASETCACHE_H
+#define SHIORIARCHIVE_DATASETCACHE_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <string>
+#include <map>
+#include <set>
+#include <list>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <sys/types.h>
+
+class DataSetFile;
+
+class DataSetCache
+{
+public:
+    DataSetCache(const uint64_t maxNumberOfFiles,
+                 const uint64_t maxMappedBytes);
+    ~DataSetCache();
+
+    std::shared_ptr<DataSetFile> getDataSetFile(const std::string &location,
+                                                Kitsunemimi::ErrorContainer &error);
+    void removeDataSetFile(const std::string &location);
+
+    static bool getFileState(const std::string &location,
+                             ino_t &inode,
+                             int64_t &modifyTime);
+
+private:
+    struct CacheEntry
+    {
+        std::shared_ptr<DataSetFile> file;
+        ino_t inode = 0;
+        int64_t modifyTime = 0;
+        uint64_t mappedBytes = 0;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    void removeEntry(const std::map<std::string, CacheEntry>::iterator &it);
+    void evictEntries();
+
+    std::mutex m_lock;
+    std::condition_variable m_fileOpened;
+    std::set<std::string> m_opening;
+    std::map<std::string, CacheEntry> m_entries;
+    std::list<std::string> m_lru;
+    uint64_t m_mappedBytes = 0;
+    uint64_t m_maxNumberOfFiles = 0;
+    uint64_t m_maxMappedBytes = 0;
+};
+
+#endif // SHIORIARCHIVE_DATASETCACHE_H
@@ -24,8 +24,21 @@
 
 #include <libKitsunemimiCommon/files/binary_file.h>
 
+#include <lz4.h>
+#include <zstd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <numeric>
+#include <random>
+
+#include <core/block_store.h>
 #include <core/data_set_files/image_data_set_file.h>
 #include <core/data_set_files/table_data_set_file.h>
+#include <core/data_set_files/view_data_set_file.h>
+#include <core/data_set_files/value_conversion.h>
 
 /**
  * @brief constructor
@@ -33,18 +46,10 @@
  * @param filePath path to file
  */
 DataSetFile::DataSetFile(const std::string &filePath)
+    : m_mappedFile(filePath)
 {
     m_targetFile = new Kitsunemimi::BinaryFile(filePath);
-}
-
-/**
- * @brief constructor
- *
- * @param file pointer to binary-file object
- */
-DataSetFile::DataSetFile(Kitsunemimi::BinaryFile* file)
-{
-    m_targetFile = file;
+    m_filePath = filePath;
 }
 
 /**
@@ -64,10 +69,34 @@ DataSetFile::initNewFile()
     // TODO: check if header are set
     Kitsunemimi::ErrorContainer error;
 
+    // the column-blocks of the columnar layout are written independently from each other, so they
+    // can not be split into compressed blocks
+    if(encoding != RAW_ENCODING
+            && layout == COLUMN_MAJOR_LAYOUT)
+    {
+        error.addMeesage("Compression is not supported for data-sets in column-major layout");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // new files are always written in the current version
+    m_fileVersion = 2;
+    m_sections.clear();
+    m_blockIndex.clear();
+    m_writeBuffer.clear();
+    m_writtenBytes = 0;
     initHeader();
 
+    // compressed payloads are appended block by block, so only the headers are allocated here
+    uint64_t fileSize = m_totalFileSize;
+    if(encoding != RAW_ENCODING) {
+        fileSize = m_headerSize;
+    }
+    m_compressedEnd = m_headerSize;
+
     // allocate storage
-    if(m_targetFile->allocateStorage(m_totalFileSize, error) == false)
+    m_allocatedSize = 0;
+    if(resizeFile(fileSize, error) == false)
     {
         LOG_ERROR(error);
         // TODO: error-message
@@ -77,6 +106,10 @@ DataSetFile::initNewFile()
     // prepare dataset-header
     DataSetHeader dataSetHeader;
     dataSetHeader.type = type;
+    dataSetHeader.dataType = dataType;
+    dataSetHeader.encoding = encoding;
+    dataSetHeader.layout = layout;
+    dataSetHeader.numberOfSections = m_sections.size();
     uint32_t nameSize = name.size();
     if(nameSize > 255) {
         nameSize = 255;
@@ -92,74 +125,244 @@ DataSetFile::initNewFile()
         return false;
     }
 
+    // write section-table to file
+    if(writeSectionTable(error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
     // write data to file
     return updateHeader();
 }
 
 /**
- * @brief read complete file into memory
+ * @brief read the headers of the file. The payload is not read and will only be read on demand.
+ *
+ * @param error reference for error-output
  *
  * @return true, if successful, else false
  */
 bool
-DataSetFile::readFromFile()
+DataSetFile::readFromFile(Kitsunemimi::ErrorContainer &error)
 {
-    Kitsunemimi::ErrorContainer error;
+    // map file for reading, so the payload can be accessed without copying it into the heap
+    if(m_mappedFile.mapFile(error) == false)
+    {
+        error.addMeesage("Failed to map data-set-file");
+        return false;
+    }
 
-    // create complete file
-    Kitsunemimi::DataBuffer buffer;
-    if(m_targetFile->readCompleteFile(buffer, error) == false)
+    // files of version 1 have no magic-number at the beginning
+    char magic[8];
+    const DataSetHeader defaultHeader;
+    bool isV2 = readFileData(magic, 0, 8, error)
+                && memcmp(magic, defaultHeader.magic, 8) == 0;
+    if(isV2 == false)
     {
-        LOG_ERROR(error);
-        // TODO: error-message
+        if(readHeaderV1(error) == false) {
+            return false;
+        }
+    }
+    else
+    {
+        if(readHeaderV2(error) == false) {
+            return false;
+        }
+    }
+
+    // read type-specific header
+    if(readHeader(error) == false)
+    {
+        error.addMeesage("Failed to read header of data-set '" + name + "'");
         return false;
     }
 
-    // prepare
-    const uint8_t* u8buffer = static_cast<const uint8_t*>(buffer.data);
+    return true;
+}
 
-    // read data-set-header
-    DataSetHeader dataSetHeader;
-    memcpy(&dataSetHeader, u8buffer, sizeof(DataSetHeader));
-    type = static_cast<DataSetType>(dataSetHeader.type);
+/**
+ * @brief read header of a file of version 1 and create the sections, which are implicitly given
+ *        by the fixed layout of these files
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::readHeaderV1(Kitsunemimi::ErrorContainer &error)
+{
+    DataSetHeaderV1 dataSetHeader;
+    if(readFileData(&dataSetHeader, 0, sizeof(DataSetHeaderV1), error) == false)
+    {
+        error.addMeesage("Failed to read data-set-header");
+        return false;
+    }
+    dataSetHeader.name[255] = '\0';
+
+    m_fileVersion = 1;
+    m_sections.clear();
     name = dataSetHeader.name;
+    dataType = FLOAT32_DTYPE;
+    encoding = RAW_ENCODING;
+    layout = ROW_MAJOR_LAYOUT;
+    type = static_cast<DataSetType>(dataSetHeader.type);
 
-    readHeader(u8buffer);
+    // in version 1 the layout was part of the type
+    if(type == TABLE_COLUMNAR_TYPE)
+    {
+        type = TABLE_TYPE;
+        layout = COLUMN_MAJOR_LAYOUT;
+    }
+
+    // the type-specific header directly follows the data-set-header
+    if(type == IMAGE_TYPE) {
+        addSection(TYPE_HEADER_SECTION, V1_IMAGE_HEADER_SIZE, 1, sizeof(DataSetHeaderV1));
+    }
+    if(type == TABLE_TYPE) {
+        addSection(TYPE_HEADER_SECTION, V1_TABLE_HEADER_SIZE, 1, sizeof(DataSetHeaderV1));
+    }
 
     return true;
 }
 
 /**
- * @brief add data to the file
+ * @brief read header and section-table of a file of version 2
  *
- * @param pos value-position, where to start to write to file
- * @param data values to write
- * @param numberOfValues number of values to write
+ * @param error reference for error-output
  *
  * @return true, if successful, else false
  */
 bool
-DataSetFile::addBlock(const uint64_t pos,
-                      const float* data,
-                      const u_int64_t numberOfValues)
+DataSetFile::readHeaderV2(Kitsunemimi::ErrorContainer &error)
 {
-    Kitsunemimi::ErrorContainer error;
+    DataSetHeader dataSetHeader;
+    if(readFileData(&dataSetHeader, 0, sizeof(DataSetHeader), error) == false)
+    {
+        error.addMeesage("Failed to read data-set-header");
+        return false;
+    }
+    dataSetHeader.name[255] = '\0';
 
-    // check size to not write over the end of the file
-    if(m_headerSize + ((pos + numberOfValues) * sizeof(float)) > m_totalFileSize)
+    // check header
+    if(dataSetHeader.byteOrderMark != DataSetHeader().byteOrderMark)
     {
-        // TODO: error-message
+        error.addMeesage("Data-set-file was written with a different byte-order");
+        return false;
+    }
+    if(dataSetHeader.version > DataSetHeader().version)
+    {
+        error.addMeesage("Data-set-file has version " + std::to_string(dataSetHeader.version)
+                         + ", which is newer than the supported version");
+        return false;
+    }
+    if(dataSetHeader.dataType > INT8_DTYPE
+            || dataSetHeader.encoding > ZSTD_ENCODING
+            || dataSetHeader.layout > COLUMN_MAJOR_LAYOUT)
+    {
+        error.addMeesage("Data-set-file has unsupported data-type, encoding or layout");
         return false;
     }
 
-    // add add data to file
-    if(m_targetFile->writeDataIntoFile(data,
-                                       m_headerSize + pos * sizeof(float),
-                                       numberOfValues * sizeof(float),
+    m_fileVersion = dataSetHeader.version;
+    name = dataSetHeader.name;
+    type = static_cast<DataSetType>(dataSetHeader.type);
+    dataType = static_cast<DataType>(dataSetHeader.dataType);
+    encoding = static_cast<Encoding>(dataSetHeader.encoding);
+    layout = static_cast<Layout>(dataSetHeader.layout);
+
+    // check size of the section-table, before memory is allocated for it
+    const uint64_t fileSize = m_mappedFile.getFileSize();
+    if(dataSetHeader.numberOfSections == 0
+            || dataSetHeader.numberOfSections > MAX_NUMBER_OF_SECTIONS
+            || sizeof(DataSetHeader) + dataSetHeader.numberOfSections * sizeof(SectionEntry)
+               > fileSize)
+    {
+        error.addMeesage("Data-set-file has an invalid number of sections: "
+                         + std::to_string(dataSetHeader.numberOfSections));
+        return false;
+    }
+
+    // read section-table, which directly follows the header
+    m_sections.resize(dataSetHeader.numberOfSections);
+    if(readFileData(&m_sections[0],
+                    sizeof(DataSetHeader),
+                    dataSetHeader.numberOfSections * sizeof(SectionEntry),
+                    error) == false)
+    {
+        error.addMeesage("Failed to read section-table of data-set-file");
+        return false;
+    }
+
+    // check that all sections are within the file
+    for(const SectionEntry &section : m_sections)
+    {
+        if(section.offset > fileSize
+                || section.size > fileSize - section.offset)
+        {
+            error.addMeesage("Section of data-set-file is outside of the file");
+            return false;
+        }
+    }
+
+    // read block-index of compressed payload
+    m_blockIndex.clear();
+    if(encoding != RAW_ENCODING)
+    {
+        const SectionEntry* indexSection = getSection(BLOCK_INDEX_SECTION);
+        if(indexSection == nullptr
+                || indexSection->entrySize == 0)
+        {
+            error.addMeesage("Compressed data-set-file has no block-index");
+            return false;
+        }
+
+        m_blockIndex.resize(indexSection->size / indexSection->entrySize);
+        if(m_blockIndex.size() > 0
+                && readSection(BLOCK_INDEX_SECTION,
+                               &m_blockIndex[0],
+                               sizeof(CompressedBlock),
+                               m_blockIndex.size(),
+                               error) == false)
+        {
+            error.addMeesage("Failed to read block-index of data-set-file");
+            return false;
+        }
+
+        for(const CompressedBlock &block : m_blockIndex)
+        {
+            if(block.fileOffset > fileSize
+                    || block.compressedSize > fileSize - block.fileOffset)
+            {
+                error.addMeesage("Compressed block of data-set-file is outside of the file");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief write the section-table into the file
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::writeSectionTable(Kitsunemimi::ErrorContainer &error)
+{
+    if(m_sections.size() == 0) {
+        return true;
+    }
+
+    if(m_targetFile->writeDataIntoFile(&m_sections[0],
+                                       sizeof(DataSetHeader),
+                                       m_sections.size() * sizeof(SectionEntry),
                                        error) == false)
     {
-        LOG_ERROR(error);
-        // TODO: error-message
+        error.addMeesage("Failed to write section-table of data-set-file");
         return false;
     }
 
@@ -167,37 +370,1670 @@ DataSetFile::addBlock(const uint64_t pos,
 }
 
 /**
- * @brief read file as data-set
+ * @brief register a new section for the file
  *
- * @param filePath path to file
+ * @param sectionType type of the section
+ * @param entrySize size of a single entry of the section in bytes
+ * @param numberOfEntries number of entries of the section
+ * @param offset byte-offset of the section within the file. Is only used for files of version 1,
+ *               because in newer files the offsets are calculated by finishSections.
+ */
+void
+DataSetFile::addSection(const SectionType sectionType,
+                        const uint32_t entrySize,
+                        const uint64_t numberOfEntries,
+                        const uint64_t offset)
+{
+    SectionEntry section;
+    section.sectionType = sectionType;
+    section.entrySize = entrySize;
+    section.offset = offset;
+    section.size = entrySize * numberOfEntries;
+    m_sections.push_back(section);
+}
+
+/**
+ * @brief calculate the offsets of all registered sections. Sections start 8-byte aligned and the
+ *        payload starts at a page-boundary, so the mapped payload can be used without copy.
+ *        Afterwards the header-size is the offset of the payload and the total file-size is the
+ *        end of the last section.
+ */
+void
+DataSetFile::finishSections()
+{
+    if(encoding != RAW_ENCODING
+            && getSection(BLOCK_INDEX_SECTION) == nullptr)
+    {
+        addSection(BLOCK_INDEX_SECTION, sizeof(CompressedBlock), 0);
+    }
+
+    uint64_t pos = sizeof(DataSetHeader) + m_sections.size() * sizeof(SectionEntry);
+
+    for(SectionEntry &section : m_sections)
+    {
+        // the block-index is placed behind the compressed blocks, when they are written
+        if(section.sectionType == BLOCK_INDEX_SECTION) {
+            continue;
+        }
+
+        if(section.sectionType == PAYLOAD_SECTION)
+        {
+            pos = alignSize(pos, 4096);
+            m_headerSize = pos;
+        }
+        else
+        {
+            pos = alignSize(pos, 8);
+        }
+
+        section.offset = pos;
+        pos += section.size;
+    }
+
+    // the total file-size is the end of the uncompressed payload, so for compressed payloads the
+    // payload-section is empty until the first blocks are written
+    m_totalFileSize = pos;
+    for(SectionEntry &section : m_sections)
+    {
+        if(section.sectionType == PAYLOAD_SECTION
+                && encoding != RAW_ENCODING)
+        {
+            section.size = 0;
+        }
+    }
+}
+
+/**
+ * @brief get a section of the file
  *
- * @return pointer to file-handler, if successful, else nullptr
+ * @param sectionType type of the requested section
+ *
+ * @return pointer to the section, or nullptr if the file has no section of this type
  */
-DataSetFile*
-readDataSetFile(const std::string &filePath)
+const DataSetFile::SectionEntry*
+DataSetFile::getSection(const SectionType sectionType) const
 {
-    Kitsunemimi::ErrorContainer error;
+    for(const SectionEntry &section : m_sections)
+    {
+        if(section.sectionType == sectionType) {
+            return &section;
+        }
+    }
 
-    // read header of file to identify type
-    Kitsunemimi::BinaryFile* targetFile = new Kitsunemimi::BinaryFile(filePath);
-    DataSetFile::DataSetHeader header;
-    if(targetFile->readDataFromFile(&header, 0 , sizeof(DataSetFile::DataSetHeader), error) == false)
+    return nullptr;
+}
+
+/**
+ * @brief read entries of a section. If the entries within the file are smaller than the
+ *        requested entry-size, the remaining bytes of the target keep their default-values and
+ *        if they are bigger, the additional bytes are ignored.
+ *
+ * @param sectionType type of the section to read
+ * @param target pointer to the buffer for the entries
+ * @param entrySize size of a single entry within the target-buffer
+ * @param numberOfEntries number of entries to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::readSection(const SectionType sectionType,
+                         void* target,
+                         const uint64_t entrySize,
+                         const uint64_t numberOfEntries,
+                         Kitsunemimi::ErrorContainer &error)
+{
+    const SectionEntry* section = getSection(sectionType);
+    if(section == nullptr)
     {
-        //TODO: handle error
-        LOG_ERROR(error);
+        error.addMeesage("Data-set-file has no section of type " + std::to_string(sectionType));
+        return false;
     }
 
-    // create file-handling object based on the type from the header
-    DataSetFile* file = nullptr;
-    if(header.type == DataSetFile::IMAGE_TYPE)
+    if(section->entrySize * numberOfEntries > section->size)
+    {
+        error.addMeesage("Section of type " + std::to_string(sectionType)
+                         + " of data-set-file is too small");
+        return false;
+    }
+
+    // read all entries at once, if they have the same size
+    if(section->entrySize == entrySize) {
+        return readFileData(target, section->offset, entrySize * numberOfEntries, error);
+    }
+
+    const uint64_t copySize = std::min(entrySize, static_cast<uint64_t>(section->entrySize));
+    uint8_t* targetBytes = static_cast<uint8_t*>(target);
+    for(uint64_t i = 0; i < numberOfEntries; i++)
+    {
+        if(readFileData(&targetBytes[i * entrySize],
+                        section->offset + i * section->entrySize,
+                        copySize,
+                        error) == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief write entries of a section. If the entries within the file are smaller than the
+ *        given entry-size, only the part, which fits into the file, is written.
+ *
+ * @param sectionType type of the section to write
+ * @param data pointer to the entries to write
+ * @param entrySize size of a single entry within the data-buffer
+ * @param numberOfEntries number of entries to write
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::writeSection(const SectionType sectionType,
+                          const void* data,
+                          const uint64_t entrySize,
+                          const uint64_t numberOfEntries,
+                          Kitsunemimi::ErrorContainer &error)
+{
+    const SectionEntry* section = getSection(sectionType);
+    if(section == nullptr)
+    {
+        error.addMeesage("Data-set-file has no section of type " + std::to_string(sectionType));
+        return false;
+    }
+
+    if(section->entrySize * numberOfEntries > section->size)
+    {
+        error.addMeesage("Section of type " + std::to_string(sectionType)
+                         + " of data-set-file is too small");
+        return false;
+    }
+
+    // write all entries at once, if they have the same size
+    if(section->entrySize == entrySize)
+    {
+        return m_targetFile->writeDataIntoFile(data,
+                                               section->offset,
+                                               entrySize * numberOfEntries,
+                                               error);
+    }
+
+    const uint64_t copySize = std::min(entrySize, static_cast<uint64_t>(section->entrySize));
+    const uint8_t* dataBytes = static_cast<const uint8_t*>(data);
+    for(uint64_t i = 0; i < numberOfEntries; i++)
+    {
+        if(m_targetFile->writeDataIntoFile(&dataBytes[i * entrySize],
+                                           section->offset + i * section->entrySize,
+                                           copySize,
+                                           error) == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief read a block of data from the file
+ *
+ * @param target pointer to the buffer for the read data
+ * @param offset byte-offset within the file where to start to read
+ * @param size number of bytes to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::readFileData(void* target,
+                          const uint64_t offset,
+                          const uint64_t size,
+                          Kitsunemimi::ErrorContainer &error)
+{
+    // empty ranges are valid and don't need any access to the file
+    if(size == 0) {
+        return true;
+    }
+
+    // files, which are stored as block-map, are read from the blocks, which overlap with the
+    // requested range
+    if(m_mappedFile.isMapped()
+            || m_mappedFile.isBlockMap())
+    {
+        if(offset + size > m_mappedFile.getFileSize())
+        {
+            error.addMeesage("Failed to read data from data-set-file, because the requested "
+                             "block is outside of the file");
+            return false;
+        }
+
+        return m_mappedFile.readData(target, offset, size, error);
+    }
+
+    return m_targetFile->readDataFromFile(target, offset, size, error);
+}
+
+/**
+ * @brief get pointer to stored values within the mapped file
+ *
+ * @param offset byte-offset within the file of the first value
+ * @param size number of bytes, which have to be accessible behind the pointer
+ *
+ * @return pointer to the values, or nullptr if file is not mapped, too small, compressed or the
+ *         values are not aligned, which is the case for files of version 1
+ */
+const uint8_t*
+DataSetFile::getMappedData(const uint64_t offset,
+                           const uint64_t size) const
+{
+    if(m_mappedFile.isMapped() == false
+            || encoding != RAW_ENCODING
+            || offset + size > m_mappedFile.size
+            || offset % getValueSize() != 0)
+    {
+        return nullptr;
+    }
+
+    return &m_mappedFile.data[offset];
+}
+
+/**
+ * @brief limit a range of rows to the rows, which exist within the file
+ *
+ * @param startRow number of the first row of the range
+ * @param numberOfRows number of rows of the range
+ *
+ * @return number of rows of the range, which exist within the file
+ */
+uint64_t
+DataSetFile::getRowsInRange(const uint64_t startRow,
+                            const uint64_t numberOfRows) const
+{
+    const uint64_t totalRows = getNumberOfRows();
+    if(startRow >= totalRows) {
+        return 0;
+    }
+
+    return std::min(numberOfRows, totalRows - startRow);
+}
+
+/**
+ * @brief get views on a range of rows within the mapped file without copying them. The views
+ *        are appended to the given list and together contain the rows in their order. Files,
+ *        which store the rows contiguous, return exactly one view.
+ *
+ * @param views reference for the list, where the views are appended
+ * @param startRow number of the first row
+ * @param numberOfRows number of rows
+ * @param columnName name of the column for table-data-sets
+ *
+ * @return false, if the rows can not be accessed directly, else true
+ */
+bool
+DataSetFile::getPayloadViews(std::vector<PayloadView> &views,
+                             const uint64_t startRow,
+                             const uint64_t numberOfRows,
+                             const std::string &columnName)
+{
+    PayloadView view;
+    if(getPayloadView(view, startRow, numberOfRows, columnName) == false) {
+        return false;
+    }
+
+    views.push_back(view);
+    return true;
+}
+
+/**
+ * @brief get multiple columns of a range of rows in one buffer, converted into floats. This
+ *        default reads each column separately, while files, which can gather all columns in a
+ *        single pass, override it.
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first row
+ * @param numberOfRows number of rows to read
+ * @param columnNames names of the columns to read
+ * @param columnBlocked true to place the values of each column contiguous one after another,
+ *                      false to interleave the columns row by row
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+float*
+DataSetFile::getColumnsPayload(uint64_t &payloadSize,
+                               const uint64_t startRow,
+                               const uint64_t numberOfRows,
+                               const std::vector<std::string> &columnNames,
+                               const bool columnBlocked)
+{
+    const uint64_t numberOfLines = getRowsInRange(startRow, numberOfRows);
+    const uint64_t valueSize = getValuesPerRow() * sizeof(float);
+    payloadSize = numberOfLines * columnNames.size() * valueSize;
+    float* payload = new float[payloadSize / sizeof(float)];
+
+    for(uint64_t i = 0; i < columnNames.size(); i++)
+    {
+        uint64_t columnSize = 0;
+        float* column = getPayload(columnSize, startRow, numberOfRows, columnNames[i]);
+        if(column == nullptr)
+        {
+            delete[] payload;
+            return nullptr;
+        }
+        copyColumn(reinterpret_cast<uint8_t*>(payload),
+                   reinterpret_cast<const uint8_t*>(column),
+                   i,
+                   columnNames.size(),
+                   numberOfLines,
+                   valueSize,
+                   columnBlocked);
+        delete[] column;
+    }
+
+    return payload;
+}
+
+/**
+ * @brief get multiple columns of a range of rows in one buffer in the data-type, in which they
+ *        are stored. This default reads each column separately, while files, which can gather
+ *        all columns in a single pass, override it.
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first row
+ * @param numberOfRows number of rows to read
+ * @param columnNames names of the columns to read
+ * @param columnBlocked true to place the values of each column contiguous one after another,
+ *                      false to interleave the columns row by row
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+DataSetFile::getCompactColumnsPayload(uint64_t &payloadSize,
+                                      const uint64_t startRow,
+                                      const uint64_t numberOfRows,
+                                      const std::vector<std::string> &columnNames,
+                                      const bool columnBlocked)
+{
+    const uint64_t numberOfLines = getRowsInRange(startRow, numberOfRows);
+    const uint64_t valueSize = getValuesPerRow() * getValueSize();
+    payloadSize = numberOfLines * columnNames.size() * valueSize;
+    uint8_t* payload = new uint8_t[payloadSize];
+
+    for(uint64_t i = 0; i < columnNames.size(); i++)
     {
-        file = new ImageDataSetFile(targetFile);
-        file->readFromFile();
+        uint64_t columnSize = 0;
+        uint8_t* column = getCompactPayload(columnSize, startRow, numberOfRows, columnNames[i]);
+        if(column == nullptr)
+        {
+            delete[] payload;
+            return nullptr;
+        }
+        copyColumn(payload,
+                   column,
+                   i,
+                   columnNames.size(),
+                   numberOfLines,
+                   valueSize,
+                   columnBlocked);
+        delete[] column;
     }
-    else if(header.type == DataSetFile::TABLE_TYPE)
+
+    return payload;
+}
+
+/**
+ * @brief get names of the columns of a group. Only tables have named columns, so this default
+ *        adds nothing.
+ *
+ * @param columnNames reference for the list, where the names are appended
+ * @param group group of the columns
+ */
+void
+DataSetFile::getColumnNames(std::vector<std::string> &,
+                            const ColumnGroup) const
+{
+    return;
+}
+
+/**
+ * @brief get the factor of a column, with which its values should be scaled. Only tables have
+ *        named columns, so this default returns the neutral factor.
+ *
+ * @return 1.0
+ */
+float
+DataSetFile::getColumnMultiplicator(const std::string &) const
+{
+    return 1.0f;
+}
+
+/**
+ * @brief get the position of the payload of a view within the file, so it can be mapped by
+ *        other processes on the same host
+ *
+ * @param filePath reference for the path of the file
+ * @param fileOffset reference for the byte-offset of the payload within the file
+ * @param view view on the mapped payload
+ *
+ * @return false, if the view is not within a mapping, which is shared with the file, else true
+ */
+bool
+DataSetFile::getViewFileRange(std::string &filePath,
+                              uint64_t &fileOffset,
+                              const PayloadView &view) const
+{
+    return m_mappedFile.getFileRange(filePath, fileOffset, view.data, view.size);
+}
+
+/**
+ * @brief get number of rows of a storage-block, which can be read contiguously. For compressed
+ *        payloads this is the number of lines of a compressed block, else the smallest number of
+ *        rows, which fill complete pages of the file.
+ *
+ * @return number of rows of a storage-block
+ */
+uint64_t
+DataSetFile::getRowsPerStorageBlock() const
+{
+    const uint64_t lineSize = std::max<uint64_t>(m_lineSize, 1) * getValueSize();
+    if(encoding != RAW_ENCODING) {
+        return std::max<uint64_t>(COMPRESSED_BLOCK_SIZE / lineSize, 1);
+    }
+
+    // in columnar layout a row has only one value within each column-block
+    uint64_t rowSize = lineSize;
+    if(layout == COLUMN_MAJOR_LAYOUT) {
+        rowSize = getValueSize();
+    }
+
+    return 4096 / std::gcd(rowSize, static_cast<uint64_t>(4096));
+}
+
+/**
+ * @brief get the ranges of rows of a shard of the data-set. The rows are split at the borders of
+ *        the storage-blocks, so each range can be read contiguously, and the number of blocks of
+ *        the shards differ at most by one. Without seed each shard is one contiguous range, with
+ *        seed the blocks are randomly distributed over the shards. All shards of the same shard-
+ *        count and seed together contain each row exactly once.
+ *
+ * @param ranges reference for the resulting ranges, sorted by their position
+ * @param shardIndex number of the requested shard
+ * @param shardCount total number of shards
+ * @param seed seed for the distribution of the blocks, or 0 for contiguous shards
+ * @param error reference for error-output
+ *
+ * @return false, if shard-index or -count are invalid, else true
+ */
+bool
+DataSetFile::getShardRanges(std::vector<RowRange> &ranges,
+                            const uint64_t shardIndex,
+                            const uint64_t shardCount,
+                            const uint64_t seed,
+                            Kitsunemimi::ErrorContainer &error) const
+{
+    if(shardCount == 0
+            || shardIndex >= shardCount)
+    {
+        error.addMeesage("Invalid shard " + std::to_string(shardIndex)
+                         + " of " + std::to_string(shardCount) + " shards");
+        return false;
+    }
+
+    const uint64_t numberOfRows = getNumberOfRows();
+    const uint64_t rowsPerBlock = getRowsPerStorageBlock();
+    const uint64_t numberOfBlocks = (numberOfRows + rowsPerBlock - 1) / rowsPerBlock;
+    const uint64_t firstPos = (numberOfBlocks * shardIndex) / shardCount;
+    const uint64_t lastPos = (numberOfBlocks * (shardIndex + 1)) / shardCount;
+
+    // select blocks of the shard
+    std::vector<uint64_t> blocks;
+    if(seed == 0)
+    {
+        for(uint64_t i = firstPos; i < lastPos; i++) {
+            blocks.push_back(i);
+        }
+    }
+    else
+    {
+        std::vector<uint64_t> permutation;
+        createPermutation(permutation, numberOfBlocks, seed);
+        blocks.assign(permutation.begin() + firstPos, permutation.begin() + lastPos);
+        std::sort(blocks.begin(), blocks.end());
+    }
+
+    // merge neighboring blocks into ranges
+    ranges.clear();
+    for(const uint64_t block : blocks)
+    {
+        const uint64_t startRow = block * rowsPerBlock;
+        const uint64_t blockRows = std::min(rowsPerBlock, numberOfRows - startRow);
+        if(ranges.size() > 0
+                && ranges.back().startRow + ranges.back().numberOfRows == startRow)
+        {
+            ranges.back().numberOfRows += blockRows;
+        }
+        else
+        {
+            RowRange range;
+            range.startRow = startRow;
+            range.numberOfRows = blockRows;
+            ranges.push_back(range);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief get size of a single stored value of the payload
+ *
+ * @return number of bytes of a value
+ */
+uint64_t
+DataSetFile::getValueSize() const
+{
+    switch(dataType)
+    {
+        case FLOAT16_DTYPE:
+        case BFLOAT16_DTYPE:
+            return 2;
+        case INT8_DTYPE:
+            return 1;
+        default:
+            return 4;
+    }
+}
+
+/**
+ * @brief convert floats into the data-type of the payload
+ *
+ * @param target buffer for the stored values
+ * @param source values to convert
+ * @param numberOfValues number of values
+ * @param firstValuePos position of the first value within the payload, which is necessary to
+ *                      select the quantization-parameters of the value
+ */
+void
+DataSetFile::encodeValues(uint8_t* target,
+                          const float* source,
+                          const uint64_t numberOfValues,
+                          const uint64_t firstValuePos) const
+{
+    // int8-payloads with different quantization for each position within the lines
+    if(dataType == INT8_DTYPE
+            && m_scales.size() > 1)
+    {
+        int8_t* values = reinterpret_cast<int8_t*>(target);
+        for(uint64_t i = 0; i < numberOfValues; i++)
+        {
+            const uint64_t paramPos = (firstValuePos + i) % m_scales.size();
+            values[i] = quantizeFloatToInt8(source[i], m_scales[paramPos], m_zeroPoints[paramPos]);
+        }
+        return;
+    }
+
+    float scale = 1.0f;
+    float zeroPoint = 0.0f;
+    if(m_scales.size() == 1)
+    {
+        scale = m_scales[0];
+        zeroPoint = m_zeroPoints[0];
+    }
+
+    encodeValues(target, source, numberOfValues, scale, zeroPoint);
+}
+
+/**
+ * @brief convert floats into the data-type of the payload
+ *
+ * @param target buffer for the stored values
+ * @param source values to convert
+ * @param numberOfValues number of values
+ * @param scale scale of the int8-quantization
+ * @param zeroPoint zero-point of the int8-quantization
+ */
+void
+DataSetFile::encodeValues(uint8_t* target,
+                          const float* source,
+                          const uint64_t numberOfValues,
+                          const float scale,
+                          const float zeroPoint) const
+{
+    switch(dataType)
+    {
+        case FLOAT16_DTYPE:
+            convertFloatToFloat16(reinterpret_cast<uint16_t*>(target), source, numberOfValues);
+            break;
+        case BFLOAT16_DTYPE:
+            convertFloatToBFloat16(reinterpret_cast<uint16_t*>(target), source, numberOfValues);
+            break;
+        case INT8_DTYPE:
+            quantizeFloatToInt8(reinterpret_cast<int8_t*>(target),
+                                source,
+                                numberOfValues,
+                                scale,
+                                zeroPoint);
+            break;
+        default:
+            memcpy(target, source, numberOfValues * sizeof(float));
+            break;
+    }
+}
+
+/**
+ * @brief convert stored values of the payload into floats
+ *
+ * @param target buffer for the floats
+ * @param source stored values to convert
+ * @param numberOfValues number of values
+ * @param firstValuePos position of the first value within the payload, which is necessary to
+ *                      select the quantization-parameters of the value
+ */
+void
+DataSetFile::decodeValues(float* target,
+                          const uint8_t* source,
+                          const uint64_t numberOfValues,
+                          const uint64_t firstValuePos) const
+{
+    // int8-payloads with different quantization for each position within the lines
+    if(dataType == INT8_DTYPE
+            && m_scales.size() > 1)
+    {
+        const int8_t* values = reinterpret_cast<const int8_t*>(source);
+        for(uint64_t i = 0; i < numberOfValues; i++)
+        {
+            const uint64_t paramPos = (firstValuePos + i) % m_scales.size();
+            target[i] = dequantizeInt8ToFloat(values[i],
+                                              m_scales[paramPos],
+                                              m_zeroPoints[paramPos]);
+        }
+        return;
+    }
+
+    float scale = 1.0f;
+    float zeroPoint = 0.0f;
+    if(m_scales.size() == 1)
+    {
+        scale = m_scales[0];
+        zeroPoint = m_zeroPoints[0];
+    }
+
+    decodeValues(target, source, numberOfValues, scale, zeroPoint);
+}
+
+/**
+ * @brief convert stored values of the payload into floats
+ *
+ * @param target buffer for the floats
+ * @param source stored values to convert
+ * @param numberOfValues number of values
+ * @param scale scale of the int8-quantization
+ * @param zeroPoint zero-point of the int8-quantization
+ */
+void
+DataSetFile::decodeValues(float* target,
+                          const uint8_t* source,
+                          const uint64_t numberOfValues,
+                          const float scale,
+                          const float zeroPoint) const
+{
+    switch(dataType)
+    {
+        case FLOAT16_DTYPE:
+            convertFloat16ToFloat(target,
+                                  reinterpret_cast<const uint16_t*>(source),
+                                  numberOfValues);
+            break;
+        case BFLOAT16_DTYPE:
+            convertBFloat16ToFloat(target,
+                                   reinterpret_cast<const uint16_t*>(source),
+                                   numberOfValues);
+            break;
+        case INT8_DTYPE:
+            dequantizeInt8ToFloat(target,
+                                  reinterpret_cast<const int8_t*>(source),
+                                  numberOfValues,
+                                  scale,
+                                  zeroPoint);
+            break;
+        default:
+            memcpy(target, source, numberOfValues * sizeof(float));
+            break;
+    }
+}
+
+/**
+ * @brief convert a single stored value of the payload into a float
+ *
+ * @param source pointer to the stored value
+ * @param scale scale of the int8-quantization
+ * @param zeroPoint zero-point of the int8-quantization
+ *
+ * @return converted value
+ */
+float
+DataSetFile::decodeValue(const uint8_t* source,
+                         const float scale,
+                         const float zeroPoint) const
+{
+    uint16_t halfValue = 0;
+    float floatValue = 0.0f;
+
+    switch(dataType)
+    {
+        case FLOAT16_DTYPE:
+            memcpy(&halfValue, source, 2);
+            return convertFloat16ToFloat(halfValue);
+        case BFLOAT16_DTYPE:
+            memcpy(&halfValue, source, 2);
+            return convertBFloat16ToFloat(halfValue);
+        case INT8_DTYPE:
+            return dequantizeInt8ToFloat(static_cast<int8_t>(source[0]), scale, zeroPoint);
+        default:
+            memcpy(&floatValue, source, 4);
+            return floatValue;
+    }
+}
+
+/**
+ * @brief add data to the file
+ *
+ * @param pos value-position, where to start to write to file
+ * @param data values to write
+ * @param numberOfValues number of values to write
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::addBlock(const uint64_t pos,
+                      const float* data,
+                      const u_int64_t numberOfValues)
+{
+    Kitsunemimi::ErrorContainer error;
+    const uint64_t valueSize = getValueSize();
+
+    // check size to not write over the end of the file
+    if(m_headerSize + ((pos + numberOfValues) * valueSize) > m_totalFileSize)
+    {
+        error.addMeesage("Writing " + std::to_string(numberOfValues) + " values at position "
+                         + std::to_string(pos) + " would exceed the payload of the "
+                         "data-set-file");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // convert values into the data-type of the payload
+    const uint8_t* storedData = reinterpret_cast<const uint8_t*>(data);
+    std::vector<uint8_t> encodedData;
+    if(dataType != FLOAT32_DTYPE)
+    {
+        encodedData.resize(numberOfValues * valueSize);
+        encodeValues(&encodedData[0], data, numberOfValues, pos);
+        storedData = &encodedData[0];
+    }
+
+    // compressed payloads are buffered and written in blocks of complete lines
+    if(encoding != RAW_ENCODING)
+    {
+        if(pos * valueSize != m_writtenBytes + m_writeBuffer.size())
+        {
+            error.addMeesage("Compressed data-sets can only be written sequentially");
+            LOG_ERROR(error);
+            return false;
+        }
+        m_writeBuffer.insert(m_writeBuffer.end(),
+                             storedData,
+                             storedData + numberOfValues * valueSize);
+
+        const uint64_t lineSize = std::max<uint64_t>(m_lineSize, 1) * valueSize;
+        const uint64_t linesPerBlock = std::max<uint64_t>(COMPRESSED_BLOCK_SIZE / lineSize, 1);
+        const uint64_t bytesPerBlock = linesPerBlock * lineSize;
+
+        uint64_t consumed = 0;
+        while(m_writeBuffer.size() - consumed >= bytesPerBlock)
+        {
+            if(writeCompressedBlock(&m_writeBuffer[consumed], bytesPerBlock, error) == false)
+            {
+                LOG_ERROR(error);
+                return false;
+            }
+            consumed += bytesPerBlock;
+        }
+        m_writeBuffer.erase(m_writeBuffer.begin(), m_writeBuffer.begin() + consumed);
+
+        return true;
+    }
+
+    // add add data to file
+    if(m_targetFile->writeDataIntoFile(storedData,
+                                       m_headerSize + pos * valueSize,
+                                       numberOfValues * valueSize,
+                                       error) == false)
+    {
+        error.addMeesage("Failed to write " + std::to_string(numberOfValues) + " values at "
+                         "position " + std::to_string(pos) + " into data-set-file");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief extend the payload of an existing file at its end, so new values can be appended with
+ *        addBlock. This is only possible for uncompressed files of version 2 in row-major layout,
+ *        because only there the payload is the last part of the file and all values have fixed
+ *        positions. The section-table is not written here, but by commitPayload, after the new
+ *        values were written.
+ *
+ * @param numberOfValues number of values to add to the payload
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::extendPayload(const uint64_t numberOfValues,
+                           Kitsunemimi::ErrorContainer &error)
+{
+    if(m_fileVersion < 2
+            || encoding != RAW_ENCODING
+            || layout != ROW_MAJOR_LAYOUT)
+    {
+        error.addMeesage("Only uncompressed data-sets of version 2 in row-major layout "
+                         "can be extended");
+        return false;
+    }
+
+    SectionEntry* payload = nullptr;
+    for(SectionEntry &section : m_sections)
+    {
+        if(section.sectionType == PAYLOAD_SECTION) {
+            payload = &section;
+        }
+    }
+
+    // the payload must end with the file to not overwrite other sections. The section can be
+    // bigger than the used payload, when less lines were written than initially allocated, and
+    // bigger than the mapping, when the payload was already extended by a previous call.
+    const uint64_t sectionEnd = payload == nullptr ? 0 : payload->offset + payload->size;
+    if(payload == nullptr
+            || m_totalFileSize > sectionEnd
+            || m_mappedFile.getFileSize() > sectionEnd)
+    {
+        error.addMeesage("Payload of data-set-file is not at the end of the file");
+        return false;
+    }
+
+    const uint64_t newEnd = m_totalFileSize + numberOfValues * getValueSize();
+    if(newEnd > sectionEnd)
+    {
+        m_allocatedSize = sectionEnd;
+        if(resizeFile(newEnd, error) == false) {
+            return false;
+        }
+        payload->size = newEnd - payload->offset;
+    }
+    m_totalFileSize = newEnd;
+
+    return true;
+}
+
+/**
+ * @brief write the section-table with the extended payload and flush the file to the disc. Has
+ *        to be called after the new values were written and before the new number of rows is
+ *        written, so the rows can never become visible before their values are on the disc.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::commitPayload(Kitsunemimi::ErrorContainer &error)
+{
+    if(syncFile(error) == false
+            || writeSectionTable(error) == false)
+    {
+        return false;
+    }
+
+    return syncFile(error);
+}
+
+/**
+ * @brief flush all written data of the file from the page-cache to the disc
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::syncFile(Kitsunemimi::ErrorContainer &error)
+{
+    // fsync flushes all dirty pages of the file, independent of the file-descriptor, which
+    // was used to write them
+    const int fd = open(m_filePath.c_str(), O_RDONLY);
+    if(fd < 0
+            || fsync(fd) != 0)
+    {
+        error.addMeesage("Failed to flush data-set-file '" + m_filePath + "': "
+                         + std::string(strerror(errno)));
+        if(fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    close(fd);
+
+    return true;
+}
+
+/**
+ * @brief search the block of a compressed payload, which contains a specific position
+ *
+ * @param payloadOffset byte-offset within the uncompressed payload
+ *
+ * @return position of the last block, which starts before or at the offset
+ */
+uint64_t
+DataSetFile::findBlock(const uint64_t payloadOffset) const
+{
+    uint64_t blockPos = 0;
+    uint64_t last = m_blockIndex.size();
+    while(last - blockPos > 1)
+    {
+        const uint64_t mid = (blockPos + last) / 2;
+        if(m_blockIndex[mid].payloadOffset <= payloadOffset)
+        {
+            blockPos = mid;
+        }
+        else
+        {
+            last = mid;
+        }
+    }
+
+    return blockPos;
+}
+
+/**
+ * @brief read a part of the payload. For compressed payloads only the blocks, which are touched
+ *        by the requested range, are decompressed.
+ *
+ * @param target pointer to the buffer for the read data
+ * @param payloadOffset byte-offset within the uncompressed payload where to start to read
+ * @param size number of bytes to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::readPayload(void* target,
+                         const uint64_t payloadOffset,
+                         const uint64_t size,
+                         Kitsunemimi::ErrorContainer &error)
+{
+    if(encoding == RAW_ENCODING
+            || size == 0)
+    {
+        return readFileData(target, m_headerSize + payloadOffset, size, error);
+    }
+
+    // search last block, which starts before the requested range
+    uint64_t blockPos = findBlock(payloadOffset);
+
+    uint8_t* targetBytes = static_cast<uint8_t*>(target);
+    std::vector<uint8_t> blockBuffer;
+    uint64_t pos = payloadOffset;
+    const uint64_t end = payloadOffset + size;
+
+    while(pos < end)
+    {
+        if(blockPos >= m_blockIndex.size()
+                || pos < m_blockIndex[blockPos].payloadOffset
+                || pos >= m_blockIndex[blockPos].payloadOffset + m_blockIndex[blockPos].rawSize)
+        {
+            error.addMeesage("Requested range is outside of the compressed payload");
+            return false;
+        }
+
+        const CompressedBlock &block = m_blockIndex[blockPos];
+        const uint64_t blockEnd = std::min(end, block.payloadOffset + block.rawSize);
+        const uint64_t copySize = blockEnd - pos;
+
+        // decompress complete blocks directly into the target
+        if(pos == block.payloadOffset
+                && copySize == block.rawSize)
+        {
+            if(decompressBlock(block, &targetBytes[pos - payloadOffset], error) == false) {
+                return false;
+            }
+        }
+        else
+        {
+            blockBuffer.resize(block.rawSize);
+            if(decompressBlock(block, &blockBuffer[0], error) == false) {
+                return false;
+            }
+            memcpy(&targetBytes[pos - payloadOffset],
+                   &blockBuffer[pos - block.payloadOffset],
+                   copySize);
+        }
+
+        pos += copySize;
+        blockPos++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief gather the same part of multiple rows of the payload into one contiguous buffer. The
+ *        rows can be in any order. For compressed payloads the rows are processed sorted by their
+ *        position, so each affected block has to be decompressed only once.
+ *
+ * @param target pointer to the buffer for the gathered data
+ * @param rows numbers of the rows to gather in the order, in which they should be written
+ * @param rowSize number of bytes between two rows
+ * @param firstByte byte-offset within the uncompressed payload of the part of the first row
+ * @param copySize number of bytes to copy of each row
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::gatherPayloadData(uint8_t* target,
+                               const std::vector<uint64_t> &rows,
+                               const uint64_t rowSize,
+                               const uint64_t firstByte,
+                               const uint64_t copySize,
+                               Kitsunemimi::ErrorContainer &error)
+{
+    const uint64_t numberOfRows = getNumberOfRows();
+    for(const uint64_t row : rows)
+    {
+        if(row >= numberOfRows)
+        {
+            error.addMeesage("Requested row " + std::to_string(row) + " is out of range");
+            return false;
+        }
+    }
+
+    if(encoding == RAW_ENCODING)
+    {
+        for(uint64_t i = 0; i < rows.size(); i++)
+        {
+            const uint64_t offset = m_headerSize + firstByte + rows[i] * rowSize;
+            if(readFileData(&target[i * copySize], offset, copySize, error) == false) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<uint64_t> order(rows.size(), 0);
+    for(uint64_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(),
+              order.end(),
+              [&rows](const uint64_t a, const uint64_t b) { return rows[a] < rows[b]; });
+
+    std::vector<uint8_t> blockBuffer;
+    uint64_t bufferedBlock = m_blockIndex.size();
+    for(const uint64_t pos : order)
+    {
+        const uint64_t offset = firstByte + rows[pos] * rowSize;
+        const uint64_t blockPos = findBlock(offset);
+        if(blockPos >= m_blockIndex.size()
+                || offset < m_blockIndex[blockPos].payloadOffset
+                || offset + copySize > m_blockIndex[blockPos].payloadOffset
+                                       + m_blockIndex[blockPos].rawSize)
+        {
+            error.addMeesage("Requested row is outside of the compressed payload");
+            return false;
+        }
+
+        const CompressedBlock &block = m_blockIndex[blockPos];
+        if(blockPos != bufferedBlock)
+        {
+            blockBuffer.resize(block.rawSize);
+            if(decompressBlock(block, &blockBuffer[0], error) == false) {
+                return false;
+            }
+            bufferedBlock = blockPos;
+        }
+
+        memcpy(&target[pos * copySize], &blockBuffer[offset - block.payloadOffset], copySize);
+    }
+
+    return true;
+}
+
+/**
+ * @brief decompress a single block of the payload
+ *
+ * @param block block to decompress
+ * @param target buffer for the uncompressed data with a size of at least the raw-size of the block
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::decompressBlock(const CompressedBlock &block,
+                             uint8_t* target,
+                             Kitsunemimi::ErrorContainer &error)
+{
+    // get compressed data directly from the mapped file, if possible
+    std::vector<uint8_t> compressedData;
+    const uint8_t* source = nullptr;
+    if(m_mappedFile.isMapped()
+            && block.fileOffset + block.compressedSize <= m_mappedFile.size)
+    {
+        source = &m_mappedFile.data[block.fileOffset];
+    }
+    else
+    {
+        compressedData.resize(block.compressedSize);
+        if(readFileData(&compressedData[0], block.fileOffset, block.compressedSize, error) == false)
+        {
+            error.addMeesage("Failed to read compressed block of data-set-file");
+            return false;
+        }
+        source = &compressedData[0];
+    }
+
+    // blocks, which could not be compressed, are stored uncompressed
+    if(block.compressedSize == block.rawSize)
+    {
+        memcpy(target, source, block.rawSize);
+        return true;
+    }
+
+    std::string failure = "unknown encoding";
+    if(encoding == LZ4_ENCODING)
+    {
+        const int result = LZ4_decompress_safe(reinterpret_cast<const char*>(source),
+                                               reinterpret_cast<char*>(target),
+                                               block.compressedSize,
+                                               block.rawSize);
+        if(result == static_cast<int>(block.rawSize)) {
+            return true;
+        }
+
+        // lz4 has no names for its errors, but returns a negative position of the malformed
+        // input, or the number of decompressed bytes
+        if(result < 0)
+        {
+            failure = "LZ4_decompress_safe failed at byte " + std::to_string(-result);
+        }
+        else
+        {
+            failure = "LZ4_decompress_safe returned " + std::to_string(result) + " bytes";
+        }
+    }
+    else if(encoding == ZSTD_ENCODING)
+    {
+        const size_t result = ZSTD_decompress(target,
+                                              block.rawSize,
+                                              source,
+                                              block.compressedSize);
+        if(ZSTD_isError(result) == 0
+                && result == block.rawSize)
+        {
+            return true;
+        }
+
+        if(ZSTD_isError(result))
+        {
+            failure = std::string("ZSTD_decompress failed: ") + ZSTD_getErrorName(result);
+        }
+        else
+        {
+            failure = "ZSTD_decompress returned " + std::to_string(result) + " bytes";
+        }
+    }
+
+    error.addMeesage("Failed to decompress block at file-offset "
+                     + std::to_string(block.fileOffset) + " of data-set-file, which should have "
+                     + std::to_string(block.rawSize) + " bytes: " + failure);
+    return false;
+}
+
+/**
+ * @brief compress values and append them as new block behind the already written blocks
+ *
+ * @param data stored values to compress
+ * @param size number of bytes to compress
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::writeCompressedBlock(const uint8_t* data,
+                                  const uint64_t size,
+                                  Kitsunemimi::ErrorContainer &error)
+{
+    const uint64_t rawSize = size;
+    std::vector<uint8_t> compressedData;
+    uint64_t compressedSize = 0;
+
+    if(encoding == LZ4_ENCODING)
+    {
+        compressedData.resize(LZ4_compressBound(rawSize));
+        const int result = LZ4_compress_default(reinterpret_cast<const char*>(data),
+                                                reinterpret_cast<char*>(&compressedData[0]),
+                                                rawSize,
+                                                compressedData.size());
+        if(result > 0) {
+            compressedSize = result;
+        }
+    }
+    else if(encoding == ZSTD_ENCODING)
+    {
+        compressedData.resize(ZSTD_compressBound(rawSize));
+        const size_t result = ZSTD_compress(&compressedData[0],
+                                            compressedData.size(),
+                                            data,
+                                            rawSize,
+                                            3);
+        if(ZSTD_isError(result) == 0)
+        {
+            compressedSize = result;
+        }
+        else
+        {
+            // the block is still written uncompressed, so this is not an error of the write
+            Kitsunemimi::ErrorContainer compressError;
+            compressError.addMeesage(std::string("ZSTD_compress failed: ")
+                                     + ZSTD_getErrorName(result)
+                                     + ", so the block is stored uncompressed");
+            LOG_ERROR(compressError);
+        }
+    }
+
+    // store the block uncompressed, if compression doesn't reduce the size
+    const void* blockData = &compressedData[0];
+    if(compressedSize == 0
+            || compressedSize >= rawSize)
+    {
+        compressedSize = rawSize;
+        blockData = data;
+    }
+
+    // append block to file
+    if(resizeFile(m_compressedEnd + compressedSize, error) == false) {
+        return false;
+    }
+    if(m_targetFile->writeDataIntoFile(blockData, m_compressedEnd, compressedSize, error) == false)
+    {
+        error.addMeesage("Failed to write compressed block into data-set-file");
+        return false;
+    }
+
+    CompressedBlock block;
+    block.payloadOffset = m_writtenBytes;
+    block.fileOffset = m_compressedEnd;
+    block.rawSize = rawSize;
+    block.compressedSize = compressedSize;
+    m_blockIndex.push_back(block);
+
+    m_compressedEnd += compressedSize;
+    m_writtenBytes += rawSize;
+
+    return true;
+}
+
+/**
+ * @brief write the remaining buffered values of a compressed payload as last block and write the
+ *        block-index behind the blocks. Can be called multiple times while writing the file,
+ *        because following blocks overwrite the previously written block-index.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::finishBlocks(Kitsunemimi::ErrorContainer &error)
+{
+    if(encoding == RAW_ENCODING) {
+        return true;
+    }
+
+    // write last incomplete block
+    if(m_writeBuffer.size() > 0)
+    {
+        if(writeCompressedBlock(&m_writeBuffer[0], m_writeBuffer.size(), error) == false) {
+            return false;
+        }
+        m_writeBuffer.clear();
+    }
+
+    // write block-index behind the compressed blocks
+    const uint64_t indexOffset = alignSize(m_compressedEnd, 8);
+    const uint64_t indexSize = m_blockIndex.size() * sizeof(CompressedBlock);
+    if(resizeFile(indexOffset + indexSize, error) == false) {
+        return false;
+    }
+    if(indexSize > 0
+            && m_targetFile->writeDataIntoFile(&m_blockIndex[0],
+                                               indexOffset,
+                                               indexSize,
+                                               error) == false)
+    {
+        error.addMeesage("Failed to write block-index into data-set-file");
+        return false;
+    }
+
+    // update sections
+    for(SectionEntry &section : m_sections)
+    {
+        if(section.sectionType == PAYLOAD_SECTION) {
+            section.size = m_compressedEnd - section.offset;
+        }
+        if(section.sectionType == BLOCK_INDEX_SECTION)
+        {
+            section.offset = indexOffset;
+            section.size = indexSize;
+        }
+    }
+
+    return writeSectionTable(error);
+}
+
+/**
+ * @brief grow the file to at least the given size
+ *
+ * @param size new minimal size of the file in bytes
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetFile::resizeFile(const uint64_t size,
+                        Kitsunemimi::ErrorContainer &error)
+{
+    if(size <= m_allocatedSize) {
+        return true;
+    }
+
+    if(m_targetFile->allocateStorage(size - m_allocatedSize, error) == false)
+    {
+        error.addMeesage("Failed to allocate storage for data-set-file");
+        return false;
+    }
+    m_allocatedSize = size;
+
+    return true;
+}
+
+/**
+ * @brief get number of bytes of the file, which are mapped into the memory
+ *
+ * @return number of mapped bytes, or 0 if not mapped
+ */
+uint64_t
+DataSetFile::getMappedSize() const
+{
+    return m_mappedFile.size;
+}
+
+/**
+ * @brief create random permutation of the numbers 0 to size-1 with a fisher-yates-shuffle. The
+ *        mt19937_64 and the shuffle itself are fully defined, so the same seed results in the
+ *        same permutation independent of the used standard-library.
+ *
+ * @param permutation reference for the resulting permutation
+ * @param size number of elements
+ * @param seed seed for the random-generator
+ */
+void
+createPermutation(std::vector<uint64_t> &permutation,
+                  const uint64_t size,
+                  const uint64_t seed)
+{
+    permutation.resize(size);
+    for(uint64_t i = 0; i < size; i++) {
+        permutation[i] = i;
+    }
+
+    std::mt19937_64 generator(seed);
+    for(uint64_t i = size; i > 1; i--)
+    {
+        const uint64_t j = generator() % i;
+        std::swap(permutation[i - 1], permutation[j]);
+    }
+}
+
+/**
+ * @brief round up a size to the next multiple of an alignment
+ *
+ * @param size size to align
+ * @param alignment alignment in bytes
+ *
+ * @return aligned size
+ */
+uint64_t
+alignSize(const uint64_t size,
+          const uint64_t alignment)
+{
+    return ((size + alignment - 1) / alignment) * alignment;
+}
+
+/**
+ * @brief copy the values of a single column into a buffer of multiple columns
+ *
+ * @param target buffer of all columns
+ * @param column contiguous values of the column
+ * @param columnPos position of the column within the target
+ * @param numberOfColumns number of columns within the target
+ * @param numberOfRows number of rows of the column
+ * @param valueSize number of bytes of the values of the column within a row
+ * @param columnBlocked true, if the columns are placed one after another within the target,
+ *                      false if they are interleaved row by row
+ */
+void
+copyColumn(uint8_t* target,
+           const uint8_t* column,
+           const uint64_t columnPos,
+           const uint64_t numberOfColumns,
+           const uint64_t numberOfRows,
+           const uint64_t valueSize,
+           const bool columnBlocked)
+{
+    if(columnBlocked)
+    {
+        memcpy(&target[columnPos * numberOfRows * valueSize], column, numberOfRows * valueSize);
+        return;
+    }
+
+    for(uint64_t row = 0; row < numberOfRows; row++)
+    {
+        memcpy(&target[(row * numberOfColumns + columnPos) * valueSize],
+               &column[row * valueSize],
+               valueSize);
+    }
+}
+
+/**
+ * @brief copy a part of the rows of multiple columns into a buffer of all rows with the same
+ *        arrangement of the columns
+ *
+ * @param target buffer of all rows
+ * @param part values of all columns of the part
+ * @param firstRow position of the first row of the part within the target
+ * @param partRows number of rows of the part
+ * @param totalRows number of rows of the target
+ * @param numberOfColumns number of columns of part and target
+ * @param valueSize number of bytes of the values of a column within a row
+ * @param columnBlocked true, if the columns are placed one after another, false if they are
+ *                      interleaved row by row
+ */
+void
+copyRowsPart(uint8_t* target,
+             const uint8_t* part,
+             const uint64_t firstRow,
+             const uint64_t partRows,
+             const uint64_t totalRows,
+             const uint64_t numberOfColumns,
+             const uint64_t valueSize,
+             const bool columnBlocked)
+{
+    // interleaved rows of a part are already contiguous within the target
+    if(columnBlocked == false)
+    {
+        memcpy(&target[firstRow * numberOfColumns * valueSize],
+               part,
+               partRows * numberOfColumns * valueSize);
+        return;
+    }
+
+    for(uint64_t column = 0; column < numberOfColumns; column++)
+    {
+        memcpy(&target[(column * totalRows + firstRow) * valueSize],
+               &part[column * partRows * valueSize],
+               partRows * valueSize);
+    }
+}
+
+/**
+ * @brief convert name of a compression into the encoding of the payload
+ *
+ * @param name name of the compression ("lz4" or "zstd")
+ *
+ * @return encoding of the payload, which is RAW_ENCODING for unknown names
+ */
+DataSetFile::Encoding
+getEncodingFromName(const std::string &name)
+{
+    if(name == "lz4") {
+        return DataSetFile::LZ4_ENCODING;
+    }
+    if(name == "zstd") {
+        return DataSetFile::ZSTD_ENCODING;
+    }
+
+    return DataSetFile::RAW_ENCODING;
+}
+
+/**
+ * @brief convert name of a data-type into the data-type of the payload
+ *
+ * @param name name of the data-type ("float16", "bfloat16" or "int8")
+ *
+ * @return data-type of the payload, which is FLOAT32_DTYPE for unknown names
+ */
+DataSetFile::DataType
+getDataTypeFromName(const std::string &name)
+{
+    if(name == "float16") {
+        return DataSetFile::FLOAT16_DTYPE;
+    }
+    if(name == "bfloat16") {
+        return DataSetFile::BFLOAT16_DTYPE;
+    }
+    if(name == "int8") {
+        return DataSetFile::INT8_DTYPE;
+    }
+
+    return DataSetFile::FLOAT32_DTYPE;
+}
+
+/**
+ * @brief get name of a data-type of the payload
+ *
+ * @param dataType data-type of the payload
+ *
+ * @return name of the data-type
+ */
+const std::string
+getDataTypeName(const DataSetFile::DataType dataType)
+{
+    if(dataType == DataSetFile::FLOAT16_DTYPE) {
+        return "float16";
+    }
+    if(dataType == DataSetFile::BFLOAT16_DTYPE) {
+        return "bfloat16";
+    }
+    if(dataType == DataSetFile::INT8_DTYPE) {
+        return "int8";
+    }
+
+    return "float32";
+}
+
+/**
+ * @brief read file as data-set. Only the headers of the file are read at this point.
+ *
+ * @param filePath path to file
+ * @param error reference for error-output
+ *
+ * @return pointer to file-handler, if successful, else nullptr
+ */
+DataSetFile*
+readDataSetFile(const std::string &filePath,
+                Kitsunemimi::ErrorContainer &error)
+{
+    // read header of file to identify type. Files, which were split into deduplicated blocks,
+    // are read from their first block.
+    DataSetFile::DataSetHeader header;
+    bool success = false;
+    if(BlockStore::isBlockMap(filePath))
+    {
+        success = BlockStore::readFileData(filePath,
+                                           &header,
+                                           0,
+                                           sizeof(DataSetFile::DataSetHeaderV1),
+                                           error);
+    }
+    else
+    {
+        Kitsunemimi::BinaryFile targetFile(filePath);
+        success = targetFile.readDataFromFile(&header,
+                                              0,
+                                              sizeof(DataSetFile::DataSetHeaderV1),
+                                              error);
+    }
+    if(success == false)
+    {
+        error.addMeesage("Failed to read data-set-header from file '" + filePath + "'");
+        return nullptr;
+    }
+
+    // files of version 1 have no magic-number and the type at the beginning of the file
+    uint8_t type = header.type;
+    if(memcmp(header.magic, DataSetFile::DataSetHeader().magic, 8) != 0) {
+        type = reinterpret_cast<DataSetFile::DataSetHeaderV1*>(&header)->type;
+    }
+
+    // create file-handling object based on the type from the header
+    DataSetFile* file = nullptr;
+    if(type == DataSetFile::IMAGE_TYPE)
+    {
+        file = new ImageDataSetFile(filePath);
+    }
+    else if(type == DataSetFile::TABLE_TYPE
+            || type == DataSetFile::TABLE_COLUMNAR_TYPE)
+    {
+        file = new TableDataSetFile(filePath);
+    }
+    else if(type == DataSetFile::VIEW_TYPE)
+    {
+        file = new ViewDataSetFile(filePath);
+    }
+    else
+    {
+        error.addMeesage("File '" + filePath + "' has unknown data-set-type");
+        return nullptr;
+    }
+
+    // read remaining headers
+    if(file->readFromFile(error) == false)
     {
-        file = new TableDataSetFile(targetFile);
-        file->readFromFile();
+        error.addMeesage("Failed to read data-set-file '" + filePath + "'");
+        delete file;
+        return nullptr;
     }
 
     return file;
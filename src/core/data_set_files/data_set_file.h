@@ -24,6 +24,7 @@
 #define SHIORIARCHIVE_DATASETFILE_H
 
 #include <libKitsunemimiCommon/logger.h>
+#include <core/mapped_file.h>
 
 #include <string>
 #include <vector>
@@ -42,14 +43,108 @@ public:
     {
         UNDEFINED_TYPE = 0,
         IMAGE_TYPE = 1,
-        TABLE_TYPE = 2
+        TABLE_TYPE = 2,
+        // only used in files of version 1 for tables in columnar layout
+        TABLE_COLUMNAR_TYPE = 3,
+        VIEW_TYPE = 4
     };
 
+    enum DataType
+    {
+        FLOAT32_DTYPE = 0,
+        FLOAT16_DTYPE = 1,
+        BFLOAT16_DTYPE = 2,
+        INT8_DTYPE = 3
+    };
+
+    enum Encoding
+    {
+        RAW_ENCODING = 0,
+        LZ4_ENCODING = 1,
+        ZSTD_ENCODING = 2
+    };
+
+    enum Layout
+    {
+        ROW_MAJOR_LAYOUT = 0,
+        COLUMN_MAJOR_LAYOUT = 1
+    };
+
+    enum SectionType
+    {
+        UNDEFINED_SECTION = 0,
+        TYPE_HEADER_SECTION = 1,
+        COLUMN_SECTION = 2,
+        COLUMN_OFFSET_SECTION = 3,
+        PAYLOAD_SECTION = 4,
+        BLOCK_INDEX_SECTION = 5,
+        PARENT_LOCATION_SECTION = 6,
+        ROW_RANGE_SECTION = 7
+    };
+
+    enum ColumnGroup
+    {
+        NO_COLUMN_GROUP = 0,
+        INPUT_COLUMNS = 1,
+        OUTPUT_COLUMNS = 2,
+        ALL_COLUMNS = 3
+    };
+
+    // header of files of version 1, which have no magic-number and no section-table
+    struct DataSetHeaderV1
+    {
+        uint8_t type = UNDEFINED_TYPE;
+        char name[256];
+    };
+
+    // header of files since version 2. It is followed by the section-table. All structs, which
+    // are stored in sections, are only allowed to grow at their end, because the readers copy
+    // only as many bytes, as the stored entries have, and keep the defaults for the rest.
     struct DataSetHeader
     {
+        char magic[8] = {'S', 'H', 'I', 'O', 'R', 'I', 'D', 'S'};
+        uint32_t version = 2;
+        uint32_t byteOrderMark = 0x01020304;
         uint8_t type = UNDEFINED_TYPE;
+        uint8_t dataType = FLOAT32_DTYPE;
+        uint8_t encoding = RAW_ENCODING;
+        uint8_t layout = ROW_MAJOR_LAYOUT;
+        uint32_t numberOfSections = 0;
         char name[256];
+        uint8_t padding[32];
+
+        DataSetHeader()
+        {
+            memset(name, 0, 256);
+            memset(padding, 0, 32);
+        }
+    };
+    static_assert(sizeof(DataSetHeader) == 312);
+
+    struct SectionEntry
+    {
+        uint32_t sectionType = UNDEFINED_SECTION;
+        uint32_t entrySize = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
     };
+    static_assert(sizeof(SectionEntry) == 24);
+
+    // upper limit for the number of sections of a file, to reject corrupted section-tables,
+    // before memory is allocated for them. Each section-type exists at most once per file.
+    static constexpr uint32_t MAX_NUMBER_OF_SECTIONS = 64;
+
+    // entry of the block-index of compressed payloads. Each block contains complete lines, so
+    // the payload-offset of a block also defines the range of lines, which are within the block.
+    // Blocks, which can not be compressed, are stored uncompressed with rawSize == compressedSize.
+    struct CompressedBlock
+    {
+        uint64_t payloadOffset = 0;
+        uint64_t fileOffset = 0;
+        uint32_t rawSize = 0;
+        uint32_t compressedSize = 0;
+    };
+    static_assert(sizeof(CompressedBlock) == 24);
 
     struct ImageTypeHeader
     {
@@ -59,6 +154,9 @@ public:
         uint64_t numberOfImages = 0;
         float maxValue = 0.0f;
         float avgValue = 0.0f;
+        // affine quantization of int8-payloads: value = (quantized - zeroPoint) * scale
+        float scale = 1.0f;
+        float zeroPoint = 0.0f;
     };
 
     struct TableTypeHeader
@@ -75,6 +173,9 @@ public:
         float multiplicator = 1.0f;
         float averageVal = 0.0f;
         float maxVal = 0.0f;
+        // affine quantization of int8-payloads: value = (quantized - zeroPoint) * scale
+        float scale = 1.0f;
+        float zeroPoint = 0.0f;
 
         void setName(const std::string &name)
         {
@@ -87,33 +188,237 @@ public:
         }
     };
 
+    struct RowRange
+    {
+        uint64_t startRow = 0;
+        uint64_t numberOfRows = 0;
+    };
+    static_assert(sizeof(RowRange) == 16);
+
+    // a view has no payload of its own, but only references ranges of rows of its parent
+    struct ViewTypeHeader
+    {
+        uint64_t numberOfRows = 0;
+        uint64_t numberOfRanges = 0;
+    };
+
+    struct PayloadView
+    {
+        const void* data = nullptr;
+        uint64_t size = 0;
+        DataType dataType = FLOAT32_DTYPE;
+    };
+
+    // sizes of the structs within files of version 1
+    static const uint32_t V1_IMAGE_HEADER_SIZE = 40;
+    static const uint32_t V1_TABLE_HEADER_SIZE = 16;
+    static const uint32_t V1_TABLE_ENTRY_SIZE = 272;
+
+    // target uncompressed size of a block of a compressed payload
+    static const uint32_t COMPRESSED_BLOCK_SIZE = 256 * 1024;
+
     DataSetFile(const std::string &filePath);
-    DataSetFile(Kitsunemimi::BinaryFile* file);
     virtual ~DataSetFile();
 
     bool initNewFile();
-    bool readFromFile();
+    bool readFromFile(Kitsunemimi::ErrorContainer &error);
 
     bool addBlock(const uint64_t pos,
                   const float* data,
                   const u_int64_t numberOfValues);
     virtual float* getPayload(uint64_t &payloadSize,
                               const std::string &columnName = "") = 0;
+    virtual uint8_t* getCompactPayload(uint64_t &payloadSize,
+                                       const std::string &columnName = "") = 0;
+    virtual bool getPayloadView(PayloadView &view,
+                                const std::string &columnName = "") = 0;
+    virtual float* getPayload(uint64_t &payloadSize,
+                              const uint64_t startRow,
+                              const uint64_t numberOfRows,
+                              const std::string &columnName = "") = 0;
+    virtual uint8_t* getCompactPayload(uint64_t &payloadSize,
+                                       const uint64_t startRow,
+                                       const uint64_t numberOfRows,
+                                       const std::string &columnName = "") = 0;
+    virtual bool getPayloadView(PayloadView &view,
+                                const uint64_t startRow,
+                                const uint64_t numberOfRows,
+                                const std::string &columnName = "") = 0;
+    virtual bool getPayloadViews(std::vector<PayloadView> &views,
+                                 const uint64_t startRow,
+                                 const uint64_t numberOfRows,
+                                 const std::string &columnName = "");
+    virtual float* getColumnsPayload(uint64_t &payloadSize,
+                                     const uint64_t startRow,
+                                     const uint64_t numberOfRows,
+                                     const std::vector<std::string> &columnNames,
+                                     const bool columnBlocked);
+    virtual uint8_t* getCompactColumnsPayload(uint64_t &payloadSize,
+                                              const uint64_t startRow,
+                                              const uint64_t numberOfRows,
+                                              const std::vector<std::string> &columnNames,
+                                              const bool columnBlocked);
+    virtual void getColumnNames(std::vector<std::string> &columnNames,
+                                const ColumnGroup group) const;
+    virtual float getColumnMultiplicator(const std::string &columnName) const;
+    virtual bool getViewFileRange(std::string &filePath,
+                                  uint64_t &fileOffset,
+                                  const PayloadView &view) const;
+    virtual float* gatherPayload(uint64_t &payloadSize,
+                                 const std::vector<uint64_t> &rows,
+                                 const std::string &columnName = "") = 0;
+    virtual uint8_t* gatherCompactPayload(uint64_t &payloadSize,
+                                          const std::vector<uint64_t> &rows,
+                                          const std::string &columnName = "") = 0;
+    virtual uint64_t getNumberOfRows() const = 0;
+    virtual uint64_t getValuesPerRow() const = 0;
+    uint64_t getRowsPerStorageBlock() const;
+    bool getShardRanges(std::vector<RowRange> &ranges,
+                        const uint64_t shardIndex,
+                        const uint64_t shardCount,
+                        const uint64_t seed,
+                        Kitsunemimi::ErrorContainer &error) const;
     virtual bool updateHeader() = 0;
+    virtual uint64_t getMappedSize() const;
+    uint64_t getValueSize() const;
 
     DataSetType type = UNDEFINED_TYPE;
+    DataType dataType = FLOAT32_DTYPE;
+    Encoding encoding = RAW_ENCODING;
+    Layout layout = ROW_MAJOR_LAYOUT;
     std::string name = "";
 
 protected:
     virtual void initHeader() = 0;
-    virtual void readHeader(const uint8_t* u8buffer) = 0;
+    virtual bool readHeader(Kitsunemimi::ErrorContainer &error) = 0;
+
+    void addSection(const SectionType sectionType,
+                    const uint32_t entrySize,
+                    const uint64_t numberOfEntries,
+                    const uint64_t offset = 0);
+    void finishSections();
+    const SectionEntry* getSection(const SectionType sectionType) const;
+    bool readSection(const SectionType sectionType,
+                     void* target,
+                     const uint64_t entrySize,
+                     const uint64_t numberOfEntries,
+                     Kitsunemimi::ErrorContainer &error);
+    bool writeSection(const SectionType sectionType,
+                      const void* data,
+                      const uint64_t entrySize,
+                      const uint64_t numberOfEntries,
+                      Kitsunemimi::ErrorContainer &error);
+
+    bool readFileData(void* target,
+                      const uint64_t offset,
+                      const uint64_t size,
+                      Kitsunemimi::ErrorContainer &error);
+    bool readPayload(void* target,
+                     const uint64_t payloadOffset,
+                     const uint64_t size,
+                     Kitsunemimi::ErrorContainer &error);
+    bool gatherPayloadData(uint8_t* target,
+                           const std::vector<uint64_t> &rows,
+                           const uint64_t rowSize,
+                           const uint64_t firstByte,
+                           const uint64_t copySize,
+                           Kitsunemimi::ErrorContainer &error);
+    bool finishBlocks(Kitsunemimi::ErrorContainer &error);
+    bool extendPayload(const uint64_t numberOfValues,
+                       Kitsunemimi::ErrorContainer &error);
+    bool commitPayload(Kitsunemimi::ErrorContainer &error);
+    bool syncFile(Kitsunemimi::ErrorContainer &error);
+
+    const uint8_t* getMappedData(const uint64_t offset,
+                                 const uint64_t size) const;
+    uint64_t getRowsInRange(const uint64_t startRow,
+                            const uint64_t numberOfRows) const;
+
+    void encodeValues(uint8_t* target,
+                      const float* source,
+                      const uint64_t numberOfValues,
+                      const uint64_t firstValuePos) const;
+    void encodeValues(uint8_t* target,
+                      const float* source,
+                      const uint64_t numberOfValues,
+                      const float scale,
+                      const float zeroPoint) const;
+    void decodeValues(float* target,
+                      const uint8_t* source,
+                      const uint64_t numberOfValues,
+                      const uint64_t firstValuePos) const;
+    void decodeValues(float* target,
+                      const uint8_t* source,
+                      const uint64_t numberOfValues,
+                      const float scale,
+                      const float zeroPoint) const;
+    float decodeValue(const uint8_t* source,
+                      const float scale,
+                      const float zeroPoint) const;
 
     Kitsunemimi::BinaryFile* m_targetFile = nullptr;
+    MappedFile m_mappedFile;
 
+    uint32_t m_fileVersion = 2;
+    std::vector<SectionEntry> m_sections;
     uint64_t m_headerSize = 0;
     uint64_t m_totalFileSize = 0;
+    uint64_t m_lineSize = 1;
+
+    // quantization-parameters for int8-payloads. Either one entry for all values or one entry
+    // for each value-position within a line.
+    std::vector<float> m_scales;
+    std::vector<float> m_zeroPoints;
+
+private:
+    bool writeCompressedBlock(const uint8_t* data,
+                              const uint64_t size,
+                              Kitsunemimi::ErrorContainer &error);
+    uint64_t findBlock(const uint64_t payloadOffset) const;
+    bool decompressBlock(const CompressedBlock &block,
+                         uint8_t* target,
+                         Kitsunemimi::ErrorContainer &error);
+    bool resizeFile(const uint64_t size,
+                    Kitsunemimi::ErrorContainer &error);
+
+    bool readHeaderV1(Kitsunemimi::ErrorContainer &error);
+    bool readHeaderV2(Kitsunemimi::ErrorContainer &error);
+    bool writeSectionTable(Kitsunemimi::ErrorContainer &error);
+
+    std::vector<CompressedBlock> m_blockIndex;
+    std::vector<uint8_t> m_writeBuffer;
+    uint64_t m_writtenBytes = 0;
+    uint64_t m_compressedEnd = 0;
+    uint64_t m_allocatedSize = 0;
+    std::string m_filePath = "";
 };
 
-DataSetFile* readDataSetFile(const std::string &filePath);
+uint64_t alignSize(const uint64_t size,
+                   const uint64_t alignment);
+void createPermutation(std::vector<uint64_t> &permutation,
+                       const uint64_t size,
+                       const uint64_t seed);
+void copyColumn(uint8_t* target,
+                const uint8_t* column,
+                const uint64_t columnPos,
+                const uint64_t numberOfColumns,
+                const uint64_t numberOfRows,
+                const uint64_t valueSize,
+                const bool columnBlocked);
+void copyRowsPart(uint8_t* target,
+                  const uint8_t* part,
+                  const uint64_t firstRow,
+                  const uint64_t partRows,
+                  const uint64_t totalRows,
+                  const uint64_t numberOfColumns,
+                  const uint64_t valueSize,
+                  const bool columnBlocked);
+
+DataSetFile::Encoding getEncodingFromName(const std::string &name);
+DataSetFile::DataType getDataTypeFromName(const std::string &name);
+const std::string getDataTypeName(const DataSetFile::DataType dataType);
+
+DataSetFile* readDataSetFile(const std::string &filePath,
+                             Kitsunemimi::ErrorContainer &error);
 
 #endif // SHIORIARCHIVE_DATASETFILE_H
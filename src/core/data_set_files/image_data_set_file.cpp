@@ -32,48 +32,76 @@
 ImageDataSetFile::ImageDataSetFile(const std::string &filePath)
     : DataSetFile(filePath) {}
 
-/**
- * @brief constructor
- *
- * @param file pointer to binary-file object
- */
-ImageDataSetFile::ImageDataSetFile(Kitsunemimi::BinaryFile* file)
-    : DataSetFile(file) {}
-
 /**
  * @brief destructor
  */
 ImageDataSetFile::~ImageDataSetFile() {}
 
 /**
- * @brief init header-sizes
+ * @brief init sections and header-sizes
  */
 void
 ImageDataSetFile::initHeader()
 {
-    m_headerSize = sizeof(DataSetHeader) + sizeof(ImageTypeHeader);
+    const uint64_t lineSize = (imageHeader.numberOfInputsX * imageHeader.numberOfInputsY)
+                              + imageHeader.numberOfOutputs;
 
-    uint64_t lineSize = (imageHeader.numberOfInputsX * imageHeader.numberOfInputsY)
-                        + imageHeader.numberOfOutputs;
-    m_totalFileSize = m_headerSize + (lineSize * imageHeader.numberOfImages * sizeof(float));
+    m_lineSize = lineSize;
+    m_scales = {imageHeader.scale};
+    m_zeroPoints = {imageHeader.zeroPoint};
+
+    addSection(TYPE_HEADER_SECTION, sizeof(ImageTypeHeader), 1);
+    addSection(PAYLOAD_SECTION, getValueSize(), lineSize * imageHeader.numberOfImages);
+    finishSections();
 }
 
 /**
- * @brief read header from buffer
+ * @brief read header from file
+ *
+ * @param error reference for error-output
  *
- * @param u8buffer buffer to read
+ * @return true, if successful, else false
  */
-void
-ImageDataSetFile::readHeader(const uint8_t* u8buffer)
+bool
+ImageDataSetFile::readHeader(Kitsunemimi::ErrorContainer &error)
 {
     // read image-header
-    m_headerSize = sizeof(DataSetHeader) + sizeof(ImageTypeHeader);
-    memcpy(&imageHeader, &u8buffer[sizeof(DataSetHeader)], sizeof(ImageTypeHeader));
+    if(readSection(TYPE_HEADER_SECTION, &imageHeader, sizeof(ImageTypeHeader), 1, error) == false)
+    {
+        error.addMeesage("Failed to read image-header");
+        return false;
+    }
 
     // get sizes
-    uint64_t lineSize = (imageHeader.numberOfInputsX * imageHeader.numberOfInputsY)
-                        + imageHeader.numberOfOutputs;
-    m_totalFileSize = m_headerSize + (lineSize * imageHeader.numberOfImages * sizeof(float));
+    const uint64_t lineSize = (imageHeader.numberOfInputsX * imageHeader.numberOfInputsY)
+                              + imageHeader.numberOfOutputs;
+    const uint64_t numberOfValues = lineSize * imageHeader.numberOfImages;
+    const uint64_t payloadSize = numberOfValues * getValueSize();
+    m_lineSize = lineSize;
+    m_scales = {imageHeader.scale};
+    m_zeroPoints = {imageHeader.zeroPoint};
+
+    // in version 1 the payload directly follows the image-header
+    if(m_fileVersion == 1)
+    {
+        addSection(PAYLOAD_SECTION,
+                   sizeof(float),
+                   numberOfValues,
+                   sizeof(DataSetHeaderV1) + V1_IMAGE_HEADER_SIZE);
+    }
+
+    const SectionEntry* payload = getSection(PAYLOAD_SECTION);
+    if(payload == nullptr
+            || (encoding == RAW_ENCODING && payload->size < payloadSize))
+    {
+        error.addMeesage("Payload-section of image-data-set is missing or too small");
+        return false;
+    }
+
+    m_headerSize = payload->offset;
+    m_totalFileSize = m_headerSize + payloadSize;
+
+    return true;
 }
 
 /**
@@ -84,12 +112,21 @@ ImageDataSetFile::readHeader(const uint8_t* u8buffer)
 bool
 ImageDataSetFile::updateHeader()
 {
-    // write image-header to file
     Kitsunemimi::ErrorContainer error;
-    if(m_targetFile->writeDataIntoFile(&imageHeader,
-                                       sizeof(DataSetHeader),
-                                       sizeof(ImageTypeHeader),
-                                       error) == false)
+
+    // the quantization can be updated until the first values are written
+    m_scales = {imageHeader.scale};
+    m_zeroPoints = {imageHeader.zeroPoint};
+
+    // write remaining blocks of compressed payload
+    if(finishBlocks(error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // write image-header to file
+    if(writeSection(TYPE_HEADER_SECTION, &imageHeader, sizeof(ImageTypeHeader), 1, error) == false)
     {
         LOG_ERROR(error);
         return false;
@@ -99,22 +136,244 @@ ImageDataSetFile::updateHeader()
 }
 
 /**
- * @brief get pointer to payload of a file
+ * @brief get pointer to payload of a file, converted into floats
+ *
+ * @param payloadSize reference for size of the read payload
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+float*
+ImageDataSetFile::getPayload(uint64_t &payloadSize,
+                             const std::string &)
+{
+    return getPayload(payloadSize, 0, imageHeader.numberOfImages);
+}
+
+/**
+ * @brief get pointer to payload of a file in the data-type, in which it is stored
  *
  * @param payloadSize reference for size of the read payload
  *
- * @return pointer to the payload
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+ImageDataSetFile::getCompactPayload(uint64_t &payloadSize,
+                                    const std::string &)
+{
+    return getCompactPayload(payloadSize, 0, imageHeader.numberOfImages);
+}
+
+/**
+ * @brief get view on the payload within the mapped file without copying it
+ *
+ * @param view reference for the resulting view
+ *
+ * @return false, if file is not mapped, else true
+ */
+bool
+ImageDataSetFile::getPayloadView(PayloadView &view,
+                                 const std::string &)
+{
+    return getPayloadView(view, 0, imageHeader.numberOfImages);
+}
+
+/**
+ * @brief get pointer to a range of images of the payload, converted into floats
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first image
+ * @param numberOfRows number of images to read
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
  */
 float*
 ImageDataSetFile::getPayload(uint64_t &payloadSize,
+                             const uint64_t startRow,
+                             const uint64_t numberOfRows,
                              const std::string &)
 {
-    payloadSize = m_totalFileSize - m_headerSize;
-    float* payload = new float[payloadSize / sizeof(float)];
+    const uint64_t numberOfValues = getRowsInRange(startRow, numberOfRows) * m_lineSize;
+    payloadSize = numberOfValues * sizeof(float);
+    float* payload = new float[numberOfValues];
     Kitsunemimi::ErrorContainer error;
-    if(m_targetFile->readDataFromFile(payload, m_headerSize, payloadSize, error) == false) {
+
+    // float32-payloads can be read without conversion
+    if(dataType == FLOAT32_DTYPE)
+    {
+        if(readPayload(payload, startRow * m_lineSize * sizeof(float), payloadSize, error) == false)
+        {
+            LOG_ERROR(error);
+            delete[] payload;
+            return nullptr;
+        }
+        return payload;
+    }
+
+    uint64_t compactSize = 0;
+    uint8_t* compactPayload = getCompactPayload(compactSize, startRow, numberOfRows);
+    if(compactPayload == nullptr)
+    {
+        delete[] payload;
+        return nullptr;
+    }
+    decodeValues(payload, compactPayload, numberOfValues, startRow * m_lineSize);
+    delete[] compactPayload;
+
+    return payload;
+}
+
+/**
+ * @brief get pointer to a range of images of the payload in the data-type, in which it is stored
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first image
+ * @param numberOfRows number of images to read
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+ImageDataSetFile::getCompactPayload(uint64_t &payloadSize,
+                                    const uint64_t startRow,
+                                    const uint64_t numberOfRows,
+                                    const std::string &)
+{
+    const uint64_t rowSize = m_lineSize * getValueSize();
+    payloadSize = getRowsInRange(startRow, numberOfRows) * rowSize;
+    uint8_t* payload = new uint8_t[payloadSize];
+    Kitsunemimi::ErrorContainer error;
+    if(readPayload(payload, startRow * rowSize, payloadSize, error) == false)
+    {
         LOG_ERROR(error);
-        // TODO: handle error
+        delete[] payload;
+        return nullptr;
     }
     return payload;
 }
+
+/**
+ * @brief get view on a range of images within the mapped file without copying it
+ *
+ * @param view reference for the resulting view
+ * @param startRow number of the first image
+ * @param numberOfRows number of images
+ *
+ * @return false, if file is not mapped, else true
+ */
+bool
+ImageDataSetFile::getPayloadView(PayloadView &view,
+                                 const uint64_t startRow,
+                                 const uint64_t numberOfRows,
+                                 const std::string &)
+{
+    const uint64_t rowSize = m_lineSize * getValueSize();
+    const uint64_t payloadSize = getRowsInRange(startRow, numberOfRows) * rowSize;
+    view.data = getMappedData(m_headerSize + startRow * rowSize, payloadSize);
+    if(view.data == nullptr) {
+        return false;
+    }
+
+    view.size = payloadSize;
+    view.dataType = dataType;
+    return true;
+}
+
+/**
+ * @brief gather a list of images in the given order into one buffer, converted into floats
+ *
+ * @param payloadSize reference for size of the gathered payload
+ * @param rows numbers of the images to gather
+ *
+ * @return pointer to the gathered payload, nullptr if reading the file failed
+ */
+float*
+ImageDataSetFile::gatherPayload(uint64_t &payloadSize,
+                                const std::vector<uint64_t> &rows,
+                                const std::string &)
+{
+    const uint64_t numberOfValues = rows.size() * m_lineSize;
+    payloadSize = numberOfValues * sizeof(float);
+    float* payload = new float[numberOfValues];
+    Kitsunemimi::ErrorContainer error;
+
+    // float32-payloads can be gathered without conversion
+    if(dataType == FLOAT32_DTYPE)
+    {
+        const uint64_t rowSize = m_lineSize * sizeof(float);
+        uint8_t* target = reinterpret_cast<uint8_t*>(payload);
+        if(gatherPayloadData(target, rows, rowSize, 0, rowSize, error) == false)
+        {
+            error.addMeesage("Failed to gather images of image-data-set");
+            LOG_ERROR(error);
+            delete[] payload;
+            payloadSize = 0;
+            return nullptr;
+        }
+        return payload;
+    }
+
+    uint64_t compactSize = 0;
+    uint8_t* compactPayload = gatherCompactPayload(compactSize, rows);
+    if(compactPayload == nullptr)
+    {
+        delete[] payload;
+        payloadSize = 0;
+        return nullptr;
+    }
+
+    decodeValues(payload, compactPayload, numberOfValues, static_cast<uint64_t>(0));
+    delete[] compactPayload;
+
+    return payload;
+}
+
+/**
+ * @brief gather a list of images in the given order into one buffer in the data-type, in which
+ *        they are stored
+ *
+ * @param payloadSize reference for size of the gathered payload
+ * @param rows numbers of the images to gather
+ *
+ * @return pointer to the gathered payload, nullptr if reading the file failed
+ */
+uint8_t*
+ImageDataSetFile::gatherCompactPayload(uint64_t &payloadSize,
+                                       const std::vector<uint64_t> &rows,
+                                       const std::string &)
+{
+    const uint64_t rowSize = m_lineSize * getValueSize();
+    payloadSize = rows.size() * rowSize;
+    uint8_t* payload = new uint8_t[payloadSize];
+    Kitsunemimi::ErrorContainer error;
+    if(gatherPayloadData(payload, rows, rowSize, 0, rowSize, error) == false)
+    {
+        error.addMeesage("Failed to gather images of image-data-set");
+        LOG_ERROR(error);
+        delete[] payload;
+        payloadSize = 0;
+        return nullptr;
+    }
+    return payload;
+}
+
+/**
+ * @brief get number of images within the file
+ *
+ * @return number of images
+ */
+uint64_t
+ImageDataSetFile::getNumberOfRows() const
+{
+    return imageHeader.numberOfImages;
+}
+
+/**
+ * @brief get number of values of each row within a payload, which are the inputs and outputs
+ *        of an image
+ *
+ * @return number of values of a row
+ */
+uint64_t
+ImageDataSetFile::getValuesPerRow() const
+{
+    return m_lineSize;
+}
@@ -30,17 +30,40 @@ class ImageDataSetFile
 {
 public:
     ImageDataSetFile(const std::string &filePath);
-    ImageDataSetFile(Kitsunemimi::BinaryFile* file);
     ~ImageDataSetFile();
     bool updateHeader();
     float* getPayload(uint64_t &payloadSize,
                       const std::string &columnName = "");
+    uint8_t* getCompactPayload(uint64_t &payloadSize,
+                               const std::string &columnName = "");
+    bool getPayloadView(PayloadView &view,
+                        const std::string &columnName = "");
+    float* getPayload(uint64_t &payloadSize,
+                      const uint64_t startRow,
+                      const uint64_t numberOfRows,
+                      const std::string &columnName = "");
+    uint8_t* getCompactPayload(uint64_t &payloadSize,
+                               const uint64_t startRow,
+                               const uint64_t numberOfRows,
+                               const std::string &columnName = "");
+    bool getPayloadView(PayloadView &view,
+                        const uint64_t startRow,
+                        const uint64_t numberOfRows,
+                        const std::string &columnName = "");
+    float* gatherPayload(uint64_t &payloadSize,
+                         const std::vector<uint64_t> &rows,
+                         const std::string &columnName = "");
+    uint8_t* gatherCompactPayload(uint64_t &payloadSize,
+                                  const std::vector<uint64_t> &rows,
+                                  const std::string &columnName = "");
+    uint64_t getNumberOfRows() const;
+    uint64_t getValuesPerRow() const;
 
     ImageTypeHeader imageHeader;
 
 protected:
     void initHeader();
-    void readHeader(const uint8_t* u8buffer);
+    bool readHeader(Kitsunemimi::ErrorContainer &error);
 };
 
 #endif // SHIORIARCHIVE_IMAGEDATASETFILE_H
@@ -24,6 +24,8 @@
 
 #include <libKitsunemimiCommon/files/binary_file.h>
 
+#include <core/data_set_files/value_conversion.h>
+
 /**
  * @brief constructor
  *
@@ -32,59 +34,146 @@
 TableDataSetFile::TableDataSetFile(const std::string &filePath)
     : DataSetFile(filePath) {}
 
-/**
- * @brief constructor
- *
- * @param file pointer to binary-file object
- */
-TableDataSetFile::TableDataSetFile(Kitsunemimi::BinaryFile* file)
-    : DataSetFile(file) {}
-
 /**
  * @brief destructor
  */
 TableDataSetFile::~TableDataSetFile() {}
 
 /**
- * @brief init header-sizes
+ * @brief init sections and header-sizes
  */
 void
 TableDataSetFile::initHeader()
 {
-    m_headerSize = sizeof(DataSetHeader) + sizeof(TableTypeHeader);
-    m_headerSize += tableColumns.size() * sizeof(TableHeaderEntry);
-
     tableHeader.numberOfColumns = tableColumns.size();
-    m_totalFileSize = m_headerSize;
-    m_totalFileSize += tableHeader.numberOfColumns * sizeof(float) * tableHeader.numberOfLines;
+    m_lineSize = tableHeader.numberOfColumns;
+    updateScales();
+
+    const uint64_t valueSize = getValueSize();
+    addSection(TYPE_HEADER_SECTION, sizeof(TableTypeHeader), 1);
+    addSection(COLUMN_SECTION, sizeof(TableHeaderEntry), tableHeader.numberOfColumns);
+
+    // in columnar layout each column is stored as one contiguous block, which has space for the
+    // number of lines, which is set at this point. Each block starts at a page-boundary and the
+    // offsets of these blocks are stored as additional section.
+    columnOffsets.clear();
+    if(isColumnar())
+    {
+        const uint64_t blockSize = alignSize(tableHeader.numberOfLines * valueSize, 4096);
+        addSection(COLUMN_OFFSET_SECTION, sizeof(uint64_t), tableHeader.numberOfColumns);
+        addSection(PAYLOAD_SECTION,
+                   valueSize,
+                   (tableHeader.numberOfColumns * blockSize) / valueSize);
+        finishSections();
+
+        for(uint64_t i = 0; i < tableHeader.numberOfColumns; i++) {
+            columnOffsets.push_back(m_headerSize + (i * blockSize));
+        }
+    }
+    else
+    {
+        addSection(PAYLOAD_SECTION,
+                   valueSize,
+                   tableHeader.numberOfColumns * tableHeader.numberOfLines);
+        finishSections();
+    }
 }
 
 /**
- * @brief read header from buffer
- *
- * @param u8buffer buffer to read
+ * @brief create the sections of a file of version 1, where all parts directly follow each other
  */
 void
-TableDataSetFile::readHeader(const uint8_t* u8buffer)
+TableDataSetFile::addV1Sections()
+{
+    uint64_t offset = sizeof(DataSetHeaderV1) + V1_TABLE_HEADER_SIZE;
+    addSection(COLUMN_SECTION, V1_TABLE_ENTRY_SIZE, tableHeader.numberOfColumns, offset);
+    offset += tableHeader.numberOfColumns * V1_TABLE_ENTRY_SIZE;
+
+    if(isColumnar())
+    {
+        addSection(COLUMN_OFFSET_SECTION, sizeof(uint64_t), tableHeader.numberOfColumns, offset);
+        offset += tableHeader.numberOfColumns * sizeof(uint64_t);
+    }
+
+    addSection(PAYLOAD_SECTION,
+               sizeof(float),
+               tableHeader.numberOfColumns * tableHeader.numberOfLines,
+               offset);
+}
+
+/**
+ * @brief read header from file
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+TableDataSetFile::readHeader(Kitsunemimi::ErrorContainer &error)
 {
     // read table-header
-    m_headerSize = sizeof(DataSetHeader) + sizeof(TableTypeHeader);
-    memcpy(&tableHeader, &u8buffer[sizeof(DataSetHeader)], sizeof(TableTypeHeader));
+    if(readSection(TYPE_HEADER_SECTION, &tableHeader, sizeof(TableTypeHeader), 1, error) == false)
+    {
+        error.addMeesage("Failed to read table-header");
+        return false;
+    }
 
-    // header header
-    for(uint64_t i = 0; i < tableHeader.numberOfColumns; i++)
+    m_lineSize = tableHeader.numberOfColumns;
+    if(m_fileVersion == 1) {
+        addV1Sections();
+    }
+
+    // read all column-entries at once
+    tableColumns.clear();
+    tableColumns.resize(tableHeader.numberOfColumns);
+    if(tableHeader.numberOfColumns > 0
+            && readSection(COLUMN_SECTION,
+                           &tableColumns[0],
+                           sizeof(TableHeaderEntry),
+                           tableHeader.numberOfColumns,
+                           error) == false)
     {
-        TableHeaderEntry entry;
-        memcpy(&entry,
-               &u8buffer[m_headerSize + (i * sizeof(TableHeaderEntry))],
-               sizeof(TableHeaderEntry));
-        tableColumns.push_back(entry);
+        error.addMeesage("Failed to read column-entries of the table-header");
+        return false;
+    }
+    for(TableHeaderEntry &entry : tableColumns) {
+        entry.name[255] = '\0';
+    }
+    updateScales();
+
+    // read offsets of the column-blocks
+    columnOffsets.clear();
+    if(isColumnar()
+            && tableHeader.numberOfColumns > 0)
+    {
+        columnOffsets.resize(tableHeader.numberOfColumns);
+        if(readSection(COLUMN_OFFSET_SECTION,
+                       &columnOffsets[0],
+                       sizeof(uint64_t),
+                       tableHeader.numberOfColumns,
+                       error) == false)
+        {
+            error.addMeesage("Failed to read column-offsets of the table-header");
+            return false;
+        }
     }
 
     // get sizes
-    m_headerSize += tableHeader.numberOfColumns * sizeof(TableHeaderEntry);
+    const SectionEntry* payload = getSection(PAYLOAD_SECTION);
+    if(payload == nullptr)
+    {
+        error.addMeesage("Table-data-set has no payload-section");
+        return false;
+    }
+    m_headerSize = payload->offset;
+    const uint64_t valueSize = getValueSize();
     m_totalFileSize = m_headerSize;
-    m_totalFileSize += tableHeader.numberOfColumns * sizeof(float) * tableHeader.numberOfLines;
+    m_totalFileSize += tableHeader.numberOfColumns * valueSize * tableHeader.numberOfLines;
+    if(columnOffsets.size() > 0) {
+        m_totalFileSize = columnOffsets.back() + tableHeader.numberOfLines * valueSize;
+    }
+
+    return true;
 }
 
 /**
@@ -95,119 +184,903 @@ TableDataSetFile::readHeader(const uint8_t* u8buffer)
 bool
 TableDataSetFile::updateHeader()
 {
-    // write table-header to file
     Kitsunemimi::ErrorContainer error;
-    if(m_targetFile->writeDataIntoFile(&tableHeader,
-                                       sizeof(DataSetHeader),
-                                       sizeof(TableTypeHeader),
-                                       error) == false)
+
+    // the quantization can be updated until the first values are written
+    updateScales();
+
+    // write remaining blocks of compressed payload
+    if(finishBlocks(error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // write table-header to file
+    if(writeSection(TYPE_HEADER_SECTION, &tableHeader, sizeof(TableTypeHeader), 1, error) == false)
     {
         LOG_ERROR(error);
         return false;
     }
 
     // write table-header-entries to file
-    const uint64_t offset = sizeof(DataSetHeader) + sizeof(TableTypeHeader);
-    for(uint64_t i = 0; i < tableColumns.size(); i++)
+    if(tableColumns.size() > 0
+            && writeSection(COLUMN_SECTION,
+                            &tableColumns[0],
+                            sizeof(TableHeaderEntry),
+                            tableColumns.size(),
+                            error) == false)
     {
-        if(m_targetFile->writeDataIntoFile(&tableColumns[i],
-                                           offset + (i * sizeof(TableHeaderEntry)),
-                                           sizeof(TableHeaderEntry),
-                                           error) == false)
-        {
-            LOG_ERROR(error);
-            return false;
-        }
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // write offsets of the column-blocks to file
+    if(columnOffsets.size() > 0
+            && writeSection(COLUMN_OFFSET_SECTION,
+                            &columnOffsets[0],
+                            sizeof(uint64_t),
+                            columnOffsets.size(),
+                            error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
     }
 
     return true;
 }
 
 /**
- * @brief get pointer to payload of a file
+ * @brief get pointer to payload of a column, converted into floats
  *
  * @param payloadSize reference for size of the read payload
+ * @param columnName name of the column to read
  *
- * @return pointer to the payload
+ * @return pointer to the payload, or nullptr, if reading failed
  */
 float*
 TableDataSetFile::getPayload(uint64_t &payloadSize,
                              const std::string &columnName)
+{
+    return getPayload(payloadSize, 0, tableHeader.numberOfLines, columnName);
+}
+
+/**
+ * @brief get pointer to payload of a column in the data-type, in which it is stored
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param columnName name of the column to read
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+TableDataSetFile::getCompactPayload(uint64_t &payloadSize,
+                                    const std::string &columnName)
+{
+    return getCompactPayload(payloadSize, 0, tableHeader.numberOfLines, columnName);
+}
+
+/**
+ * @brief get view on the payload of a column within the mapped file without copying it. This is
+ *        only possible for tables in columnar layout, because only there the values of a column
+ *        are stored contiguous.
+ *
+ * @param view reference for the resulting view
+ * @param columnName name of the column
+ *
+ * @return false, if file is not mapped or not in columnar layout, else true
+ */
+bool
+TableDataSetFile::getPayloadView(PayloadView &view,
+                                 const std::string &columnName)
+{
+    return getPayloadView(view, 0, tableHeader.numberOfLines, columnName);
+}
+
+/**
+ * @brief get pointer to a range of lines of a column, converted into floats
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first line
+ * @param numberOfRows number of lines to read
+ * @param columnName name of the column to read
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+float*
+TableDataSetFile::getPayload(uint64_t &payloadSize,
+                             const uint64_t startRow,
+                             const uint64_t numberOfRows,
+                             const std::string &columnName)
+{
+    const uint64_t columnPos = getColumnPos(columnName);
+    const uint64_t numberOfLines = getRowsInRange(startRow, numberOfRows);
+    payloadSize = numberOfLines * sizeof(float);
+    float* columnData = new float[numberOfLines];
+
+    uint64_t compactSize = 0;
+    uint8_t* compactData = getCompactPayload(compactSize, startRow, numberOfRows, columnName);
+    if(compactData == nullptr)
+    {
+        delete[] columnData;
+        return nullptr;
+    }
+
+    decodeValues(columnData,
+                 compactData,
+                 numberOfLines,
+                 tableColumns[columnPos].scale,
+                 tableColumns[columnPos].zeroPoint);
+    delete[] compactData;
+
+    return columnData;
+}
+
+/**
+ * @brief get pointer to a range of lines of a column in the data-type, in which it is stored
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first line
+ * @param numberOfRows number of lines to read
+ * @param columnName name of the column to read
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+TableDataSetFile::getCompactPayload(uint64_t &payloadSize,
+                                    const uint64_t startRow,
+                                    const uint64_t numberOfRows,
+                                    const std::string &columnName)
 {
     Kitsunemimi::ErrorContainer error;
 
-    float* payload = new float[(m_totalFileSize - m_headerSize) / sizeof(float)];
-    if(m_targetFile->readDataFromFile(payload,
-                                      m_headerSize,
-                                      m_totalFileSize - m_headerSize,
-                                      error) == false)
+    const uint64_t valueSize = getValueSize();
+    const uint64_t columnPos = getColumnPos(columnName);
+    const uint64_t numberOfLines = getRowsInRange(startRow, numberOfRows);
+    payloadSize = numberOfLines * valueSize;
+    uint8_t* columnData = new uint8_t[payloadSize];
+
+    // in columnar layout the range can be read directly as one block
+    if(isColumnar())
+    {
+        const uint64_t offset = columnOffsets[columnPos] + startRow * valueSize;
+        if(readFileData(columnData, offset, payloadSize, error) == false)
+        {
+            LOG_ERROR(error);
+            delete[] columnData;
+            return nullptr;
+        }
+        return columnData;
+    }
+
+    // gather the column directly from the mapped file
+    const uint64_t lineSize = tableHeader.numberOfColumns * valueSize;
+    const uint8_t* payload = getMappedData(m_headerSize + startRow * lineSize,
+                                           numberOfLines * lineSize);
+    if(payload != nullptr)
+    {
+        for(uint64_t line = 0; line < numberOfLines; line++)
+        {
+            memcpy(&columnData[line * valueSize],
+                   &payload[line * lineSize + columnPos * valueSize],
+                   valueSize);
+        }
+
+        return columnData;
+    }
+
+    // fallback for not mapped or compressed files, which reads only the requested lines
+    uint8_t* linesData = new uint8_t[numberOfLines * lineSize];
+    if(readPayload(linesData, startRow * lineSize, numberOfLines * lineSize, error) == false)
     {
-        //TODO: handle error
         LOG_ERROR(error);
+        delete[] linesData;
+        delete[] columnData;
+        return nullptr;
+    }
+
+    for(uint64_t line = 0; line < numberOfLines; line++)
+    {
+        memcpy(&columnData[line * valueSize],
+               &linesData[line * lineSize + columnPos * valueSize],
+               valueSize);
+    }
+
+    delete[] linesData;
+
+    return columnData;
+}
+
+/**
+ * @brief get view on a range of lines of a column within the mapped file without copying it.
+ *        Like the complete column, this is only possible for tables in columnar layout or for
+ *        tables with only one column, where the lines are contiguous in both layouts.
+ *
+ * @param view reference for the resulting view
+ * @param startRow number of the first line
+ * @param numberOfRows number of lines
+ * @param columnName name of the column
+ *
+ * @return false, if file is not mapped or the values of the column are not contiguous,
+ *         else true
+ */
+bool
+TableDataSetFile::getPayloadView(PayloadView &view,
+                                 const uint64_t startRow,
+                                 const uint64_t numberOfRows,
+                                 const std::string &columnName)
+{
+    if(isColumnar() == false
+            && tableColumns.size() != 1)
+    {
+        return false;
+    }
+
+    const uint64_t valueSize = getValueSize();
+    const uint64_t columnPos = getColumnPos(columnName);
+    const uint64_t payloadSize = getRowsInRange(startRow, numberOfRows) * valueSize;
+    uint64_t columnOffset = m_headerSize;
+    if(isColumnar()) {
+        columnOffset = columnOffsets[columnPos];
+    }
+    view.data = getMappedData(columnOffset + startRow * valueSize, payloadSize);
+    if(view.data == nullptr) {
+        return false;
+    }
+
+    view.size = payloadSize;
+    view.dataType = dataType;
+    return true;
+}
+
+/**
+ * @brief get multiple columns of a range of lines in one buffer, converted into floats
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first line
+ * @param numberOfRows number of lines to read
+ * @param columnNames names of the columns to read
+ * @param columnBlocked true to place the values of each column contiguous one after another,
+ *                      false to interleave the columns line by line
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+float*
+TableDataSetFile::getColumnsPayload(uint64_t &payloadSize,
+                                    const uint64_t startRow,
+                                    const uint64_t numberOfRows,
+                                    const std::vector<std::string> &columnNames,
+                                    const bool columnBlocked)
+{
+    const uint64_t valueSize = getValueSize();
+    const uint64_t numberOfLines = getRowsInRange(startRow, numberOfRows);
+    const uint64_t numberOfColumns = columnNames.size();
+    payloadSize = numberOfLines * numberOfColumns * sizeof(float);
+    float* payload = new float[numberOfLines * numberOfColumns];
+
+    // read the columns blocked, because each column has its own quantization-parameters
+    uint64_t compactSize = 0;
+    uint8_t* compactData = getCompactColumnsPayload(compactSize,
+                                                    startRow,
+                                                    numberOfRows,
+                                                    columnNames,
+                                                    true);
+    if(compactData == nullptr)
+    {
+        delete[] payload;
+        return nullptr;
+    }
+
+    std::vector<float> columnData(numberOfLines);
+    for(uint64_t i = 0; i < numberOfColumns; i++)
+    {
+        const uint64_t columnPos = getColumnPos(columnNames[i]);
+        float* target = &columnData[0];
+        if(columnBlocked) {
+            target = &payload[i * numberOfLines];
+        }
+
+        decodeValues(target,
+                     &compactData[i * numberOfLines * valueSize],
+                     numberOfLines,
+                     tableColumns[columnPos].scale,
+                     tableColumns[columnPos].zeroPoint);
+
+        if(columnBlocked == false)
+        {
+            copyColumn(reinterpret_cast<uint8_t*>(payload),
+                       reinterpret_cast<const uint8_t*>(target),
+                       i,
+                       numberOfColumns,
+                       numberOfLines,
+                       sizeof(float),
+                       false);
+        }
+    }
+    delete[] compactData;
+
+    return payload;
+}
+
+/**
+ * @brief get multiple columns of a range of lines in one buffer in the data-type, in which they
+ *        are stored. In columnar layout each column is read with a single ranged read, while in
+ *        row-major layout all columns are gathered in a single pass over the lines, instead of
+ *        reading the lines again for each column.
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first line
+ * @param numberOfRows number of lines to read
+ * @param columnNames names of the columns to read
+ * @param columnBlocked true to place the values of each column contiguous one after another,
+ *                      false to interleave the columns line by line
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+TableDataSetFile::getCompactColumnsPayload(uint64_t &payloadSize,
+                                           const uint64_t startRow,
+                                           const uint64_t numberOfRows,
+                                           const std::vector<std::string> &columnNames,
+                                           const bool columnBlocked)
+{
+    Kitsunemimi::ErrorContainer error;
+
+    const uint64_t valueSize = getValueSize();
+    const uint64_t numberOfLines = getRowsInRange(startRow, numberOfRows);
+    const uint64_t numberOfColumns = columnNames.size();
+    payloadSize = numberOfLines * numberOfColumns * valueSize;
+    uint8_t* payload = new uint8_t[payloadSize];
+
+    std::vector<uint64_t> columnPositions;
+    for(const std::string &columnName : columnNames) {
+        columnPositions.push_back(getColumnPos(columnName));
+    }
+
+    // in columnar layout the range of each column can be read directly as one block
+    if(isColumnar())
+    {
+        std::vector<uint8_t> columnData(numberOfLines * valueSize);
+        for(uint64_t i = 0; i < numberOfColumns; i++)
+        {
+            uint8_t* target = &columnData[0];
+            if(columnBlocked) {
+                target = &payload[i * numberOfLines * valueSize];
+            }
+
+            const uint64_t offset = columnOffsets[columnPositions[i]] + startRow * valueSize;
+            if(readFileData(target, offset, numberOfLines * valueSize, error) == false)
+            {
+                LOG_ERROR(error);
+                delete[] payload;
+                return nullptr;
+            }
+
+            if(columnBlocked == false) {
+                copyColumn(payload, target, i, numberOfColumns, numberOfLines, valueSize, false);
+            }
+        }
+
         return payload;
     }
 
-    uint64_t columnPos = 0;
-    for(uint64_t i = 0; i < tableColumns.size(); i++)
+    // get the lines directly from the mapped file or read them once for all columns
+    const uint64_t lineSize = tableHeader.numberOfColumns * valueSize;
+    const uint8_t* lines = getMappedData(m_headerSize + startRow * lineSize,
+                                         numberOfLines * lineSize);
+    uint8_t* linesData = nullptr;
+    if(lines == nullptr)
     {
-        if(tableColumns[i].name == columnName) {
-            columnPos = i;
+        linesData = new uint8_t[numberOfLines * lineSize];
+        if(readPayload(linesData, startRow * lineSize, numberOfLines * lineSize, error) == false)
+        {
+            LOG_ERROR(error);
+            delete[] linesData;
+            delete[] payload;
+            return nullptr;
         }
+        lines = linesData;
     }
 
-    payloadSize = tableHeader.numberOfLines * sizeof(float);
-    float* filteredData = new float[tableHeader.numberOfLines];
-    for(uint64_t line = 0; line < tableHeader.numberOfLines; line++) {
-        filteredData[line] = payload[line * tableHeader.numberOfColumns + columnPos];
+    for(uint64_t line = 0; line < numberOfLines; line++)
+    {
+        const uint8_t* lineData = &lines[line * lineSize];
+        for(uint64_t i = 0; i < numberOfColumns; i++)
+        {
+            uint64_t targetPos = line * numberOfColumns + i;
+            if(columnBlocked) {
+                targetPos = i * numberOfLines + line;
+            }
+            memcpy(&payload[targetPos * valueSize],
+                   &lineData[columnPositions[i] * valueSize],
+                   valueSize);
+        }
     }
 
-    delete[] payload;
+    if(linesData != nullptr) {
+        delete[] linesData;
+    }
 
-    return filteredData;
+    return payload;
 }
 
 /**
- * @brief print-function for manually debugging only
+ * @brief get names of the columns of a group
+ *
+ * @param columnNames reference for the list, where the names are appended
+ * @param group group of the columns
  */
 void
-TableDataSetFile::print()
+TableDataSetFile::getColumnNames(std::vector<std::string> &columnNames,
+                                 const ColumnGroup group) const
 {
-    std::cout<<"======================================================="<<std::endl;
-    std::cout<<"====================    PRINT    ======================"<<std::endl;
-    std::cout<<"======================================================="<<std::endl;
-    std::cout<<std::endl;
+    for(const TableHeaderEntry &entry : tableColumns)
+    {
+        if(group == ALL_COLUMNS
+                || (group == INPUT_COLUMNS && entry.isInput)
+                || (group == OUTPUT_COLUMNS && entry.isOutput))
+        {
+            columnNames.push_back(entry.name);
+        }
+    }
+}
+
+/**
+ * @brief get the factor of a column, with which its values should be scaled
+ *
+ * @param columnName name of the column
+ *
+ * @return multiplicator of the column, or 1.0 if the column doesn't exist
+ */
+float
+TableDataSetFile::getColumnMultiplicator(const std::string &columnName) const
+{
+    for(const TableHeaderEntry &entry : tableColumns)
+    {
+        if(entry.name == columnName) {
+            return entry.multiplicator;
+        }
+    }
+
+    return 1.0f;
+}
+
+/**
+ * @brief gather a list of lines of a column in the given order into one buffer, converted into
+ *        floats
+ *
+ * @param payloadSize reference for size of the gathered payload
+ * @param rows numbers of the lines to gather
+ * @param columnName name of the column
+ *
+ * @return pointer to the gathered payload, nullptr if reading the file failed
+ */
+float*
+TableDataSetFile::gatherPayload(uint64_t &payloadSize,
+                                const std::vector<uint64_t> &rows,
+                                const std::string &columnName)
+{
+    const uint64_t columnPos = getColumnPos(columnName);
+    payloadSize = rows.size() * sizeof(float);
+    float* columnData = new float[rows.size()];
 
+    uint64_t compactSize = 0;
+    uint8_t* compactData = gatherCompactPayload(compactSize, rows, columnName);
+    if(compactData == nullptr)
+    {
+        delete[] columnData;
+        payloadSize = 0;
+        return nullptr;
+    }
+
+    decodeValues(columnData,
+                 compactData,
+                 rows.size(),
+                 tableColumns[columnPos].scale,
+                 tableColumns[columnPos].zeroPoint);
+    delete[] compactData;
+
+    return columnData;
+}
+
+/**
+ * @brief gather a list of lines of a column in the given order into one buffer in the data-type,
+ *        in which they are stored
+ *
+ * @param payloadSize reference for size of the gathered payload
+ * @param rows numbers of the lines to gather
+ * @param columnName name of the column
+ *
+ * @return pointer to the gathered payload, nullptr if reading the file failed
+ */
+uint8_t*
+TableDataSetFile::gatherCompactPayload(uint64_t &payloadSize,
+                                       const std::vector<uint64_t> &rows,
+                                       const std::string &columnName)
+{
     Kitsunemimi::ErrorContainer error;
 
-    Kitsunemimi::DataBuffer completeFile;
-    if(m_targetFile->readCompleteFile(completeFile, error) == false)
+    const uint64_t valueSize = getValueSize();
+    const uint64_t columnPos = getColumnPos(columnName);
+    payloadSize = rows.size() * valueSize;
+    uint8_t* columnData = new uint8_t[payloadSize];
+
+    // in columnar layout the values of the column are contiguous, else they are strided by the
+    // size of a complete line
+    uint64_t rowSize = tableHeader.numberOfColumns * valueSize;
+    uint64_t firstByte = columnPos * valueSize;
+    if(isColumnar())
+    {
+        rowSize = valueSize;
+        firstByte = columnOffsets[columnPos] - m_headerSize;
+    }
+
+    if(gatherPayloadData(columnData, rows, rowSize, firstByte, valueSize, error) == false)
     {
-        error.addMeesage("Failed to read file");
+        error.addMeesage("Failed to gather column '" + columnName + "' of table-data-set");
         LOG_ERROR(error);
+        delete[] columnData;
+        payloadSize = 0;
+        return nullptr;
     }
 
-    // read data-set-header
-    DataSetHeader dataSetHeader;
-    memcpy(&dataSetHeader, completeFile.data, sizeof(DataSetHeader));
-    std::cout<<"name: "<<dataSetHeader.name<<std::endl;
+    return columnData;
+}
 
-    // read table-header
-    const uint8_t* u8buffer = static_cast<uint8_t*>(completeFile.data);
-    uint32_t headerSize = sizeof(DataSetHeader) + sizeof(TableTypeHeader);
-    memcpy(&tableHeader, &u8buffer[sizeof(DataSetHeader)], sizeof(TableTypeHeader));
+/**
+ * @brief get number of lines of the table
+ *
+ * @return number of lines
+ */
+uint64_t
+TableDataSetFile::getNumberOfRows() const
+{
+    return tableHeader.numberOfLines;
+}
+
+/**
+ * @brief get number of values of each row within a payload. Payloads of a table contain always
+ *        only a single column.
+ *
+ * @return number of values of a row
+ */
+uint64_t
+TableDataSetFile::getValuesPerRow() const
+{
+    return 1;
+}
+
+/**
+ * @brief add complete lines to the file
+ *
+ * @param startLine number of the first line, which should be written
+ * @param data values of the lines in row-major order
+ * @param numberOfLines number of lines to write
+ *
+ * @return true, if successful, else false
+ */
+bool
+TableDataSetFile::addLines(const uint64_t startLine,
+                           const float* data,
+                           const uint64_t numberOfLines)
+{
+    const uint64_t numberOfColumns = tableColumns.size();
+
+    // in row-major layout the lines are already in the correct order
+    if(isColumnar() == false)
+    {
+        return addBlock(startLine * numberOfColumns,
+                        data,
+                        numberOfLines * numberOfColumns);
+    }
+
+    // split lines into the column-blocks
+    std::vector<float> columnData(numberOfLines, 0.0f);
+    for(uint64_t col = 0; col < numberOfColumns; col++)
+    {
+        for(uint64_t line = 0; line < numberOfLines; line++) {
+            columnData[line] = data[line * numberOfColumns + col];
+        }
+        if(addColumnValues(col, startLine, &columnData[0], numberOfLines) == false) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief write values of a single column into its column-block. This is only possible for
+ *        tables in columnar layout.
+ *
+ * @param columnPos position of the column
+ * @param startLine number of the first line, which should be written
+ * @param data values of the column
+ * @param numberOfLines number of lines to write
+ *
+ * @return true, if successful, else false
+ */
+bool
+TableDataSetFile::addColumnValues(const uint64_t columnPos,
+                                  const uint64_t startLine,
+                                  const float* data,
+                                  const uint64_t numberOfLines)
+{
+    Kitsunemimi::ErrorContainer error;
+    const uint64_t numberOfColumns = tableColumns.size();
+    if(isColumnar() == false
+            || columnPos >= numberOfColumns)
+    {
+        error.addMeesage("Column " + std::to_string(columnPos) + " can not be written, because "
+                         "the table is not columnar or has no such column");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // check size to not write into the block of the next column
+    const uint64_t valueSize = getValueSize();
+    const uint64_t blockEnd = columnPos + 1 < numberOfColumns ? columnOffsets[columnPos + 1]
+                                                              : m_totalFileSize;
+    const uint64_t start = columnOffsets[columnPos] + (startLine * valueSize);
+    if(start + (numberOfLines * valueSize) > blockEnd)
+    {
+        error.addMeesage("Writing " + std::to_string(numberOfLines) + " values at line "
+                         + std::to_string(startLine) + " would exceed the block of column "
+                         + std::to_string(columnPos));
+        LOG_ERROR(error);
+        return false;
+    }
+
+    std::vector<uint8_t> encodedData(numberOfLines * valueSize, 0);
+    encodeValues(&encodedData[0],
+                 data,
+                 numberOfLines,
+                 tableColumns[columnPos].scale,
+                 tableColumns[columnPos].zeroPoint);
+
+    if(m_targetFile->writeDataIntoFile(&encodedData[0],
+                                       start,
+                                       numberOfLines * valueSize,
+                                       error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief append new lines at the end of an existing table. Only the payload is extended and the
+ *        column-statistics and number of lines are updated in memory, so finishAppend has to be
+ *        called afterwards to persist them. Tables with int8-payload can not be extended,
+ *        because the quantization of the existing values can not be changed anymore.
+ *
+ * @param data values of the new lines in row-major order
+ * @param numberOfLines number of new lines
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+TableDataSetFile::appendLines(const float* data,
+                              const uint64_t numberOfLines,
+                              Kitsunemimi::ErrorContainer &error)
+{
+    if(dataType == INT8_DTYPE)
+    {
+        error.addMeesage("Tables with int8-payload can not be extended");
+        return false;
+    }
+
+    const uint64_t numberOfColumns = tableColumns.size();
+    if(extendPayload(numberOfLines * numberOfColumns, error) == false)
+    {
+        error.addMeesage("Failed to extend payload of table '" + name + "'");
+        return false;
+    }
+
+    if(addBlock(tableHeader.numberOfLines * numberOfColumns,
+                data,
+                numberOfLines * numberOfColumns) == false)
+    {
+        error.addMeesage("Failed to write new lines into table '" + name + "'");
+        return false;
+    }
+
+    updateStatistics(data, tableHeader.numberOfLines, numberOfLines);
+    tableHeader.numberOfLines += numberOfLines;
+
+    return true;
+}
+
+/**
+ * @brief persist the lines, which were appended with appendLines. The new lines and the
+ *        extended section-table are flushed to the disc at first, then the column-statistics
+ *        are written and the number of lines at last, so after a crash the file has either the
+ *        old or the new number of lines, but never lines, whose values were not written.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+TableDataSetFile::finishAppend(Kitsunemimi::ErrorContainer &error)
+{
+    if(commitPayload(error) == false)
+    {
+        error.addMeesage("Failed to write new lines of table '" + name + "'");
+        return false;
+    }
+
+    if(tableColumns.size() > 0
+            && writeSection(COLUMN_SECTION,
+                            &tableColumns[0],
+                            sizeof(TableHeaderEntry),
+                            tableColumns.size(),
+                            error) == false)
+    {
+        error.addMeesage("Failed to write column-statistics of table '" + name + "'");
+        return false;
+    }
+
+    if(writeSection(TYPE_HEADER_SECTION, &tableHeader, sizeof(TableTypeHeader), 1, error) == false
+            || syncFile(error) == false)
+    {
+        error.addMeesage("Failed to write number of lines of table '" + name + "'");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief check if the payload of the file is stored in columnar layout
+ *
+ * @return true, if columnar, else false
+ */
+bool
+TableDataSetFile::isColumnar() const
+{
+    return layout == COLUMN_MAJOR_LAYOUT;
+}
 
+/**
+ * @brief calculate the int8-quantization of each column based on the value-range of the given
+ *        lines. Has to be called before the first lines are written into the file.
+ *
+ * @param data values of the lines in row-major order
+ * @param numberOfLines number of lines
+ */
+void
+TableDataSetFile::updateQuantization(const float* data,
+                                     const uint64_t numberOfLines)
+{
+    const uint64_t numberOfColumns = tableColumns.size();
+    if(numberOfLines == 0) {
+        return;
+    }
+
+    std::vector<float> minValues(&data[0], &data[numberOfColumns]);
+    std::vector<float> maxValues(&data[0], &data[numberOfColumns]);
+    for(uint64_t line = 1; line < numberOfLines; line++)
+    {
+        for(uint64_t col = 0; col < numberOfColumns; col++)
+        {
+            const float value = data[line * numberOfColumns + col];
+            minValues[col] = std::min(minValues[col], value);
+            maxValues[col] = std::max(maxValues[col], value);
+        }
+    }
+
+    for(uint64_t col = 0; col < numberOfColumns; col++)
+    {
+        calcInt8Quantization(tableColumns[col].scale,
+                             tableColumns[col].zeroPoint,
+                             minValues[col],
+                             maxValues[col]);
+    }
+
+    updateScales();
+}
+
+/**
+ * @brief update average and maximum of each column with new lines. The existing statistics are
+ *        weighted with the number of already included lines, so the complete table doesn't have
+ *        to be read again, when lines are added.
+ *
+ * @param data values of the new lines in row-major order
+ * @param startLine number of lines, which are already included in the statistics
+ * @param numberOfLines number of new lines
+ */
+void
+TableDataSetFile::updateStatistics(const float* data,
+                                   const uint64_t startLine,
+                                   const uint64_t numberOfLines)
+{
+    const uint64_t numberOfColumns = tableColumns.size();
+    if(numberOfLines == 0) {
+        return;
+    }
+
+    for(uint64_t col = 0; col < numberOfColumns; col++)
+    {
+        TableHeaderEntry &entry = tableColumns[col];
+        double sum = 0.0;
+        float maxVal = data[col];
+        for(uint64_t line = 0; line < numberOfLines; line++)
+        {
+            const float value = data[line * numberOfColumns + col];
+            sum += value;
+            maxVal = std::max(maxVal, value);
+        }
+
+        const double totalLines = static_cast<double>(startLine + numberOfLines);
+        entry.averageVal = (static_cast<double>(entry.averageVal) * startLine + sum) / totalLines;
+        if(startLine == 0) {
+            entry.maxVal = maxVal;
+        }
+        entry.maxVal = std::max(entry.maxVal, maxVal);
+    }
+}
+
+/**
+ * @brief copy the quantization of the columns into the quantization of the value-positions
+ */
+void
+TableDataSetFile::updateScales()
+{
+    m_scales.clear();
+    m_zeroPoints.clear();
+    for(const TableHeaderEntry &entry : tableColumns)
+    {
+        m_scales.push_back(entry.scale);
+        m_zeroPoints.push_back(entry.zeroPoint);
+    }
+}
+
+/**
+ * @brief get position of a column within the table
+ *
+ * @param columnName name of the column
+ *
+ * @return position of the column, or 0 if not found
+ */
+uint64_t
+TableDataSetFile::getColumnPos(const std::string &columnName) const
+{
+    uint64_t columnPos = 0;
+    for(uint64_t i = 0; i < tableColumns.size(); i++)
+    {
+        if(tableColumns[i].name == columnName) {
+            columnPos = i;
+        }
+    }
+
+    return columnPos;
+}
+
+/**
+ * @brief print-function for manually debugging only
+ */
+void
+TableDataSetFile::print()
+{
+    std::cout<<"======================================================="<<std::endl;
+    std::cout<<"====================    PRINT    ======================"<<std::endl;
+    std::cout<<"======================================================="<<std::endl;
+    std::cout<<std::endl;
+
+    std::cout<<"name: "<<name<<std::endl;
+    std::cout<<"version: "<<m_fileVersion<<std::endl;
     std::cout<<"number of columns: "<<tableHeader.numberOfColumns<<std::endl;
     std::cout<<"number of lines: "<<tableHeader.numberOfLines<<std::endl;
     std::cout<<std::endl;
 
     // header header
-    for(uint64_t i = 0; i < tableHeader.numberOfColumns; i++)
+    for(const TableHeaderEntry &entry : tableColumns)
     {
         std::cout<<"column:"<<std::endl;
-        TableHeaderEntry entry;
-        memcpy(&entry,
-               &u8buffer[headerSize + (i * sizeof(TableHeaderEntry))],
-               sizeof(TableHeaderEntry));
         std::cout<<"    name: "<<entry.name<<std::endl;
         std::cout<<"    avg: "<<entry.averageVal<<std::endl;
         std::cout<<"    max: "<<entry.maxVal<<std::endl;
@@ -216,19 +1089,32 @@ TableDataSetFile::print()
     }
     std::cout<<std::endl;
 
-    // get sizes
-    headerSize += tableHeader.numberOfColumns * sizeof(TableHeaderEntry);
-
-
     std::cout<<"content:"<<std::endl;
-    const float* fbuffer = reinterpret_cast<const float*>(&u8buffer[headerSize]);
-
+    Kitsunemimi::ErrorContainer error;
+    const uint64_t valueSize = getValueSize();
     for(uint64_t line = 0; line < tableHeader.numberOfLines; line++)
     {
         for(uint64_t col = 0; col < tableHeader.numberOfColumns; col++)
         {
-            std::cout<<fbuffer[line * tableHeader.numberOfColumns + col];
-            std::cout<<"   ";
+            uint8_t storedValue[4] = {0, 0, 0, 0};
+            bool success = false;
+            if(isColumnar())
+            {
+                const uint64_t offset = columnOffsets[col] + line * valueSize;
+                success = readFileData(storedValue, offset, valueSize, error);
+            }
+            else
+            {
+                const uint64_t offset = (line * tableHeader.numberOfColumns + col) * valueSize;
+                success = readPayload(storedValue, offset, valueSize, error);
+            }
+
+            if(success == false) {
+                LOG_ERROR(error);
+            }
+            std::cout<<decodeValue(storedValue,
+                                   tableColumns[col].scale,
+                                   tableColumns[col].zeroPoint)<<"   ";
         }
         std::cout<<"\n";
     }
@@ -30,20 +30,79 @@ class TableDataSetFile
 {
 public:
     TableDataSetFile(const std::string &filePath);
-    TableDataSetFile(Kitsunemimi::BinaryFile* file);
     ~TableDataSetFile();
     bool updateHeader();
     float* getPayload(uint64_t &payloadSize,
                       const std::string &columnName = "");
+    uint8_t* getCompactPayload(uint64_t &payloadSize,
+                               const std::string &columnName = "");
+    bool getPayloadView(PayloadView &view,
+                        const std::string &columnName = "");
+    float* getPayload(uint64_t &payloadSize,
+                      const uint64_t startRow,
+                      const uint64_t numberOfRows,
+                      const std::string &columnName = "");
+    uint8_t* getCompactPayload(uint64_t &payloadSize,
+                               const uint64_t startRow,
+                               const uint64_t numberOfRows,
+                               const std::string &columnName = "");
+    bool getPayloadView(PayloadView &view,
+                        const uint64_t startRow,
+                        const uint64_t numberOfRows,
+                        const std::string &columnName = "");
+    float* getColumnsPayload(uint64_t &payloadSize,
+                             const uint64_t startRow,
+                             const uint64_t numberOfRows,
+                             const std::vector<std::string> &columnNames,
+                             const bool columnBlocked);
+    uint8_t* getCompactColumnsPayload(uint64_t &payloadSize,
+                                      const uint64_t startRow,
+                                      const uint64_t numberOfRows,
+                                      const std::vector<std::string> &columnNames,
+                                      const bool columnBlocked);
+    void getColumnNames(std::vector<std::string> &columnNames,
+                        const ColumnGroup group) const;
+    float getColumnMultiplicator(const std::string &columnName) const;
+    float* gatherPayload(uint64_t &payloadSize,
+                         const std::vector<uint64_t> &rows,
+                         const std::string &columnName = "");
+    uint8_t* gatherCompactPayload(uint64_t &payloadSize,
+                                  const std::vector<uint64_t> &rows,
+                                  const std::string &columnName = "");
+    uint64_t getNumberOfRows() const;
+    uint64_t getValuesPerRow() const;
+    bool addLines(const uint64_t startLine,
+                  const float* data,
+                  const uint64_t numberOfLines);
+    bool addColumnValues(const uint64_t columnPos,
+                         const uint64_t startLine,
+                         const float* data,
+                         const uint64_t numberOfLines);
+    bool appendLines(const float* data,
+                     const uint64_t numberOfLines,
+                     Kitsunemimi::ErrorContainer &error);
+    bool finishAppend(Kitsunemimi::ErrorContainer &error);
+    bool isColumnar() const;
+    void updateQuantization(const float* data,
+                            const uint64_t numberOfLines);
+    void updateStatistics(const float* data,
+                          const uint64_t startLine,
+                          const uint64_t numberOfLines);
 
     void print();
 
     TableTypeHeader tableHeader;
     std::vector<TableHeaderEntry> tableColumns;
+    std::vector<uint64_t> columnOffsets;
 
 protected:
     void initHeader();
-    void readHeader(const uint8_t* u8buffer);
+    bool readHeader(Kitsunemimi::ErrorContainer &error);
+
+private:
+    void addV1Sections();
+    void updateScales();
+    uint64_t getColumnPos(const std::string &columnName) const;
 };
 
 #endif // SHIORIARCHIVE_TABLEDATASETFILE_H
@@ -0,0 +1,812 @@
+/**
+ * @file        value_conversion.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "value_conversion.h"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SHIORI_X86_KERNELS
+#endif
+
+#ifdef SHIORI_X86_KERNELS
+
+/**
+ * @brief check if the cpu supports the conversion-instructions for float16
+ */
+static bool
+hasF16c()
+{
+    static const bool support = __builtin_cpu_supports("avx")
+                                && __builtin_cpu_supports("f16c");
+    return support;
+}
+
+/**
+ * @brief check if the cpu supports avx2
+ */
+static bool
+hasAvx2()
+{
+    static const bool support = __builtin_cpu_supports("avx2");
+    return support;
+}
+
+/**
+ * @brief check if the cpu supports fused multiply-add
+ */
+static bool
+hasFma()
+{
+    static const bool support = __builtin_cpu_supports("fma");
+    return support;
+}
+
+#endif
+
+//==================================================================================================
+// single values
+//==================================================================================================
+
+/**
+ * @brief convert float into float16 with round-to-nearest-even, like the F16C-instructions
+ */
+uint16_t
+convertFloatToFloat16(const float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, 4);
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    // infinity and nan
+    if(exponent == 0xff) {
+        return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+    }
+
+    // overflow
+    const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if(halfExponent >= 31) {
+        return sign | 0x7c00;
+    }
+
+    // subnormal values and underflow
+    if(halfExponent <= 0)
+    {
+        if(halfExponent < -10) {
+            return sign;
+        }
+
+        mantissa |= 0x800000;
+        const uint32_t shift = 14 - halfExponent;
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if(rest > halfway
+                || (rest == halfway && (half & 1) != 0))
+        {
+            half++;
+        }
+
+        return sign | half;
+    }
+
+    // normal values, where a carry of the rounding correctly increases the exponent
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    const uint32_t rest = mantissa & 0x1fff;
+    if(rest > 0x1000
+            || (rest == 0x1000 && (half & 1) != 0))
+    {
+        half++;
+    }
+
+    return sign | half;
+}
+
+/**
+ * @brief convert float16 into float
+ */
+float
+convertFloat16ToFloat(const uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+    uint32_t bits = 0;
+
+    if(exponent == 0)
+    {
+        if(mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // normalize subnormal value
+            exponent = 127 - 15 + 1;
+            while((mantissa & 0x400) == 0)
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+            mantissa &= 0x3ff;
+            bits = sign | (exponent << 23) | (mantissa << 13);
+        }
+    }
+    else if(exponent == 31)
+    {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float result = 0.0f;
+    memcpy(&result, &bits, 4);
+    return result;
+}
+
+/**
+ * @brief convert float into bfloat16 with round-to-nearest-even
+ */
+uint16_t
+convertFloatToBFloat16(const float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, 4);
+
+    // keep nan as quiet nan
+    if((bits & 0x7fffffff) > 0x7f800000) {
+        return (bits >> 16) | 0x40;
+    }
+
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return bits >> 16;
+}
+
+/**
+ * @brief convert bfloat16 into float
+ */
+float
+convertBFloat16ToFloat(const uint16_t value)
+{
+    const uint32_t bits = static_cast<uint32_t>(value) << 16;
+    float result = 0.0f;
+    memcpy(&result, &bits, 4);
+    return result;
+}
+
+/**
+ * @brief quantize float affine into int8
+ */
+int8_t
+quantizeFloatToInt8(const float value,
+                    const float scale,
+                    const float zeroPoint)
+{
+    float quantized = std::nearbyint(value / scale) + zeroPoint;
+    quantized = std::min(std::max(quantized, -128.0f), 127.0f);
+    return static_cast<int8_t>(quantized);
+}
+
+/**
+ * @brief convert affine quantized int8 back into float
+ */
+float
+dequantizeInt8ToFloat(const int8_t value,
+                      const float scale,
+                      const float zeroPoint)
+{
+    return (static_cast<float>(value) - zeroPoint) * scale;
+}
+
+//==================================================================================================
+// vectorized kernels
+//==================================================================================================
+
+#ifdef SHIORI_X86_KERNELS
+
+__attribute__((target("avx,f16c")))
+static uint64_t
+convertFloatToFloat16F16c(uint16_t* target,
+                          const float* source,
+                          const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m256 values = _mm256_loadu_ps(&source[i]);
+        const __m128i halfs = _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i]), halfs);
+    }
+    return i;
+}
+
+__attribute__((target("avx,f16c")))
+static uint64_t
+convertFloat16ToFloatF16c(float* target,
+                          const uint16_t* source,
+                          const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m128i halfs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+        _mm256_storeu_ps(&target[i], _mm256_cvtph_ps(halfs));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint64_t
+convertFloatToBFloat16Avx2(uint16_t* target,
+                           const float* source,
+                           const uint64_t numberOfValues)
+{
+    const __m256i roundBase = _mm256_set1_epi32(0x7fff);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i quietBit = _mm256_set1_epi32(0x400000);
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m256 values = _mm256_loadu_ps(&source[i]);
+        const __m256i bits = _mm256_castps_si256(values);
+
+        // round to nearest even and keep nan as quiet nan
+        const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), one);
+        __m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(roundBase, lsb));
+        const __m256i isNan = _mm256_castps_si256(_mm256_cmp_ps(values, values, _CMP_UNORD_Q));
+        rounded = _mm256_blendv_epi8(rounded, _mm256_or_si256(bits, quietBit), isNan);
+        rounded = _mm256_srli_epi32(rounded, 16);
+
+        // pack 32bit-values into 16bit-values
+        const __m128i low = _mm256_castsi256_si128(rounded);
+        const __m128i high = _mm256_extracti128_si256(rounded, 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i]), _mm_packus_epi32(low, high));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint64_t
+convertBFloat16ToFloatAvx2(float* target,
+                           const uint16_t* source,
+                           const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+        const __m256i bits = _mm256_slli_epi32(_mm256_cvtepu16_epi32(values), 16);
+        _mm256_storeu_ps(&target[i], _mm256_castsi256_ps(bits));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint64_t
+quantizeFloatToInt8Avx2(int8_t* target,
+                        const float* source,
+                        const uint64_t numberOfValues,
+                        const float scale,
+                        const float zeroPoint)
+{
+    const __m256 scales = _mm256_set1_ps(scale);
+    const __m256 zeroPoints = _mm256_set1_ps(zeroPoint);
+    const __m256 minValues = _mm256_set1_ps(-128.0f);
+    const __m256 maxValues = _mm256_set1_ps(127.0f);
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        __m256 values = _mm256_div_ps(_mm256_loadu_ps(&source[i]), scales);
+        values = _mm256_round_ps(values, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        values = _mm256_add_ps(values, zeroPoints);
+        values = _mm256_min_ps(_mm256_max_ps(values, minValues), maxValues);
+
+        // pack 32bit-values into 8bit-values
+        const __m256i integers = _mm256_cvtps_epi32(values);
+        const __m128i packed16 = _mm_packs_epi32(_mm256_castsi256_si128(integers),
+                                                 _mm256_extracti128_si256(integers, 1));
+        const __m128i packed8 = _mm_packs_epi16(packed16, packed16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&target[i]), packed8);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint64_t
+dequantizeInt8ToFloatAvx2(float* target,
+                          const int8_t* source,
+                          const uint64_t numberOfValues,
+                          const float scale,
+                          const float zeroPoint)
+{
+    const __m256 scales = _mm256_set1_ps(scale);
+    const __m256 zeroPoints = _mm256_set1_ps(zeroPoint);
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m128i values = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&source[i]));
+        const __m256 floats = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(values));
+        _mm256_storeu_ps(&target[i], _mm256_mul_ps(_mm256_sub_ps(floats, zeroPoints), scales));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint64_t
+normalizeValuesAvx2(float* target,
+                    const float* source,
+                    const uint64_t numberOfValues,
+                    const float offset,
+                    const float factor)
+{
+    const __m256 offsets = _mm256_set1_ps(offset);
+    const __m256 factors = _mm256_set1_ps(factor);
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m256 values = _mm256_sub_ps(_mm256_loadu_ps(&source[i]), offsets);
+        _mm256_storeu_ps(&target[i], _mm256_mul_ps(values, factors));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint64_t
+sumSquaredDeviationsAvx2(double &sum,
+                         const float* source,
+                         const uint64_t numberOfValues,
+                         const float mean)
+{
+    // the squares are accumulated in double-precision to not lose precision on large data-sets
+    const __m256 means = _mm256_set1_ps(mean);
+    __m256d sumsLow = _mm256_setzero_pd();
+    __m256d sumsHigh = _mm256_setzero_pd();
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m256 deviations = _mm256_sub_ps(_mm256_loadu_ps(&source[i]), means);
+        const __m256d low = _mm256_cvtps_pd(_mm256_castps256_ps128(deviations));
+        const __m256d high = _mm256_cvtps_pd(_mm256_extractf128_ps(deviations, 1));
+        sumsLow = _mm256_add_pd(sumsLow, _mm256_mul_pd(low, low));
+        sumsHigh = _mm256_add_pd(sumsHigh, _mm256_mul_pd(high, high));
+    }
+
+    double sums[4];
+    _mm256_storeu_pd(sums, _mm256_add_pd(sumsLow, sumsHigh));
+    sum += sums[0] + sums[1] + sums[2] + sums[3];
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint64_t
+clipValuesAvx2(float* values,
+               const uint64_t numberOfValues,
+               const float minValue,
+               const float maxValue)
+{
+    const __m256 minValues = _mm256_set1_ps(minValue);
+    const __m256 maxValues = _mm256_set1_ps(maxValue);
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        // the value is the second operand, so NaNs are kept like in the scalar loop
+        const __m256 clipped = _mm256_max_ps(minValues, _mm256_loadu_ps(&values[i]));
+        _mm256_storeu_ps(&values[i], _mm256_min_ps(maxValues, clipped));
+    }
+    return i;
+}
+
+__attribute__((target("avx2,fma")))
+static uint64_t
+logValuesAvx2(float* values,
+              const uint64_t numberOfValues)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minNormal = _mm256_set1_ps(1.17549435e-38f);
+    const __m256 maxFinite = _mm256_set1_ps(3.40282347e+38f);
+    const __m256 sqrtHalf = _mm256_set1_ps(0.707106781186547524f);
+    const __m256i mantissaMask = _mm256_set1_epi32(0x807fffff);
+    const __m256i halfExponent = _mm256_set1_epi32(0x3f000000);
+    const __m256i exponentBias = _mm256_set1_epi32(126);
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(&values[i]);
+        const __m256 u = _mm256_add_ps(x, one);
+
+        // values with a non-normal or non-finite sum are left for the scalar loop of the caller
+        const __m256 valid = _mm256_and_ps(_mm256_cmp_ps(u, minNormal, _CMP_GE_OQ),
+                                           _mm256_cmp_ps(u, maxFinite, _CMP_LE_OQ));
+        if(_mm256_movemask_ps(valid) != 0xff) {
+            return i;
+        }
+
+        // split into mantissa within [0.5, 1) and exponent
+        const __m256i bits = _mm256_castps_si256(u);
+        __m256 exponent = _mm256_cvtepi32_ps(
+                              _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), exponentBias));
+        __m256 m = _mm256_castsi256_ps(
+                       _mm256_or_si256(_mm256_and_si256(bits, mantissaMask), halfExponent));
+
+        // shift the mantissa into [sqrt(0.5) - 1, sqrt(2) - 1)
+        const __m256 small = _mm256_cmp_ps(m, sqrtHalf, _CMP_LT_OQ);
+        exponent = _mm256_sub_ps(exponent, _mm256_and_ps(one, small));
+        m = _mm256_add_ps(_mm256_sub_ps(m, one), _mm256_and_ps(m, small));
+
+        // polynomial approximation of log(1 + m) like in the cephes-library
+        const __m256 z = _mm256_mul_ps(m, m);
+        __m256 y = _mm256_set1_ps(7.0376836292e-2f);
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.1514610310e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.1676998740e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.2420140846e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.4249322787e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.6668057665e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(2.0000714765e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-2.4999993993e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(3.3333331174e-1f));
+        y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+        y = _mm256_fmadd_ps(exponent, _mm256_set1_ps(-2.12194440e-4f), y);
+        y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+        __m256 result = _mm256_add_ps(m, y);
+        result = _mm256_fmadd_ps(exponent, _mm256_set1_ps(0.693359375f), result);
+
+        // correct the rounding-error of 1 + x, so small values keep their precision:
+        // log(1 + x) = log(u) * x / (u - 1)
+        const __m256 roundedX = _mm256_sub_ps(u, one);
+        const __m256 exact = _mm256_cmp_ps(roundedX, _mm256_setzero_ps(), _CMP_EQ_OQ);
+        const __m256 corrected = _mm256_mul_ps(result, _mm256_div_ps(x, roundedX));
+        _mm256_storeu_ps(&values[i], _mm256_blendv_ps(corrected, x, exact));
+    }
+    return i;
+}
+
+#endif
+
+//==================================================================================================
+// arrays
+//==================================================================================================
+
+/**
+ * @brief convert floats into float16
+ *
+ * @param target buffer for the converted values
+ * @param source values to convert
+ * @param numberOfValues number of values
+ */
+void
+convertFloatToFloat16(uint16_t* target,
+                      const float* source,
+                      const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasF16c()) {
+        i = convertFloatToFloat16F16c(target, source, numberOfValues);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        target[i] = convertFloatToFloat16(source[i]);
+    }
+}
+
+/**
+ * @brief convert float16 into floats
+ *
+ * @param target buffer for the converted values
+ * @param source values to convert
+ * @param numberOfValues number of values
+ */
+void
+convertFloat16ToFloat(float* target,
+                      const uint16_t* source,
+                      const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasF16c()) {
+        i = convertFloat16ToFloatF16c(target, source, numberOfValues);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        target[i] = convertFloat16ToFloat(source[i]);
+    }
+}
+
+/**
+ * @brief convert floats into bfloat16
+ *
+ * @param target buffer for the converted values
+ * @param source values to convert
+ * @param numberOfValues number of values
+ */
+void
+convertFloatToBFloat16(uint16_t* target,
+                       const float* source,
+                       const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasAvx2()) {
+        i = convertFloatToBFloat16Avx2(target, source, numberOfValues);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        target[i] = convertFloatToBFloat16(source[i]);
+    }
+}
+
+/**
+ * @brief convert bfloat16 into floats
+ *
+ * @param target buffer for the converted values
+ * @param source values to convert
+ * @param numberOfValues number of values
+ */
+void
+convertBFloat16ToFloat(float* target,
+                       const uint16_t* source,
+                       const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasAvx2()) {
+        i = convertBFloat16ToFloatAvx2(target, source, numberOfValues);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        target[i] = convertBFloat16ToFloat(source[i]);
+    }
+}
+
+/**
+ * @brief quantize floats affine into int8
+ *
+ * @param target buffer for the converted values
+ * @param source values to convert
+ * @param numberOfValues number of values
+ * @param scale scale of the quantization
+ * @param zeroPoint zero-point of the quantization
+ */
+void
+quantizeFloatToInt8(int8_t* target,
+                    const float* source,
+                    const uint64_t numberOfValues,
+                    const float scale,
+                    const float zeroPoint)
+{
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasAvx2()) {
+        i = quantizeFloatToInt8Avx2(target, source, numberOfValues, scale, zeroPoint);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        target[i] = quantizeFloatToInt8(source[i], scale, zeroPoint);
+    }
+}
+
+/**
+ * @brief convert affine quantized int8 back into floats
+ *
+ * @param target buffer for the converted values
+ * @param source values to convert
+ * @param numberOfValues number of values
+ * @param scale scale of the quantization
+ * @param zeroPoint zero-point of the quantization
+ */
+void
+dequantizeInt8ToFloat(float* target,
+                      const int8_t* source,
+                      const uint64_t numberOfValues,
+                      const float scale,
+                      const float zeroPoint)
+{
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasAvx2()) {
+        i = dequantizeInt8ToFloatAvx2(target, source, numberOfValues, scale, zeroPoint);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        target[i] = dequantizeInt8ToFloat(source[i], scale, zeroPoint);
+    }
+}
+
+/**
+ * @brief normalize values with an offset and a factor: target = (source - offset) * factor
+ *
+ * @param target buffer for the normalized values, which can be the same as the source
+ * @param source values to normalize
+ * @param numberOfValues number of values
+ * @param offset value, which is subtracted from each value
+ * @param factor factor, which is multiplied with each value after subtracting the offset
+ */
+void
+normalizeValues(float* target,
+                const float* source,
+                const uint64_t numberOfValues,
+                const float offset,
+                const float factor)
+{
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasAvx2()) {
+        i = normalizeValuesAvx2(target, source, numberOfValues, offset, factor);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        target[i] = (source[i] - offset) * factor;
+    }
+}
+
+/**
+ * @brief limit values to a range
+ *
+ * @param values values to clip in place
+ * @param numberOfValues number of values
+ * @param minValue lower limit
+ * @param maxValue upper limit
+ */
+void
+clipValues(float* values,
+           const uint64_t numberOfValues,
+           const float minValue,
+           const float maxValue)
+{
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasAvx2()) {
+        i = clipValuesAvx2(values, numberOfValues, minValue, maxValue);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        values[i] = std::min(std::max(values[i], minValue), maxValue);
+    }
+}
+
+/**
+ * @brief replace values by their logarithm: value = ln(1 + value), so zeros stay zero. Values
+ *        below -1 have no logarithm and become NaN.
+ *
+ * @param values values to transform in place
+ * @param numberOfValues number of values
+ */
+void
+logValues(float* values,
+          const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+    while(i < numberOfValues)
+    {
+#ifdef SHIORI_X86_KERNELS
+        if(hasAvx2()
+                && hasFma())
+        {
+            i += logValuesAvx2(&values[i], numberOfValues - i);
+        }
+#endif
+        // the vectorized kernel stops at blocks with values, which it can not handle, like
+        // values below -1, so these blocks are processed here
+        const uint64_t end = std::min(i + 8, numberOfValues);
+        for(; i < end; i++) {
+            values[i] = std::log1p(values[i]);
+        }
+    }
+}
+
+/**
+ * @brief expand class-numbers into one-hot-vectors. Values, which are not a valid class-number,
+ *        result in a vector of zeros.
+ *
+ * @param target buffer for numberOfValues * numberOfClasses values
+ * @param source class-numbers to expand
+ * @param numberOfValues number of class-numbers
+ * @param numberOfClasses number of classes and length of each one-hot-vector
+ */
+void
+expandOneHot(float* target,
+             const float* source,
+             const uint64_t numberOfValues,
+             const uint32_t numberOfClasses)
+{
+    std::fill(target, target + (numberOfValues * numberOfClasses), 0.0f);
+
+    for(uint64_t i = 0; i < numberOfValues; i++)
+    {
+        const float classNumber = std::nearbyint(source[i]);
+        if(classNumber >= 0.0f
+                && classNumber < static_cast<float>(numberOfClasses))
+        {
+            target[(i * numberOfClasses) + static_cast<uint64_t>(classNumber)] = 1.0f;
+        }
+    }
+}
+
+/**
+ * @brief calculate the sum of the squared deviations of values from their mean
+ *
+ * @param source values to check
+ * @param numberOfValues number of values
+ * @param mean mean of the values
+ *
+ * @return sum of the squared deviations
+ */
+double
+sumSquaredDeviations(const float* source,
+                     const uint64_t numberOfValues,
+                     const float mean)
+{
+    double sum = 0.0;
+    uint64_t i = 0;
+#ifdef SHIORI_X86_KERNELS
+    if(hasAvx2()) {
+        i = sumSquaredDeviationsAvx2(sum, source, numberOfValues, mean);
+    }
+#endif
+    for(; i < numberOfValues; i++)
+    {
+        const double deviation = source[i] - mean;
+        sum += deviation * deviation;
+    }
+
+    return sum;
+}
+
+/**
+ * @brief calculate the parameters of an affine int8-quantization, which maps the given
+ *        value-range to the complete range of int8
+ *
+ * @param scale reference for the resulting scale
+ * @param zeroPoint reference for the resulting zero-point
+ * @param minValue minimal value, which has to be quantized
+ * @param maxValue maximal value, which has to be quantized
+ */
+void
+calcInt8Quantization(float &scale,
+                     float &zeroPoint,
+                     const float minValue,
+                     const float maxValue)
+{
+    scale = (maxValue - minValue) / 255.0f;
+    if(scale <= 0.0f
+            || std::isfinite(scale) == false)
+    {
+        scale = 1.0f;
+    }
+
+    zeroPoint = std::nearbyint(-128.0f - (minValue / scale));
+}
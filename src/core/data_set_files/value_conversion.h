@@ -0,0 +1,85 @@
+/**
+ * @file        value_conversion.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_VALUECONVERSION_H
+#define SHIORIARCHIVE_VALUECONVERSION_H
+
+#include <stdint.h>
+
+uint16_t convertFloatToFloat16(const float value);
+float convertFloat16ToFloat(const uint16_t value);
+uint16_t convertFloatToBFloat16(const float value);
+float convertBFloat16ToFloat(const uint16_t value);
+int8_t quantizeFloatToInt8(const float value,
+                           const float scale,
+                           const float zeroPoint);
+float dequantizeInt8ToFloat(const int8_t value,
+                            const float scale,
+                            const float zeroPoint);
+
+void convertFloatToFloat16(uint16_t* target,
+                           const float* source,
+                           const uint64_t numberOfValues);
+void convertFloat16ToFloat(float* target,
+                           const uint16_t* source,
+                           const uint64_t numberOfValues);
+void convertFloatToBFloat16(uint16_t* target,
+                            const float* source,
+                            const uint64_t numberOfValues);
+void convertBFloat16ToFloat(float* target,
+                            const uint16_t* source,
+                            const uint64_t numberOfValues);
+void quantizeFloatToInt8(int8_t* target,
+                         const float* source,
+                         const uint64_t numberOfValues,
+                         const float scale,
+                         const float zeroPoint);
+void dequantizeInt8ToFloat(float* target,
+                           const int8_t* source,
+                           const uint64_t numberOfValues,
+                           const float scale,
+                           const float zeroPoint);
+void normalizeValues(float* target,
+                     const float* source,
+                     const uint64_t numberOfValues,
+                     const float offset,
+                     const float factor);
+void clipValues(float* values,
+                const uint64_t numberOfValues,
+                const float minValue,
+                const float maxValue);
+void logValues(float* values,
+               const uint64_t numberOfValues);
+void expandOneHot(float* target,
+                  const float* source,
+                  const uint64_t numberOfValues,
+                  const uint32_t numberOfClasses);
+double sumSquaredDeviations(const float* source,
+                            const uint64_t numberOfValues,
+                            const float mean);
+
+void calcInt8Quantization(float &scale,
+                          float &zeroPoint,
+                          const float minValue,
+                          const float maxValue);
+
+#endif // SHIORIARCHIVE_VALUECONVERSION_H
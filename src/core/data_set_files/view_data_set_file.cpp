@@ -0,0 +1,873 @@
+/**
+ * @file        view_data_set_file.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "view_data_set_file.h"
+
+#include <algorithm>
+
+/**
+ * @brief constructor
+ *
+ * @param filePath path to file
+ */
+ViewDataSetFile::ViewDataSetFile(const std::string &filePath)
+    : DataSetFile(filePath) {}
+
+/**
+ * @brief destructor
+ */
+ViewDataSetFile::~ViewDataSetFile() {}
+
+/**
+ * @brief prepare a new view on a parent data-set. Views on views are resolved to the rows of the
+ *        underlying data-set, so a view never has to open a chain of files.
+ *
+ * @param parent opened parent data-set
+ * @param location location of the file of the parent data-set
+ * @param ranges ranges of rows of the parent, which form the view in the given order
+ * @param error reference for error-output
+ *
+ * @return false, if a range is outside of the parent, else true
+ */
+bool
+ViewDataSetFile::initView(std::shared_ptr<DataSetFile> parent,
+                          const std::string &location,
+                          const std::vector<RowRange> &ranges,
+                          Kitsunemimi::ErrorContainer &error)
+{
+    ViewDataSetFile* parentView = dynamic_cast<ViewDataSetFile*>(parent.get());
+    std::vector<RowRange> resolvedRanges;
+    for(const RowRange &range : ranges)
+    {
+        if(range.startRow > parent->getNumberOfRows()
+                || range.numberOfRows > parent->getNumberOfRows() - range.startRow)
+        {
+            error.addMeesage("Range of rows, which starts at row "
+                             + std::to_string(range.startRow)
+                             + ", is outside of the parent data-set");
+            return false;
+        }
+
+        if(parentView != nullptr)
+        {
+            parentView->getParentRanges(resolvedRanges, range.startRow, range.numberOfRows);
+        }
+        else
+        {
+            resolvedRanges.push_back(range);
+        }
+    }
+
+    parentLocation = location;
+    m_parent = parent;
+    if(parentView != nullptr)
+    {
+        parentLocation = parentView->parentLocation;
+        m_parent = parentView->m_parent;
+    }
+
+    // merge ranges, which directly follow each other, so also lists of single rows are stored
+    // compact, as long as they are mostly ordered
+    rowRanges.clear();
+    for(const RowRange &range : resolvedRanges)
+    {
+        if(range.numberOfRows == 0) {
+            continue;
+        }
+
+        if(rowRanges.size() > 0
+                && rowRanges.back().startRow + rowRanges.back().numberOfRows == range.startRow)
+        {
+            rowRanges.back().numberOfRows += range.numberOfRows;
+            continue;
+        }
+
+        rowRanges.push_back(range);
+    }
+
+    type = VIEW_TYPE;
+    dataType = m_parent->dataType;
+    updateRangeStarts();
+
+    return true;
+}
+
+/**
+ * @brief init sections and header-sizes
+ */
+void
+ViewDataSetFile::initHeader()
+{
+    viewHeader.numberOfRanges = rowRanges.size();
+
+    addSection(TYPE_HEADER_SECTION, sizeof(ViewTypeHeader), 1);
+    addSection(PARENT_LOCATION_SECTION, 1, parentLocation.size());
+    addSection(ROW_RANGE_SECTION, sizeof(RowRange), viewHeader.numberOfRanges);
+    finishSections();
+}
+
+/**
+ * @brief read header from file and open the parent data-set
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+ViewDataSetFile::readHeader(Kitsunemimi::ErrorContainer &error)
+{
+    // read view-header
+    if(readSection(TYPE_HEADER_SECTION, &viewHeader, sizeof(ViewTypeHeader), 1, error) == false)
+    {
+        error.addMeesage("Failed to read view-header");
+        return false;
+    }
+
+    // read location of the parent
+    const SectionEntry* locationSection = getSection(PARENT_LOCATION_SECTION);
+    if(locationSection == nullptr)
+    {
+        error.addMeesage("View-data-set has no location of a parent");
+        return false;
+    }
+    parentLocation = std::string(locationSection->size, '\0');
+    if(readSection(PARENT_LOCATION_SECTION,
+                   &parentLocation[0],
+                   1,
+                   locationSection->size,
+                   error) == false)
+    {
+        error.addMeesage("Failed to read location of the parent of the view");
+        return false;
+    }
+
+    // read ranges of rows
+    rowRanges.clear();
+    rowRanges.resize(viewHeader.numberOfRanges);
+    if(viewHeader.numberOfRanges > 0
+            && readSection(ROW_RANGE_SECTION,
+                           &rowRanges[0],
+                           sizeof(RowRange),
+                           viewHeader.numberOfRanges,
+                           error) == false)
+    {
+        error.addMeesage("Failed to read row-ranges of the view");
+        return false;
+    }
+
+    return openParent(error);
+}
+
+/**
+ * @brief open the parent data-set and check, that all rows of the view exist within the parent
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+ViewDataSetFile::openParent(Kitsunemimi::ErrorContainer &error)
+{
+    DataSetFile* parent = readDataSetFile(parentLocation, error);
+    if(parent == nullptr)
+    {
+        error.addMeesage("Failed to open parent '" + parentLocation + "' of the view");
+        return false;
+    }
+    m_parent = std::shared_ptr<DataSetFile>(parent);
+
+    // views are always created based on the underlying data-set
+    if(m_parent->type == VIEW_TYPE)
+    {
+        error.addMeesage("Parent '" + parentLocation + "' of the view is a view itself");
+        return false;
+    }
+
+    for(const RowRange &range : rowRanges)
+    {
+        if(range.startRow > m_parent->getNumberOfRows()
+                || range.numberOfRows > m_parent->getNumberOfRows() - range.startRow)
+        {
+            error.addMeesage("Rows of the view are outside of the parent '"
+                             + parentLocation + "'");
+            return false;
+        }
+    }
+
+    dataType = m_parent->dataType;
+    updateRangeStarts();
+
+    return true;
+}
+
+/**
+ * @brief update the number of the first row of the view for each range
+ */
+void
+ViewDataSetFile::updateRangeStarts()
+{
+    m_rangeStarts.clear();
+    m_rangeStarts.reserve(rowRanges.size());
+
+    uint64_t numberOfRows = 0;
+    for(const RowRange &range : rowRanges)
+    {
+        m_rangeStarts.push_back(numberOfRows);
+        numberOfRows += range.numberOfRows;
+    }
+
+    viewHeader.numberOfRows = numberOfRows;
+    viewHeader.numberOfRanges = rowRanges.size();
+}
+
+/**
+ * @brief update header in file
+ *
+ * @return true, if successful, else false
+ */
+bool
+ViewDataSetFile::updateHeader()
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // write view-header to file
+    if(writeSection(TYPE_HEADER_SECTION, &viewHeader, sizeof(ViewTypeHeader), 1, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // write location of the parent to file
+    if(parentLocation.size() > 0
+            && writeSection(PARENT_LOCATION_SECTION,
+                            parentLocation.c_str(),
+                            1,
+                            parentLocation.size(),
+                            error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // write ranges of rows to file
+    if(rowRanges.size() > 0
+            && writeSection(ROW_RANGE_SECTION,
+                            &rowRanges[0],
+                            sizeof(RowRange),
+                            rowRanges.size(),
+                            error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get all rows of the view, converted into floats
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param columnName name of the column to read, if the parent is a table
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+float*
+ViewDataSetFile::getPayload(uint64_t &payloadSize,
+                            const std::string &columnName)
+{
+    return getPayload(payloadSize, 0, viewHeader.numberOfRows, columnName);
+}
+
+/**
+ * @brief get all rows of the view in the data-type, in which they are stored
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param columnName name of the column to read, if the parent is a table
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+ViewDataSetFile::getCompactPayload(uint64_t &payloadSize,
+                                   const std::string &columnName)
+{
+    return getCompactPayload(payloadSize, 0, viewHeader.numberOfRows, columnName);
+}
+
+/**
+ * @brief get view on all rows of the view within the mapped parent without copying them
+ *
+ * @param view reference for the resulting view
+ * @param columnName name of the column, if the parent is a table
+ *
+ * @return false, if the rows are not contiguous within the parent or the parent doesn't allow
+ *         direct access, else true
+ */
+bool
+ViewDataSetFile::getPayloadView(PayloadView &view,
+                                const std::string &columnName)
+{
+    return getPayloadView(view, 0, viewHeader.numberOfRows, columnName);
+}
+
+/**
+ * @brief get a range of rows of the view, converted into floats. Each contiguous part within the
+ *        parent is read with a single ranged read.
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first row within the view
+ * @param numberOfRows number of rows to read
+ * @param columnName name of the column to read, if the parent is a table
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+float*
+ViewDataSetFile::getPayload(uint64_t &payloadSize,
+                            const uint64_t startRow,
+                            const uint64_t numberOfRows,
+                            const std::string &columnName)
+{
+    std::vector<RowRange> parentRanges;
+    getParentRanges(parentRanges, startRow, numberOfRows);
+    if(parentRanges.size() == 1)
+    {
+        return m_parent->getPayload(payloadSize,
+                                    parentRanges[0].startRow,
+                                    parentRanges[0].numberOfRows,
+                                    columnName);
+    }
+
+    // read all parts and concatenate them afterwards, because the number of values per row is
+    // only known by the parent
+    std::vector<float*> parts;
+    std::vector<uint64_t> partSizes;
+    payloadSize = 0;
+    for(const RowRange &range : parentRanges)
+    {
+        uint64_t partSize = 0;
+        parts.push_back(m_parent->getPayload(partSize,
+                                             range.startRow,
+                                             range.numberOfRows,
+                                             columnName));
+        partSizes.push_back(partSize);
+        payloadSize += partSize;
+        if(parts.back() == nullptr) {
+            break;
+        }
+    }
+
+    // a failed read of one part fails the whole range
+    if(parts.size() > 0
+            && parts.back() == nullptr)
+    {
+        for(float* part : parts) {
+            delete[] part;
+        }
+        return nullptr;
+    }
+
+    float* payload = new float[payloadSize / sizeof(float)];
+    uint8_t* payloadBytes = reinterpret_cast<uint8_t*>(payload);
+    uint64_t pos = 0;
+    for(uint64_t i = 0; i < parts.size(); i++)
+    {
+        memcpy(&payloadBytes[pos], parts[i], partSizes[i]);
+        pos += partSizes[i];
+        delete[] parts[i];
+    }
+
+    return payload;
+}
+
+/**
+ * @brief get a range of rows of the view in the data-type, in which they are stored. Each
+ *        contiguous part within the parent is read with a single ranged read.
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first row within the view
+ * @param numberOfRows number of rows to read
+ * @param columnName name of the column to read, if the parent is a table
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+ViewDataSetFile::getCompactPayload(uint64_t &payloadSize,
+                                   const uint64_t startRow,
+                                   const uint64_t numberOfRows,
+                                   const std::string &columnName)
+{
+    std::vector<RowRange> parentRanges;
+    getParentRanges(parentRanges, startRow, numberOfRows);
+    if(parentRanges.size() == 1)
+    {
+        return m_parent->getCompactPayload(payloadSize,
+                                           parentRanges[0].startRow,
+                                           parentRanges[0].numberOfRows,
+                                           columnName);
+    }
+
+    std::vector<uint8_t*> parts;
+    std::vector<uint64_t> partSizes;
+    payloadSize = 0;
+    for(const RowRange &range : parentRanges)
+    {
+        uint64_t partSize = 0;
+        parts.push_back(m_parent->getCompactPayload(partSize,
+                                                    range.startRow,
+                                                    range.numberOfRows,
+                                                    columnName));
+        partSizes.push_back(partSize);
+        payloadSize += partSize;
+        if(parts.back() == nullptr) {
+            break;
+        }
+    }
+
+    // a failed read of one part fails the whole range
+    if(parts.size() > 0
+            && parts.back() == nullptr)
+    {
+        for(uint8_t* part : parts) {
+            delete[] part;
+        }
+        return nullptr;
+    }
+
+    uint8_t* payload = new uint8_t[payloadSize];
+    uint64_t pos = 0;
+    for(uint64_t i = 0; i < parts.size(); i++)
+    {
+        memcpy(&payload[pos], parts[i], partSizes[i]);
+        pos += partSizes[i];
+        delete[] parts[i];
+    }
+
+    return payload;
+}
+
+/**
+ * @brief get multiple columns of a range of rows of the view in one buffer, converted into
+ *        floats. The columns of each contiguous part within the parent are read together by
+ *        the parent.
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first row within the view
+ * @param numberOfRows number of rows to read
+ * @param columnNames names of the columns to read
+ * @param columnBlocked true to place the values of each column contiguous one after another,
+ *                      false to interleave the columns row by row
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+float*
+ViewDataSetFile::getColumnsPayload(uint64_t &payloadSize,
+                                   const uint64_t startRow,
+                                   const uint64_t numberOfRows,
+                                   const std::vector<std::string> &columnNames,
+                                   const bool columnBlocked)
+{
+    std::vector<RowRange> parentRanges;
+    getParentRanges(parentRanges, startRow, numberOfRows);
+    if(parentRanges.size() == 1)
+    {
+        return m_parent->getColumnsPayload(payloadSize,
+                                           parentRanges[0].startRow,
+                                           parentRanges[0].numberOfRows,
+                                           columnNames,
+                                           columnBlocked);
+    }
+
+    const uint64_t numberOfLines = getRowsInRange(startRow, numberOfRows);
+    const uint64_t valueSize = m_parent->getValuesPerRow() * sizeof(float);
+    payloadSize = numberOfLines * columnNames.size() * valueSize;
+    float* payload = new float[payloadSize / sizeof(float)];
+
+    uint64_t firstRow = 0;
+    for(const RowRange &range : parentRanges)
+    {
+        uint64_t partSize = 0;
+        float* part = m_parent->getColumnsPayload(partSize,
+                                                  range.startRow,
+                                                  range.numberOfRows,
+                                                  columnNames,
+                                                  columnBlocked);
+        if(part == nullptr)
+        {
+            delete[] payload;
+            return nullptr;
+        }
+        copyRowsPart(reinterpret_cast<uint8_t*>(payload),
+                     reinterpret_cast<const uint8_t*>(part),
+                     firstRow,
+                     range.numberOfRows,
+                     numberOfLines,
+                     columnNames.size(),
+                     valueSize,
+                     columnBlocked);
+        firstRow += range.numberOfRows;
+        delete[] part;
+    }
+
+    return payload;
+}
+
+/**
+ * @brief get multiple columns of a range of rows of the view in one buffer in the data-type, in
+ *        which they are stored. The columns of each contiguous part within the parent are read
+ *        together by the parent.
+ *
+ * @param payloadSize reference for size of the read payload
+ * @param startRow number of the first row within the view
+ * @param numberOfRows number of rows to read
+ * @param columnNames names of the columns to read
+ * @param columnBlocked true to place the values of each column contiguous one after another,
+ *                      false to interleave the columns row by row
+ *
+ * @return pointer to the payload, or nullptr, if reading failed
+ */
+uint8_t*
+ViewDataSetFile::getCompactColumnsPayload(uint64_t &payloadSize,
+                                          const uint64_t startRow,
+                                          const uint64_t numberOfRows,
+                                          const std::vector<std::string> &columnNames,
+                                          const bool columnBlocked)
+{
+    std::vector<RowRange> parentRanges;
+    getParentRanges(parentRanges, startRow, numberOfRows);
+    if(parentRanges.size() == 1)
+    {
+        return m_parent->getCompactColumnsPayload(payloadSize,
+                                                  parentRanges[0].startRow,
+                                                  parentRanges[0].numberOfRows,
+                                                  columnNames,
+                                                  columnBlocked);
+    }
+
+    const uint64_t numberOfLines = getRowsInRange(startRow, numberOfRows);
+    const uint64_t valueSize = m_parent->getValuesPerRow() * m_parent->getValueSize();
+    payloadSize = numberOfLines * columnNames.size() * valueSize;
+    uint8_t* payload = new uint8_t[payloadSize];
+
+    uint64_t firstRow = 0;
+    for(const RowRange &range : parentRanges)
+    {
+        uint64_t partSize = 0;
+        uint8_t* part = m_parent->getCompactColumnsPayload(partSize,
+                                                           range.startRow,
+                                                           range.numberOfRows,
+                                                           columnNames,
+                                                           columnBlocked);
+        if(part == nullptr)
+        {
+            delete[] payload;
+            return nullptr;
+        }
+        copyRowsPart(payload,
+                     part,
+                     firstRow,
+                     range.numberOfRows,
+                     numberOfLines,
+                     columnNames.size(),
+                     valueSize,
+                     columnBlocked);
+        firstRow += range.numberOfRows;
+        delete[] part;
+    }
+
+    return payload;
+}
+
+/**
+ * @brief get names of the columns of a group of the parent
+ *
+ * @param columnNames reference for the list, where the names are appended
+ * @param group group of the columns
+ */
+void
+ViewDataSetFile::getColumnNames(std::vector<std::string> &columnNames,
+                                const ColumnGroup group) const
+{
+    m_parent->getColumnNames(columnNames, group);
+}
+
+/**
+ * @brief get the factor of a column of the parent, with which its values should be scaled
+ *
+ * @param columnName name of the column
+ *
+ * @return multiplicator of the column
+ */
+float
+ViewDataSetFile::getColumnMultiplicator(const std::string &columnName) const
+{
+    return m_parent->getColumnMultiplicator(columnName);
+}
+
+/**
+ * @brief get the position of the payload of a view within the file of the parent
+ *
+ * @param filePath reference for the path of the file
+ * @param fileOffset reference for the byte-offset of the payload within the file
+ * @param view view on the mapped payload of the parent
+ *
+ * @return false, if the view is not within a mapping, which is shared with the file, else true
+ */
+bool
+ViewDataSetFile::getViewFileRange(std::string &filePath,
+                                  uint64_t &fileOffset,
+                                  const PayloadView &view) const
+{
+    return m_parent->getViewFileRange(filePath, fileOffset, view);
+}
+
+/**
+ * @brief get view on a range of rows within the mapped parent without copying them. This is only
+ *        possible, if all rows are contiguous within the parent.
+ *
+ * @param view reference for the resulting view
+ * @param startRow number of the first row within the view
+ * @param numberOfRows number of rows
+ * @param columnName name of the column, if the parent is a table
+ *
+ * @return false, if the rows are not contiguous within the parent or the parent doesn't allow
+ *         direct access, else true
+ */
+bool
+ViewDataSetFile::getPayloadView(PayloadView &view,
+                                const uint64_t startRow,
+                                const uint64_t numberOfRows,
+                                const std::string &columnName)
+{
+    std::vector<RowRange> parentRanges;
+    getParentRanges(parentRanges, startRow, numberOfRows);
+    if(parentRanges.size() != 1) {
+        return false;
+    }
+
+    return m_parent->getPayloadView(view,
+                                    parentRanges[0].startRow,
+                                    parentRanges[0].numberOfRows,
+                                    columnName);
+}
+
+/**
+ * @brief get views on a range of rows within the mapped parent without copying them. In contrast
+ *        to a single view, the rows don't have to be contiguous within the parent, because each
+ *        segment of the parent gets its own view.
+ *
+ * @param views reference for the list, where the views are appended
+ * @param startRow number of the first row within the view
+ * @param numberOfRows number of rows
+ * @param columnName name of the column, if the parent is a table
+ *
+ * @return false, if the parent doesn't allow direct access, else true
+ */
+bool
+ViewDataSetFile::getPayloadViews(std::vector<PayloadView> &views,
+                                 const uint64_t startRow,
+                                 const uint64_t numberOfRows,
+                                 const std::string &columnName)
+{
+    std::vector<RowRange> parentRanges;
+    getParentRanges(parentRanges, startRow, numberOfRows);
+
+    for(const RowRange &range : parentRanges)
+    {
+        if(m_parent->getPayloadViews(views,
+                                     range.startRow,
+                                     range.numberOfRows,
+                                     columnName) == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief gather a list of rows of the view in the given order into one buffer, converted into
+ *        floats
+ *
+ * @param payloadSize reference for size of the gathered payload
+ * @param rows numbers of the rows within the view
+ * @param columnName name of the column, if the parent is a table
+ *
+ * @return pointer to the gathered payload, nullptr if reading the file failed
+ */
+float*
+ViewDataSetFile::gatherPayload(uint64_t &payloadSize,
+                               const std::vector<uint64_t> &rows,
+                               const std::string &columnName)
+{
+    std::vector<uint64_t> parentRows;
+    parentRows.reserve(rows.size());
+    for(const uint64_t row : rows) {
+        parentRows.push_back(getParentRow(row));
+    }
+
+    return m_parent->gatherPayload(payloadSize, parentRows, columnName);
+}
+
+/**
+ * @brief gather a list of rows of the view in the given order into one buffer in the data-type,
+ *        in which they are stored
+ *
+ * @param payloadSize reference for size of the gathered payload
+ * @param rows numbers of the rows within the view
+ * @param columnName name of the column, if the parent is a table
+ *
+ * @return pointer to the gathered payload, nullptr if reading the file failed
+ */
+uint8_t*
+ViewDataSetFile::gatherCompactPayload(uint64_t &payloadSize,
+                                      const std::vector<uint64_t> &rows,
+                                      const std::string &columnName)
+{
+    std::vector<uint64_t> parentRows;
+    parentRows.reserve(rows.size());
+    for(const uint64_t row : rows) {
+        parentRows.push_back(getParentRow(row));
+    }
+
+    return m_parent->gatherCompactPayload(payloadSize, parentRows, columnName);
+}
+
+/**
+ * @brief get number of rows of the view
+ *
+ * @return number of rows
+ */
+uint64_t
+ViewDataSetFile::getNumberOfRows() const
+{
+    return viewHeader.numberOfRows;
+}
+
+/**
+ * @brief get number of values of each row within a payload, which is defined by the parent
+ *
+ * @return number of values of a row
+ */
+uint64_t
+ViewDataSetFile::getValuesPerRow() const
+{
+    return m_parent->getValuesPerRow();
+}
+
+/**
+ * @brief get number of mapped bytes of the view together with its parent
+ *
+ * @return number of mapped bytes
+ */
+uint64_t
+ViewDataSetFile::getMappedSize() const
+{
+    uint64_t mappedSize = DataSetFile::getMappedSize();
+    if(m_parent != nullptr) {
+        mappedSize += m_parent->getMappedSize();
+    }
+
+    return mappedSize;
+}
+
+/**
+ * @brief translate a range of rows of the view into the ranges of rows within the parent
+ *
+ * @param parentRanges reference for the resulting ranges, where the new ranges are appended
+ * @param startRow number of the first row within the view
+ * @param numberOfRows number of rows, which is limited to the end of the view
+ */
+void
+ViewDataSetFile::getParentRanges(std::vector<RowRange> &parentRanges,
+                                 const uint64_t startRow,
+                                 const uint64_t numberOfRows) const
+{
+    uint64_t remainingRows = getRowsInRange(startRow, numberOfRows);
+    if(remainingRows == 0) {
+        return;
+    }
+
+    uint64_t rangePos = findRange(startRow);
+    uint64_t offset = startRow - m_rangeStarts[rangePos];
+
+    while(remainingRows > 0)
+    {
+        const RowRange &range = rowRanges[rangePos];
+        RowRange parentRange;
+        parentRange.startRow = range.startRow + offset;
+        parentRange.numberOfRows = std::min(range.numberOfRows - offset, remainingRows);
+        parentRanges.push_back(parentRange);
+
+        remainingRows -= parentRange.numberOfRows;
+        offset = 0;
+        rangePos++;
+    }
+}
+
+/**
+ * @brief get position of the range, which contains a specific row of the view
+ *
+ * @param row number of the row within the view, which must exist
+ *
+ * @return position of the range
+ */
+uint64_t
+ViewDataSetFile::findRange(const uint64_t row) const
+{
+    // search last range, which starts before or at the requested row
+    std::vector<uint64_t>::const_iterator it = std::upper_bound(m_rangeStarts.begin(),
+                                                                m_rangeStarts.end(),
+                                                                row);
+    return (it - m_rangeStarts.begin()) - 1;
+}
+
+/**
+ * @brief translate a row of the view into the row within the parent
+ *
+ * @param row number of the row within the view
+ *
+ * @return number of the row within the parent. Rows outside of the view are translated into the
+ *         first row behind the end of the parent, so the parent rejects them like its own
+ *         invalid rows.
+ */
+uint64_t
+ViewDataSetFile::getParentRow(const uint64_t row) const
+{
+    if(row >= viewHeader.numberOfRows) {
+        return m_parent->getNumberOfRows();
+    }
+
+    const uint64_t rangePos = findRange(row);
+    return rowRanges[rangePos].startRow + (row - m_rangeStarts[rangePos]);
+}
+
+/**
+ * @brief get parent data-set, on which the view is based
+ *
+ * @return pointer to the parent
+ */
+DataSetFile*
+ViewDataSetFile::getParent() const
+{
+    return m_parent.get();
+}
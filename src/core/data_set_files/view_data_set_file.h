@@ -0,0 +1,112 @@
+/**
+ * @file        view_data_set_file.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_VIEWDATASETFILE_H
+#define SHIORIARCHIVE_VIEWDATASETFILE_H
+
+#include <core/data_set_files/data_set_file.h>
+
+#include <memory>
+
+class ViewDataSetFile
+        : public DataSetFile
+{
+public:
+    ViewDataSetFile(const std::string &filePath);
+    ~ViewDataSetFile();
+    bool initView(std::shared_ptr<DataSetFile> parent,
+                  const std::string &location,
+                  const std::vector<RowRange> &ranges,
+                  Kitsunemimi::ErrorContainer &error);
+    bool updateHeader();
+    float* getPayload(uint64_t &payloadSize,
+                      const std::string &columnName = "");
+    uint8_t* getCompactPayload(uint64_t &payloadSize,
+                               const std::string &columnName = "");
+    bool getPayloadView(PayloadView &view,
+                        const std::string &columnName = "");
+    float* getPayload(uint64_t &payloadSize,
+                      const uint64_t startRow,
+                      const uint64_t numberOfRows,
+                      const std::string &columnName = "");
+    uint8_t* getCompactPayload(uint64_t &payloadSize,
+                               const uint64_t startRow,
+                               const uint64_t numberOfRows,
+                               const std::string &columnName = "");
+    bool getPayloadView(PayloadView &view,
+                        const uint64_t startRow,
+                        const uint64_t numberOfRows,
+                        const std::string &columnName = "");
+    bool getPayloadViews(std::vector<PayloadView> &views,
+                         const uint64_t startRow,
+                         const uint64_t numberOfRows,
+                         const std::string &columnName = "");
+    float* getColumnsPayload(uint64_t &payloadSize,
+                             const uint64_t startRow,
+                             const uint64_t numberOfRows,
+                             const std::vector<std::string> &columnNames,
+                             const bool columnBlocked);
+    uint8_t* getCompactColumnsPayload(uint64_t &payloadSize,
+                                      const uint64_t startRow,
+                                      const uint64_t numberOfRows,
+                                      const std::vector<std::string> &columnNames,
+                                      const bool columnBlocked);
+    void getColumnNames(std::vector<std::string> &columnNames,
+                        const ColumnGroup group) const;
+    float getColumnMultiplicator(const std::string &columnName) const;
+    bool getViewFileRange(std::string &filePath,
+                          uint64_t &fileOffset,
+                          const PayloadView &view) const;
+    float* gatherPayload(uint64_t &payloadSize,
+                         const std::vector<uint64_t> &rows,
+                         const std::string &columnName = "");
+    uint8_t* gatherCompactPayload(uint64_t &payloadSize,
+                                  const std::vector<uint64_t> &rows,
+                                  const std::string &columnName = "");
+    uint64_t getNumberOfRows() const;
+    uint64_t getValuesPerRow() const;
+    uint64_t getMappedSize() const;
+    void getParentRanges(std::vector<RowRange> &parentRanges,
+                         const uint64_t startRow,
+                         const uint64_t numberOfRows) const;
+
+    DataSetFile* getParent() const;
+
+    ViewTypeHeader viewHeader;
+    std::string parentLocation = "";
+    std::vector<RowRange> rowRanges;
+
+protected:
+    void initHeader();
+    bool readHeader(Kitsunemimi::ErrorContainer &error);
+
+private:
+    bool openParent(Kitsunemimi::ErrorContainer &error);
+    void updateRangeStarts();
+    uint64_t findRange(const uint64_t row) const;
+    uint64_t getParentRow(const uint64_t row) const;
+
+    std::shared_ptr<DataSetFile> m_parent;
+    std::vector<uint64_t> m_rangeStarts;
+};
+
+#endif // SHIORIARCHIVE_VIEWDATASETFILE_H
@@ -0,0 +1,94 @@
+/**
+ * @file        load_coalescer.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "load_coalescer.h"
+
+#include <libKitsunemimiCommon/logger.h>
+
+/**
+ * @brief constructor
+ */
+LoadCoalescer::LoadCoalescer() {}
+
+/**
+ * @brief destructor
+ */
+LoadCoalescer::~LoadCoalescer() {}
+
+/**
+ * @brief load a payload only once for all requests, which come in at the same time. The first
+ *        request of a key runs the load, while all other requests of the same key wait for it
+ *        and get the same buffer, instead of reading the same data again in parallel.
+ *
+ * @param key key, which identifies the requested payload
+ * @param loadFunction function to load the payload, which is only called by the first request
+ *
+ * @return pointer to the loaded payload, or nullptr if the load failed or threw an exception
+ */
+LoadCoalescer::Payload
+LoadCoalescer::load(const std::string &key,
+                    const std::function<Payload()> &loadFunction)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    // join load, which is already running for the same key
+    std::map<std::string, std::shared_ptr<InFlightLoad>>::iterator it = m_inFlight.find(key);
+    if(it != m_inFlight.end())
+    {
+        std::shared_ptr<InFlightLoad> inFlight = it->second;
+        m_loadFinished.wait(lock, [&] { return inFlight->finished; });
+        return inFlight->payload;
+    }
+
+    std::shared_ptr<InFlightLoad> inFlight = std::make_shared<InFlightLoad>();
+    m_inFlight.insert(std::make_pair(key, inFlight));
+    lock.unlock();
+
+    // load outside of the lock to not block the loads of other keys. An exception must not
+    // skip the publishing of the result, because else the waiting requests would never wake up
+    // and the key would be blocked forever.
+    Payload payload = nullptr;
+    try {
+        payload = loadFunction();
+    }
+    catch(const std::exception &exception)
+    {
+        Kitsunemimi::ErrorContainer error;
+        error.addMeesage("Failed to load payload: " + std::string(exception.what()));
+        LOG_ERROR(error);
+    }
+    catch(...)
+    {
+        Kitsunemimi::ErrorContainer error;
+        error.addMeesage("Failed to load payload because of an unknown exception");
+        LOG_ERROR(error);
+    }
+
+    lock.lock();
+    inFlight->payload = payload;
+    inFlight->finished = true;
+    m_inFlight.erase(key);
+    lock.unlock();
+    m_loadFinished.notify_all();
+
+    return payload;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file        load_coalescer.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_LOADCOALESCER_H
+#define SHIORIARCHIVE_LOADCOALESCER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+class LoadCoalescer
+{
+public:
+    typedef std::shared_ptr<const std::vector<uint8_t>> Payload;
+
+    LoadCoalescer();
+    ~LoadCoalescer();
+
+    Payload load(const std::string &key,
+                 const std::function<Payload()> &loadFunction);
+
+private:
+    struct InFlightLoad
+    {
+        Payload payload;
+        bool finished = false;
+    };
+
+    std::mutex m_lock;
+    std::condition_variable m_loadFinished;
+    std::map<std::string, std::shared_ptr<InFlightLoad>> m_inFlight;
+};
+
+#endif // SHIORIARCHIVE_LOADCOALESCER_H
@@ -0,0 +1,381 @@
+/**
+ * @file        local_handoff.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "local_handoff.h"
+
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cstdlib>
+
+/**
+ * @brief constructor
+ *
+ * @param directory directory for the exported payloads, which should be within a tmpfs like
+ *                  /dev/shm, so the payloads are held in shared memory
+ * @param maxBytes maximum number of bytes of all exported payloads. With 0 only payloads, which
+ *                 can be mapped directly from the data-set-files, are handed off.
+ * @param pinSeconds number of seconds, for which an exported payload is not evicted after it was
+ *                   handed to a client, so the client has time to map it
+ */
+LocalHandoff::LocalHandoff(const std::string &directory,
+                           const uint64_t maxBytes,
+                           const uint64_t pinSeconds)
+{
+    m_directory = directory;
+    m_maxBytes = maxBytes;
+    m_pinTime = std::chrono::seconds(pinSeconds);
+    m_bootId = getBootId();
+}
+
+/**
+ * @brief destructor
+ */
+LocalHandoff::~LocalHandoff()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    while(m_entries.size() > 0) {
+        removeEntry(m_entries.begin());
+    }
+}
+
+/**
+ * @brief create the directory for the exported payloads and remove the payloads, which were left
+ *        by previous runs. The names of the files contain the process-id of their creator, so
+ *        other files and the payloads of other running instances within the same directory
+ *        are kept.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+LocalHandoff::initDirectory(Kitsunemimi::ErrorContainer &error)
+{
+    if(m_maxBytes == 0) {
+        return true;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(m_directory, errorCode);
+    if(errorCode)
+    {
+        error.addMeesage("Failed to create directory '" + m_directory + "' for local handoff: "
+                         + errorCode.message());
+        return false;
+    }
+
+    const std::string prefix = getFilePrefix(-1);
+    for(const auto &entry : std::filesystem::directory_iterator(m_directory, errorCode))
+    {
+        const std::string fileName = entry.path().filename().string();
+        if(fileName.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+
+        const int64_t processId = std::atoll(fileName.c_str() + prefix.size());
+        if(processId != getpid()
+                && (processId <= 0 || kill(processId, 0) == 0 || errno != ESRCH))
+        {
+            continue;
+        }
+
+        std::filesystem::remove(entry.path(), errorCode);
+    }
+
+    return true;
+}
+
+/**
+ * @brief check if a client runs on the same host, by comparing the boot-id of its kernel, so
+ *        clients in other containers on the same host can use the handoff too
+ *
+ * @param clientBootId boot-id of the host of the client
+ *
+ * @return true, if the client runs on the same host, else false
+ */
+bool
+LocalHandoff::isLocalClient(const std::string &clientBootId) const
+{
+    return m_bootId.size() > 0
+           && clientBootId == m_bootId;
+}
+
+/**
+ * @brief write a payload, which can not be mapped from its data-set-file, into a read-only file
+ *        within the handoff-directory. Payloads are exported only once and reused by following
+ *        requests, until they are evicted to free space for other payloads. Each handoff pins
+ *        the payload for some time, so it is not removed, before the client mapped it. If there
+ *        is not enough space without evicting pinned payloads, the export fails and the client
+ *        has to request the payload without handoff. Errors of the export are already logged.
+ *
+ * @param segment reference for the exported file
+ * @param key unique key of the payload, which must change, when the data-set changes
+ * @param data payload to export
+ * @param size number of bytes of the payload
+ * @param error reference for error-output
+ *
+ * @return false, if there is not enough space or the export failed, else true
+ */
+bool
+LocalHandoff::exportPayload(Segment &segment,
+                            const std::string &key,
+                            const void* data,
+                            const uint64_t size,
+                            Kitsunemimi::ErrorContainer &error)
+{
+    if(size == 0
+            || size > m_maxBytes)
+    {
+        return false;
+    }
+
+    std::string filePath = "";
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        std::map<std::string, ExportEntry>::iterator it = m_entries.find(key);
+        if(it != m_entries.end())
+        {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+            it->second.pinnedUntil = std::chrono::steady_clock::now() + m_pinTime;
+            segment.filePath = it->second.filePath;
+            segment.offset = 0;
+            segment.size = it->second.size;
+            return true;
+        }
+
+        // reserve the space, before the file is written
+        if(freeSpace(size) == false) {
+            return false;
+        }
+        m_usedBytes += size;
+
+        filePath = m_directory + "/" + getFilePrefix(getpid()) + std::to_string(m_nextFileId);
+        m_nextFileId++;
+    }
+
+    // write the file outside of the lock to not block the handoff of other payloads
+    bool success = false;
+    const int fd = open(filePath.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0444);
+    if(fd < 0)
+    {
+        error.addMeesage("Failed to create file '" + filePath + "' for local handoff: "
+                         + std::string(strerror(errno)));
+    }
+    else
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t writtenBytes = 0;
+        success = true;
+        while(writtenBytes < size)
+        {
+            const ssize_t ret = write(fd, &bytes[writtenBytes], size - writtenBytes);
+            if(ret <= 0)
+            {
+                error.addMeesage("Failed to write file '" + filePath + "' for local handoff: "
+                                 + std::string(strerror(errno)));
+                unlink(filePath.c_str());
+                success = false;
+                break;
+            }
+            writtenBytes += static_cast<uint64_t>(ret);
+        }
+        close(fd);
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(success == false)
+    {
+        LOG_ERROR(error);
+        m_usedBytes -= size;
+        return false;
+    }
+
+    // the same payload was exported by a parallel request in the meantime
+    std::map<std::string, ExportEntry>::iterator it = m_entries.find(key);
+    if(it != m_entries.end())
+    {
+        unlink(filePath.c_str());
+        m_usedBytes -= size;
+        it->second.pinnedUntil = std::chrono::steady_clock::now() + m_pinTime;
+        segment.filePath = it->second.filePath;
+        segment.offset = 0;
+        segment.size = it->second.size;
+        return true;
+    }
+
+    m_lru.push_front(key);
+    ExportEntry entry;
+    entry.filePath = filePath;
+    entry.size = size;
+    entry.pinnedUntil = std::chrono::steady_clock::now() + m_pinTime;
+    entry.lruPos = m_lru.begin();
+    m_entries.emplace(key, entry);
+
+    segment.filePath = filePath;
+    segment.offset = 0;
+    segment.size = size;
+
+    return true;
+}
+
+/**
+ * @brief add a segment to a list of segments and merge it with the last one, if it directly
+ *        follows it within the same file
+ *
+ * @param segments list of segments
+ * @param segment segment to add
+ */
+void
+LocalHandoff::addSegment(std::vector<Segment> &segments,
+                         const Segment &segment)
+{
+    if(segments.size() > 0
+            && segments.back().filePath == segment.filePath
+            && segments.back().offset + segments.back().size == segment.offset)
+    {
+        segments.back().size += segment.size;
+        return;
+    }
+
+    segments.push_back(segment);
+}
+
+/**
+ * @brief create the response for a request with local handoff
+ *
+ * @param response reference for the response
+ * @param segments ranges of files, which contain the payload in the order of the request
+ */
+void
+LocalHandoff::serializeSegments(std::vector<uint8_t> &response,
+                                const std::vector<Segment> &segments)
+{
+    HandoffHeader header;
+    header.numberOfSegments = segments.size();
+    for(const Segment &segment : segments) {
+        header.totalSize += segment.size;
+    }
+
+    const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    response.insert(response.end(), headerBytes, headerBytes + sizeof(HandoffHeader));
+
+    for(const Segment &segment : segments)
+    {
+        SegmentHeader segmentHeader;
+        segmentHeader.offset = segment.offset;
+        segmentHeader.size = segment.size;
+        segmentHeader.pathSize = segment.filePath.size();
+
+        const uint8_t* segmentBytes = reinterpret_cast<const uint8_t*>(&segmentHeader);
+        response.insert(response.end(), segmentBytes, segmentBytes + sizeof(SegmentHeader));
+        response.insert(response.end(), segment.filePath.begin(), segment.filePath.end());
+    }
+}
+
+/**
+ * @brief get the boot-id of the kernel, which identifies the host until its next reboot
+ *
+ * @return boot-id, or empty string, if not available
+ */
+const std::string
+LocalHandoff::getBootId()
+{
+    std::ifstream file("/proc/sys/kernel/random/boot_id");
+    std::string bootId = "";
+    std::getline(file, bootId);
+
+    return bootId;
+}
+
+/**
+ * @brief evict the least recently used payloads, which are not pinned anymore, until there is
+ *        enough space for a new payload. The lock must already be held by the caller.
+ *
+ * @param size number of bytes of the new payload
+ *
+ * @return true, if there is enough space, else false
+ */
+bool
+LocalHandoff::freeSpace(const uint64_t size)
+{
+    if(size > m_maxBytes) {
+        return false;
+    }
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::list<std::string>::iterator lruIt = m_lru.end();
+    while(m_usedBytes + size > m_maxBytes
+          && lruIt != m_lru.begin())
+    {
+        lruIt--;
+        std::map<std::string, ExportEntry>::iterator it = m_entries.find(*lruIt);
+        if(it->second.pinnedUntil > now) {
+            continue;
+        }
+
+        // move the iterator behind the entry, so it stays valid, when the entry is removed
+        lruIt++;
+        removeEntry(it);
+    }
+
+    return m_usedBytes + size <= m_maxBytes;
+}
+
+/**
+ * @brief get the prefix of the names of the exported files
+ *
+ * @param processId id of the process, which created the files, or -1 for the common prefix
+ *                  of all processes
+ *
+ * @return prefix of the file-names
+ */
+const std::string
+LocalHandoff::getFilePrefix(const int64_t processId) const
+{
+    if(processId < 0) {
+        return "shiori_handoff_";
+    }
+
+    return "shiori_handoff_" + std::to_string(processId) + "_";
+}
+
+/**
+ * @brief remove an exported payload. The lock must already be held by the caller.
+ *
+ * @param it iterator to the entry to remove
+ */
+void
+LocalHandoff::removeEntry(const std::map<std::string, ExportEntry>::iterator &it)
+{
+    unlink(it->second.filePath.c_str());
+    m_usedBytes -= it->second.size;
+    m_lru.erase(it->second.lruPos);
+    m_entries.erase(it);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file        local_handoff.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_LOCALHANDOFF_H
+#define SHIORIARCHIVE_LOCALHANDOFF_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <mutex>
+#include <chrono>
+
+class LocalHandoff
+{
+public:
+    // response of a request with local handoff, which is followed by the segments
+    struct HandoffHeader
+    {
+        char magic[8] = {'S', 'H', 'I', 'O', 'R', 'I', 'L', 'H'};
+        uint32_t version = 1;
+        uint32_t numberOfSegments = 0;
+        uint64_t totalSize = 0;
+    };
+    static_assert(sizeof(HandoffHeader) == 24);
+
+    // header of a segment, which is followed by the path of the file to map
+    struct SegmentHeader
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t pathSize = 0;
+        uint32_t padding = 0;
+    };
+    static_assert(sizeof(SegmentHeader) == 24);
+
+    // range of a file, which the client has to map read-only
+    struct Segment
+    {
+        std::string filePath = "";
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    LocalHandoff(const std::string &directory,
+                 const uint64_t maxBytes,
+                 const uint64_t pinSeconds);
+    ~LocalHandoff();
+
+    bool initDirectory(Kitsunemimi::ErrorContainer &error);
+    bool isLocalClient(const std::string &clientBootId) const;
+    bool exportPayload(Segment &segment,
+                       const std::string &key,
+                       const void* data,
+                       const uint64_t size,
+                       Kitsunemimi::ErrorContainer &error);
+
+    static void addSegment(std::vector<Segment> &segments,
+                           const Segment &segment);
+    static void serializeSegments(std::vector<uint8_t> &response,
+                                  const std::vector<Segment> &segments);
+    static const std::string getBootId();
+
+private:
+    struct ExportEntry
+    {
+        std::string filePath = "";
+        uint64_t size = 0;
+        std::chrono::steady_clock::time_point pinnedUntil;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    bool freeSpace(const uint64_t size);
+    void removeEntry(const std::map<std::string, ExportEntry>::iterator &it);
+    const std::string getFilePrefix(const int64_t processId) const;
+
+    std::mutex m_lock;
+    std::string m_directory = "";
+    uint64_t m_maxBytes = 0;
+    std::chrono::seconds m_pinTime;
+    uint64_t m_usedBytes = 0;
+    uint64_t m_nextFileId = 0;
+    std::string m_bootId = "";
+    std::map<std::string, ExportEntry> m_entries;
+    std::list<std::string> m_lru;
+};
+
+#endif // SHIORIARCHIVE_LOCALHANDOFF_H
@@ -0,0 +1,311 @@
+/**
+ * @file        mapped_file.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "mapped_file.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+/**
+ * @brief constructor
+ *
+ * @param filePath path to the file, which should be mapped
+ */
+MappedFile::MappedFile(const std::string &filePath)
+{
+    m_filePath = filePath;
+}
+
+/**
+ * @brief destructor
+ */
+MappedFile::~MappedFile()
+{
+    unmapFile();
+}
+
+/**
+ * @brief map the complete file read-only into the memory. The pages are shared with the
+ *        page-cache of the kernel, so multiple mappings of the same file don't need
+ *        additional memory. Files, which are stored as block-map, are not mapped, but only
+ *        their list of blocks is loaded, so they can be read with readData.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+MappedFile::mapFile(Kitsunemimi::ErrorContainer &error)
+{
+    if(isMapped()
+            || m_isBlockMap)
+    {
+        return true;
+    }
+
+    if(BlockStore::isBlockMap(m_filePath)) {
+        return loadBlockMap(error);
+    }
+
+    const int fd = open(m_filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        error.addMeesage("Failed to open file '" + m_filePath + "' for mapping: "
+                         + std::string(strerror(errno)));
+        return false;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0)
+    {
+        error.addMeesage("Failed to get size of file '" + m_filePath + "': "
+                         + std::string(strerror(errno)));
+        close(fd);
+        return false;
+    }
+
+    // mmap doesn't allow to map empty files
+    if(fileStat.st_size == 0)
+    {
+        error.addMeesage("Failed to map file '" + m_filePath + "', because it is empty");
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after closing the file-descriptor
+    close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        error.addMeesage("Failed to map file '" + m_filePath + "': "
+                         + std::string(strerror(errno)));
+        return false;
+    }
+
+    data = static_cast<const uint8_t*>(mapping);
+    size = fileStat.st_size;
+    m_shared = true;
+
+    return true;
+}
+
+/**
+ * @brief load the list of blocks of a file, which is stored as block-map, and pin the blocks,
+ *        so they stay readable, even if the file is deleted or restored in the meantime. The
+ *        file is never reassembled as a whole, but only the blocks, which overlap with a read
+ *        range, are read.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+MappedFile::loadBlockMap(Kitsunemimi::ErrorContainer &error)
+{
+    std::vector<BlockStore::BlockEntry> blocks;
+    uint64_t totalSize = 0;
+    if(BlockStore::readBlockMap(blocks, totalSize, m_filePath, error) == false) {
+        return false;
+    }
+
+    if(totalSize == 0)
+    {
+        error.addMeesage("Failed to map file '" + m_filePath + "', because it is empty");
+        return false;
+    }
+
+    m_blocks = std::move(blocks);
+    BlockStore::getBlockOffsets(m_blockOffsets, m_blocks);
+    BlockStore::pinBlocks(m_blocks, BlockStore::getBlockDirectory(m_filePath));
+    m_blockMapSize = totalSize;
+    m_isBlockMap = true;
+
+    return true;
+}
+
+/**
+ * @brief remove the mapping of the file, if exist
+ */
+void
+MappedFile::unmapFile()
+{
+    if(m_isBlockMap)
+    {
+        BlockStore::unpinBlocks(m_blocks, BlockStore::getBlockDirectory(m_filePath));
+        m_blocks.clear();
+        m_blockOffsets.clear();
+        m_blockMapSize = 0;
+        m_isBlockMap = false;
+    }
+
+    if(isMapped() == false) {
+        return;
+    }
+
+    munmap(const_cast<uint8_t*>(data), size);
+    data = nullptr;
+    size = 0;
+    m_shared = false;
+}
+
+/**
+ * @brief check if the file is mapped
+ *
+ * @return true, if mapped, else false
+ */
+bool
+MappedFile::isMapped() const
+{
+    return data != nullptr;
+}
+
+/**
+ * @brief check if the file is a block-map, whose list of blocks was loaded
+ *
+ * @return true, if block-map, else false
+ */
+bool
+MappedFile::isBlockMap() const
+{
+    return m_isBlockMap;
+}
+
+/**
+ * @brief get size of the complete file, which is also available for block-maps
+ *
+ * @return size of the file, or 0 if neither mapped nor loaded as block-map
+ */
+uint64_t
+MappedFile::getFileSize() const
+{
+    if(m_isBlockMap) {
+        return m_blockMapSize;
+    }
+
+    return size;
+}
+
+/**
+ * @brief read a range of the file, either from the mapping or from the blocks of a block-map
+ *
+ * @param target pointer to the buffer for the read data
+ * @param offset byte-offset within the file
+ * @param size number of bytes to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+MappedFile::readData(void* target,
+                     const uint64_t offset,
+                     const uint64_t size,
+                     Kitsunemimi::ErrorContainer &error) const
+{
+    if(offset + size > getFileSize())
+    {
+        error.addMeesage("Requested data is outside of the file '" + m_filePath + "'");
+        return false;
+    }
+    if(size == 0) {
+        return true;
+    }
+
+    if(m_isBlockMap)
+    {
+        return BlockStore::readBlocksData(m_blocks,
+                                          m_blockOffsets,
+                                          m_blockMapSize,
+                                          m_filePath,
+                                          target,
+                                          offset,
+                                          size,
+                                          error);
+    }
+
+    memcpy(target, &data[offset], size);
+
+    return true;
+}
+
+/**
+ * @brief get the position of a range of the mapping within the file. This is only possible for
+ *        mappings, which share their pages with the file, so other processes can map the same
+ *        range of the file instead of copying it.
+ *
+ * @param filePath reference for the path of the file
+ * @param fileOffset reference for the byte-offset of the range within the file
+ * @param rangeStart pointer to the first byte of the range within the mapping
+ * @param rangeSize number of bytes of the range
+ *
+ * @return true, if the range is within a shared mapping, else false
+ */
+bool
+MappedFile::getFileRange(std::string &filePath,
+                         uint64_t &fileOffset,
+                         const void* rangeStart,
+                         const uint64_t rangeSize) const
+{
+    const uint8_t* start = static_cast<const uint8_t*>(rangeStart);
+    if(m_shared == false
+            || start < data
+            || start + rangeSize > data + size)
+    {
+        return false;
+    }
+
+    filePath = m_filePath;
+    fileOffset = static_cast<uint64_t>(start - data);
+
+    return true;
+}
+
+/**
+ * @brief tell the kernel, that a range of a mapping will be read soon, so it can read the
+ *        missing pages ahead in large chunks, instead of faulting them in page by page, while
+ *        the range is sent
+ *
+ * @param rangeStart pointer to the first byte of the range within a mapping
+ * @param rangeSize number of bytes of the range
+ */
+void
+MappedFile::prefetchRange(const void* rangeStart,
+                          const uint64_t rangeSize)
+{
+    if(rangeStart == nullptr
+            || rangeSize == 0)
+    {
+        return;
+    }
+
+    // madvise requires a page-aligned start
+    const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t start = reinterpret_cast<uint64_t>(rangeStart);
+    const uint64_t alignedStart = start - (start % pageSize);
+
+    madvise(reinterpret_cast<void*>(alignedStart),
+            rangeSize + (start - alignedStart),
+            MADV_WILLNEED);
+}
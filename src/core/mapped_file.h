@@ -0,0 +1,73 @@
+/**
+ * @file        mapped_file.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_MAPPEDFILE_H
+#define SHIORIARCHIVE_MAPPEDFILE_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <core/block_store.h>
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class MappedFile
+{
+public:
+    MappedFile(const std::string &filePath);
+    ~MappedFile();
+
+    bool mapFile(Kitsunemimi::ErrorContainer &error);
+    void unmapFile();
+    bool isMapped() const;
+    bool isBlockMap() const;
+    uint64_t getFileSize() const;
+    bool readData(void* target,
+                  const uint64_t offset,
+                  const uint64_t size,
+                  Kitsunemimi::ErrorContainer &error) const;
+    bool getFileRange(std::string &filePath,
+                      uint64_t &fileOffset,
+                      const void* rangeStart,
+                      const uint64_t rangeSize) const;
+
+    static void prefetchRange(const void* rangeStart,
+                              const uint64_t rangeSize);
+
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+
+private:
+    bool loadBlockMap(Kitsunemimi::ErrorContainer &error);
+
+    std::string m_filePath = "";
+    bool m_shared = false;
+
+    // files, which are split into deduplicated blocks, are read block by block instead
+    bool m_isBlockMap = false;
+    std::vector<BlockStore::BlockEntry> m_blocks;
+    std::vector<uint64_t> m_blockOffsets;
+    uint64_t m_blockMapSize = 0;
+};
+
+#endif // SHIORIARCHIVE_MAPPEDFILE_H
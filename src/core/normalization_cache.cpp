@@ -0,0 +1,526 @@
+/**
+ * @file        normalization_cache.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "normalization_cache.h"
+
+#include <shiori_root.h>
+#include <core/data_set_cache.h>
+#include <core/data_set_files/data_set_file.h>
+#include <core/data_set_files/table_data_set_file.h>
+#include <core/data_set_files/image_data_set_file.h>
+#include <core/data_set_files/view_data_set_file.h>
+#include <core/data_set_files/value_conversion.h>
+
+#include <libKitsunemimiCommon/methods/file_methods.h>
+
+#include <sys/stat.h>
+#include <cmath>
+
+/**
+ * @brief constructor
+ */
+NormalizationCache::NormalizationCache() {}
+
+/**
+ * @brief destructor
+ */
+NormalizationCache::~NormalizationCache() {}
+
+/**
+ * @brief get location of the normalized variant of a data-set. The variant is created by the
+ *        first request and reused by all following requests, as long as the data-set is not
+ *        modified. Requests, which come in while the variant is created, wait for it instead of
+ *        creating it again.
+ *
+ * @param normalizedLocation reference for the location of the normalized variant
+ * @param location location of the original data-set
+ * @param mode requested normalization-mode
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+NormalizationCache::getNormalizedLocation(std::string &normalizedLocation,
+                                          const std::string &location,
+                                          const uint32_t mode,
+                                          Kitsunemimi::ErrorContainer &error)
+{
+    normalizedLocation = location;
+    if(mode == NO_NORMALIZATION) {
+        return true;
+    }
+    if(mode > Z_SCORE_NORMALIZATION)
+    {
+        error.addMeesage("Unknown normalization-mode " + std::to_string(mode));
+        return false;
+    }
+
+    std::shared_ptr<DataSetFile> file = ShioriRoot::dataSetCache->getDataSetFile(location, error);
+    if(file == nullptr) {
+        return false;
+    }
+
+    // a view has to be normalized again, when its parent was modified
+    std::vector<std::string> sourceLocations = {location};
+    if(file->type == DataSetFile::VIEW_TYPE)
+    {
+        ViewDataSetFile* view = static_cast<ViewDataSetFile*>(file.get());
+        sourceLocations.push_back(view->parentLocation);
+    }
+
+    const NormalizationMode normalizationMode = static_cast<NormalizationMode>(mode);
+    const std::string variantLocation = getVariantLocation(location, normalizationMode);
+
+    // check if variant already exist or is created by another request at the moment
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_variantCreated.wait(lock, [&] { return m_inProgress.count(variantLocation) == 0; });
+    if(isUpToDate(variantLocation, sourceLocations))
+    {
+        normalizedLocation = variantLocation;
+        return true;
+    }
+    m_inProgress.insert(variantLocation);
+    lock.unlock();
+
+    // create variant outside of the lock to not block requests of other data-sets
+    const bool success = createVariant(file.get(), variantLocation, normalizationMode, error);
+
+    lock.lock();
+    m_inProgress.erase(variantLocation);
+    lock.unlock();
+    m_variantCreated.notify_all();
+
+    if(success == false)
+    {
+        error.addMeesage("Failed to create normalized variant of data-set '" + location + "'");
+        return false;
+    }
+
+    normalizedLocation = variantLocation;
+    return true;
+}
+
+/**
+ * @brief delete all normalized variants of a data-set, for example because the data-set itself
+ *        was deleted
+ *
+ * @param location location of the original data-set
+ */
+void
+NormalizationCache::removeVariants(const std::string &location)
+{
+    Kitsunemimi::ErrorContainer error;
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for(const NormalizationMode mode : {MAX_NORMALIZATION, Z_SCORE_NORMALIZATION})
+    {
+        const std::string variantLocation = getVariantLocation(location, mode);
+        int64_t modifyTime = 0;
+        if(getModifyTime(variantLocation, modifyTime) == false) {
+            continue;
+        }
+
+        ShioriRoot::dataSetCache->removeDataSetFile(variantLocation);
+        if(Kitsunemimi::deleteFileOrDir(variantLocation, error) == false) {
+            LOG_ERROR(error);
+        }
+    }
+}
+
+/**
+ * @brief get location of the normalized variant of a data-set
+ *
+ * @param location location of the original data-set
+ * @param mode normalization-mode
+ *
+ * @return location of the variant
+ */
+const std::string
+NormalizationCache::getVariantLocation(const std::string &location,
+                                       const NormalizationMode mode)
+{
+    if(mode == Z_SCORE_NORMALIZATION) {
+        return location + "_z_score_normalized";
+    }
+
+    return location + "_max_normalized";
+}
+
+/**
+ * @brief check if a variant exist and was created after the last modification of its sources
+ *
+ * @param variantLocation location of the variant
+ * @param sourceLocations locations of all files, on which the variant is based
+ *
+ * @return true, if the variant can be used, else false
+ */
+bool
+NormalizationCache::isUpToDate(const std::string &variantLocation,
+                               const std::vector<std::string> &sourceLocations)
+{
+    int64_t variantTime = 0;
+    if(getModifyTime(variantLocation, variantTime) == false) {
+        return false;
+    }
+
+    for(const std::string &sourceLocation : sourceLocations)
+    {
+        int64_t sourceTime = 0;
+        if(getModifyTime(sourceLocation, sourceTime) == false
+                || sourceTime >= variantTime)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief get last modification-time of a file
+ *
+ * @param location path to the file
+ * @param modifyTime reference for the resulting modification-time in nanoseconds
+ *
+ * @return false, if file doesn't exist, else true
+ */
+bool
+NormalizationCache::getModifyTime(const std::string &location,
+                                  int64_t &modifyTime)
+{
+    struct stat fileStat;
+    if(stat(location.c_str(), &fileStat) != 0) {
+        return false;
+    }
+
+    modifyTime = (static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000)
+                 + fileStat.st_mtim.tv_nsec;
+
+    return true;
+}
+
+/**
+ * @brief create the normalized variant of a data-set. The variant is written into a temporary
+ *        file first and moved to its final location afterwards, so the requests never see an
+ *        incomplete variant.
+ *
+ * @param file data-set to normalize
+ * @param variantLocation location of the new variant
+ * @param mode normalization-mode
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+NormalizationCache::createVariant(DataSetFile* file,
+                                  const std::string &variantLocation,
+                                  const NormalizationMode mode,
+                                  Kitsunemimi::ErrorContainer &error)
+{
+    // views have no header of their own, so the structure and statistics of the parent are used
+    DataSetFile* headerFile = file;
+    if(file->type == DataSetFile::VIEW_TYPE) {
+        headerFile = static_cast<ViewDataSetFile*>(file)->getParent();
+    }
+    if(headerFile == nullptr)
+    {
+        error.addMeesage("Parent of view '" + file->name + "' is not available");
+        return false;
+    }
+
+    const std::string tempLocation = variantLocation + ".tmp";
+    bool success = false;
+    if(headerFile->type == DataSetFile::IMAGE_TYPE)
+    {
+        ImageDataSetFile* header = static_cast<ImageDataSetFile*>(headerFile);
+        success = createImageVariant(file, *header, tempLocation, mode, error);
+    }
+    else if(headerFile->type == DataSetFile::TABLE_TYPE)
+    {
+        TableDataSetFile* header = static_cast<TableDataSetFile*>(headerFile);
+        success = createTableVariant(file, *header, tempLocation, mode, error);
+    }
+    else
+    {
+        error.addMeesage("Data-set '" + file->name + "' has a type, which can not be normalized");
+    }
+
+    if(success == false)
+    {
+        Kitsunemimi::ErrorContainer deleteError;
+        Kitsunemimi::deleteFileOrDir(tempLocation, deleteError);
+        return false;
+    }
+
+    return Kitsunemimi::renameFileOrDir(tempLocation, variantLocation, error);
+}
+
+/**
+ * @brief create normalized variant of a table. Each column is normalized on its own and the
+ *        variant is written in columnar layout with float32-values, so requests of a column can
+ *        be served directly from the mapped variant.
+ *
+ * @param file data-set to normalize, which can also be a view of the table
+ * @param header table, which provides the columns and their statistics
+ * @param targetLocation location of the new file
+ * @param mode normalization-mode
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+NormalizationCache::createTableVariant(DataSetFile* file,
+                                       const TableDataSetFile &header,
+                                       const std::string &targetLocation,
+                                       const NormalizationMode mode,
+                                       Kitsunemimi::ErrorContainer &error)
+{
+    const uint64_t numberOfRows = file->getNumberOfRows();
+    const uint64_t numberOfColumns = header.tableColumns.size();
+    std::vector<float> offsets(numberOfColumns, 0.0f);
+    std::vector<float> factors(numberOfColumns, 1.0f);
+
+    // calculate normalization of each column
+    for(uint64_t col = 0; col < numberOfColumns; col++)
+    {
+        const DataSetFile::TableHeaderEntry &entry = header.tableColumns[col];
+        double sum = 0.0;
+        for(uint64_t start = 0;
+            mode == Z_SCORE_NORMALIZATION && start < numberOfRows;
+            start += VALUES_PER_SEGMENT)
+        {
+            uint64_t payloadSize = 0;
+            float* values = file->getPayload(payloadSize, start, VALUES_PER_SEGMENT, entry.name);
+            if(values == nullptr)
+            {
+                error.addMeesage("Failed to read column '" + std::string(entry.name) + "'");
+                return false;
+            }
+            sum += sumSquaredDeviations(values, payloadSize / sizeof(float), entry.averageVal);
+            delete[] values;
+        }
+
+        getNormalization(offsets[col],
+                         factors[col],
+                         mode,
+                         entry.averageVal,
+                         entry.maxVal,
+                         sum,
+                         numberOfRows);
+    }
+
+    // init variant with the normalized statistics
+    TableDataSetFile variant(targetLocation);
+    variant.type = DataSetFile::TABLE_TYPE;
+    variant.name = file->name;
+    variant.layout = DataSetFile::COLUMN_MAJOR_LAYOUT;
+    variant.tableHeader.numberOfLines = numberOfRows;
+    variant.tableColumns = header.tableColumns;
+    for(uint64_t col = 0; col < numberOfColumns; col++)
+    {
+        DataSetFile::TableHeaderEntry &entry = variant.tableColumns[col];
+        entry.averageVal = (entry.averageVal - offsets[col]) * factors[col];
+        entry.maxVal = (entry.maxVal - offsets[col]) * factors[col];
+        entry.scale = 1.0f;
+        entry.zeroPoint = 0.0f;
+    }
+    if(variant.initNewFile() == false)
+    {
+        error.addMeesage("Failed to initialize file '" + targetLocation + "'");
+        return false;
+    }
+
+    // normalize values
+    for(uint64_t col = 0; col < numberOfColumns; col++)
+    {
+        const std::string columnName = header.tableColumns[col].name;
+        for(uint64_t start = 0; start < numberOfRows; start += VALUES_PER_SEGMENT)
+        {
+            uint64_t payloadSize = 0;
+            float* values = file->getPayload(payloadSize, start, VALUES_PER_SEGMENT, columnName);
+            if(values == nullptr)
+            {
+                error.addMeesage("Failed to read column '" + columnName + "'");
+                return false;
+            }
+
+            const uint64_t numberOfValues = payloadSize / sizeof(float);
+            normalizeValues(values, values, numberOfValues, offsets[col], factors[col]);
+            const bool success = variant.addColumnValues(col, start, values, numberOfValues);
+            delete[] values;
+            if(success == false)
+            {
+                error.addMeesage("Failed to write column '" + columnName + "'");
+                return false;
+            }
+        }
+    }
+
+    return variant.updateHeader();
+}
+
+/**
+ * @brief create normalized variant of an image-data-set. Only the inputs are normalized, while
+ *        the labels are copied unchanged.
+ *
+ * @param file data-set to normalize, which can also be a view of the images
+ * @param header image-data-set, which provides the structure and the statistics
+ * @param targetLocation location of the new file
+ * @param mode normalization-mode
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+NormalizationCache::createImageVariant(DataSetFile* file,
+                                       const ImageDataSetFile &header,
+                                       const std::string &targetLocation,
+                                       const NormalizationMode mode,
+                                       Kitsunemimi::ErrorContainer &error)
+{
+    const DataSetFile::ImageTypeHeader &imageHeader = header.imageHeader;
+    const uint64_t numberOfRows = file->getNumberOfRows();
+    const uint64_t numberOfInputs = imageHeader.numberOfInputsX * imageHeader.numberOfInputsY;
+    const uint64_t lineSize = numberOfInputs + imageHeader.numberOfOutputs;
+    const uint64_t rowsPerSegment = std::max<uint64_t>(VALUES_PER_SEGMENT / lineSize, 1);
+
+    // all inputs share the same statistics
+    double sum = 0.0;
+    for(uint64_t start = 0;
+        mode == Z_SCORE_NORMALIZATION && start < numberOfRows;
+        start += rowsPerSegment)
+    {
+        uint64_t payloadSize = 0;
+        float* values = file->getPayload(payloadSize, start, rowsPerSegment);
+        if(values == nullptr)
+        {
+            error.addMeesage("Failed to read images of data-set '" + file->name + "'");
+            return false;
+        }
+
+        const uint64_t numberOfLines = payloadSize / (lineSize * sizeof(float));
+        for(uint64_t line = 0; line < numberOfLines; line++) {
+            sum += sumSquaredDeviations(&values[line * lineSize],
+                                        numberOfInputs,
+                                        imageHeader.avgValue);
+        }
+        delete[] values;
+    }
+
+    float offset = 0.0f;
+    float factor = 1.0f;
+    getNormalization(offset,
+                     factor,
+                     mode,
+                     imageHeader.avgValue,
+                     imageHeader.maxValue,
+                     sum,
+                     numberOfRows * numberOfInputs);
+
+    // init variant with the normalized statistics
+    ImageDataSetFile variant(targetLocation);
+    variant.type = DataSetFile::IMAGE_TYPE;
+    variant.name = file->name;
+    variant.imageHeader = imageHeader;
+    variant.imageHeader.numberOfImages = numberOfRows;
+    variant.imageHeader.avgValue = (imageHeader.avgValue - offset) * factor;
+    variant.imageHeader.maxValue = (imageHeader.maxValue - offset) * factor;
+    variant.imageHeader.scale = 1.0f;
+    variant.imageHeader.zeroPoint = 0.0f;
+    if(variant.initNewFile() == false)
+    {
+        error.addMeesage("Failed to initialize file '" + targetLocation + "'");
+        return false;
+    }
+
+    // normalize inputs
+    for(uint64_t start = 0; start < numberOfRows; start += rowsPerSegment)
+    {
+        uint64_t payloadSize = 0;
+        float* values = file->getPayload(payloadSize, start, rowsPerSegment);
+        if(values == nullptr)
+        {
+            error.addMeesage("Failed to read images of data-set '" + file->name + "'");
+            return false;
+        }
+
+        const uint64_t numberOfLines = payloadSize / (lineSize * sizeof(float));
+        for(uint64_t line = 0; line < numberOfLines; line++)
+        {
+            float* inputs = &values[line * lineSize];
+            normalizeValues(inputs, inputs, numberOfInputs, offset, factor);
+        }
+        const bool success = variant.addBlock(start * lineSize, values, numberOfLines * lineSize);
+        delete[] values;
+        if(success == false)
+        {
+            error.addMeesage("Failed to write images into file '" + targetLocation + "'");
+            return false;
+        }
+    }
+
+    return variant.updateHeader();
+}
+
+/**
+ * @brief get offset and factor of a normalization, which is applied as
+ *        normalized = (value - offset) * factor
+ *
+ * @param offset reference for the resulting offset
+ * @param factor reference for the resulting factor
+ * @param mode normalization-mode
+ * @param mean average of the values
+ * @param maxValue maximum of the values
+ * @param squaredDeviations sum of the squared deviations of the values from their average
+ * @param numberOfValues number of values
+ */
+void
+NormalizationCache::getNormalization(float &offset,
+                                     float &factor,
+                                     const NormalizationMode mode,
+                                     const float mean,
+                                     const float maxValue,
+                                     const double squaredDeviations,
+                                     const uint64_t numberOfValues)
+{
+    offset = 0.0f;
+    factor = 1.0f;
+
+    // values are divided by the maximum
+    if(mode == MAX_NORMALIZATION)
+    {
+        if(maxValue != 0.0f) {
+            factor = 1.0f / maxValue;
+        }
+        return;
+    }
+
+    // values are shifted by the average and divided by the standard-deviation
+    offset = mean;
+    if(numberOfValues > 0)
+    {
+        const double deviation = std::sqrt(squaredDeviations / numberOfValues);
+        if(deviation > 0.0) {
+            factor = 1.0 / deviation;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file        normalization_cache.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_NORMALIZATIONCACHE_H
+#define SHIORIARCHIVE_NORMALIZATIONCACHE_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+
+class DataSetFile;
+class TableDataSetFile;
+class ImageDataSetFile;
+
+class NormalizationCache
+{
+public:
+    enum NormalizationMode
+    {
+        NO_NORMALIZATION = 0,
+        MAX_NORMALIZATION = 1,
+        Z_SCORE_NORMALIZATION = 2
+    };
+
+    NormalizationCache();
+    ~NormalizationCache();
+
+    bool getNormalizedLocation(std::string &normalizedLocation,
+                               const std::string &location,
+                               const uint32_t mode,
+                               Kitsunemimi::ErrorContainer &error);
+    void removeVariants(const std::string &location);
+
+    static const std::string getVariantLocation(const std::string &location,
+                                                const NormalizationMode mode);
+
+private:
+    // number of values, which are normalized at once, to limit the memory-usage
+    static constexpr uint64_t VALUES_PER_SEGMENT = 4 * 1024 * 1024;
+
+    bool isUpToDate(const std::string &variantLocation,
+                    const std::vector<std::string> &sourceLocations);
+    bool getModifyTime(const std::string &location,
+                       int64_t &modifyTime);
+
+    bool createVariant(DataSetFile* file,
+                       const std::string &variantLocation,
+                       const NormalizationMode mode,
+                       Kitsunemimi::ErrorContainer &error);
+    bool createTableVariant(DataSetFile* file,
+                            const TableDataSetFile &header,
+                            const std::string &targetLocation,
+                            const NormalizationMode mode,
+                            Kitsunemimi::ErrorContainer &error);
+    bool createImageVariant(DataSetFile* file,
+                            const ImageDataSetFile &header,
+                            const std::string &targetLocation,
+                            const NormalizationMode mode,
+                            Kitsunemimi::ErrorContainer &error);
+    void getNormalization(float &offset,
+                          float &factor,
+                          const NormalizationMode mode,
+                          const float mean,
+                          const float maxValue,
+                          const double squaredDeviations,
+                          const uint64_t numberOfValues);
+
+    std::mutex m_lock;
+    std::condition_variable m_variantCreated;
+    std::set<std::string> m_inProgress;
+};
+
+#endif // SHIORIARCHIVE_NORMALIZATIONCACHE_H
@@ -0,0 +1,407 @@
+/**
+ * @file        payload_cache.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "payload_cache.h"
+
+#include <core/data_set_cache.h>
+#include <core/data_set_files/data_set_file.h>
+
+#include <functional>
+
+/**
+ * @brief constructor
+ *
+ * @param maxBytes maximum number of bytes of all cached payloads. With 0 the cache is disabled.
+ */
+PayloadCache::PayloadCache(const uint64_t maxBytes)
+{
+    m_maxBytes = maxBytes;
+    m_sketch.resize(SKETCH_DEPTH * SKETCH_WIDTH, 0);
+}
+
+/**
+ * @brief destructor
+ */
+PayloadCache::~PayloadCache() {}
+
+/**
+ * @brief get the complete decoded payload of a data-set or of a column of a table from the
+ *        memory. Payloads, which are not cached yet, are only loaded, if they are requested
+ *        more frequently than the payloads, which would have to be evicted for them, so single
+ *        scans over rarely used data-sets don't flush the payloads of the active trainings.
+ *
+ * @param file opened data-set-file
+ * @param location path to the data-set-file
+ * @param columnName name of the column for table-data-sets
+ * @param compact true for the payload in the data-type, in which it is stored
+ *
+ * @return pointer to the payload, if cached or admitted, else nullptr. The payload stays valid,
+ *         as long as the pointer is held, even if it is evicted in the meantime.
+ */
+std::shared_ptr<const std::vector<uint8_t>>
+PayloadCache::getPayload(std::shared_ptr<DataSetFile> file,
+                         const std::string &location,
+                         const std::string &columnName,
+                         const bool compact)
+{
+    if(m_maxBytes == 0) {
+        return nullptr;
+    }
+
+    ino_t inode = 0;
+    int64_t modifyTime = 0;
+    if(DataSetCache::getFileState(location, inode, modifyTime) == false)
+    {
+        removeDataSet(location);
+        return nullptr;
+    }
+
+    const std::string key = location + "\n" + columnName + "\n" + std::to_string(compact);
+    uint64_t valueSize = sizeof(float);
+    if(compact) {
+        valueSize = file->getValueSize();
+    }
+    const uint64_t size = file->getNumberOfRows() * file->getValuesPerRow() * valueSize;
+
+    // check cache
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        incrementFrequency(key);
+        std::map<std::string, CacheEntry>::iterator it = m_entries.find(key);
+        if(it != m_entries.end())
+        {
+            if(it->second.inode == inode
+                    && it->second.modifyTime == modifyTime)
+            {
+                m_hits++;
+                m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+                return it->second.payload;
+            }
+
+            // file was changed since it was cached
+            removeEntry(it);
+        }
+
+        m_misses++;
+        if(admitEntry(key, location, size) == false)
+        {
+            m_rejections++;
+            return nullptr;
+        }
+    }
+
+    // load payload outside of the lock to not block requests of other payloads. Parallel
+    // requests of the same payload share a single load.
+    std::shared_ptr<const std::vector<uint8_t>> payload;
+    payload = m_loads.load(key, [&] { return loadPayload(file, columnName, compact); });
+    if(payload == nullptr
+            || payload->size() != size)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    // check if the payload was added by another thread in the meantime
+    std::map<std::string, CacheEntry>::iterator it = m_entries.find(key);
+    if(it != m_entries.end()) {
+        return it->second.payload;
+    }
+
+    // evict least recently used payloads, which are not pinned
+    std::list<std::string>::iterator victimIt = m_lru.end();
+    while(m_usedBytes + size > m_maxBytes
+          && victimIt != m_lru.begin())
+    {
+        victimIt--;
+        std::map<std::string, CacheEntry>::iterator victim = m_entries.find(*victimIt);
+        if(m_pinned.count(victim->second.location) > 0) {
+            continue;
+        }
+
+        // step back behind the victim, because its position becomes invalid by the removal
+        victimIt++;
+        removeEntry(victim);
+        m_evictions++;
+    }
+
+    // the payload can still be used for the current request, even if it doesn't fit anymore
+    if(m_usedBytes + size > m_maxBytes) {
+        return payload;
+    }
+
+    CacheEntry entry;
+    entry.payload = payload;
+    entry.location = location;
+    entry.inode = inode;
+    entry.modifyTime = modifyTime;
+    m_lru.push_front(key);
+    entry.lruPos = m_lru.begin();
+    m_usedBytes += size;
+    m_entries.insert(std::make_pair(key, entry));
+
+    return payload;
+}
+
+/**
+ * @brief pin all payloads of a data-set, so they are admitted at their first request and never
+ *        evicted, until the data-set is unpinned again
+ *
+ * @param location path to the data-set-file
+ */
+void
+PayloadCache::pinDataSet(const std::string &location)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_pinned.insert(location);
+}
+
+/**
+ * @brief unpin the payloads of a data-set, so they are evicted like all other payloads
+ *
+ * @param location path to the data-set-file
+ */
+void
+PayloadCache::unpinDataSet(const std::string &location)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_pinned.erase(location);
+}
+
+/**
+ * @brief remove all payloads of a data-set from the cache, for example because it was deleted
+ *
+ * @param location path to the data-set-file
+ */
+void
+PayloadCache::removeDataSet(const std::string &location)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_pinned.erase(location);
+    std::map<std::string, CacheEntry>::iterator it = m_entries.begin();
+    while(it != m_entries.end())
+    {
+        std::map<std::string, CacheEntry>::iterator current = it;
+        it++;
+        if(current->second.location == location) {
+            removeEntry(current);
+        }
+    }
+}
+
+/**
+ * @brief get counters and usage of the cache
+ *
+ * @return current statistics of the cache
+ */
+PayloadCache::CacheStats
+PayloadCache::getStats()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    CacheStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.rejections = m_rejections;
+    stats.usedBytes = m_usedBytes;
+    stats.maxBytes = m_maxBytes;
+    stats.numberOfEntries = m_entries.size();
+    stats.numberOfPinned = m_pinned.size();
+
+    return stats;
+}
+
+/**
+ * @brief read the complete payload of a data-set or a column of a table
+ *
+ * @param file opened data-set-file
+ * @param columnName name of the column for table-data-sets
+ * @param compact true for the payload in the data-type, in which it is stored
+ *
+ * @return pointer to the payload, if successful, else nullptr
+ */
+std::shared_ptr<const std::vector<uint8_t>>
+PayloadCache::loadPayload(std::shared_ptr<DataSetFile> file,
+                          const std::string &columnName,
+                          const bool compact)
+{
+    uint64_t payloadSize = 0;
+    std::shared_ptr<std::vector<uint8_t>> payload = std::make_shared<std::vector<uint8_t>>();
+
+    if(compact)
+    {
+        uint8_t* data = file->getCompactPayload(payloadSize, columnName);
+        if(data == nullptr) {
+            return nullptr;
+        }
+        payload->assign(data, data + payloadSize);
+        delete[] data;
+    }
+    else
+    {
+        float* data = file->getPayload(payloadSize, columnName);
+        if(data == nullptr) {
+            return nullptr;
+        }
+        const uint8_t* dataBytes = reinterpret_cast<const uint8_t*>(data);
+        payload->assign(dataBytes, dataBytes + payloadSize);
+        delete[] data;
+    }
+
+    return payload;
+}
+
+/**
+ * @brief decide, if a new payload should be cached (TinyLFU-admission). Payloads of pinned
+ *        data-sets are always admitted. Other payloads must be requested at least twice and,
+ *        if other payloads have to be evicted for them, more frequently than each of these.
+ *        The lock must already be held by the caller.
+ *
+ * @param key key of the new payload
+ * @param location path to the data-set-file of the new payload
+ * @param size number of bytes of the new payload
+ *
+ * @return true, if the payload should be loaded into the cache, else false
+ */
+bool
+PayloadCache::admitEntry(const std::string &key,
+                         const std::string &location,
+                         const uint64_t size)
+{
+    if(size == 0
+            || size > m_maxBytes)
+    {
+        return false;
+    }
+    if(m_pinned.count(location) > 0) {
+        return true;
+    }
+
+    const uint32_t frequency = estimateFrequency(key);
+    if(frequency < 2) {
+        return false;
+    }
+
+    // compare with the least recently used payloads, which would be evicted
+    uint64_t freeBytes = m_maxBytes - std::min(m_usedBytes, m_maxBytes);
+    std::list<std::string>::reverse_iterator victimIt = m_lru.rbegin();
+    while(freeBytes < size
+          && victimIt != m_lru.rend())
+    {
+        const std::string &victimKey = *victimIt;
+        const CacheEntry &victim = m_entries.at(victimKey);
+        victimIt++;
+        if(m_pinned.count(victim.location) > 0) {
+            continue;
+        }
+        if(estimateFrequency(victimKey) >= frequency) {
+            return false;
+        }
+
+        freeBytes += victim.payload->size();
+    }
+
+    return freeBytes >= size;
+}
+
+/**
+ * @brief remove entry from the cache. The lock must already be held by the caller.
+ *
+ * @param it iterator to the entry
+ */
+void
+PayloadCache::removeEntry(const std::map<std::string, CacheEntry>::iterator &it)
+{
+    m_usedBytes -= it->second.payload->size();
+    m_lru.erase(it->second.lruPos);
+    m_entries.erase(it);
+}
+
+/**
+ * @brief count a request of a payload within the frequency-sketch. After a fixed number of
+ *        requests all counters are halved, so the frequencies follow the current workload.
+ *        The lock must already be held by the caller.
+ *
+ * @param key key of the payload
+ */
+void
+PayloadCache::incrementFrequency(const std::string &key)
+{
+    for(uint64_t row = 0; row < SKETCH_DEPTH; row++)
+    {
+        uint8_t &counter = m_sketch[getSketchPos(key, row)];
+        if(counter < 255) {
+            counter++;
+        }
+    }
+
+    m_sketchIncrements++;
+    if(m_sketchIncrements >= 10 * SKETCH_WIDTH)
+    {
+        for(uint8_t &counter : m_sketch) {
+            counter /= 2;
+        }
+        m_sketchIncrements = 0;
+    }
+}
+
+/**
+ * @brief estimate the number of requests of a payload as minimum of its counters
+ *
+ * @param key key of the payload
+ *
+ * @return estimated number of requests
+ */
+uint32_t
+PayloadCache::estimateFrequency(const std::string &key) const
+{
+    uint32_t frequency = 255;
+    for(uint64_t row = 0; row < SKETCH_DEPTH; row++) {
+        frequency = std::min<uint32_t>(frequency, m_sketch[getSketchPos(key, row)]);
+    }
+
+    return frequency;
+}
+
+/**
+ * @brief get position of the counter of a payload within a row of the sketch
+ *
+ * @param key key of the payload
+ * @param row row of the sketch
+ *
+ * @return position of the counter within the sketch
+ */
+uint64_t
+PayloadCache::getSketchPos(const std::string &key,
+                           const uint64_t row) const
+{
+    // mix the hash with a different seed for each row
+    uint64_t hash = std::hash<std::string>()(key) + (row + 1) * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return row * SKETCH_WIDTH + (hash & (SKETCH_WIDTH - 1));
+}
@@ -0,0 +1,113 @@
+/**
+ * @file        payload_cache.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_PAYLOADCACHE_H
+#define SHIORIARCHIVE_PAYLOADCACHE_H
+
+#include <libKitsunemimiCommon/logger.h>
+#include <core/load_coalescer.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <sys/types.h>
+
+class DataSetFile;
+
+class PayloadCache
+{
+public:
+    struct CacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t rejections = 0;
+        uint64_t usedBytes = 0;
+        uint64_t maxBytes = 0;
+        uint64_t numberOfEntries = 0;
+        uint64_t numberOfPinned = 0;
+    };
+
+    PayloadCache(const uint64_t maxBytes);
+    ~PayloadCache();
+
+    std::shared_ptr<const std::vector<uint8_t>> getPayload(std::shared_ptr<DataSetFile> file,
+                                                           const std::string &location,
+                                                           const std::string &columnName,
+                                                           const bool compact);
+    void pinDataSet(const std::string &location);
+    void unpinDataSet(const std::string &location);
+    void removeDataSet(const std::string &location);
+    CacheStats getStats();
+
+private:
+    struct CacheEntry
+    {
+        std::shared_ptr<const std::vector<uint8_t>> payload;
+        std::string location = "";
+        ino_t inode = 0;
+        int64_t modifyTime = 0;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    // number of counters of each row of the frequency-sketch, which must be a power of two
+    static constexpr uint64_t SKETCH_WIDTH = 16384;
+    static constexpr uint64_t SKETCH_DEPTH = 4;
+
+    std::shared_ptr<const std::vector<uint8_t>> loadPayload(std::shared_ptr<DataSetFile> file,
+                                                            const std::string &columnName,
+                                                            const bool compact);
+    bool admitEntry(const std::string &key,
+                    const std::string &location,
+                    const uint64_t size);
+    void removeEntry(const std::map<std::string, CacheEntry>::iterator &it);
+
+    void incrementFrequency(const std::string &key);
+    uint32_t estimateFrequency(const std::string &key) const;
+    uint64_t getSketchPos(const std::string &key,
+                          const uint64_t row) const;
+
+    std::mutex m_lock;
+    std::map<std::string, CacheEntry> m_entries;
+    std::list<std::string> m_lru;
+    std::set<std::string> m_pinned;
+    uint64_t m_usedBytes = 0;
+    uint64_t m_maxBytes = 0;
+    LoadCoalescer m_loads;
+
+    // count-min-sketch of the request-frequencies, which are halved periodically, so old
+    // popularity fades out
+    std::vector<uint8_t> m_sketch;
+    uint64_t m_sketchIncrements = 0;
+
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+    uint64_t m_rejections = 0;
+};
+
+#endif // SHIORIARCHIVE_PAYLOADCACHE_H
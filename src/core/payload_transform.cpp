@@ -0,0 +1,236 @@
+/**
+ * @file        payload_transform.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "payload_transform.h"
+
+#include <core/data_set_files/value_conversion.h>
+
+#include <cmath>
+#include <cstring>
+
+/**
+ * @brief check if any transform is requested
+ *
+ * @return true, if at least one transform is requested, else false
+ */
+bool
+PayloadTransform::isActive() const
+{
+    return scaleByMultiplicator
+           || clip
+           || logarithm
+           || oneHotClasses > 0;
+}
+
+/**
+ * @brief get the number of values, which are served for each value of the payload
+ *
+ * @return number of classes with one-hot-expansion, else 1
+ */
+uint64_t
+PayloadTransform::getValuesPerValue() const
+{
+    if(oneHotClasses > 0) {
+        return oneHotClasses;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief check if the requested transforms are valid
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if valid, else false
+ */
+bool
+PayloadTransform::checkTransform(Kitsunemimi::ErrorContainer &error) const
+{
+    if(clip
+            && (std::isnan(clipMin)
+                || std::isnan(clipMax)
+                || clipMin > clipMax))
+    {
+        error.addMeesage("Invalid clip-range [" + std::to_string(clipMin)
+                         + ", " + std::to_string(clipMax) + "]");
+        return false;
+    }
+
+    // clipping to a range below -1 would produce values without logarithm
+    if(clip
+            && logarithm
+            && clipMin < -1.0f)
+    {
+        error.addMeesage("Clip-range [" + std::to_string(clipMin)
+                         + ", " + std::to_string(clipMax) + "] contains values below -1, "
+                         "which have no logarithm");
+        return false;
+    }
+
+    if(oneHotClasses > MAX_ONE_HOT_CLASSES)
+    {
+        error.addMeesage("Number of classes for one-hot-expansion is limited to "
+                         + std::to_string(MAX_ONE_HOT_CLASSES));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief check if the transformed values of a payload fit into a response. A one-hot-expansion
+ *        multiplies the size of the payload, so a valid request for a large data-set could
+ *        otherwise allocate more memory than available.
+ *
+ * @param numberOfValues number of values of the payload before the transforms
+ * @param maxBytes maximum number of bytes of the transformed values
+ * @param error reference for error-output
+ *
+ * @return true, if the transformed values fit, else false
+ */
+bool
+PayloadTransform::checkTransformedSize(const uint64_t numberOfValues,
+                                       const uint64_t maxBytes,
+                                       Kitsunemimi::ErrorContainer &error) const
+{
+    const uint64_t maxValues = maxBytes / sizeof(float) / getValuesPerValue();
+    if(numberOfValues > maxValues)
+    {
+        error.addMeesage("Transformed payload of " + std::to_string(numberOfValues)
+                         + " values with " + std::to_string(getValuesPerValue())
+                         + " values per value is bigger than the limit of "
+                         + std::to_string(maxBytes) + " bytes");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief apply the transforms to values
+ *
+ * @param target buffer for numberOfValues * transform.getValuesPerValue() values, which can be
+ *               the same as the source, if no one-hot-expansion is requested
+ * @param source values to transform
+ * @param numberOfValues number of values of the source
+ * @param multiplicator factor for the scaling of the values
+ * @param transform requested transforms
+ */
+void
+transformPayload(float* target,
+                 const float* source,
+                 const uint64_t numberOfValues,
+                 const float multiplicator,
+                 const PayloadTransform &transform)
+{
+    // one-hot-vectors are created out of the other transformed values, so these have to be
+    // buffered in this case
+    std::vector<float> buffer;
+    float* values = target;
+    if(transform.oneHotClasses > 0)
+    {
+        buffer.resize(numberOfValues);
+        values = buffer.data();
+    }
+
+    float factor = 1.0f;
+    if(transform.scaleByMultiplicator) {
+        factor = multiplicator;
+    }
+    if(factor != 1.0f) {
+        normalizeValues(values, source, numberOfValues, 0.0f, factor);
+    }
+    if(factor == 1.0f
+            && values != source)
+    {
+        memcpy(values, source, numberOfValues * sizeof(float));
+    }
+
+    if(transform.clip) {
+        clipValues(values, numberOfValues, transform.clipMin, transform.clipMax);
+    }
+    if(transform.logarithm) {
+        logValues(values, numberOfValues);
+    }
+    if(transform.oneHotClasses > 0) {
+        expandOneHot(target, values, numberOfValues, transform.oneHotClasses);
+    }
+}
+
+/**
+ * @brief apply the transforms to a payload of multiple columns. Each column is transformed as
+ *        one contiguous block, so the kernels can run over complete columns, even if the
+ *        columns are served row by row interleaved.
+ *
+ * @param target buffer for the transformed values, which must not be the same as the source
+ * @param source values of the columns, stored column by column
+ * @param numberOfRows number of rows of each column
+ * @param valuesPerRow number of values of a row of a column
+ * @param multiplicators factors for the scaling of the values of each column
+ * @param columnBlocked true to store the transformed columns contiguous one after another,
+ *                      false to interleave the columns row by row
+ * @param transform requested transforms, which must not contain a one-hot-expansion
+ */
+void
+transformColumnsPayload(float* target,
+                        const float* source,
+                        const uint64_t numberOfRows,
+                        const uint64_t valuesPerRow,
+                        const std::vector<float> &multiplicators,
+                        const bool columnBlocked,
+                        const PayloadTransform &transform)
+{
+    const uint64_t numberOfColumns = multiplicators.size();
+    const uint64_t columnSize = numberOfRows * valuesPerRow;
+
+    if(columnBlocked)
+    {
+        for(uint64_t col = 0; col < numberOfColumns; col++)
+        {
+            transformPayload(&target[col * columnSize],
+                             &source[col * columnSize],
+                             columnSize,
+                             multiplicators[col],
+                             transform);
+        }
+        return;
+    }
+
+    std::vector<float> column(columnSize);
+    const uint64_t rowSize = numberOfColumns * valuesPerRow;
+    for(uint64_t col = 0; col < numberOfColumns; col++)
+    {
+        transformPayload(column.data(),
+                         &source[col * columnSize],
+                         columnSize,
+                         multiplicators[col],
+                         transform);
+
+        for(uint64_t row = 0; row < numberOfRows; row++)
+        {
+            memcpy(&target[(row * rowSize) + (col * valuesPerRow)],
+                   &column[row * valuesPerRow],
+                   valuesPerRow * sizeof(float));
+        }
+    }
+}
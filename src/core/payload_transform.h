@@ -0,0 +1,69 @@
+/**
+ * @file        payload_transform.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_PAYLOADTRANSFORM_H
+#define SHIORIARCHIVE_PAYLOADTRANSFORM_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// transforms of the float-values of a payload, which are applied while the payload is served,
+// so the trainers don't have to repeat them in each epoch. They are applied in the order of the
+// fields. The logarithm is ln(1 + value), which is not defined for values below -1, so these
+// values become NaN, if they are not clipped before.
+struct PayloadTransform
+{
+    bool scaleByMultiplicator = false;
+    bool clip = false;
+    float clipMin = 0.0f;
+    float clipMax = 0.0f;
+    bool logarithm = false;
+    uint32_t oneHotClasses = 0;
+
+    // limit of the number of classes, so a request can not blow up the payload arbitrarily
+    static constexpr uint32_t MAX_ONE_HOT_CLASSES = 65536;
+
+    bool isActive() const;
+    uint64_t getValuesPerValue() const;
+    bool checkTransform(Kitsunemimi::ErrorContainer &error) const;
+    bool checkTransformedSize(const uint64_t numberOfValues,
+                              const uint64_t maxBytes,
+                              Kitsunemimi::ErrorContainer &error) const;
+};
+
+void transformPayload(float* target,
+                      const float* source,
+                      const uint64_t numberOfValues,
+                      const float multiplicator,
+                      const PayloadTransform &transform);
+void transformColumnsPayload(float* target,
+                             const float* source,
+                             const uint64_t numberOfRows,
+                             const uint64_t valuesPerRow,
+                             const std::vector<float> &multiplicators,
+                             const bool columnBlocked,
+                             const PayloadTransform &transform);
+
+#endif // SHIORIARCHIVE_PAYLOADTRANSFORM_H
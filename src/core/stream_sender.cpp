@@ -0,0 +1,629 @@
+/**
+ * @file        stream_sender.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "stream_sender.h"
+
+#include <libKitsunemimiCommon/files/binary_file.h>
+#include <libKitsunemimiSakuraNetwork/session.h>
+
+#include <atomic>
+#include <filesystem>
+#include <cstring>
+
+// ids to allow the clients to assign the chunks of parallel streams of one session
+static std::atomic<uint64_t> nextStreamId(1);
+
+/**
+ * @brief constructor
+ *
+ * @param chunkSize requested number of bytes of each chunk, which is limited to the range
+ *                  between MIN_CHUNK_SIZE and MAX_CHUNK_SIZE
+ * @param chunksInFlight maximum number of chunks, which are read ahead and not sent yet
+ */
+StreamSender::StreamSender(const uint64_t chunkSize,
+                           const uint64_t chunksInFlight)
+{
+    m_streamId = nextStreamId++;
+    m_chunkSize = std::min(std::max(chunkSize, MIN_CHUNK_SIZE), MAX_CHUNK_SIZE);
+    m_chunksInFlight = std::max<uint64_t>(chunksInFlight, 1);
+}
+
+/**
+ * @brief destructor, which stops the read-thread, if still running
+ */
+StreamSender::~StreamSender()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_abort = true;
+    }
+    m_cond.notify_all();
+
+    if(m_readThread.joinable()) {
+        m_readThread.join();
+    }
+}
+
+/**
+ * @brief send the content as stream. The stream-header is sent as response of the request and
+ *        is followed by the chunks as stream-messages, so the client can process the first
+ *        chunks, while the following are still transfered. The chunks are read by a background-
+ *        thread, which stays at most the number of chunks in flight ahead of the sending. So
+ *        the memory-usage is limited, independent of the size of the content, and a slow client
+ *        slows down the reading instead of filling the memory.
+ *
+ * @param session pointer to the session, which received the request
+ * @param blockerId blocker-id for the response
+ * @param error reference for error-output
+ *
+ * @return true, if all chunks were sent, else false
+ */
+bool
+StreamSender::sendStream(Kitsunemimi::Sakura::Session* session,
+                         const uint64_t blockerId,
+                         Kitsunemimi::ErrorContainer &error)
+{
+    const uint64_t numberOfChunks = getNumberOfChunks();
+
+    // send header as response
+    StreamHeader header;
+    header.streamId = m_streamId;
+    header.totalSize = m_totalSize;
+    header.chunkSize = m_chunkSize;
+    header.numberOfChunks = numberOfChunks;
+    if(session->sendResponse(&header, sizeof(StreamHeader), blockerId, error) == false)
+    {
+        error.addMeesage("Failed to send header of stream " + std::to_string(m_streamId));
+        return false;
+    }
+    if(numberOfChunks == 0) {
+        return true;
+    }
+
+    // buffers for the chunks, which are read ahead
+    m_slots.resize(std::min(m_chunksInFlight, numberOfChunks));
+    for(std::vector<uint8_t> &slot : m_slots) {
+        slot.resize(sizeof(ChunkHeader) + m_chunkSize);
+    }
+    m_readThread = std::thread(&StreamSender::readLoop, this);
+
+    bool success = true;
+    for(uint64_t chunk = 0; chunk < numberOfChunks; chunk++)
+    {
+        // wait until the chunk was read
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_cond.wait(lock, [this, chunk] { return m_readChunks > chunk || m_readFailed; });
+            if(m_readChunks <= chunk)
+            {
+                error.addMeesage("Failed to read chunk " + std::to_string(chunk)
+                                 + " of stream " + std::to_string(m_streamId));
+                success = false;
+            }
+        }
+
+        // inform the client about the failure, so it doesn't wait for the missing chunks
+        if(success == false)
+        {
+            ChunkHeader failedHeader;
+            failedHeader.streamId = m_streamId;
+            failedHeader.chunkIndex = chunk;
+            failedHeader.offset = chunk * m_chunkSize;
+            failedHeader.flags = FAILED_FLAG;
+            session->sendStreamData(&failedHeader, sizeof(ChunkHeader), error);
+            break;
+        }
+
+        // send chunk
+        const std::vector<uint8_t> &slot = m_slots[chunk % m_slots.size()];
+        ChunkHeader chunkHeader;
+        memcpy(&chunkHeader, &slot[0], sizeof(ChunkHeader));
+        if(session->sendStreamData(&slot[0],
+                                   sizeof(ChunkHeader) + chunkHeader.size,
+                                   error) == false)
+        {
+            error.addMeesage("Failed to send chunk " + std::to_string(chunk)
+                             + " of stream " + std::to_string(m_streamId));
+            success = false;
+            break;
+        }
+
+        // release buffer of the chunk for the read-thread
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_sentChunks++;
+        }
+        m_cond.notify_all();
+    }
+
+    // stop read-thread
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_abort = true;
+    }
+    m_cond.notify_all();
+    m_readThread.join();
+
+    return success;
+}
+
+/**
+ * @brief loop of the read-thread, which reads the chunks into the free buffers
+ */
+void
+StreamSender::readLoop()
+{
+    const uint64_t numberOfChunks = getNumberOfChunks();
+
+    for(uint64_t chunk = 0; chunk < numberOfChunks; chunk++)
+    {
+        // wait until the buffer of the chunk was sent
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_cond.wait(lock, [this, chunk] {
+                return m_abort || chunk - m_sentChunks < m_slots.size();
+            });
+            if(m_abort) {
+                return;
+            }
+        }
+
+        // the buffer is not accessed by the sender, until the chunk is marked as read
+        std::vector<uint8_t> &slot = m_slots[chunk % m_slots.size()];
+        ChunkHeader chunkHeader;
+        chunkHeader.streamId = m_streamId;
+        chunkHeader.chunkIndex = chunk;
+        chunkHeader.offset = chunk * m_chunkSize;
+        chunkHeader.size = std::min(m_chunkSize, m_totalSize - chunkHeader.offset);
+        if(chunk == numberOfChunks - 1) {
+            chunkHeader.flags = LAST_CHUNK_FLAG;
+        }
+        memcpy(&slot[0], &chunkHeader, sizeof(ChunkHeader));
+
+        Kitsunemimi::ErrorContainer error;
+        const bool success = readData(&slot[sizeof(ChunkHeader)],
+                                      chunkHeader.offset,
+                                      chunkHeader.size,
+                                      error);
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if(success) {
+                m_readChunks++;
+            }
+            m_readFailed = success == false;
+        }
+        m_cond.notify_all();
+
+        if(success == false)
+        {
+            LOG_ERROR(error);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief get number of chunks of the stream
+ *
+ * @return number of chunks
+ */
+uint64_t
+StreamSender::getNumberOfChunks() const
+{
+    return (m_totalSize + m_chunkSize - 1) / m_chunkSize;
+}
+
+//==================================================================================================
+// DataSetStreamSender
+//==================================================================================================
+
+/**
+ * @brief constructor. The chunks contain always complete rows, so the chunk-size is reduced to
+ *        a multiple of the size of a row.
+ *
+ * @param file data-set-file to read
+ * @param ranges ranges of rows to send
+ * @param columnName name of the column for table-data-sets
+ * @param compact true to send the values in the data-type, in which they are stored
+ * @param transform transforms, which are applied to the float-values of each chunk
+ * @param chunkSize requested number of bytes of each chunk
+ * @param chunksInFlight maximum number of chunks, which are read ahead and not sent yet
+ */
+DataSetStreamSender::DataSetStreamSender(std::shared_ptr<DataSetFile> file,
+                                         const std::vector<DataSetFile::RowRange> &ranges,
+                                         const std::string &columnName,
+                                         const bool compact,
+                                         const PayloadTransform &transform,
+                                         const uint64_t chunkSize,
+                                         const uint64_t chunksInFlight)
+    : StreamSender(chunkSize, chunksInFlight)
+{
+    m_file = file;
+    m_columnName = columnName;
+    m_compact = compact;
+    m_transform = transform;
+    m_multiplicator = m_file->getColumnMultiplicator(m_columnName);
+
+    uint64_t valueSize = sizeof(float);
+    if(m_compact) {
+        valueSize = m_file->getValueSize();
+    }
+    m_sourceRowSize = std::max<uint64_t>(m_file->getValuesPerRow() * valueSize, 1);
+    m_rowSize = m_sourceRowSize * m_transform.getValuesPerValue();
+    m_chunkSize = std::max<uint64_t>(m_chunkSize / m_rowSize, 1) * m_rowSize;
+
+    // limit ranges to the existing rows
+    const uint64_t totalRows = m_file->getNumberOfRows();
+    for(DataSetFile::RowRange range : ranges)
+    {
+        if(range.startRow >= totalRows) {
+            continue;
+        }
+
+        range.numberOfRows = std::min(range.numberOfRows, totalRows - range.startRow);
+        m_ranges.push_back(range);
+        m_totalSize += range.numberOfRows * m_rowSize;
+    }
+}
+
+/**
+ * @brief destructor
+ */
+DataSetStreamSender::~DataSetStreamSender() {}
+
+/**
+ * @brief read the rows of a chunk, which can be spread over multiple ranges
+ *
+ * @param target buffer for the read rows
+ * @param offset byte-offset of the chunk within the stream
+ * @param size number of bytes of the chunk
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetStreamSender::readData(uint8_t* target,
+                              const uint64_t offset,
+                              const uint64_t size,
+                              Kitsunemimi::ErrorContainer &error)
+{
+    const uint64_t firstRow = offset / m_rowSize;
+    const uint64_t endRow = firstRow + (size / m_rowSize);
+
+    uint64_t rangeStart = 0;
+    for(const DataSetFile::RowRange &range : m_ranges)
+    {
+        const uint64_t rangeEnd = rangeStart + range.numberOfRows;
+        if(rangeEnd > firstRow
+                && rangeStart < endRow)
+        {
+            const uint64_t readStart = std::max(rangeStart, firstRow);
+            const uint64_t readEnd = std::min(rangeEnd, endRow);
+
+            DataSetFile::RowRange part;
+            part.startRow = range.startRow + (readStart - rangeStart);
+            part.numberOfRows = readEnd - readStart;
+            if(readTransformedRows(&target[(readStart - firstRow) * m_rowSize],
+                                   part,
+                                   error) == false)
+            {
+                return false;
+            }
+        }
+
+        rangeStart = rangeEnd;
+        if(rangeStart >= endRow) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief read a range of rows of the file and apply the requested transforms to them
+ *
+ * @param target buffer for the transformed rows
+ * @param range range of rows to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetStreamSender::readTransformedRows(uint8_t* target,
+                                         const DataSetFile::RowRange &range,
+                                         Kitsunemimi::ErrorContainer &error)
+{
+    if(m_transform.isActive() == false) {
+        return readRows(target, range, error);
+    }
+
+    // with one-hot-expansion the transformed rows are larger than the read rows, so they can
+    // not be transformed in place
+    std::vector<uint8_t> buffer;
+    uint8_t* rows = target;
+    if(m_transform.getValuesPerValue() > 1)
+    {
+        buffer.resize(range.numberOfRows * m_sourceRowSize);
+        rows = buffer.data();
+    }
+
+    if(readRows(rows, range, error) == false) {
+        return false;
+    }
+
+    transformPayload(reinterpret_cast<float*>(target),
+                     reinterpret_cast<const float*>(rows),
+                     (range.numberOfRows * m_sourceRowSize) / sizeof(float),
+                     m_multiplicator,
+                     m_transform);
+
+    return true;
+}
+
+/**
+ * @brief read a range of rows of the file, directly from the mapped file, if possible
+ *
+ * @param target buffer for the read rows
+ * @param range range of rows to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetStreamSender::readRows(uint8_t* target,
+                              const DataSetFile::RowRange &range,
+                              Kitsunemimi::ErrorContainer &error)
+{
+    const uint64_t expectedSize = range.numberOfRows * m_sourceRowSize;
+
+    // copy rows directly from the mapped file, if they are stored in the requested data-type
+    std::vector<DataSetFile::PayloadView> views;
+    bool mapped = m_file->getPayloadViews(views,
+                                          range.startRow,
+                                          range.numberOfRows,
+                                          m_columnName);
+    for(const DataSetFile::PayloadView &view : views)
+    {
+        if(m_compact == false
+                && view.dataType != DataSetFile::FLOAT32_DTYPE)
+        {
+            mapped = false;
+        }
+    }
+    if(mapped)
+    {
+        uint64_t targetPos = 0;
+        for(const DataSetFile::PayloadView &view : views)
+        {
+            if(targetPos + view.size > expectedSize) {
+                break;
+            }
+            memcpy(&target[targetPos], view.data, view.size);
+            targetPos += view.size;
+        }
+        if(targetPos == expectedSize) {
+            return true;
+        }
+    }
+
+    // read and convert rows
+    uint64_t payloadSize = 0;
+    if(m_compact)
+    {
+        uint8_t* payload = m_file->getCompactPayload(payloadSize,
+                                                     range.startRow,
+                                                     range.numberOfRows,
+                                                     m_columnName);
+        if(payload != nullptr
+                && payloadSize == expectedSize)
+        {
+            memcpy(target, payload, payloadSize);
+        }
+        delete[] payload;
+    }
+    else
+    {
+        float* payload = m_file->getPayload(payloadSize,
+                                            range.startRow,
+                                            range.numberOfRows,
+                                            m_columnName);
+        if(payload != nullptr
+                && payloadSize == expectedSize)
+        {
+            memcpy(target, payload, payloadSize);
+        }
+        delete[] payload;
+    }
+
+    if(payloadSize != expectedSize)
+    {
+        error.addMeesage("Failed to read rows " + std::to_string(range.startRow) + " to "
+                         + std::to_string(range.startRow + range.numberOfRows)
+                         + " of data-set '" + m_file->name + "'");
+        return false;
+    }
+
+    return true;
+}
+
+//==================================================================================================
+// FileStreamSender
+//==================================================================================================
+
+/**
+ * @brief constructor
+ *
+ * @param location path of the file to send
+ * @param chunkSize requested number of bytes of each chunk
+ * @param chunksInFlight maximum number of chunks, which are read ahead and not sent yet
+ */
+FileStreamSender::FileStreamSender(const std::string &location,
+                                   const uint64_t chunkSize,
+                                   const uint64_t chunksInFlight)
+    : StreamSender(chunkSize, chunksInFlight)
+{
+    m_location = location;
+}
+
+/**
+ * @brief destructor
+ */
+FileStreamSender::~FileStreamSender()
+{
+    if(m_file != nullptr) {
+        delete m_file;
+    }
+    if(m_blockMap != nullptr) {
+        delete m_blockMap;
+    }
+}
+
+/**
+ * @brief prepare the file for sending. Only a byte-range of the file can be sent, for example
+ *        to restore only a part of a snapshot or to resume an interrupted transfer.
+ *
+ * @param rangeOffset byte-offset of the first byte to send
+ * @param rangeSize number of bytes to send. With 0 all bytes behind the offset are sent.
+ * @param error reference for error-output
+ *
+ * @return false, if the file doesn't exist or the offset is behind the end of the file, else true
+ */
+bool
+FileStreamSender::initFile(const uint64_t rangeOffset,
+                           const uint64_t rangeSize,
+                           Kitsunemimi::ErrorContainer &error)
+{
+    uint64_t fileSize = 0;
+    if(getFileSize(fileSize, m_location, error) == false) {
+        return false;
+    }
+
+    if(rangeOffset > fileSize)
+    {
+        error.addMeesage("Offset " + std::to_string(rangeOffset) + " is behind the end of file '"
+                         + m_location + "'");
+        return false;
+    }
+
+    m_rangeOffset = rangeOffset;
+    m_totalSize = fileSize - rangeOffset;
+    if(rangeSize > 0) {
+        m_totalSize = std::min(m_totalSize, rangeSize);
+    }
+
+    // the blocks of a block-map are read only once instead of for each chunk and stay pinned
+    // until the stream is finished, so they are not deleted, while they are sent
+    if(BlockStore::isBlockMap(m_location))
+    {
+        m_blockMap = new MappedFile(m_location);
+        return m_blockMap->mapFile(error);
+    }
+    m_file = new Kitsunemimi::BinaryFile(m_location);
+
+    return true;
+}
+
+/**
+ * @brief get size of a file, which can also be stored as block-map
+ *
+ * @param fileSize reference for the size of the file
+ * @param location path of the file
+ * @param error reference for error-output
+ *
+ * @return false, if the file doesn't exist, else true
+ */
+bool
+FileStreamSender::getFileSize(uint64_t &fileSize,
+                              const std::string &location,
+                              Kitsunemimi::ErrorContainer &error)
+{
+    if(BlockStore::isBlockMap(location))
+    {
+        std::vector<BlockStore::BlockEntry> blocks;
+        return BlockStore::readBlockMap(blocks, fileSize, location, error);
+    }
+
+    std::error_code errorCode;
+    fileSize = std::filesystem::file_size(location, errorCode);
+    if(errorCode)
+    {
+        error.addMeesage("File '" + location + "' doesn't exist");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief read a byte-range of a file, which can also be stored as block-map
+ *
+ * @param target buffer for the read data
+ * @param location path of the file
+ * @param offset byte-offset of the range within the file
+ * @param size number of bytes to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+FileStreamSender::readFileRange(uint8_t* target,
+                                const std::string &location,
+                                const uint64_t offset,
+                                const uint64_t size,
+                                Kitsunemimi::ErrorContainer &error)
+{
+    if(size == 0) {
+        return true;
+    }
+
+    if(BlockStore::isBlockMap(location)) {
+        return BlockStore::readFileData(location, target, offset, size, error);
+    }
+
+    Kitsunemimi::BinaryFile file(location);
+    return file.readDataFromFile(target, offset, size, error);
+}
+
+/**
+ * @brief read a chunk of the file
+ *
+ * @param target buffer for the read data
+ * @param offset byte-offset of the chunk within the sent range of the file
+ * @param size number of bytes of the chunk
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+FileStreamSender::readData(uint8_t* target,
+                           const uint64_t offset,
+                           const uint64_t size,
+                           Kitsunemimi::ErrorContainer &error)
+{
+    if(m_blockMap != nullptr) {
+        return m_blockMap->readData(target, m_rangeOffset + offset, size, error);
+    }
+
+    return m_file->readDataFromFile(target, m_rangeOffset + offset, size, error);
+}
@@ -0,0 +1,192 @@
+/**
+ * @file        stream_sender.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_STREAMSENDER_H
+#define SHIORIARCHIVE_STREAMSENDER_H
+
+#include <libKitsunemimiCommon/logger.h>
+#include <core/data_set_files/data_set_file.h>
+#include <core/payload_transform.h>
+#include <core/mapped_file.h>
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <condition_variable>
+
+namespace Kitsunemimi {
+class BinaryFile;
+namespace Sakura {
+class Session;
+}
+}
+
+class StreamSender
+{
+public:
+    // response of a streamed request, which announces the following chunks
+    struct StreamHeader
+    {
+        char magic[8] = {'S', 'H', 'I', 'O', 'R', 'I', 'S', 'T'};
+        uint32_t version = 1;
+        uint32_t padding = 0;
+        uint64_t streamId = 0;
+        uint64_t totalSize = 0;
+        uint64_t chunkSize = 0;
+        uint64_t numberOfChunks = 0;
+    };
+    static_assert(sizeof(StreamHeader) == 48);
+
+    enum ChunkFlags
+    {
+        LAST_CHUNK_FLAG = 1,
+        FAILED_FLAG = 2
+    };
+
+    // header in front of the data of each chunk, which is sent as stream-message
+    struct ChunkHeader
+    {
+        uint64_t streamId = 0;
+        uint64_t chunkIndex = 0;
+        uint64_t offset = 0;
+        uint32_t size = 0;
+        uint32_t flags = 0;
+    };
+    static_assert(sizeof(ChunkHeader) == 32);
+
+    // limits of the size of a chunk
+    static constexpr uint64_t MIN_CHUNK_SIZE = 64 * 1024;
+    static constexpr uint64_t MAX_CHUNK_SIZE = 64 * 1024 * 1024;
+
+    StreamSender(const uint64_t chunkSize,
+                 const uint64_t chunksInFlight);
+    virtual ~StreamSender();
+
+    bool sendStream(Kitsunemimi::Sakura::Session* session,
+                    const uint64_t blockerId,
+                    Kitsunemimi::ErrorContainer &error);
+
+protected:
+    virtual bool readData(uint8_t* target,
+                          const uint64_t offset,
+                          const uint64_t size,
+                          Kitsunemimi::ErrorContainer &error) = 0;
+
+    uint64_t m_totalSize = 0;
+    uint64_t m_chunkSize = 0;
+
+private:
+    void readLoop();
+    uint64_t getNumberOfChunks() const;
+
+    uint64_t m_streamId = 0;
+    uint64_t m_chunksInFlight = 0;
+    std::vector<std::vector<uint8_t>> m_slots;
+
+    std::mutex m_lock;
+    std::condition_variable m_cond;
+    uint64_t m_readChunks = 0;
+    uint64_t m_sentChunks = 0;
+    bool m_readFailed = false;
+    bool m_abort = false;
+    std::thread m_readThread;
+};
+
+//==================================================================================================
+
+class DataSetStreamSender
+        : public StreamSender
+{
+public:
+    DataSetStreamSender(std::shared_ptr<DataSetFile> file,
+                        const std::vector<DataSetFile::RowRange> &ranges,
+                        const std::string &columnName,
+                        const bool compact,
+                        const PayloadTransform &transform,
+                        const uint64_t chunkSize,
+                        const uint64_t chunksInFlight);
+    ~DataSetStreamSender();
+
+protected:
+    bool readData(uint8_t* target,
+                  const uint64_t offset,
+                  const uint64_t size,
+                  Kitsunemimi::ErrorContainer &error);
+
+private:
+    bool readTransformedRows(uint8_t* target,
+                             const DataSetFile::RowRange &range,
+                             Kitsunemimi::ErrorContainer &error);
+    bool readRows(uint8_t* target,
+                  const DataSetFile::RowRange &range,
+                  Kitsunemimi::ErrorContainer &error);
+
+    std::shared_ptr<DataSetFile> m_file;
+    std::vector<DataSetFile::RowRange> m_ranges;
+    std::string m_columnName = "";
+    bool m_compact = false;
+    PayloadTransform m_transform;
+    float m_multiplicator = 1.0f;
+    uint64_t m_sourceRowSize = 0;
+    uint64_t m_rowSize = 0;
+};
+
+//==================================================================================================
+
+class FileStreamSender
+        : public StreamSender
+{
+public:
+    FileStreamSender(const std::string &location,
+                     const uint64_t chunkSize,
+                     const uint64_t chunksInFlight);
+    ~FileStreamSender();
+
+    bool initFile(const uint64_t rangeOffset,
+                  const uint64_t rangeSize,
+                  Kitsunemimi::ErrorContainer &error);
+
+    static bool getFileSize(uint64_t &fileSize,
+                            const std::string &location,
+                            Kitsunemimi::ErrorContainer &error);
+    static bool readFileRange(uint8_t* target,
+                              const std::string &location,
+                              const uint64_t offset,
+                              const uint64_t size,
+                              Kitsunemimi::ErrorContainer &error);
+
+protected:
+    bool readData(uint8_t* target,
+                  const uint64_t offset,
+                  const uint64_t size,
+                  Kitsunemimi::ErrorContainer &error);
+
+private:
+    std::string m_location = "";
+    uint64_t m_rangeOffset = 0;
+    MappedFile* m_blockMap = nullptr;
+    Kitsunemimi::BinaryFile* m_file = nullptr;
+};
+
+#endif // SHIORIARCHIVE_STREAMSENDER_H
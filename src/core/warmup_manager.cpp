@@ -0,0 +1,492 @@
+/**
+ * @file        warmup_manager.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "warmup_manager.h"
+
+#include <shiori_root.h>
+#include <core/data_set_cache.h>
+#include <core/block_store.h>
+#include <core/data_set_files/data_set_file.h>
+#include <core/data_set_files/view_data_set_file.h>
+
+#include <libKitsunemimiCommon/methods/file_methods.h>
+#include <libKitsunemimiCommon/files/text_file.h>
+#include <libKitsunemimiCommon/methods/string_methods.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <set>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * @brief get the current time in seconds since epoch
+ */
+static int64_t
+getCurrentTime()
+{
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::seconds>(now).count();
+}
+
+/**
+ * @brief constructor
+ *
+ * @param statsFilePath path of the file, which persists the access-statistics over restarts
+ * @param maxNumberOfDataSets maximum number of data-sets, which are warmed up at once
+ * @param maxBytesPerSecond maximum number of bytes per second, which are read by the warmup.
+ *                          With 0 the bandwidth is not limited.
+ */
+WarmupManager::WarmupManager(const std::string &statsFilePath,
+                             const uint64_t maxNumberOfDataSets,
+                             const uint64_t maxBytesPerSecond)
+{
+    m_statsFilePath = statsFilePath;
+    m_maxNumberOfDataSets = maxNumberOfDataSets;
+    m_maxBytesPerSecond = maxBytesPerSecond;
+}
+
+/**
+ * @brief destructor
+ */
+WarmupManager::~WarmupManager()
+{
+    m_abort = true;
+    if(m_warmupThread.joinable()) {
+        m_warmupThread.join();
+    }
+
+    Kitsunemimi::ErrorContainer error;
+    if(saveStats(error) == false) {
+        LOG_ERROR(error);
+    }
+}
+
+/**
+ * @brief load the access-statistics, which were written before the last shutdown
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful or no statistics exist yet, else false
+ */
+bool
+WarmupManager::loadStats(Kitsunemimi::ErrorContainer &error)
+{
+    if(std::filesystem::exists(m_statsFilePath) == false) {
+        return true;
+    }
+
+    std::string content = "";
+    if(Kitsunemimi::readFile(content, m_statsFilePath, error) == false)
+    {
+        error.addMeesage("Failed to read access-statistics '" + m_statsFilePath + "'");
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    Kitsunemimi::splitStringByDelimiter(lines, content, '\n');
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    // each line has the format "<number of accesses> <last access> <location>", where the
+    // location is the last part, so it can contain spaces
+    for(const std::string &line : lines)
+    {
+        const size_t firstSpace = line.find(' ');
+        if(firstSpace == std::string::npos) {
+            continue;
+        }
+        const size_t secondSpace = line.find(' ', firstSpace + 1);
+        if(secondSpace == std::string::npos) {
+            continue;
+        }
+
+        AccessStats stats;
+        stats.numberOfAccesses = std::strtoull(line.c_str(), nullptr, 10);
+        stats.lastAccess = std::strtoll(line.c_str() + firstSpace + 1, nullptr, 10);
+        m_stats[line.substr(secondSpace + 1)] = stats;
+    }
+
+    return true;
+}
+
+/**
+ * @brief count a request of a data-set. The statistics are written at most once per minute, so
+ *        the requests are not slowed down by writes to the disc.
+ *
+ * @param location path to the requested data-set-file
+ */
+void
+WarmupManager::recordAccess(const std::string &location)
+{
+    const int64_t now = getCurrentTime();
+    std::string content = "";
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        AccessStats &stats = m_stats[location];
+        stats.numberOfAccesses++;
+        stats.lastAccess = now;
+        m_statsChanged = true;
+
+        // forget the data-set with the oldest access, so the statistics don't grow endlessly
+        if(m_stats.size() > MAX_TRACKED_DATA_SETS)
+        {
+            auto oldest = m_stats.begin();
+            for(auto it = m_stats.begin(); it != m_stats.end(); it++)
+            {
+                if(it->second.lastAccess < oldest->second.lastAccess) {
+                    oldest = it;
+                }
+            }
+            m_stats.erase(oldest);
+        }
+
+        if(now - m_lastSave < SAVE_INTERVAL) {
+            return;
+        }
+
+        content = serializeStats(now);
+    }
+
+    Kitsunemimi::ErrorContainer error;
+    if(writeStats(content, error) == false) {
+        LOG_ERROR(error);
+    }
+}
+
+/**
+ * @brief forget the statistics of a deleted data-set
+ *
+ * @param location path to the data-set-file
+ */
+void
+WarmupManager::removeDataSet(const std::string &location)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_stats.erase(location) > 0) {
+        m_statsChanged = true;
+    }
+}
+
+/**
+ * @brief start to read the most frequently and recently requested data-sets in the background
+ *        into the page-cache, so the first requests after a restart don't have to wait for
+ *        the disc
+ *
+ * @return number of data-sets, which are warmed up, or 0, if a warmup is already running
+ */
+uint64_t
+WarmupManager::startWarmup()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_running) {
+        return 0;
+    }
+    if(m_warmupThread.joinable()) {
+        m_warmupThread.join();
+    }
+
+    std::vector<std::string> locations;
+    getWarmupLocations(locations, getCurrentTime());
+    if(locations.size() == 0) {
+        return 0;
+    }
+
+    m_running = true;
+    m_queuedDataSets = locations.size();
+    m_warmedDataSets = 0;
+    m_warmedBytes = 0;
+    m_warmupThread = std::thread(&WarmupManager::runWarmup, this, locations);
+
+    return locations.size();
+}
+
+/**
+ * @brief get the state of the current or last warmup
+ *
+ * @return status of the warmup
+ */
+WarmupManager::WarmupStatus
+WarmupManager::getStatus()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    WarmupStatus status;
+    status.running = m_running;
+    status.queuedDataSets = m_queuedDataSets;
+    status.warmedDataSets = m_warmedDataSets;
+    status.warmedBytes = m_warmedBytes;
+    status.trackedDataSets = m_stats.size();
+
+    return status;
+}
+
+/**
+ * @brief select the data-sets with the highest score for the warmup. The score is the number
+ *        of requests, which is reduced with the number of days since the last request, so
+ *        data-sets of finished trainings are replaced by the ones of the active trainings.
+ *        The lock must already be held by the caller.
+ *
+ * @param locations reference for the resulting locations, sorted by descending score
+ * @param now current time in seconds
+ */
+void
+WarmupManager::getWarmupLocations(std::vector<std::string> &locations,
+                                  const int64_t now)
+{
+    std::vector<std::pair<double, std::string>> scores;
+    for(const auto &[location, stats] : m_stats)
+    {
+        const double ageInDays = static_cast<double>(std::max(now - stats.lastAccess, 0l))
+                                 / 86400.0;
+        const double score = static_cast<double>(stats.numberOfAccesses) / (1.0 + ageInDays);
+        scores.emplace_back(score, location);
+    }
+
+    std::sort(scores.begin(), scores.end(), std::greater<std::pair<double, std::string>>());
+    if(scores.size() > m_maxNumberOfDataSets) {
+        scores.resize(m_maxNumberOfDataSets);
+    }
+
+    for(const auto &[score, location] : scores) {
+        locations.push_back(location);
+    }
+}
+
+/**
+ * @brief write the access-statistics, if they were changed since the last write
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+WarmupManager::saveStats(Kitsunemimi::ErrorContainer &error)
+{
+    std::string content = "";
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if(m_statsChanged == false) {
+            return true;
+        }
+        content = serializeStats(getCurrentTime());
+    }
+
+    return writeStats(content, error);
+}
+
+/**
+ * @brief convert the access-statistics into the format of the statistics-file and mark them as
+ *        saved. The lock must already be held by the caller.
+ *
+ * @param now current time in seconds
+ *
+ * @return content of the statistics-file
+ */
+const std::string
+WarmupManager::serializeStats(const int64_t now)
+{
+    std::string content = "";
+    for(const auto &[location, stats] : m_stats)
+    {
+        content += std::to_string(stats.numberOfAccesses) + " "
+                   + std::to_string(stats.lastAccess) + " "
+                   + location + "\n";
+    }
+
+    m_statsChanged = false;
+    m_lastSave = now;
+
+    return content;
+}
+
+/**
+ * @brief write the statistics into a temporary file first and replace the old file afterwards,
+ *        so a crash while writing doesn't destroy the statistics
+ *
+ * @param content content of the statistics-file
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+WarmupManager::writeStats(const std::string &content,
+                          Kitsunemimi::ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_writeLock);
+
+    const std::string tempPath = m_statsFilePath + ".tmp";
+    if(Kitsunemimi::writeFile(tempPath, content, error, true) == false
+            || Kitsunemimi::renameFileOrDir(tempPath, m_statsFilePath, error) == false)
+    {
+        error.addMeesage("Failed to write access-statistics '" + m_statsFilePath + "'");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief warm up the selected data-sets one after another
+ *
+ * @param locations paths to the data-set-files
+ */
+void
+WarmupManager::runWarmup(const std::vector<std::string> locations)
+{
+    m_warmupStart = std::chrono::steady_clock::now();
+    m_warmupBytes = 0;
+
+    for(const std::string &location : locations)
+    {
+        if(m_abort) {
+            break;
+        }
+
+        warmupDataSet(location);
+        m_warmedDataSets++;
+    }
+
+    m_running = false;
+}
+
+/**
+ * @brief open a data-set in the cache of the opened files and read all files, which hold its
+ *        payload, into the page-cache
+ *
+ * @param location path to the data-set-file
+ */
+void
+WarmupManager::warmupDataSet(const std::string &location)
+{
+    Kitsunemimi::ErrorContainer error;
+    std::shared_ptr<DataSetFile> file = ShioriRoot::dataSetCache->getDataSetFile(location, error);
+    if(file == nullptr)
+    {
+        // data-sets, which were deleted in the meantime, are skipped
+        removeDataSet(location);
+        return;
+    }
+
+    // the payload of a view is stored in its parent
+    if(file->type == DataSetFile::VIEW_TYPE)
+    {
+        warmupDataSet(static_cast<ViewDataSetFile*>(file.get())->parentLocation);
+        return;
+    }
+
+    if(BlockStore::isBlockMap(location) == false)
+    {
+        warmupFile(location);
+        return;
+    }
+
+    // files, which were split into deduplicated blocks, are read block by block, but blocks,
+    // which occur multiple times in the file, only once
+    std::vector<BlockStore::BlockEntry> blocks;
+    uint64_t totalSize = 0;
+    if(BlockStore::readBlockMap(blocks, totalSize, location, error) == false)
+    {
+        LOG_ERROR(error);
+        return;
+    }
+
+    const std::string directory = BlockStore::getBlockDirectory(location);
+    std::set<std::string> warmedBlocks;
+    for(const BlockStore::BlockEntry &block : blocks)
+    {
+        if(m_abort) {
+            return;
+        }
+
+        const std::string blockPath = BlockStore::getBlockPath(directory, block.hash);
+        if(warmedBlocks.insert(blockPath).second) {
+            warmupFile(blockPath);
+        }
+    }
+}
+
+/**
+ * @brief read a file in chunks ahead into the page-cache, without copying it into the memory of
+ *        the process
+ *
+ * @param filePath path to the file
+ */
+void
+WarmupManager::warmupFile(const std::string &filePath)
+{
+    const int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        return;
+    }
+
+    const uint64_t fileSize = static_cast<uint64_t>(fileStat.st_size);
+    for(uint64_t offset = 0; offset < fileSize; offset += WARMUP_CHUNK_SIZE)
+    {
+        if(m_abort) {
+            break;
+        }
+
+        // readahead blocks until the chunk is read, so the bandwidth can be limited, in
+        // contrast to posix_fadvise, which only queues the read
+        const uint64_t chunkSize = std::min(WARMUP_CHUNK_SIZE, fileSize - offset);
+        readahead(fd, static_cast<off64_t>(offset), chunkSize);
+        m_warmedBytes += chunkSize;
+        limitBandwidth(chunkSize);
+    }
+
+    close(fd);
+}
+
+/**
+ * @brief sleep, if the warmup has read more bytes, than allowed by the bandwidth-limit since
+ *        its start, so it doesn't slow down the requests of the running trainings
+ *
+ * @param readBytes number of bytes, which were read since the last call
+ */
+void
+WarmupManager::limitBandwidth(const uint64_t readBytes)
+{
+    m_warmupBytes += readBytes;
+    if(m_maxBytesPerSecond == 0) {
+        return;
+    }
+
+    const std::chrono::microseconds targetDuration(m_warmupBytes * 1000000 / m_maxBytesPerSecond);
+    const auto targetTime = m_warmupStart + targetDuration;
+    if(targetTime > std::chrono::steady_clock::now()) {
+        std::this_thread::sleep_until(targetTime);
+    }
+}
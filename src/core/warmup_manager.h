@@ -0,0 +1,104 @@
+/**
+ * @file        warmup_manager.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_WARMUPMANAGER_H
+#define SHIORIARCHIVE_WARMUPMANAGER_H
+
+#include <libKitsunemimiCommon/logger.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+class WarmupManager
+{
+public:
+    struct WarmupStatus
+    {
+        bool running = false;
+        uint64_t queuedDataSets = 0;
+        uint64_t warmedDataSets = 0;
+        uint64_t warmedBytes = 0;
+        uint64_t trackedDataSets = 0;
+    };
+
+    WarmupManager(const std::string &statsFilePath,
+                  const uint64_t maxNumberOfDataSets,
+                  const uint64_t maxBytesPerSecond);
+    ~WarmupManager();
+
+    bool loadStats(Kitsunemimi::ErrorContainer &error);
+    void recordAccess(const std::string &location);
+    void removeDataSet(const std::string &location);
+    uint64_t startWarmup();
+    WarmupStatus getStatus();
+
+private:
+    struct AccessStats
+    {
+        uint64_t numberOfAccesses = 0;
+        int64_t lastAccess = 0;
+    };
+
+    // number of bytes, which are read ahead at once, before the bandwidth-limit is checked
+    static constexpr uint64_t WARMUP_CHUNK_SIZE = 4 * 1024 * 1024;
+    // minimum number of seconds between two writes of the access-statistics
+    static constexpr int64_t SAVE_INTERVAL = 60;
+    static constexpr uint64_t MAX_TRACKED_DATA_SETS = 4096;
+
+    void getWarmupLocations(std::vector<std::string> &locations,
+                            const int64_t now);
+    bool saveStats(Kitsunemimi::ErrorContainer &error);
+    const std::string serializeStats(const int64_t now);
+    bool writeStats(const std::string &content,
+                    Kitsunemimi::ErrorContainer &error);
+
+    void runWarmup(const std::vector<std::string> locations);
+    void warmupDataSet(const std::string &location);
+    void warmupFile(const std::string &filePath);
+    void limitBandwidth(const uint64_t readBytes);
+
+    std::mutex m_lock;
+    std::mutex m_writeLock;
+    std::string m_statsFilePath = "";
+    uint64_t m_maxNumberOfDataSets = 0;
+    uint64_t m_maxBytesPerSecond = 0;
+    std::map<std::string, AccessStats> m_stats;
+    bool m_statsChanged = false;
+    int64_t m_lastSave = 0;
+
+    std::thread m_warmupThread;
+    std::atomic<bool> m_running = false;
+    std::atomic<bool> m_abort = false;
+    std::chrono::steady_clock::time_point m_warmupStart;
+    uint64_t m_warmupBytes = 0;
+
+    uint64_t m_queuedDataSets = 0;
+    std::atomic<uint64_t> m_warmedDataSets = 0;
+    std::atomic<uint64_t> m_warmedBytes = 0;
+};
+
+#endif // SHIORIARCHIVE_WARMUPMANAGER_H
@@ -0,0 +1,178 @@
+/**
+ * @file        worker_pool.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+/**
+ * @brief constructor, which starts the workers of all lanes. Each lane has its own workers, so
+ *        tasks of one lane never wait behind the tasks of another lane.
+ *
+ * @param numberOfBulkWorkers number of workers for large transfers of data-sets and snapshots
+ * @param numberOfMetadataWorkers number of workers for small requests, which need a response
+ * @param numberOfLogWorkers number of workers for log-messages, which need no response
+ * @param maxQueuedTasks maximum number of waiting tasks of each lane
+ */
+WorkerPool::WorkerPool(const uint64_t numberOfBulkWorkers,
+                       const uint64_t numberOfMetadataWorkers,
+                       const uint64_t numberOfLogWorkers,
+                       const uint64_t maxQueuedTasks)
+{
+    m_maxQueuedTasks = std::max<uint64_t>(maxQueuedTasks, 1);
+
+    const uint64_t numberOfWorkers[NUMBER_OF_LANES] = {numberOfBulkWorkers,
+                                                       numberOfMetadataWorkers,
+                                                       numberOfLogWorkers};
+
+    for(uint64_t lane = 0; lane < NUMBER_OF_LANES; lane++)
+    {
+        // each lane needs at least one worker, because its tasks would never run otherwise
+        const uint64_t laneWorkers = std::max<uint64_t>(numberOfWorkers[lane], 1);
+        for(uint64_t i = 0; i < laneWorkers; i++) {
+            m_workers.emplace_back(&WorkerPool::workerLoop, this, static_cast<Lane>(lane));
+        }
+    }
+}
+
+/**
+ * @brief destructor, which finishes all queued tasks and stops the workers
+ */
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    for(LaneQueue &lane : m_lanes) {
+        lane.taskAdded.notify_all();
+    }
+
+    for(std::thread &worker : m_workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief add a task to the queue of a lane. This never blocks, because messages are added by the
+ *        thread, which receives them from the connection, and a waiting receive-thread would
+ *        stall all other sessions too. If the queue of the lane is full, the task is rejected,
+ *        so the caller can answer the request as busy, instead of filling the memory of the
+ *        server with the requests of a client, which sends faster than they can be processed.
+ *
+ * @param lane lane, which should process the task
+ * @param owner session, which is used by the task, or nullptr, if the task uses no session
+ * @param task function to run
+ *
+ * @return false, if the queue of the lane is full or the pool is already stopped and the task
+ *         was not added, else true
+ */
+bool
+WorkerPool::addTask(const Lane lane,
+                    const void* owner,
+                    const std::function<void()> &task)
+{
+    LaneQueue &queue = m_lanes[lane];
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if(m_stop
+                || queue.tasks.size() >= m_maxQueuedTasks)
+        {
+            return false;
+        }
+
+        Task newTask;
+        newTask.owner = owner;
+        newTask.function = task;
+        queue.tasks.push_back(newTask);
+    }
+    queue.taskAdded.notify_one();
+
+    return true;
+}
+
+/**
+ * @brief remove all waiting tasks of an owner and wait until its running tasks are finished.
+ *        This has to be called, when a session is closed, because the tasks use the session and
+ *        it is deleted after the close.
+ *
+ * @param owner session, which is closed
+ */
+void
+WorkerPool::cancelTasks(const void* owner)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    for(LaneQueue &queue : m_lanes)
+    {
+        queue.tasks.erase(std::remove_if(queue.tasks.begin(),
+                                         queue.tasks.end(),
+                                         [&](const Task &task) { return task.owner == owner; }),
+                          queue.tasks.end());
+    }
+
+    // running tasks end fast, because sending to a closed session fails
+    m_taskFinished.wait(lock, [&] { return m_runningTasks.count(owner) == 0; });
+}
+
+/**
+ * @brief loop of a worker, which runs the tasks of its lane in the order of their arrival
+ *
+ * @param lane lane of the worker
+ */
+void
+WorkerPool::workerLoop(const Lane lane)
+{
+    LaneQueue &queue = m_lanes[lane];
+
+    while(true)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        queue.taskAdded.wait(lock, [&] { return m_stop || queue.tasks.empty() == false; });
+        if(queue.tasks.empty()) {
+            return;
+        }
+
+        const Task task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        if(task.owner != nullptr) {
+            m_runningTasks[task.owner]++;
+        }
+        lock.unlock();
+
+        task.function();
+
+        if(task.owner == nullptr) {
+            continue;
+        }
+
+        lock.lock();
+        std::map<const void*, uint64_t>::iterator it = m_runningTasks.find(task.owner);
+        it->second--;
+        if(it->second == 0) {
+            m_runningTasks.erase(it);
+        }
+        lock.unlock();
+        m_taskFinished.notify_all();
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file        worker_pool.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_WORKERPOOL_H
+#define SHIORIARCHIVE_WORKERPOOL_H
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+class WorkerPool
+{
+public:
+    enum Lane
+    {
+        BULK_LANE = 0,
+        METADATA_LANE = 1,
+        LOG_LANE = 2,
+        NUMBER_OF_LANES = 3
+    };
+
+    WorkerPool(const uint64_t numberOfBulkWorkers,
+               const uint64_t numberOfMetadataWorkers,
+               const uint64_t numberOfLogWorkers,
+               const uint64_t maxQueuedTasks);
+    ~WorkerPool();
+
+    bool addTask(const Lane lane,
+                 const void* owner,
+                 const std::function<void()> &task);
+    void cancelTasks(const void* owner);
+
+private:
+    struct Task
+    {
+        const void* owner = nullptr;
+        std::function<void()> function;
+    };
+
+    struct LaneQueue
+    {
+        std::deque<Task> tasks;
+        std::condition_variable taskAdded;
+    };
+
+    void workerLoop(const Lane lane);
+
+    std::mutex m_lock;
+    LaneQueue m_lanes[NUMBER_OF_LANES];
+    std::map<const void*, uint64_t> m_runningTasks;
+    std::condition_variable m_taskFinished;
+    std::vector<std::thread> m_workers;
+    uint64_t m_maxQueuedTasks = 0;
+    bool m_stop = false;
+};
+
+#endif // SHIORIARCHIVE_WORKERPOOL_H
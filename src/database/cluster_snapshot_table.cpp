@@ -128,16 +128,18 @@ ClusterSnapshotTable::getClusterSnapshot(Kitsunemimi::JsonItem &result,
  * @param result reference for the result-output
  * @param userContext context-object with all user specific information
  * @param error reference for error-output
+ * @param showHiddenValues set to true to also show as hidden marked fields
  *
  * @return true, if successful, else false
  */
 bool
 ClusterSnapshotTable::getAllClusterSnapshot(Kitsunemimi::TableItem &result,
                                             const Kitsunemimi::Hanami::UserContext &userContext,
-                                            Kitsunemimi::ErrorContainer &error)
+                                            Kitsunemimi::ErrorContainer &error,
+                                            const bool showHiddenValues)
 {
     std::vector<RequestCondition> conditions;
-    if(getAll(result, userContext, conditions, error) == false)
+    if(getAll(result, userContext, conditions, error, showHiddenValues) == false)
     {
         error.addMeesage("Failed to get all snapshots from database");
         return false;
@@ -47,7 +47,8 @@ public:
                             const bool showHiddenValues);
     bool getAllClusterSnapshot(Kitsunemimi::TableItem &result,
                                const Kitsunemimi::Hanami::UserContext &userContext,
-                               Kitsunemimi::ErrorContainer &error);
+                               Kitsunemimi::ErrorContainer &error,
+                               const bool showHiddenValues = false);
     bool deleteClusterSnapshot(const std::string &snapshotUuid,
                                const Kitsunemimi::Hanami::UserContext &userContext,
                                Kitsunemimi::ErrorContainer &error);
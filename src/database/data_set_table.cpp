@@ -128,16 +128,18 @@ DataSetTable::getDataSet(Kitsunemimi::JsonItem &result,
  * @param result reference for the result-output
  * @param userContext context-object with all user specific information
  * @param error reference for error-output
+ * @param showHiddenValues set to true to also show as hidden marked fields
  *
  * @return true, if successful, else false
  */
 bool
 DataSetTable::getAllDataSet(Kitsunemimi::TableItem &result,
                             const Kitsunemimi::Hanami::UserContext &userContext,
-                            Kitsunemimi::ErrorContainer &error)
+                            Kitsunemimi::ErrorContainer &error,
+                            const bool showHiddenValues)
 {
     std::vector<RequestCondition> conditions;
-    if(getAll(result, userContext, conditions, error) == false)
+    if(getAll(result, userContext, conditions, error, showHiddenValues) == false)
     {
         error.addMeesage("Failed to get all datasets from database");
         return false;
@@ -173,6 +175,71 @@ DataSetTable::deleteDataSet(const std::string &datasetUuid,
     return true;
 }
 
+/**
+ * @brief get the locations of all views of all projects, to find the views of a data-set
+ *
+ * @param locations reference for the locations of the view-files
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetTable::getAllViewLocations(std::vector<std::string> &locations,
+                                  Kitsunemimi::ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("type", "view");
+    Kitsunemimi::TableItem result;
+
+    Kitsunemimi::Hanami::UserContext userContext;
+    userContext.isAdmin = true;
+
+    if(getAll(result, userContext, conditions, error, true) == false)
+    {
+        error.addMeesage("Failed to get views from database");
+        return false;
+    }
+
+    // get position of the location within the rows
+    const Kitsunemimi::JsonItem header(result.getInnerHeader());
+    const Kitsunemimi::JsonItem body(result.getBody());
+    uint64_t locationPos = header.size();
+    for(uint64_t i = 0; i < header.size(); i++)
+    {
+        if(header.get(i).getString() == "location") {
+            locationPos = i;
+        }
+    }
+    if(locationPos == header.size())
+    {
+        error.addMeesage("Entries of views in database have no location");
+        return false;
+    }
+
+    for(uint64_t i = 0; i < body.size(); i++) {
+        locations.push_back(body.get(i).get(locationPos).getString());
+    }
+
+    return true;
+}
+
+/**
+ * @brief register a new temporary file for an additional upload to an existing dataset
+ *
+ * @param uuid uuid of the dataset
+ * @param fileUuid uuid of the temporary file
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetTable::addUploadFile(const std::string &uuid,
+                            const std::string &fileUuid,
+                            Kitsunemimi::ErrorContainer &error)
+{
+    return setUploadProgress(uuid, fileUuid, 0.0f, error);
+}
+
 /**
  * @brief update dataset in database to fully uploaded
  *
@@ -186,6 +253,25 @@ bool
 DataSetTable::setUploadFinish(const std::string &uuid,
                               const std::string &fileUuid,
                               Kitsunemimi::ErrorContainer &error)
+{
+    return setUploadProgress(uuid, fileUuid, 1.0f, error);
+}
+
+/**
+ * @brief update the upload-progress of a temporary file of a dataset
+ *
+ * @param uuid uuid of the dataset
+ * @param fileUuid uuid of the temporary file
+ * @param progress new progress between 0.0 and 1.0
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DataSetTable::setUploadProgress(const std::string &uuid,
+                                const std::string &fileUuid,
+                                const float progress,
+                                Kitsunemimi::ErrorContainer &error)
 {
     std::vector<RequestCondition> conditions;
     conditions.emplace_back("uuid", uuid);
@@ -210,7 +296,7 @@ DataSetTable::setUploadFinish(const std::string &uuid,
         return false;
     }
 
-    // update temp-files entry to 100%
+    // update progress of the temp-file
     const std::string tempFilesStr = result.get("temp_files").toString();
     Kitsunemimi::JsonItem tempFiles;
     if(tempFiles.parse(tempFilesStr, error) == false)
@@ -221,7 +307,7 @@ DataSetTable::setUploadFinish(const std::string &uuid,
         LOG_ERROR(error);
         return false;
     }
-    tempFiles.insert(fileUuid, Kitsunemimi::JsonItem(1.0f), true);
+    tempFiles.insert(fileUuid, Kitsunemimi::JsonItem(progress), true);
 
     // update new entry within the database
     Kitsunemimi::JsonItem newValues;
@@ -47,14 +47,26 @@ public:
                     const bool showHiddenValues);
     bool getAllDataSet(Kitsunemimi::TableItem &result,
                        const Kitsunemimi::Hanami::UserContext &userContext,
-                       Kitsunemimi::ErrorContainer &error);
+                       Kitsunemimi::ErrorContainer &error,
+                       const bool showHiddenValues = false);
     bool deleteDataSet(const std::string &uuid,
                        const Kitsunemimi::Hanami::UserContext &userContext,
                        Kitsunemimi::ErrorContainer &error);
+    bool getAllViewLocations(std::vector<std::string> &locations,
+                             Kitsunemimi::ErrorContainer &error);
 
+    bool addUploadFile(const std::string &uuid,
+                       const std::string &fileUuid,
+                       Kitsunemimi::ErrorContainer &error);
     bool setUploadFinish(const std::string &uuid,
                          const std::string &fileUuid,
                          Kitsunemimi::ErrorContainer &error);
+
+private:
+    bool setUploadProgress(const std::string &uuid,
+                           const std::string &fileUuid,
+                           const float progress,
+                           Kitsunemimi::ErrorContainer &error);
 };
 
 #endif // SHIORIARCHIVE_DATA_SET_TABLE_H
@@ -55,13 +55,26 @@ int main(int argc, char *argv[])
 
     // initialize server and connections based on the config-file
     const std::vector<std::string> groupNames = {"misaki"};
+#ifdef SHIORI_SESSION_CLOSE_CALLBACK
+    // queued and running tasks of the worker-pool are bound to their session, so they have to be
+    // cancelled, before a closed session is deleted
     if(HanamiMessaging::getInstance()->initialize("shiori",
                                                   groupNames,
                                                   nullptr,
                                                   &streamDataCallback,
                                                   &genericMessageCallback,
+                                                  &sessionCloseCallback,
                                                   error,
                                                   true) == false)
+#else
+    if(HanamiMessaging::getInstance()->initialize("shiori",
+                                                  groupNames,
+                                                  nullptr,
+                                                  &streamDataCallback,
+                                                  &genericMessageCallback,
+                                                  error,
+                                                  true) == false)
+#endif
     {
         LOG_ERROR(error);
         return 1;
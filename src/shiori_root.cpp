@@ -31,9 +31,28 @@
 #include <database/error_log_table.h>
 #include <database/audit_log_table.h>
 #include <core/temp_file_handler.h>
+#include <core/data_set_cache.h>
+#include <core/batch_server.h>
+#include <core/block_store.h>
+#include <core/normalization_cache.h>
+#include <core/payload_cache.h>
+#include <core/load_coalescer.h>
+#include <core/worker_pool.h>
+#include <core/warmup_manager.h>
+#include <core/local_handoff.h>
 #include <api/blossom_initializing.h>
 
 TempFileHandler* ShioriRoot::tempFileHandler = nullptr;
+DataSetCache* ShioriRoot::dataSetCache = nullptr;
+BatchServer* ShioriRoot::batchServer = nullptr;
+BlockStore* ShioriRoot::dataSetBlockStore = nullptr;
+BlockStore* ShioriRoot::clusterSnapshotBlockStore = nullptr;
+NormalizationCache* ShioriRoot::normalizationCache = nullptr;
+PayloadCache* ShioriRoot::payloadCache = nullptr;
+LoadCoalescer* ShioriRoot::payloadLoads = nullptr;
+WorkerPool* ShioriRoot::workerPool = nullptr;
+WarmupManager* ShioriRoot::warmupManager = nullptr;
+LocalHandoff* ShioriRoot::localHandoff = nullptr;
 DataSetTable* ShioriRoot::dataSetTable = nullptr;
 ClusterSnapshotTable* ShioriRoot::clusterSnapshotTable = nullptr;
 RequestResultTable* ShioriRoot::requestResultTable = nullptr;
@@ -120,6 +139,103 @@ ShioriRoot::init()
     // create new tempfile-handler
     tempFileHandler = new TempFileHandler();
 
+    // create cache for opened data-set-files
+    const long maxCachedFiles = GET_INT_CONFIG("shiori", "data_set_cache_max_files", success);
+    const long maxCachedMb = GET_INT_CONFIG("shiori", "data_set_cache_max_mapped_mb", success);
+    dataSetCache = new DataSetCache(maxCachedFiles, maxCachedMb * 1024 * 1024);
+
+    // create server for shuffled batches of data-sets
+    const long maxBatchers = GET_INT_CONFIG("shiori", "batch_server_max_iterators", success);
+    const long prefetchDepth = GET_INT_CONFIG("shiori", "batch_prefetch_depth", success);
+    batchServer = new BatchServer(maxBatchers, prefetchDepth);
+
+    // create cache for the normalized variants of data-sets
+    normalizationCache = new NormalizationCache();
+
+    // create cache for the decoded payloads of frequently requested data-sets
+    const long maxPayloadCacheMb = GET_INT_CONFIG("shiori", "payload_cache_max_mb", success);
+    payloadCache = new PayloadCache(maxPayloadCacheMb * 1024 * 1024);
+
+    // create coalescer for parallel identical reads of the same rows
+    payloadLoads = new LoadCoalescer();
+
+    // create workers, which process the messages in separate lanes for bulk-transfers,
+    // metadata-requests and logs
+    const long bulkWorkers = GET_INT_CONFIG("shiori", "bulk_worker_threads", success);
+    const long metadataWorkers = GET_INT_CONFIG("shiori", "metadata_worker_threads", success);
+    const long logWorkers = GET_INT_CONFIG("shiori", "log_worker_threads", success);
+    const long maxQueuedTasks = GET_INT_CONFIG("shiori", "worker_queue_max_tasks", success);
+    if(bulkWorkers <= 0
+            || metadataWorkers <= 0
+            || logWorkers <= 0
+            || maxQueuedTasks <= 0)
+    {
+        error.addMeesage("Number of workers and queued tasks of the worker-pool must be "
+                         "greater than 0.");
+        LOG_ERROR(error);
+        return false;
+    }
+    workerPool = new WorkerPool(bulkWorkers, metadataWorkers, logWorkers, maxQueuedTasks);
+
+    // create stores for the deduplicated blocks of the finalized files
+    const std::string dataSetLocation = GET_STRING_CONFIG("shiori", "data_set_location", success);
+    const bool dedupDataSets = GET_BOOL_CONFIG("shiori", "dedup_data_sets", success);
+    dataSetBlockStore = new BlockStore(dataSetLocation, dedupDataSets, 0);
+    if(dataSetBlockStore->initStore(error) == false)
+    {
+        error.addMeesage("Failed to initialize block-store for data-sets.");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    const std::string snapshotLocation = GET_STRING_CONFIG("shiori",
+                                                           "cluster_snapshot_location",
+                                                           success);
+    const bool dedupSnapshots = GET_BOOL_CONFIG("shiori", "dedup_cluster_snapshots", success);
+    // snapshots of the same cluster keep their layout, so they can also be split at fixed offsets
+    const long snapshotBlockKb = GET_INT_CONFIG("shiori", "cluster_snapshot_block_kb", success);
+    clusterSnapshotBlockStore = new BlockStore(snapshotLocation,
+                                               dedupSnapshots,
+                                               snapshotBlockKb * 1024);
+    if(clusterSnapshotBlockStore->initStore(error) == false)
+    {
+        error.addMeesage("Failed to initialize block-store for cluster-snapshots.");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // create handoff of payloads via shared memory to clients on the same host
+    const std::string handoffDirectory = GET_STRING_CONFIG("shiori",
+                                                           "local_handoff_directory",
+                                                           success);
+    const long handoffMaxMb = GET_INT_CONFIG("shiori", "local_handoff_max_mb", success);
+    const long handoffPinSeconds = GET_INT_CONFIG("shiori", "local_handoff_pin_seconds", success);
+    localHandoff = new LocalHandoff(handoffDirectory,
+                                    handoffMaxMb * 1024 * 1024,
+                                    handoffPinSeconds);
+    if(localHandoff->initDirectory(error) == false)
+    {
+        error.addMeesage("Failed to initialize directory for local handoff.");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // create manager, which reads the most requested data-sets into the page-cache, so the
+    // first epochs after a restart don't have to wait for the disc
+    const long warmupDataSets = GET_INT_CONFIG("shiori", "warmup_max_data_sets", success);
+    const long warmupMbPerSec = GET_INT_CONFIG("shiori", "warmup_max_mb_per_sec", success);
+    warmupManager = new WarmupManager(dataSetLocation + "/warmup_stats",
+                                      warmupDataSets,
+                                      warmupMbPerSec * 1024 * 1024);
+    if(warmupManager->loadStats(error) == false)
+    {
+        // without statistics the data-sets are only not warmed up, so this is not fatal
+        LOG_ERROR(error);
+    }
+    if(GET_BOOL_CONFIG("shiori", "warmup_on_startup", success)) {
+        warmupManager->startWarmup();
+    }
+
     initBlossoms();
 
     return true;
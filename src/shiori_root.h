@@ -34,6 +34,15 @@ class RequestResultTable;
 class ErrorLogTable;
 class AuditLogTable;
 class TempFileHandler;
+class DataSetCache;
+class BatchServer;
+class BlockStore;
+class NormalizationCache;
+class PayloadCache;
+class LoadCoalescer;
+class WorkerPool;
+class WarmupManager;
+class LocalHandoff;
 
 class ShioriRoot
 {
@@ -43,6 +52,16 @@ public:
     bool init();
 
     static TempFileHandler* tempFileHandler;
+    static DataSetCache* dataSetCache;
+    static BatchServer* batchServer;
+    static BlockStore* dataSetBlockStore;
+    static BlockStore* clusterSnapshotBlockStore;
+    static NormalizationCache* normalizationCache;
+    static PayloadCache* payloadCache;
+    static LoadCoalescer* payloadLoads;
+    static WorkerPool* workerPool;
+    static WarmupManager* warmupManager;
+    static LocalHandoff* localHandoff;
     static DataSetTable* dataSetTable;
     static ClusterSnapshotTable* clusterSnapshotTable;
     static RequestResultTable* requestResultTable;
@@ -0,0 +1,241 @@
+/**
+ * @file        block_store_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "block_store_test.h"
+
+#include <core/block_store.h>
+
+#include <libKitsunemimiCommon/files/binary_file.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <vector>
+
+/**
+ * @brief create random bytes
+ *
+ * @param data reference for the resulting bytes
+ * @param size number of bytes
+ */
+static void
+createRandomData(std::vector<uint8_t> &data,
+                 const uint64_t size)
+{
+    std::mt19937 generator(42);
+    data.resize(size);
+    for(uint8_t &value : data) {
+        value = generator() & 0xff;
+    }
+}
+
+/**
+ * @brief constructor
+ */
+BlockStore_Test::BlockStore_Test()
+    : Kitsunemimi::CompareTestHelper("BlockStore_Test")
+{
+    splitIntoBlocks_test();
+    splitIntoBlocks_shift_test();
+    splitIntoFixedBlocks_test();
+    sharedLocation_test();
+}
+
+/**
+ * @brief splitIntoBlocks_test: content-defined blocks cover the data completely and have sizes
+ *        within the limits
+ */
+void
+BlockStore_Test::splitIntoBlocks_test()
+{
+    std::vector<uint64_t> blockEnds;
+
+    // no data and data smaller than the minimal block-size
+    std::vector<uint8_t> data;
+    BlockStore::splitIntoBlocks(blockEnds, data.data(), 0);
+    TEST_EQUAL(blockEnds.size(), 0);
+    createRandomData(data, 1000);
+    BlockStore::splitIntoBlocks(blockEnds, data.data(), data.size());
+    TEST_EQUAL(blockEnds.size(), 1);
+    TEST_EQUAL(blockEnds.at(0), 1000);
+
+    // all blocks, except of the last one, are within the limits
+    createRandomData(data, 8 * 1024 * 1024);
+    blockEnds.clear();
+    BlockStore::splitIntoBlocks(blockEnds, data.data(), data.size());
+    TEST_EQUAL(blockEnds.back(), data.size());
+    bool withinLimits = true;
+    uint64_t blockStart = 0;
+    for(uint64_t i = 0; i < blockEnds.size() - 1; i++)
+    {
+        const uint64_t blockSize = blockEnds[i] - blockStart;
+        withinLimits &= blockSize >= BlockStore::MIN_BLOCK_SIZE;
+        withinLimits &= blockSize <= BlockStore::MAX_BLOCK_SIZE;
+        blockStart = blockEnds[i];
+    }
+    TEST_EQUAL(withinLimits, true);
+
+    // the sizes of random data stay close to the average
+    const uint64_t averageSize = data.size() / blockEnds.size();
+    const bool nearAverage = averageSize > BlockStore::AVG_BLOCK_SIZE / 2
+                             && averageSize < BlockStore::AVG_BLOCK_SIZE * 2;
+    TEST_EQUAL(nearAverage, true);
+
+    // data without content, which could define borders, are split at the maximal size
+    std::vector<uint8_t> zeros(1024 * 1024, 0);
+    blockEnds.clear();
+    BlockStore::splitIntoBlocks(blockEnds, zeros.data(), zeros.size());
+    TEST_EQUAL(blockEnds.back(), zeros.size());
+    const bool atMaximum = blockEnds.size() == zeros.size() / BlockStore::MAX_BLOCK_SIZE;
+    TEST_EQUAL(atMaximum, true);
+}
+
+/**
+ * @brief splitIntoBlocks_shift_test: inserted bytes only change the blocks around the insertion,
+ *        because the borders only depend on the content before them
+ */
+void
+BlockStore_Test::splitIntoBlocks_shift_test()
+{
+    std::vector<uint8_t> data;
+    createRandomData(data, 4 * 1024 * 1024);
+    std::vector<uint64_t> originalEnds;
+    BlockStore::splitIntoBlocks(originalEnds, data.data(), data.size());
+
+    const uint64_t insertPos = 1024 * 1024;
+    const uint64_t insertSize = 100;
+    data.insert(data.begin() + insertPos, insertSize, 0x42);
+    std::vector<uint64_t> shiftedEnds;
+    BlockStore::splitIntoBlocks(shiftedEnds, data.data(), data.size());
+
+    // same blocks before the insertion
+    bool sameBefore = true;
+    for(uint64_t i = 0; i < originalEnds.size() && originalEnds[i] < insertPos; i++) {
+        sameBefore &= shiftedEnds.at(i) == originalEnds[i];
+    }
+    TEST_EQUAL(sameBefore, true);
+
+    // borders behind the insertion are found again at the shifted position
+    std::set<uint64_t> shifted(shiftedEnds.begin(), shiftedEnds.end());
+    uint64_t numberOfBorders = 0;
+    uint64_t numberOfFound = 0;
+    for(const uint64_t blockEnd : originalEnds)
+    {
+        if(blockEnd < insertPos + BlockStore::MAX_BLOCK_SIZE) {
+            continue;
+        }
+        numberOfBorders++;
+        numberOfFound += shifted.count(blockEnd + insertSize);
+    }
+    const bool hasBorders = numberOfBorders > 0;
+    TEST_EQUAL(hasBorders, true);
+    TEST_EQUAL(numberOfFound, numberOfBorders);
+}
+
+/**
+ * @brief splitIntoFixedBlocks_test: blocks of fixed size, where only the last block is smaller
+ */
+void
+BlockStore_Test::splitIntoFixedBlocks_test()
+{
+    std::vector<uint64_t> blockEnds;
+
+    BlockStore::splitIntoFixedBlocks(blockEnds, 10, 4);
+    TEST_EQUAL(blockEnds.size(), 3);
+    TEST_EQUAL(blockEnds.at(0), 4);
+    TEST_EQUAL(blockEnds.at(1), 8);
+    TEST_EQUAL(blockEnds.at(2), 10);
+
+    // size is a multiple of the block-size
+    BlockStore::splitIntoFixedBlocks(blockEnds, 8, 4);
+    TEST_EQUAL(blockEnds.size(), 2);
+    TEST_EQUAL(blockEnds.back(), 8);
+
+    // data smaller than a block
+    BlockStore::splitIntoFixedBlocks(blockEnds, 3, 4);
+    TEST_EQUAL(blockEnds.size(), 1);
+    TEST_EQUAL(blockEnds.at(0), 3);
+
+    // no data and invalid block-size
+    BlockStore::splitIntoFixedBlocks(blockEnds, 0, 4);
+    TEST_EQUAL(blockEnds.size(), 0);
+    BlockStore::splitIntoFixedBlocks(blockEnds, 10, 0);
+    TEST_EQUAL(blockEnds.size(), 0);
+}
+
+/**
+ * @brief sharedLocation_test: stores of the same location share the reference-counts of their
+ *        blocks, so deleting a file of one store keeps the blocks, which are still used by a
+ *        file of the other store
+ */
+void
+BlockStore_Test::sharedLocation_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::string location = (std::filesystem::temp_directory_path()
+                                  / "shiori_block_store_test").string();
+    std::filesystem::remove_all(location);
+    std::filesystem::create_directories(location);
+
+    // two files with the same content
+    std::vector<uint8_t> data;
+    createRandomData(data, 1024 * 1024);
+    const std::string firstPath = location + "/first";
+    const std::string secondPath = location + "/second";
+    for(const std::string &filePath : {firstPath, secondPath})
+    {
+        Kitsunemimi::BinaryFile file(filePath);
+        const bool written = file.allocateStorage(data.size(), error)
+                             && file.writeDataIntoFile(data.data(), 0, data.size(), error)
+                             && file.closeFile(error);
+        TEST_EQUAL(written, true);
+    }
+
+    // the second store is initialized after the first one has already stored its file, so its
+    // initialization must neither delete nor count the blocks of the first store again
+    BlockStore firstStore(location, true, 0);
+    TEST_EQUAL(firstStore.initStore(error), true);
+    TEST_EQUAL(firstStore.storeFile(firstPath, error), true);
+    BlockStore secondStore(location + "/", true, 0);
+    TEST_EQUAL(secondStore.initStore(error), true);
+    TEST_EQUAL(secondStore.storeFile(secondPath, error), true);
+    TEST_EQUAL(BlockStore::isBlockMap(firstPath), true);
+    TEST_EQUAL(BlockStore::isBlockMap(secondPath), true);
+
+    uint64_t storedSize = 0;
+    uint64_t referencedSize = 0;
+    secondStore.getStoreSize(storedSize, referencedSize);
+    TEST_EQUAL(storedSize, data.size());
+    TEST_EQUAL(referencedSize, 2 * data.size());
+
+    // deleting the file of the first store keeps the blocks of the second one
+    TEST_EQUAL(firstStore.deleteFile(firstPath, error), true);
+    std::vector<uint8_t> readData(data.size(), 0);
+    TEST_EQUAL(BlockStore::readFileData(secondPath, readData.data(), 0, data.size(), error), true);
+    const bool sameData = readData == data;
+    TEST_EQUAL(sameData, true);
+    TEST_EQUAL(secondStore.restoreFile(secondPath, error), true);
+    TEST_EQUAL(std::filesystem::file_size(secondPath), data.size());
+
+    std::filesystem::remove_all(location);
+}
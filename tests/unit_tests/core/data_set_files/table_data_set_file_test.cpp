@@ -0,0 +1,546 @@
+/**
+ * @file        table_data_set_file_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "table_data_set_file_test.h"
+
+#include <core/data_set_files/table_data_set_file.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+/**
+ * @brief constructor
+ */
+TableDataSetFile_Test::TableDataSetFile_Test()
+    : Kitsunemimi::CompareTestHelper("TableDataSetFile_Test")
+{
+    m_directory = (std::filesystem::temp_directory_path() / "shiori_table_test").string();
+    std::filesystem::remove_all(m_directory);
+    std::filesystem::create_directories(m_directory);
+
+    // values of all lines in row-major order, which are different in each column
+    m_values.resize(NUMBER_OF_COLUMNS * NUMBER_OF_LINES);
+    for(uint64_t line = 0; line < NUMBER_OF_LINES; line++)
+    {
+        for(uint64_t col = 0; col < NUMBER_OF_COLUMNS; col++) {
+            m_values[line * NUMBER_OF_COLUMNS + col] = (line % 1000) * 0.25f - col * 100.0f;
+        }
+    }
+
+    columnarLayout_test();
+    sectionTable_test();
+    invalidSectionTable_test();
+    versionOne_test();
+    blockIndex_test();
+    dataTypes_test();
+}
+
+/**
+ * @brief destructor
+ */
+TableDataSetFile_Test::~TableDataSetFile_Test()
+{
+    std::filesystem::remove_all(m_directory);
+}
+
+/**
+ * @brief columnarLayout_test: each column is stored as a contiguous block at a page-boundary,
+ *        so a column is read without the values of the other columns
+ */
+void
+TableDataSetFile_Test::columnarLayout_test()
+{
+    const std::string filePath = m_directory + "/columnar";
+    TEST_EQUAL(createTable(filePath, DataSetFile::COLUMN_MAJOR_LAYOUT), true);
+
+    Kitsunemimi::ErrorContainer error;
+    DataSetFile* file = readDataSetFile(filePath, error);
+    TEST_NOT_EQUAL(file, nullptr);
+    if(file == nullptr) {
+        return;
+    }
+    TableDataSetFile* table = dynamic_cast<TableDataSetFile*>(file);
+    TEST_EQUAL(file->layout, DataSetFile::COLUMN_MAJOR_LAYOUT);
+    TEST_EQUAL(table->isColumnar(), true);
+
+    // column-blocks start at page-boundaries and don't overlap
+    TEST_EQUAL(table->columnOffsets.size(), NUMBER_OF_COLUMNS);
+    bool aligned = true;
+    for(uint64_t col = 0; col < table->columnOffsets.size(); col++)
+    {
+        aligned &= table->columnOffsets[col] % 4096 == 0;
+        if(col > 0)
+        {
+            const uint64_t blockSize = table->columnOffsets[col] - table->columnOffsets[col - 1];
+            aligned &= blockSize >= NUMBER_OF_LINES * sizeof(float);
+        }
+    }
+    TEST_EQUAL(aligned, true);
+
+    // the view on a column points directly to its contiguous values
+    DataSetFile::PayloadView view;
+    TEST_EQUAL(file->getPayloadView(view, "column_2"), true);
+    TEST_EQUAL(view.size, NUMBER_OF_LINES * sizeof(float));
+    bool equal = view.data != nullptr;
+    const float* values = static_cast<const float*>(view.data);
+    for(uint64_t line = 0; line < NUMBER_OF_LINES && equal; line++) {
+        equal &= values[line] == m_values[line * NUMBER_OF_COLUMNS + 2];
+    }
+    TEST_EQUAL(equal, true);
+
+    // ranges of a column
+    uint64_t payloadSize = 0;
+    float* payload = file->getPayload(payloadSize, NUMBER_OF_LINES - 2, 5, "column_3");
+    TEST_EQUAL(payloadSize, 2 * sizeof(float));
+    TEST_EQUAL(payload[0], m_values[(NUMBER_OF_LINES - 2) * NUMBER_OF_COLUMNS + 3]);
+    TEST_EQUAL(payload[1], m_values[(NUMBER_OF_LINES - 1) * NUMBER_OF_COLUMNS + 3]);
+    delete[] payload;
+    delete file;
+
+    // in row-major layout the values of a column are not contiguous
+    const std::string rowMajorPath = m_directory + "/row_major";
+    TEST_EQUAL(createTable(rowMajorPath), true);
+    file = readDataSetFile(rowMajorPath, error);
+    TEST_NOT_EQUAL(file, nullptr);
+    if(file == nullptr) {
+        return;
+    }
+    TEST_EQUAL(file->getPayloadView(view, "column_2"), false);
+    delete file;
+}
+
+/**
+ * @brief sectionTable_test: the section-table of a new file covers the headers and the payload
+ *        and the payload can be read back
+ */
+void
+TableDataSetFile_Test::sectionTable_test()
+{
+    const std::string filePath = m_directory + "/raw";
+    TEST_EQUAL(createTable(filePath), true);
+
+    std::vector<DataSetFile::SectionEntry> sections;
+    TEST_EQUAL(readSectionTable(sections, filePath), true);
+
+    // type-header, columns and payload, where the payload is the last part of the file
+    TEST_EQUAL(sections.size(), 3);
+    uint64_t payloadEnd = 0;
+    bool withinFile = true;
+    for(const DataSetFile::SectionEntry &section : sections)
+    {
+        withinFile &= section.offset + section.size <= std::filesystem::file_size(filePath);
+        if(section.sectionType == DataSetFile::PAYLOAD_SECTION)
+        {
+            TEST_EQUAL(section.entrySize, sizeof(float));
+            TEST_EQUAL(section.size, m_values.size() * sizeof(float));
+            payloadEnd = section.offset + section.size;
+        }
+    }
+    TEST_EQUAL(withinFile, true);
+    TEST_EQUAL(payloadEnd, std::filesystem::file_size(filePath));
+
+    Kitsunemimi::ErrorContainer error;
+    DataSetFile* file = readDataSetFile(filePath, error);
+    TEST_NOT_EQUAL(file, nullptr);
+    if(file == nullptr) {
+        return;
+    }
+
+    TEST_EQUAL(file->name, "test-table");
+    TEST_EQUAL(file->getNumberOfRows(), NUMBER_OF_LINES);
+    TEST_EQUAL(file->getValuesPerRow(), 1);
+
+    uint64_t payloadSize = 0;
+    float* payload = file->getPayload(payloadSize, 10, 5, "column_2");
+    TEST_EQUAL(payloadSize, 5 * sizeof(float));
+    TEST_EQUAL(payload[0], m_values[10 * NUMBER_OF_COLUMNS + 2]);
+    TEST_EQUAL(payload[4], m_values[14 * NUMBER_OF_COLUMNS + 2]);
+    delete[] payload;
+
+    delete file;
+}
+
+/**
+ * @brief invalidSectionTable_test: files with a corrupted number of sections are rejected,
+ *        before the section-table is read
+ */
+void
+TableDataSetFile_Test::invalidSectionTable_test()
+{
+    const std::string filePath = m_directory + "/invalid";
+    TEST_EQUAL(createTable(filePath), true);
+
+    const uint64_t countPos = offsetof(DataSetFile::DataSetHeader, numberOfSections);
+    const std::vector<uint32_t> invalidCounts = {0, DataSetFile::MAX_NUMBER_OF_SECTIONS + 1};
+    for(const uint32_t numberOfSections : invalidCounts)
+    {
+        std::fstream output(filePath, std::ios::in | std::ios::out | std::ios::binary);
+        output.seekp(countPos);
+        output.write(reinterpret_cast<const char*>(&numberOfSections), sizeof(uint32_t));
+        output.close();
+
+        Kitsunemimi::ErrorContainer error;
+        DataSetFile* file = readDataSetFile(filePath, error);
+        TEST_EQUAL(file, nullptr);
+        delete file;
+    }
+}
+
+/**
+ * @brief versionOne_test: files of version 1 without magic-number and section-table are read
+ *        in row-major and in columnar layout
+ */
+void
+TableDataSetFile_Test::versionOne_test()
+{
+    const uint64_t numberOfLines = 100;
+    const std::vector<DataSetFile::DataSetType> types = {DataSetFile::TABLE_TYPE,
+                                                         DataSetFile::TABLE_COLUMNAR_TYPE};
+    for(const DataSetFile::DataSetType type : types)
+    {
+        const bool columnar = type == DataSetFile::TABLE_COLUMNAR_TYPE;
+        const std::string filePath = m_directory + "/version1";
+        std::ofstream output(filePath, std::ios::binary | std::ios::trunc);
+
+        // header of version 1: type followed directly by the name
+        DataSetFile::DataSetHeaderV1 header;
+        memset(header.name, 0, 256);
+        header.type = type;
+        strcpy(header.name, "old-table");
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        DataSetFile::TableTypeHeader tableHeader;
+        tableHeader.numberOfColumns = NUMBER_OF_COLUMNS;
+        tableHeader.numberOfLines = numberOfLines;
+        output.write(reinterpret_cast<const char*>(&tableHeader),
+                     DataSetFile::V1_TABLE_HEADER_SIZE);
+
+        // column-entries of version 1 have no quantization-parameters
+        for(uint64_t col = 0; col < NUMBER_OF_COLUMNS; col++)
+        {
+            DataSetFile::TableHeaderEntry entry;
+            memset(entry.name, 0, 256);
+            entry.setName("column_" + std::to_string(col));
+            entry.isInput = col < NUMBER_OF_COLUMNS - 1;
+            entry.isOutput = col == NUMBER_OF_COLUMNS - 1;
+            output.write(reinterpret_cast<const char*>(&entry), DataSetFile::V1_TABLE_ENTRY_SIZE);
+        }
+
+        uint64_t payloadOffset = sizeof(header)
+                                 + DataSetFile::V1_TABLE_HEADER_SIZE
+                                 + NUMBER_OF_COLUMNS * DataSetFile::V1_TABLE_ENTRY_SIZE;
+        if(columnar)
+        {
+            // offsets of the column-blocks, which directly follow each other
+            payloadOffset += NUMBER_OF_COLUMNS * sizeof(uint64_t);
+            for(uint64_t col = 0; col < NUMBER_OF_COLUMNS; col++)
+            {
+                const uint64_t offset = payloadOffset + col * numberOfLines * sizeof(float);
+                output.write(reinterpret_cast<const char*>(&offset), sizeof(uint64_t));
+            }
+            for(uint64_t col = 0; col < NUMBER_OF_COLUMNS; col++)
+            {
+                for(uint64_t line = 0; line < numberOfLines; line++)
+                {
+                    const float value = m_values[line * NUMBER_OF_COLUMNS + col];
+                    output.write(reinterpret_cast<const char*>(&value), sizeof(float));
+                }
+            }
+        }
+        else
+        {
+            output.write(reinterpret_cast<const char*>(&m_values[0]),
+                         NUMBER_OF_COLUMNS * numberOfLines * sizeof(float));
+        }
+        output.close();
+
+        Kitsunemimi::ErrorContainer error;
+        DataSetFile* file = readDataSetFile(filePath, error);
+        TEST_NOT_EQUAL(file, nullptr);
+        if(file == nullptr) {
+            continue;
+        }
+
+        TEST_EQUAL(file->name, "old-table");
+        TEST_EQUAL(file->type, DataSetFile::TABLE_TYPE);
+        DataSetFile::Layout expectedLayout = DataSetFile::ROW_MAJOR_LAYOUT;
+        if(columnar) {
+            expectedLayout = DataSetFile::COLUMN_MAJOR_LAYOUT;
+        }
+        TEST_EQUAL(file->layout, expectedLayout);
+        TEST_EQUAL(file->dataType, DataSetFile::FLOAT32_DTYPE);
+        TEST_EQUAL(file->getNumberOfRows(), numberOfLines);
+
+        std::vector<std::string> outputColumns;
+        file->getColumnNames(outputColumns, DataSetFile::OUTPUT_COLUMNS);
+        TEST_EQUAL(outputColumns.size(), 1);
+        TEST_EQUAL(outputColumns.at(0), "column_3");
+
+        // values of version 1 are not quantized
+        bool equal = true;
+        for(uint64_t col = 0; col < NUMBER_OF_COLUMNS; col++)
+        {
+            uint64_t payloadSize = 0;
+            float* payload = file->getPayload(payloadSize, "column_" + std::to_string(col));
+            for(uint64_t line = 0; line < numberOfLines; line++) {
+                equal &= payload[line] == m_values[line * NUMBER_OF_COLUMNS + col];
+            }
+            delete[] payload;
+        }
+        TEST_EQUAL(equal, true);
+
+        delete file;
+    }
+}
+
+/**
+ * @brief blockIndex_test: compressed payloads are split into blocks of complete lines, which
+ *        are found again for ranges within and across the borders of the blocks
+ */
+void
+TableDataSetFile_Test::blockIndex_test()
+{
+    const uint64_t lineSize = NUMBER_OF_COLUMNS * sizeof(float);
+    const std::vector<DataSetFile::Encoding> encodings = {DataSetFile::LZ4_ENCODING,
+                                                          DataSetFile::ZSTD_ENCODING};
+    for(const DataSetFile::Encoding encoding : encodings)
+    {
+        const std::string filePath = m_directory + "/compressed";
+        TEST_EQUAL(createTable(filePath, DataSetFile::ROW_MAJOR_LAYOUT, encoding), true);
+
+        // read the block-index directly from the file
+        std::vector<DataSetFile::SectionEntry> sections;
+        TEST_EQUAL(readSectionTable(sections, filePath), true);
+        std::vector<DataSetFile::CompressedBlock> blocks;
+        for(const DataSetFile::SectionEntry &section : sections)
+        {
+            if(section.sectionType != DataSetFile::BLOCK_INDEX_SECTION) {
+                continue;
+            }
+
+            TEST_EQUAL(section.entrySize, sizeof(DataSetFile::CompressedBlock));
+            blocks.resize(section.size / sizeof(DataSetFile::CompressedBlock));
+            std::ifstream input(filePath, std::ios::binary);
+            input.seekg(section.offset);
+            input.read(reinterpret_cast<char*>(&blocks[0]), section.size);
+        }
+
+        // blocks follow each other without gaps and contain only complete lines
+        uint64_t payloadOffset = 0;
+        bool consistent = blocks.size() > 1;
+        for(const DataSetFile::CompressedBlock &block : blocks)
+        {
+            consistent &= block.payloadOffset == payloadOffset;
+            consistent &= block.payloadOffset % lineSize == 0;
+            consistent &= block.rawSize <= DataSetFile::COMPRESSED_BLOCK_SIZE;
+            consistent &= block.compressedSize <= block.rawSize;
+            payloadOffset += block.rawSize;
+        }
+        TEST_EQUAL(consistent, true);
+        TEST_EQUAL(payloadOffset, m_values.size() * sizeof(float));
+        if(consistent == false) {
+            continue;
+        }
+
+        Kitsunemimi::ErrorContainer error;
+        DataSetFile* file = readDataSetFile(filePath, error);
+        TEST_NOT_EQUAL(file, nullptr);
+        if(file == nullptr) {
+            continue;
+        }
+        TEST_EQUAL(file->encoding, encoding);
+
+        // first lines, lines around the border of the first two blocks and the last lines, where
+        // the last range is cut at the end of the table
+        const uint64_t border = blocks.at(1).payloadOffset / lineSize;
+        const std::vector<std::pair<uint64_t, uint64_t>> ranges = {{0, 3},
+                                                                   {border - 2, 4},
+                                                                   {border, 1},
+                                                                   {NUMBER_OF_LINES - 3, 10}};
+        std::vector<std::string> columnNames;
+        file->getColumnNames(columnNames, DataSetFile::ALL_COLUMNS);
+        for(const std::pair<uint64_t, uint64_t> &range : ranges)
+        {
+            const uint64_t numberOfLines = std::min(range.second, NUMBER_OF_LINES - range.first);
+            uint64_t payloadSize = 0;
+            float* payload = file->getColumnsPayload(payloadSize,
+                                                     range.first,
+                                                     range.second,
+                                                     columnNames,
+                                                     false);
+            TEST_EQUAL(payloadSize, numberOfLines * lineSize);
+
+            const int compared = memcmp(payload,
+                                        &m_values[range.first * NUMBER_OF_COLUMNS],
+                                        numberOfLines * lineSize);
+            TEST_EQUAL(compared, 0);
+            delete[] payload;
+        }
+
+        delete file;
+    }
+}
+
+/**
+ * @brief dataTypes_test: payloads stored as float16, bfloat16 and int8 have the smaller size in
+ *        the file and are converted back into floats within the precision of the data-type
+ */
+void
+TableDataSetFile_Test::dataTypes_test()
+{
+    const std::vector<DataSetFile::DataType> dataTypes = {DataSetFile::FLOAT16_DTYPE,
+                                                          DataSetFile::BFLOAT16_DTYPE,
+                                                          DataSetFile::INT8_DTYPE};
+    for(const DataSetFile::DataType dataType : dataTypes)
+    {
+        const std::string filePath = m_directory + "/compact";
+        const bool created = createTable(filePath,
+                                         DataSetFile::ROW_MAJOR_LAYOUT,
+                                         DataSetFile::RAW_ENCODING,
+                                         dataType);
+        TEST_EQUAL(created, true);
+
+        Kitsunemimi::ErrorContainer error;
+        DataSetFile* file = readDataSetFile(filePath, error);
+        TEST_NOT_EQUAL(file, nullptr);
+        if(file == nullptr) {
+            continue;
+        }
+        TableDataSetFile* table = dynamic_cast<TableDataSetFile*>(file);
+
+        const uint64_t valueSize = dataType == DataSetFile::INT8_DTYPE ? 1 : 2;
+        TEST_EQUAL(file->dataType, dataType);
+        TEST_EQUAL(file->getValueSize(), valueSize);
+
+        uint64_t compactSize = 0;
+        uint8_t* compact = file->getCompactPayload(compactSize, "column_1");
+        TEST_EQUAL(compactSize, NUMBER_OF_LINES * valueSize);
+        delete[] compact;
+
+        uint64_t payloadSize = 0;
+        float* payload = file->getPayload(payloadSize, "column_1");
+        TEST_EQUAL(payloadSize, NUMBER_OF_LINES * sizeof(float));
+
+        // float16 and bfloat16 have a relative error, int8 an absolute error of half a step
+        bool withinPrecision = true;
+        for(uint64_t line = 0; line < NUMBER_OF_LINES; line++)
+        {
+            const float expected = m_values[line * NUMBER_OF_COLUMNS + 1];
+            float tolerance = std::fabs(expected) * std::ldexp(1.0f, -8);
+            if(dataType == DataSetFile::FLOAT16_DTYPE) {
+                tolerance = std::fabs(expected) * std::ldexp(1.0f, -11);
+            }
+            if(dataType == DataSetFile::INT8_DTYPE) {
+                tolerance = table->tableColumns.at(1).scale * 0.5001f;
+            }
+            if(std::fabs(payload[line] - expected) > tolerance) {
+                withinPrecision = false;
+            }
+        }
+        TEST_EQUAL(withinPrecision, true);
+        delete[] payload;
+
+        delete file;
+    }
+}
+
+/**
+ * @brief create a new table-file with the test-values
+ *
+ * @param filePath path of the new file
+ * @param layout layout of the payload
+ * @param encoding encoding of the payload
+ * @param dataType data-type of the stored values
+ *
+ * @return true, if successful, else false
+ */
+bool
+TableDataSetFile_Test::createTable(const std::string &filePath,
+                                   const DataSetFile::Layout layout,
+                                   const DataSetFile::Encoding encoding,
+                                   const DataSetFile::DataType dataType)
+{
+    std::filesystem::remove(filePath);
+
+    TableDataSetFile file(filePath);
+    file.type = DataSetFile::TABLE_TYPE;
+    file.name = "test-table";
+    file.layout = layout;
+    file.encoding = encoding;
+    file.dataType = dataType;
+    for(uint64_t col = 0; col < NUMBER_OF_COLUMNS; col++)
+    {
+        DataSetFile::TableHeaderEntry entry;
+        entry.setName("column_" + std::to_string(col));
+        entry.isInput = col < NUMBER_OF_COLUMNS - 1;
+        entry.isOutput = col == NUMBER_OF_COLUMNS - 1;
+        file.tableColumns.push_back(entry);
+    }
+    file.tableHeader.numberOfLines = NUMBER_OF_LINES;
+
+    if(file.initNewFile() == false) {
+        return false;
+    }
+    if(dataType == DataSetFile::INT8_DTYPE) {
+        file.updateQuantization(&m_values[0], NUMBER_OF_LINES);
+    }
+
+    // write in two parts, like the segments of an upload
+    const uint64_t firstPart = NUMBER_OF_LINES / 3;
+    return file.addLines(0, &m_values[0], firstPart)
+           && file.addLines(firstPart,
+                            &m_values[firstPart * NUMBER_OF_COLUMNS],
+                            NUMBER_OF_LINES - firstPart)
+           && file.updateHeader();
+}
+
+/**
+ * @brief read the section-table of a file of version 2
+ *
+ * @param sections reference for the resulting sections
+ * @param filePath path of the file
+ *
+ * @return false, if the file has no valid header, else true
+ */
+bool
+TableDataSetFile_Test::readSectionTable(std::vector<DataSetFile::SectionEntry> &sections,
+                                        const std::string &filePath)
+{
+    std::ifstream input(filePath, std::ios::binary);
+    DataSetFile::DataSetHeader header;
+    input.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if(input.good() == false
+            || memcmp(header.magic, DataSetFile::DataSetHeader().magic, 8) != 0
+            || header.numberOfSections > DataSetFile::MAX_NUMBER_OF_SECTIONS)
+    {
+        return false;
+    }
+
+    sections.resize(header.numberOfSections);
+    input.read(reinterpret_cast<char*>(&sections[0]),
+               header.numberOfSections * sizeof(DataSetFile::SectionEntry));
+
+    return input.good();
+}
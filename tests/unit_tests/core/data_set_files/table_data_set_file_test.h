@@ -0,0 +1,62 @@
+/**
+ * @file        table_data_set_file_test.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_TABLEDATASETFILE_TEST_H
+#define SHIORIARCHIVE_TABLEDATASETFILE_TEST_H
+
+#include <libKitsunemimiCommon/test_helper/compare_test_helper.h>
+
+#include <core/data_set_files/data_set_file.h>
+
+#include <string>
+#include <vector>
+
+class TableDataSetFile_Test
+        : public Kitsunemimi::CompareTestHelper
+{
+public:
+    TableDataSetFile_Test();
+    ~TableDataSetFile_Test();
+
+private:
+    void columnarLayout_test();
+    void sectionTable_test();
+    void invalidSectionTable_test();
+    void versionOne_test();
+    void blockIndex_test();
+    void dataTypes_test();
+
+    bool createTable(const std::string &filePath,
+                     const DataSetFile::Layout layout = DataSetFile::ROW_MAJOR_LAYOUT,
+                     const DataSetFile::Encoding encoding = DataSetFile::RAW_ENCODING,
+                     const DataSetFile::DataType dataType = DataSetFile::FLOAT32_DTYPE);
+    bool readSectionTable(std::vector<DataSetFile::SectionEntry> &sections,
+                          const std::string &filePath);
+
+    std::string m_directory = "";
+    std::vector<float> m_values;
+
+    static const uint64_t NUMBER_OF_COLUMNS = 4;
+    static const uint64_t NUMBER_OF_LINES = 50000;
+};
+
+#endif // SHIORIARCHIVE_TABLEDATASETFILE_TEST_H
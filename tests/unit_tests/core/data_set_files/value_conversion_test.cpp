@@ -0,0 +1,362 @@
+/**
+ * @file        value_conversion_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "value_conversion_test.h"
+
+#include <core/data_set_files/value_conversion.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// numbers of values for the bulk-conversions. The vectorized kernels process blocks of 8 values
+// and leave the rest to the scalar loop, so each size covers a different length of the tail.
+static const std::vector<uint64_t> testSizes = {0, 1, 7, 8, 9, 1027};
+
+/**
+ * @brief create random values with a wide range of magnitudes and signs
+ *
+ * @param values reference for the resulting values
+ * @param numberOfValues number of values to create
+ * @param maxExponent maximal binary exponent of the values
+ */
+static void
+createTestValues(std::vector<float> &values,
+                 const uint64_t numberOfValues,
+                 const int maxExponent)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> mantissa(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> exponent(-maxExponent, maxExponent);
+
+    values.resize(numberOfValues);
+    for(uint64_t i = 0; i < numberOfValues; i++) {
+        values[i] = std::ldexp(mantissa(generator), exponent(generator));
+    }
+}
+
+/**
+ * @brief constructor
+ */
+ValueConversion_Test::ValueConversion_Test()
+    : Kitsunemimi::CompareTestHelper("ValueConversion_Test")
+{
+    float16_test();
+    bfloat16_test();
+    int8_test();
+    clipValues_test();
+    logValues_test();
+    expandOneHot_test();
+}
+
+/**
+ * @brief float16: exact values, rounding, special values and bulk- vs. scalar-conversion
+ */
+void
+ValueConversion_Test::float16_test()
+{
+    // values, which are exactly representable
+    const std::vector<float> exactValues = {0.0f, 1.0f, -2.0f, 0.5f, 65504.0f, 0.00006103515625f};
+    for(const float value : exactValues) {
+        TEST_EQUAL(convertFloat16ToFloat(convertFloatToFloat16(value)), value);
+    }
+
+    // smallest subnormal value and underflow
+    TEST_EQUAL(convertFloat16ToFloat(0x0001), std::ldexp(1.0f, -24));
+    TEST_EQUAL(convertFloatToFloat16(std::ldexp(1.0f, -24)), 0x0001);
+    TEST_EQUAL(convertFloatToFloat16(std::ldexp(1.0f, -26)), 0x0000);
+
+    // round to nearest even: 2049 is exactly between 2048 and 2050
+    TEST_EQUAL(convertFloat16ToFloat(convertFloatToFloat16(2049.0f)), 2048.0f);
+    TEST_EQUAL(convertFloat16ToFloat(convertFloatToFloat16(2051.0f)), 2052.0f);
+
+    // special values
+    const float infinity = std::numeric_limits<float>::infinity();
+    TEST_EQUAL(convertFloatToFloat16(-0.0f), 0x8000);
+    TEST_EQUAL(convertFloatToFloat16(100000.0f), 0x7c00);
+    TEST_EQUAL(convertFloat16ToFloat(convertFloatToFloat16(-infinity)), -infinity);
+    const bool isNan = std::isnan(convertFloat16ToFloat(convertFloatToFloat16(NAN)));
+    TEST_EQUAL(isNan, true);
+
+    // relative error of the round-trip within the half of the precision of float16
+    std::vector<float> values;
+    createTestValues(values, 1027, 14);
+    bool withinPrecision = true;
+    for(const float value : values)
+    {
+        const float result = convertFloat16ToFloat(convertFloatToFloat16(value));
+        if(std::fabs(value) >= 0.00006103515625f
+                && std::fabs(result - value) > std::fabs(value) * std::ldexp(1.0f, -11))
+        {
+            withinPrecision = false;
+        }
+    }
+    TEST_EQUAL(withinPrecision, true);
+
+    // bulk-conversion must be equal to the conversion of single values
+    values.push_back(infinity);
+    values.push_back(std::ldexp(1.0f, -20));
+    for(const uint64_t size : testSizes)
+    {
+        std::vector<uint16_t> converted(size + 1, 0xffff);
+        std::vector<float> restored(size + 1, -1.0f);
+        convertFloatToFloat16(&converted[0], values.data() + values.size() - size, size);
+        convertFloat16ToFloat(&restored[0], &converted[0], size);
+
+        bool equal = true;
+        for(uint64_t i = 0; i < size; i++)
+        {
+            const float value = values[values.size() - size + i];
+            equal &= converted[i] == convertFloatToFloat16(value);
+            equal &= restored[i] == convertFloat16ToFloat(converted[i]);
+        }
+        TEST_EQUAL(equal, true);
+
+        // values behind the given range must not be touched
+        TEST_EQUAL(converted[size], 0xffff);
+        TEST_EQUAL(restored[size], -1.0f);
+    }
+}
+
+/**
+ * @brief bfloat16: exact values, rounding, special values and bulk- vs. scalar-conversion
+ */
+void
+ValueConversion_Test::bfloat16_test()
+{
+    const std::vector<float> exactValues = {0.0f, 1.0f, -3.0f, 0.0078125f, -0.5f};
+    for(const float value : exactValues) {
+        TEST_EQUAL(convertBFloat16ToFloat(convertFloatToBFloat16(value)), value);
+    }
+
+    // round to nearest even at the lowest kept bit
+    TEST_EQUAL(convertFloatToBFloat16(1.0f + std::ldexp(1.0f, -8)), 0x3f80);
+    TEST_EQUAL(convertFloatToBFloat16(1.0f + std::ldexp(3.0f, -8)), 0x3f82);
+
+    // nan stays nan and doesn't become infinity by the rounding
+    const bool isNan = std::isnan(convertBFloat16ToFloat(convertFloatToBFloat16(NAN)));
+    TEST_EQUAL(isNan, true);
+
+    std::vector<float> values;
+    createTestValues(values, 1027, 100);
+    bool withinPrecision = true;
+    for(const float value : values)
+    {
+        const float result = convertBFloat16ToFloat(convertFloatToBFloat16(value));
+        if(std::fabs(result - value) > std::fabs(value) * std::ldexp(1.0f, -8)) {
+            withinPrecision = false;
+        }
+    }
+    TEST_EQUAL(withinPrecision, true);
+
+    values.push_back(std::numeric_limits<float>::infinity());
+    for(const uint64_t size : testSizes)
+    {
+        std::vector<uint16_t> converted(size + 1, 0xffff);
+        std::vector<float> restored(size + 1, -1.0f);
+        convertFloatToBFloat16(&converted[0], values.data() + values.size() - size, size);
+        convertBFloat16ToFloat(&restored[0], &converted[0], size);
+
+        bool equal = true;
+        for(uint64_t i = 0; i < size; i++)
+        {
+            const float value = values[values.size() - size + i];
+            equal &= converted[i] == convertFloatToBFloat16(value);
+            equal &= restored[i] == convertBFloat16ToFloat(converted[i]);
+        }
+        TEST_EQUAL(equal, true);
+        TEST_EQUAL(converted[size], 0xffff);
+        TEST_EQUAL(restored[size], -1.0f);
+    }
+}
+
+/**
+ * @brief int8: quantization-parameters, round-trip, clamping and bulk- vs. scalar-conversion
+ */
+void
+ValueConversion_Test::int8_test()
+{
+    float scale = 0.0f;
+    float zeroPoint = 0.0f;
+
+    // the range is mapped to the complete range of int8, where the rounding of the zero-point
+    // can shift the limits by one step
+    calcInt8Quantization(scale, zeroPoint, -1.0f, 1.0f);
+    TEST_EQUAL(scale, 2.0f / 255.0f);
+    TEST_EQUAL(quantizeFloatToInt8(-1.0f, scale, zeroPoint), -128);
+    const float upperLimit = dequantizeInt8ToFloat(quantizeFloatToInt8(1.0f, scale, zeroPoint),
+                                                   scale,
+                                                   zeroPoint);
+    const bool upperWithinPrecision = std::fabs(upperLimit - 1.0f) <= scale * 0.5001f;
+    TEST_EQUAL(upperWithinPrecision, true);
+
+    // values outside of the range are clamped
+    TEST_EQUAL(quantizeFloatToInt8(-5.0f, scale, zeroPoint), -128);
+    TEST_EQUAL(quantizeFloatToInt8(5.0f, scale, zeroPoint), 127);
+
+    // an empty range falls back to a scale of 1
+    float emptyScale = 0.0f;
+    calcInt8Quantization(emptyScale, zeroPoint, 3.0f, 3.0f);
+    TEST_EQUAL(emptyScale, 1.0f);
+    TEST_EQUAL(dequantizeInt8ToFloat(quantizeFloatToInt8(3.0f, 1.0f, zeroPoint), 1.0f, zeroPoint),
+               3.0f);
+
+    // the round-trip has at most the half of the scale as error
+    calcInt8Quantization(scale, zeroPoint, -10.0f, 30.0f);
+    std::vector<float> values(1027);
+    for(uint64_t i = 0; i < values.size(); i++) {
+        values[i] = -10.0f + (40.0f * i) / (values.size() - 1);
+    }
+    bool withinPrecision = true;
+    for(const float value : values)
+    {
+        const int8_t quantized = quantizeFloatToInt8(value, scale, zeroPoint);
+        const float result = dequantizeInt8ToFloat(quantized, scale, zeroPoint);
+        if(std::fabs(result - value) > scale * 0.5001f) {
+            withinPrecision = false;
+        }
+    }
+    TEST_EQUAL(withinPrecision, true);
+
+    values.push_back(-100.0f);
+    values.push_back(100.0f);
+    for(const uint64_t size : testSizes)
+    {
+        std::vector<int8_t> converted(size + 1, 42);
+        std::vector<float> restored(size + 1, -1.0f);
+        quantizeFloatToInt8(&converted[0],
+                            values.data() + values.size() - size,
+                            size,
+                            scale,
+                            zeroPoint);
+        dequantizeInt8ToFloat(&restored[0], &converted[0], size, scale, zeroPoint);
+
+        bool equal = true;
+        for(uint64_t i = 0; i < size; i++)
+        {
+            const float value = values[values.size() - size + i];
+            equal &= converted[i] == quantizeFloatToInt8(value, scale, zeroPoint);
+            equal &= restored[i] == dequantizeInt8ToFloat(converted[i], scale, zeroPoint);
+        }
+        TEST_EQUAL(equal, true);
+        TEST_EQUAL(converted[size], 42);
+        TEST_EQUAL(restored[size], -1.0f);
+    }
+}
+
+/**
+ * @brief clipValues: vectorized blocks and scalar tail must clip the same way
+ */
+void
+ValueConversion_Test::clipValues_test()
+{
+    std::vector<float> values;
+    createTestValues(values, 1027, 4);
+
+    for(const uint64_t size : testSizes)
+    {
+        std::vector<float> clipped(values.begin(), values.begin() + size);
+        clipped.push_back(100.0f);
+        clipValues(&clipped[0], size, -2.0f, 3.0f);
+
+        bool equal = true;
+        for(uint64_t i = 0; i < size; i++) {
+            equal &= clipped[i] == std::min(std::max(values[i], -2.0f), 3.0f);
+        }
+        TEST_EQUAL(equal, true);
+        TEST_EQUAL(clipped[size], 100.0f);
+    }
+}
+
+/**
+ * @brief logValues: ln(1 + x) in the vectorized blocks and in the scalar tail, also for blocks
+ *        with values, which have no logarithm
+ */
+void
+ValueConversion_Test::logValues_test()
+{
+    std::vector<float> values;
+    createTestValues(values, 1027, 20);
+    for(float &value : values) {
+        value = std::fabs(value);
+    }
+
+    // very small values, where 1 + x is rounded
+    values[3] = 1.0e-10f;
+    values[4] = -1.0e-7f;
+
+    for(const uint64_t size : testSizes)
+    {
+        std::vector<float> result(values.begin(), values.begin() + size);
+        logValues(result.data(), size);
+
+        bool withinPrecision = true;
+        for(uint64_t i = 0; i < size; i++)
+        {
+            const double expected = std::log1p(static_cast<double>(values[i]));
+            if(std::fabs(result[i] - expected) > std::fabs(expected) * 2.0e-6) {
+                withinPrecision = false;
+            }
+        }
+        TEST_EQUAL(withinPrecision, true);
+    }
+
+    // values below -1 become NaN and -1 becomes minus infinity, also in the middle of a block,
+    // while the other values of the block are still transformed
+    std::vector<float> invalid(values.begin(), values.begin() + 19);
+    invalid[2] = -3.0f;
+    invalid[10] = -1.0f;
+    invalid[18] = -2.0f;
+    logValues(&invalid[0], invalid.size());
+    TEST_EQUAL(std::isnan(invalid[2]), true);
+    TEST_EQUAL(invalid[10], -std::numeric_limits<float>::infinity());
+    TEST_EQUAL(std::isnan(invalid[18]), true);
+    const float expected = std::log1p(values[5]);
+    const bool withinPrecision = std::fabs(invalid[5] - expected) <= std::fabs(expected) * 2.0e-6f;
+    TEST_EQUAL(withinPrecision, true);
+    TEST_EQUAL(invalid[0], std::log1p(values[0]));
+}
+
+/**
+ * @brief expandOneHot: valid class-numbers, rounding and invalid values
+ */
+void
+ValueConversion_Test::expandOneHot_test()
+{
+    const std::vector<float> classes = {0.0f, 2.0f, 1.2f, -1.0f, 3.0f, NAN};
+    std::vector<float> result(classes.size() * 3 + 1, 42.0f);
+    expandOneHot(&result[0], &classes[0], classes.size(), 3);
+
+    const std::vector<float> expected = {1.0f, 0.0f, 0.0f,
+                                         0.0f, 0.0f, 1.0f,
+                                         0.0f, 1.0f, 0.0f,
+                                         0.0f, 0.0f, 0.0f,
+                                         0.0f, 0.0f, 0.0f,
+                                         0.0f, 0.0f, 0.0f};
+    bool equal = true;
+    for(uint64_t i = 0; i < expected.size(); i++) {
+        equal &= result[i] == expected[i];
+    }
+    TEST_EQUAL(equal, true);
+    TEST_EQUAL(result[expected.size()], 42.0f);
+}
@@ -0,0 +1,43 @@
+/**
+ * @file        value_conversion_test.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_VALUECONVERSION_TEST_H
+#define SHIORIARCHIVE_VALUECONVERSION_TEST_H
+
+#include <libKitsunemimiCommon/test_helper/compare_test_helper.h>
+
+class ValueConversion_Test
+        : public Kitsunemimi::CompareTestHelper
+{
+public:
+    ValueConversion_Test();
+
+private:
+    void float16_test();
+    void bfloat16_test();
+    void int8_test();
+    void clipValues_test();
+    void logValues_test();
+    void expandOneHot_test();
+};
+
+#endif // SHIORIARCHIVE_VALUECONVERSION_TEST_H
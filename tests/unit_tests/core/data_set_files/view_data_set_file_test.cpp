@@ -0,0 +1,219 @@
+/**
+ * @file        view_data_set_file_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "view_data_set_file_test.h"
+
+#include <core/data_set_files/table_data_set_file.h>
+#include <core/data_set_files/view_data_set_file.h>
+
+#include <filesystem>
+#include <vector>
+
+/**
+ * @brief constructor
+ */
+ViewDataSetFile_Test::ViewDataSetFile_Test()
+    : Kitsunemimi::CompareTestHelper("ViewDataSetFile_Test")
+{
+    m_directory = (std::filesystem::temp_directory_path() / "shiori_view_test").string();
+    std::filesystem::remove_all(m_directory);
+    std::filesystem::create_directories(m_directory);
+
+    // parent-table, where the value of each line is the number of the line
+    m_parentPath = m_directory + "/parent";
+    std::vector<float> values;
+    for(uint64_t line = 0; line < NUMBER_OF_LINES; line++) {
+        values.push_back(line);
+    }
+    {
+        TableDataSetFile file(m_parentPath);
+        file.type = DataSetFile::TABLE_TYPE;
+        file.name = "parent";
+        DataSetFile::TableHeaderEntry entry;
+        entry.setName("value");
+        entry.isInput = true;
+        file.tableColumns.push_back(entry);
+        file.tableHeader.numberOfLines = NUMBER_OF_LINES;
+        const bool created = file.initNewFile()
+                             && file.addLines(0, &values[0], NUMBER_OF_LINES)
+                             && file.updateHeader();
+        TEST_EQUAL(created, true);
+    }
+
+    Kitsunemimi::ErrorContainer error;
+    m_parent = std::shared_ptr<DataSetFile>(readDataSetFile(m_parentPath, error));
+    TEST_NOT_EQUAL(m_parent, nullptr);
+    if(m_parent == nullptr) {
+        return;
+    }
+
+    initView_test();
+    getParentRanges_test();
+    viewOfView_test();
+    readView_test();
+}
+
+/**
+ * @brief destructor
+ */
+ViewDataSetFile_Test::~ViewDataSetFile_Test()
+{
+    m_parent.reset();
+    std::filesystem::remove_all(m_directory);
+}
+
+/**
+ * @brief initView_test: ranges are checked against the parent and directly following ranges
+ *        are merged
+ */
+void
+ViewDataSetFile_Test::initView_test()
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // ranges outside of the parent
+    const std::vector<std::vector<DataSetFile::RowRange>> invalidRanges = {{{990, 11}},
+                                                                           {{1001, 0}},
+                                                                           {{0, 5}, {5, 996}}};
+    for(const std::vector<DataSetFile::RowRange> &ranges : invalidRanges)
+    {
+        ViewDataSetFile view(m_directory + "/invalid");
+        TEST_EQUAL(view.initView(m_parent, m_parentPath, ranges, error), false);
+    }
+
+    // the ranges 10-14 and 15-16 are merged, empty ranges are dropped
+    ViewDataSetFile view(m_directory + "/view");
+    const std::vector<DataSetFile::RowRange> ranges = {{10, 5}, {15, 2}, {500, 0}, {3, 1}};
+    TEST_EQUAL(view.initView(m_parent, m_parentPath, ranges, error), true);
+    TEST_EQUAL(view.type, DataSetFile::VIEW_TYPE);
+    TEST_EQUAL(view.getNumberOfRows(), 8);
+    TEST_EQUAL(view.rowRanges.size(), 2);
+    TEST_EQUAL(view.rowRanges.at(0).startRow, 10);
+    TEST_EQUAL(view.rowRanges.at(0).numberOfRows, 7);
+    TEST_EQUAL(view.rowRanges.at(1).startRow, 3);
+    TEST_EQUAL(view.parentLocation, m_parentPath);
+}
+
+/**
+ * @brief getParentRanges_test: ranges of rows of the view are split at the borders of the
+ *        ranges of the view and cut at its end
+ */
+void
+ViewDataSetFile_Test::getParentRanges_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    ViewDataSetFile view(m_directory + "/view");
+    const std::vector<DataSetFile::RowRange> ranges = {{100, 10}, {0, 5}, {900, 20}};
+    TEST_EQUAL(view.initView(m_parent, m_parentPath, ranges, error), true);
+
+    // within a single range
+    std::vector<DataSetFile::RowRange> parentRanges;
+    view.getParentRanges(parentRanges, 12, 3);
+    TEST_EQUAL(parentRanges.size(), 1);
+    TEST_EQUAL(parentRanges.at(0).startRow, 2);
+    TEST_EQUAL(parentRanges.at(0).numberOfRows, 3);
+
+    // over all ranges, where the last one is cut at the end of the view
+    parentRanges.clear();
+    view.getParentRanges(parentRanges, 8, 100);
+    TEST_EQUAL(parentRanges.size(), 3);
+    TEST_EQUAL(parentRanges.at(0).startRow, 108);
+    TEST_EQUAL(parentRanges.at(0).numberOfRows, 2);
+    TEST_EQUAL(parentRanges.at(1).startRow, 0);
+    TEST_EQUAL(parentRanges.at(1).numberOfRows, 5);
+    TEST_EQUAL(parentRanges.at(2).startRow, 900);
+    TEST_EQUAL(parentRanges.at(2).numberOfRows, 20);
+
+    // behind the end of the view
+    parentRanges.clear();
+    view.getParentRanges(parentRanges, 35, 1);
+    TEST_EQUAL(parentRanges.size(), 0);
+}
+
+/**
+ * @brief viewOfView_test: views of views reference the rows of the underlying data-set
+ */
+void
+ViewDataSetFile_Test::viewOfView_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    std::shared_ptr<ViewDataSetFile> view =
+            std::make_shared<ViewDataSetFile>(m_directory + "/view");
+    const std::vector<DataSetFile::RowRange> ranges = {{100, 10}, {0, 5}};
+    TEST_EQUAL(view->initView(m_parent, m_parentPath, ranges, error), true);
+
+    ViewDataSetFile subView(m_directory + "/sub_view");
+    const std::vector<DataSetFile::RowRange> subRanges = {{8, 4}};
+    TEST_EQUAL(subView.initView(view, m_directory + "/view", subRanges, error), true);
+    TEST_EQUAL(subView.parentLocation, m_parentPath);
+    TEST_EQUAL(subView.getNumberOfRows(), 4);
+    TEST_EQUAL(subView.rowRanges.size(), 2);
+    TEST_EQUAL(subView.rowRanges.at(0).startRow, 108);
+    TEST_EQUAL(subView.rowRanges.at(1).startRow, 0);
+    TEST_EQUAL(subView.rowRanges.at(1).numberOfRows, 2);
+}
+
+/**
+ * @brief readView_test: a written view is read again and its payload is gathered from the
+ *        rows of the parent
+ */
+void
+ViewDataSetFile_Test::readView_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::string viewPath = m_directory + "/stored_view";
+    {
+        ViewDataSetFile view(viewPath);
+        view.name = "view";
+        const std::vector<DataSetFile::RowRange> ranges = {{997, 3}, {20, 2}};
+        TEST_EQUAL(view.initView(m_parent, m_parentPath, ranges, error), true);
+        TEST_EQUAL(view.initNewFile(), true);
+    }
+
+    DataSetFile* file = readDataSetFile(viewPath, error);
+    TEST_NOT_EQUAL(file, nullptr);
+    if(file == nullptr) {
+        return;
+    }
+    TEST_EQUAL(file->type, DataSetFile::VIEW_TYPE);
+    TEST_EQUAL(file->getNumberOfRows(), 5);
+
+    // range over the border of the two ranges
+    uint64_t payloadSize = 0;
+    float* payload = file->getPayload(payloadSize, 1, 3, "value");
+    TEST_EQUAL(payloadSize, 3 * sizeof(float));
+    TEST_EQUAL(payload[0], 998.0f);
+    TEST_EQUAL(payload[1], 999.0f);
+    TEST_EQUAL(payload[2], 20.0f);
+    delete[] payload;
+
+    // single rows in arbitrary order
+    const std::vector<uint64_t> rows = {4, 0, 3};
+    payload = file->gatherPayload(payloadSize, rows, "value");
+    TEST_EQUAL(payloadSize, 3 * sizeof(float));
+    TEST_EQUAL(payload[0], 21.0f);
+    TEST_EQUAL(payload[1], 997.0f);
+    TEST_EQUAL(payload[2], 20.0f);
+    delete[] payload;
+
+    delete file;
+}
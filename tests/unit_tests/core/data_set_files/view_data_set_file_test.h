@@ -0,0 +1,53 @@
+/**
+ * @file        view_data_set_file_test.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_VIEWDATASETFILE_TEST_H
+#define SHIORIARCHIVE_VIEWDATASETFILE_TEST_H
+
+#include <libKitsunemimiCommon/test_helper/compare_test_helper.h>
+
+#include <core/data_set_files/data_set_file.h>
+
+#include <memory>
+#include <string>
+
+class ViewDataSetFile_Test
+        : public Kitsunemimi::CompareTestHelper
+{
+public:
+    ViewDataSetFile_Test();
+    ~ViewDataSetFile_Test();
+
+private:
+    void initView_test();
+    void getParentRanges_test();
+    void viewOfView_test();
+    void readView_test();
+
+    std::string m_directory = "";
+    std::string m_parentPath = "";
+    std::shared_ptr<DataSetFile> m_parent;
+
+    static const uint64_t NUMBER_OF_LINES = 1000;
+};
+
+#endif // SHIORIARCHIVE_VIEWDATASETFILE_TEST_H
@@ -0,0 +1,212 @@
+/**
+ * @file        payload_cache_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "payload_cache_test.h"
+
+#include <core/payload_cache.h>
+#include <core/data_set_files/table_data_set_file.h>
+
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+/**
+ * @brief constructor
+ */
+PayloadCache_Test::PayloadCache_Test()
+    : Kitsunemimi::CompareTestHelper("PayloadCache_Test")
+{
+    m_directory = (std::filesystem::temp_directory_path() / "shiori_payload_cache_test").string();
+    std::filesystem::remove_all(m_directory);
+    std::filesystem::create_directories(m_directory);
+
+    // table with two columns, where the payload of each column is cached separately
+    m_filePath = m_directory + "/table";
+    std::vector<float> values;
+    for(uint64_t line = 0; line < NUMBER_OF_LINES; line++)
+    {
+        values.push_back(line);
+        values.push_back(-1.0f * line);
+    }
+    {
+        TableDataSetFile file(m_filePath);
+        file.type = DataSetFile::TABLE_TYPE;
+        file.name = "table";
+        DataSetFile::TableHeaderEntry input;
+        input.setName("input");
+        input.isInput = true;
+        file.tableColumns.push_back(input);
+        DataSetFile::TableHeaderEntry output;
+        output.setName("output");
+        output.isOutput = true;
+        file.tableColumns.push_back(output);
+        file.tableHeader.numberOfLines = NUMBER_OF_LINES;
+        const bool created = file.initNewFile()
+                             && file.addLines(0, &values[0], NUMBER_OF_LINES)
+                             && file.updateHeader();
+        TEST_EQUAL(created, true);
+    }
+
+    Kitsunemimi::ErrorContainer error;
+    m_file = std::shared_ptr<DataSetFile>(readDataSetFile(m_filePath, error));
+    TEST_NOT_EQUAL(m_file, nullptr);
+    if(m_file == nullptr) {
+        return;
+    }
+
+    admission_test();
+    frequencyEviction_test();
+    pinnedDataSet_test();
+    changedFile_test();
+}
+
+/**
+ * @brief destructor
+ */
+PayloadCache_Test::~PayloadCache_Test()
+{
+    m_file.reset();
+    std::filesystem::remove_all(m_directory);
+}
+
+/**
+ * @brief admission_test: payloads are only cached at their second request and served from the
+ *        cache afterwards
+ */
+void
+PayloadCache_Test::admission_test()
+{
+    // disabled cache
+    PayloadCache disabledCache(0);
+    TEST_EQUAL(disabledCache.getPayload(m_file, m_filePath, "input", false), nullptr);
+
+    PayloadCache cache(10 * PAYLOAD_SIZE);
+
+    // a single request, like of a scan, is not cached
+    TEST_EQUAL(cache.getPayload(m_file, m_filePath, "input", false), nullptr);
+    TEST_EQUAL(cache.getStats().rejections, 1);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 0);
+
+    // the second request loads the payload into the cache
+    std::shared_ptr<const std::vector<uint8_t>> payload;
+    payload = cache.getPayload(m_file, m_filePath, "output", false);
+    payload = cache.getPayload(m_file, m_filePath, "output", false);
+    TEST_NOT_EQUAL(payload, nullptr);
+    if(payload == nullptr) {
+        return;
+    }
+    TEST_EQUAL(payload->size(), PAYLOAD_SIZE);
+    const float* values = reinterpret_cast<const float*>(payload->data());
+    TEST_EQUAL(values[7], -7.0f);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 1);
+    TEST_EQUAL(cache.getStats().usedBytes, PAYLOAD_SIZE);
+
+    // further requests are hits and return the same payload
+    TEST_EQUAL(cache.getPayload(m_file, m_filePath, "output", false), payload);
+    TEST_EQUAL(cache.getStats().hits, 1);
+    TEST_EQUAL(cache.getStats().misses, 3);
+}
+
+/**
+ * @brief frequencyEviction_test: a new payload only replaces a cached payload, if it was
+ *        requested more frequently
+ */
+void
+PayloadCache_Test::frequencyEviction_test()
+{
+    // space for only one payload
+    PayloadCache cache(PAYLOAD_SIZE);
+    for(uint32_t i = 0; i < 4; i++) {
+        cache.getPayload(m_file, m_filePath, "input", false);
+    }
+    TEST_EQUAL(cache.getStats().numberOfEntries, 1);
+
+    // less or equal frequently requested payload is rejected, without evicting the cached one
+    for(uint32_t i = 0; i < 4; i++) {
+        TEST_EQUAL(cache.getPayload(m_file, m_filePath, "output", false), nullptr);
+    }
+    TEST_EQUAL(cache.getStats().evictions, 0);
+    TEST_NOT_EQUAL(cache.getPayload(m_file, m_filePath, "input", false), nullptr);
+
+    // after more requests than the cached payload, the new payload replaces it
+    TEST_EQUAL(cache.getPayload(m_file, m_filePath, "output", false), nullptr);
+    TEST_NOT_EQUAL(cache.getPayload(m_file, m_filePath, "output", false), nullptr);
+    TEST_EQUAL(cache.getStats().evictions, 1);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 1);
+    TEST_EQUAL(cache.getStats().usedBytes, PAYLOAD_SIZE);
+}
+
+/**
+ * @brief pinnedDataSet_test: payloads of pinned data-sets are cached at their first request and
+ *        not evicted for other payloads
+ */
+void
+PayloadCache_Test::pinnedDataSet_test()
+{
+    PayloadCache cache(PAYLOAD_SIZE);
+    cache.pinDataSet(m_filePath);
+    TEST_NOT_EQUAL(cache.getPayload(m_file, m_filePath, "input", false), nullptr);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 1);
+    TEST_EQUAL(cache.getStats().numberOfPinned, 1);
+
+    // the second payload is admitted too, but doesn't fit beside the pinned one, so it is only
+    // returned for the current request
+    TEST_NOT_EQUAL(cache.getPayload(m_file, m_filePath, "output", false), nullptr);
+    TEST_EQUAL(cache.getStats().evictions, 0);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 1);
+
+    // after unpinning, the payloads are evicted like all others
+    cache.unpinDataSet(m_filePath);
+    TEST_NOT_EQUAL(cache.getPayload(m_file, m_filePath, "output", false), nullptr);
+    TEST_EQUAL(cache.getStats().numberOfPinned, 0);
+    TEST_EQUAL(cache.getStats().evictions, 1);
+
+    cache.removeDataSet(m_filePath);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 0);
+    TEST_EQUAL(cache.getStats().usedBytes, 0);
+}
+
+/**
+ * @brief changedFile_test: cached payloads of modified files are not served anymore
+ */
+void
+PayloadCache_Test::changedFile_test()
+{
+    PayloadCache cache(10 * PAYLOAD_SIZE);
+    cache.getPayload(m_file, m_filePath, "input", false);
+    cache.getPayload(m_file, m_filePath, "input", false);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 1);
+
+    // new modification-time invalidates the entry, so the request is a miss again
+    const std::filesystem::file_time_type modifyTime =
+            std::filesystem::last_write_time(m_filePath);
+    std::filesystem::last_write_time(m_filePath, modifyTime + std::chrono::seconds(10));
+    TEST_NOT_EQUAL(cache.getPayload(m_file, m_filePath, "input", false), nullptr);
+    TEST_EQUAL(cache.getStats().hits, 0);
+    TEST_EQUAL(cache.getStats().misses, 3);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 1);
+
+    // deleted files are removed from the cache
+    std::filesystem::remove(m_filePath);
+    TEST_EQUAL(cache.getPayload(m_file, m_filePath, "input", false), nullptr);
+    TEST_EQUAL(cache.getStats().numberOfEntries, 0);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file        payload_cache_test.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef SHIORIARCHIVE_PAYLOADCACHE_TEST_H
+#define SHIORIARCHIVE_PAYLOADCACHE_TEST_H
+
+#include <libKitsunemimiCommon/test_helper/compare_test_helper.h>
+
+#include <memory>
+#include <string>
+
+class DataSetFile;
+
+class PayloadCache_Test
+        : public Kitsunemimi::CompareTestHelper
+{
+public:
+    PayloadCache_Test();
+    ~PayloadCache_Test();
+
+private:
+    void admission_test();
+    void frequencyEviction_test();
+    void pinnedDataSet_test();
+    void changedFile_test();
+
+    std::string m_directory = "";
+    std::string m_filePath = "";
+    std::shared_ptr<DataSetFile> m_file;
+
+    static const uint64_t NUMBER_OF_LINES = 1000;
+    static const uint64_t PAYLOAD_SIZE = NUMBER_OF_LINES * sizeof(float);
+};
+
+#endif // SHIORIARCHIVE_PAYLOADCACHE_TEST_H
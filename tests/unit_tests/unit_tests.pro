@@ -0,0 +1,39 @@
+QT -= qt core gui
+
+TARGET = ShioriArchive_UnitTests
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+LIBS += -L../../../libKitsunemimiCommon/src -lKitsunemimiCommon
+LIBS += -L../../../libKitsunemimiCommon/src/debug -lKitsunemimiCommon
+LIBS += -L../../../libKitsunemimiCommon/src/release -lKitsunemimiCommon
+INCLUDEPATH += ../../../libKitsunemimiCommon/include
+
+LIBS += -lcrypto -pthread -lpthread -llz4 -lzstd
+
+INCLUDEPATH += $$PWD \
+               ../../src
+
+SOURCES += main.cpp \
+    core/block_store_test.cpp \
+    core/data_set_files/table_data_set_file_test.cpp \
+    core/data_set_files/value_conversion_test.cpp \
+    core/data_set_files/view_data_set_file_test.cpp \
+    core/payload_cache_test.cpp \
+    ../../src/core/block_store.cpp \
+    ../../src/core/data_set_cache.cpp \
+    ../../src/core/data_set_files/data_set_file.cpp \
+    ../../src/core/data_set_files/image_data_set_file.cpp \
+    ../../src/core/data_set_files/table_data_set_file.cpp \
+    ../../src/core/data_set_files/value_conversion.cpp \
+    ../../src/core/data_set_files/view_data_set_file.cpp \
+    ../../src/core/load_coalescer.cpp \
+    ../../src/core/mapped_file.cpp \
+    ../../src/core/payload_cache.cpp
+
+HEADERS += \
+    core/block_store_test.h \
+    core/data_set_files/table_data_set_file_test.h \
+    core/data_set_files/value_conversion_test.h \
+    core/data_set_files/view_data_set_file_test.h \
+    core/payload_cache_test.h